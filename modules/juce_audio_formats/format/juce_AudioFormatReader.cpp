@@ -377,12 +377,12 @@ MemoryMappedAudioFormatReader::MemoryMappedAudioFormatReader (const File& f, con
     usesFloatingPointData = reader.usesFloatingPointData;
 }
 
-bool MemoryMappedAudioFormatReader::mapEntireFile()
+bool MemoryMappedAudioFormatReader::mapEntireFile (int mappingOptions)
 {
-    return mapSectionOfFile (Range<int64> (0, lengthInSamples));
+    return mapSectionOfFile (Range<int64> (0, lengthInSamples), mappingOptions);
 }
 
-bool MemoryMappedAudioFormatReader::mapSectionOfFile (Range<int64> samplesToMap)
+bool MemoryMappedAudioFormatReader::mapSectionOfFile (Range<int64> samplesToMap, int mappingOptions)
 {
     if (map == nullptr || samplesToMap != mappedSection)
     {
@@ -391,7 +391,7 @@ bool MemoryMappedAudioFormatReader::mapSectionOfFile (Range<int64> samplesToMap)
         const Range<int64> fileRange (sampleToFilePos (samplesToMap.getStart()),
                                       sampleToFilePos (samplesToMap.getEnd()));
 
-        map = new MemoryMappedFile (file, fileRange, MemoryMappedFile::readOnly);
+        map = new MemoryMappedFile (file, fileRange, MemoryMappedFile::readOnly, false, mappingOptions);
 
         if (map->getData() == nullptr)
             map = nullptr;
@@ -399,6 +399,16 @@ bool MemoryMappedAudioFormatReader::mapSectionOfFile (Range<int64> samplesToMap)
             mappedSection = Range<int64> (jmax ((int64) 0, filePosToSample (map->getRange().getStart() + (bytesPerFrame - 1))),
                                           jmin (lengthInSamples, filePosToSample (map->getRange().getEnd())));
     }
+    else if ((mappingOptions & MemoryMappedFile::lockPagesInMemory) != 0)
+    {
+        // (the section is already mapped, so just apply the options to the existing mapping)
+        if (! map->lockPages (map->getRange()))
+            map->prefault (map->getRange());
+    }
+    else if ((mappingOptions & MemoryMappedFile::prefaultPages) != 0)
+    {
+        map->prefault (map->getRange());
+    }
 
     return map != nullptr;
 }
@@ -412,3 +422,187 @@ void MemoryMappedAudioFormatReader::touchSample (int64 sample) const noexcept
     else
         jassertfalse; // you must make sure that the window contains all the samples you're going to attempt to read.
 }
+
+void MemoryMappedAudioFormatReader::touchSampleRange (Range<int64> samples) const noexcept
+{
+    // you must make sure that the window contains all the samples you're going to attempt to read.
+    jassert (map != nullptr && samples.getIntersectionWith (mappedSection) == samples);
+
+    if (map != nullptr)
+        map->prefault (sampleRangeToFileRange (samples));
+}
+
+bool MemoryMappedAudioFormatReader::adviseAccess (Range<int64> samples, MemoryMappedFile::AccessHint hint) const noexcept
+{
+    return map != nullptr && map->adviseAccess (sampleRangeToFileRange (samples), hint);
+}
+
+bool MemoryMappedAudioFormatReader::lockSampleRange (Range<int64> samples) const noexcept
+{
+    return map != nullptr && map->lockPages (sampleRangeToFileRange (samples));
+}
+
+void MemoryMappedAudioFormatReader::unlockSampleRange (Range<int64> samples) const noexcept
+{
+    if (map != nullptr)
+        map->unlockPages (sampleRangeToFileRange (samples));
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class MemoryMappedAudioFormatReaderTests  : public UnitTest
+{
+public:
+    MemoryMappedAudioFormatReaderTests() : UnitTest ("MemoryMappedAudioFormatReader") {}
+
+    static int getTestSample (const int64 sample, const int channel) noexcept
+    {
+        return (int) ((sample * 37 + channel * 1001) % 65536) - 32768;
+    }
+
+    static int getNumWrongSamples (MemoryMappedAudioFormatReader& reader, Range<int64> samples)
+    {
+        AudioSampleBuffer buffer ((int) reader.numChannels, (int) samples.getLength());
+        reader.read (&buffer, 0, buffer.getNumSamples(), samples.getStart(), true, true);
+
+        int numWrong = 0;
+
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+            {
+                if (buffer.getSample (channel, i) != getTestSample (samples.getStart() + i, channel) / 32768.0f)
+                    ++numWrong;
+
+                float sample[numTestChannels];
+                reader.getSample (samples.getStart() + i, sample);
+
+                if (sample[channel] != buffer.getSample (channel, i))
+                    ++numWrong;
+            }
+        }
+
+        return numWrong;
+    }
+
+    void testEdges (MemoryMappedAudioFormatReader& reader)
+    {
+        const Range<int64> mapped (reader.getMappedSection());
+        const Range<int64> first (mapped.getStart(), mapped.getStart() + 1);
+        const Range<int64> last (mapped.getEnd() - 1, mapped.getEnd());
+
+        reader.touchSampleRange (first);
+        reader.touchSampleRange (last);
+        reader.touchSampleRange (Range<int64> (mapped.getEnd(), mapped.getEnd()));
+        reader.touchSampleRange (mapped);
+
+        expectEquals (getNumWrongSamples (reader, first), 0);
+        expectEquals (getNumWrongSamples (reader, last), 0);
+        expectEquals (getNumWrongSamples (reader, mapped), 0);
+    }
+
+    void runTest() override
+    {
+        beginTest ("Mapping the whole file");
+
+        const TemporaryFile tempFile (".wav");
+        const int numSamples = 200000;
+
+        {
+            // (the writer takes 32-bit samples, which are shifted down to 16 bits)
+            HeapBlock<int> samples ((size_t) (numTestChannels * numSamples));
+            const int* channels[numTestChannels + 1] = { nullptr };
+
+            for (int channel = 0; channel < numTestChannels; ++channel)
+            {
+                for (int i = 0; i < numSamples; ++i)
+                    samples[channel * numSamples + i] = getTestSample (i, channel) * 65536;
+
+                channels[channel] = samples + channel * numSamples;
+            }
+
+            ScopedPointer<AudioFormatWriter> writer (WavAudioFormat().createWriterFor (tempFile.getFile().createOutputStream(),
+                                                                                       44100.0, numTestChannels, 16,
+                                                                                       StringPairArray(), 0));
+            expect (writer != nullptr);
+            expect (writer->write (channels, numSamples));
+        }
+
+        ScopedPointer<MemoryMappedAudioFormatReader> reader (WavAudioFormat().createMemoryMappedReader (tempFile.getFile()));
+        expect (reader != nullptr);
+
+        if (reader == nullptr)
+            return;
+
+        {
+            expect (reader->mapEntireFile());
+            expect (reader->getMappedSection() == Range<int64> (0, numSamples));
+            testEdges (*reader);
+
+            // (mapping it again with these options applies them to the existing mapping)
+            expect (reader->mapEntireFile (MemoryMappedFile::prefaultPages));
+            expect (reader->getMappedSection() == Range<int64> (0, numSamples));
+            expect (reader->mapEntireFile (MemoryMappedFile::lockPagesInMemory));
+            expect (reader->getMappedSection() == Range<int64> (0, numSamples));
+            testEdges (*reader);
+        }
+
+        beginTest ("Mapping sections");
+        {
+            const Range<int64> section (10001, 150003);
+
+            expect (reader->mapSectionOfFile (section, MemoryMappedFile::prefaultPages));
+            const Range<int64> mapped (reader->getMappedSection());
+            expect (mapped.contains (section));
+            testEdges (*reader);
+
+            expect (reader->mapSectionOfFile (mapped, MemoryMappedFile::lockPagesInMemory));
+            expect (reader->getMappedSection() == mapped);
+            expect (reader->mapSectionOfFile (mapped, MemoryMappedFile::prefaultPages));
+            expect (reader->getMappedSection() == mapped);
+            testEdges (*reader);
+
+            expect (reader->mapSectionOfFile (Range<int64> (numSamples - 10, numSamples), MemoryMappedFile::lockPagesInMemory));
+            expect (reader->getMappedSection().contains (Range<int64> (numSamples - 10, numSamples)));
+            testEdges (*reader);
+        }
+
+        beginTest ("Access hints and locking");
+        {
+            expect (reader->mapSectionOfFile (Range<int64> (5000, 100000)));
+            const Range<int64> mapped (reader->getMappedSection());
+            const Range<int64> part (mapped.getStart() + 3, mapped.getStart() + 20000);
+
+           #if JUCE_LINUX || JUCE_MAC
+            expect (reader->adviseAccess (part, MemoryMappedFile::randomAccess));
+            expect (reader->adviseAccess (mapped, MemoryMappedFile::sequentialAccess));
+            expect (reader->adviseAccess (mapped, MemoryMappedFile::normalAccess));
+           #endif
+
+            reader->adviseAccess (part, MemoryMappedFile::willNeed);
+
+            // (the OS may refuse to lock it if there's a limit on locked memory)
+            if (reader->lockSampleRange (part))
+                reader->unlockSampleRange (part);
+
+            // (ranges that stick out of the mapped section are clipped to fit it)
+            if (reader->lockSampleRange (Range<int64> (0, numSamples)))
+                reader->unlockSampleRange (Range<int64> (0, numSamples));
+
+            expect (! reader->adviseAccess (Range<int64> (mapped.getEnd() + 1, numSamples), MemoryMappedFile::willNeed));
+            expect (! reader->lockSampleRange (Range<int64> (mapped.getEnd() + 1, numSamples)));
+
+            expectEquals (getNumWrongSamples (*reader, mapped), 0);
+        }
+    }
+
+private:
+    enum { numTestChannels = 2 };
+
+    JUCE_DECLARE_NON_COPYABLE (MemoryMappedAudioFormatReaderTests)
+};
+
+static MemoryMappedAudioFormatReaderTests memoryMappedAudioFormatReaderTests;
+
+#endif
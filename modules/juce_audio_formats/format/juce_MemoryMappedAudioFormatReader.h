@@ -58,11 +58,20 @@ public:
     /** Returns the file that is being mapped */
     const File& getFile() const noexcept                    { return file; }
 
-    /** Attempts to map the entire file into memory. */
-    bool mapEntireFile();
+    /** Attempts to map the entire file into memory.
+        The mappingOptions parameter is a combination of flags from
+        MemoryMappedFile::MappingOptions.
+    */
+    bool mapEntireFile (int mappingOptions = MemoryMappedFile::defaultMapping);
 
-    /** Attempts to map a section of the file into memory. */
-    bool mapSectionOfFile (Range<int64> samplesToMap);
+    /** Attempts to map a section of the file into memory.
+        The mappingOptions parameter is a combination of flags from
+        MemoryMappedFile::MappingOptions - e.g. if you pass lockPagesInMemory, the
+        section will be loaded straight away and kept in memory, so that reading it
+        never has to wait for the disk.
+    */
+    bool mapSectionOfFile (Range<int64> samplesToMap,
+                           int mappingOptions = MemoryMappedFile::defaultMapping);
 
     /** Returns the sample range that's currently memory-mapped and available for reading. */
     Range<int64> getMappedSection() const noexcept          { return mappedSection; }
@@ -70,6 +79,33 @@ public:
     /** Touches the memory for the given sample, to force it to be loaded into active memory. */
     void touchSample (int64 sample) const noexcept;
 
+    /** Touches all the memory for a range of samples, to force it to be loaded into active memory.
+
+        This blocks until the data has been read from the disk, so the idea is to call it on a
+        background thread for the samples that are going to be played next, so that when the
+        audio thread reads them, it won't have to wait for page faults. The samples must be
+        inside the mapped section, and the mapping mustn't be changed while this is running.
+    */
+    void touchSampleRange (Range<int64> samples) const noexcept;
+
+    /** Tells the OS how a range of samples is going to be accessed.
+        E.g. MemoryMappedFile::willNeed will start loading them in the background without
+        blocking, and MemoryMappedFile::randomAccess will stop the OS reading ahead when the
+        file is being read out of order. Returns false if the hint isn't supported.
+        @see MemoryMappedFile::adviseAccess
+    */
+    bool adviseAccess (Range<int64> samples, MemoryMappedFile::AccessHint hint) const noexcept;
+
+    /** Loads a range of samples and locks it into physical memory, so that it can't be paged out.
+        Returns false if the OS refuses, e.g. because the process's limit for locked memory has
+        been reached.
+        @see unlockSampleRange, MemoryMappedFile::lockPages
+    */
+    bool lockSampleRange (Range<int64> samples) const noexcept;
+
+    /** Unlocks a range of samples that was locked with lockSampleRange(). */
+    void unlockSampleRange (Range<int64> samples) const noexcept;
+
     /** Returns the samples for all channels at a given sample position.
         The result array must be large enough to hold a value for each channel
         that this reader contains.
@@ -89,6 +125,13 @@ protected:
     /** Converts a sample index to a byte position in the file. */
     inline int64 sampleToFilePos (int64 sample) const noexcept       { return dataChunkStart + sample * bytesPerFrame; }
 
+    /** Converts a range of samples to the range of bytes that they occupy in the file. */
+    Range<int64> sampleRangeToFileRange (Range<int64> samples) const noexcept
+    {
+        samples = samples.getIntersectionWith (mappedSection);
+        return Range<int64> (sampleToFilePos (samples.getStart()), sampleToFilePos (samples.getEnd()));
+    }
+
     /** Converts a byte position in the file to a sample index. */
     inline int64 filePosToSample (int64 filePos) const noexcept      { return (filePos - dataChunkStart) / bytesPerFrame; }
 
@@ -133,6 +133,7 @@ private:
     virtual void invokeMethod (const Identifier&, const var*, int) {}
    #endif
 
+    JUCE_ALLOCATE_FROM_MEMORY_ARENA
     JUCE_LEAK_DETECTOR (DynamicObject)
 };
 
@@ -0,0 +1,227 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+#if JUCE_UNIT_TESTS
+
+class FlatHashMapTests  : public UnitTest
+{
+public:
+    FlatHashMapTests() : UnitTest ("FlatHashMap") {}
+
+    void runTest() override
+    {
+        beginTest ("Basic operations");
+        {
+            FlatHashMap<int, String> map;
+            expect (map.isEmpty() && map.getNumSlots() >= 16);
+            expect (! map.contains (1) && map[1].isEmpty());
+
+            map.set (1, "one");
+            map.set (2, "two");
+            map.set (1, "uno");
+            expectEquals (map.size(), 2);
+            expectEquals (map[1], String ("uno"));
+            expectEquals (map[2], String ("two"));
+            expect (map.containsValue ("two") && ! map.containsValue ("one"));
+
+            map.remove (1);
+            expect (! map.contains (1) && map.contains (2));
+            expectEquals (map.size(), 1);
+
+            map.clear();
+            expect (map.isEmpty() && ! map.contains (2));
+        }
+
+        beginTest ("Random operations");
+        {
+            Random r = getRandom();
+            FlatHashMap<int, int> map;
+            HashMap<int, int> reference;
+
+            for (int i = 0; i < 50000; ++i)
+            {
+                const int key = r.nextInt (4000) - 2000;
+
+                switch (r.nextInt (4))
+                {
+                    case 0:   map.remove (key); reference.remove (key); break;
+                    default:  map.set (key, i); reference.set (key, i); break;
+                }
+            }
+
+            expectEquals (map.size(), reference.size());
+
+            for (int key = -2000; key < 2000; ++key)
+            {
+                expect (map.contains (key) == reference.contains (key));
+                expectEquals (map[key], reference[key]);
+            }
+
+            int numIterated = 0;
+
+            for (FlatHashMap<int, int>::Iterator i (map); i.next();)
+            {
+                expectEquals (i.getValue(), reference[i.getKey()]);
+                ++numIterated;
+            }
+
+            expectEquals (numIterated, reference.size());
+        }
+
+        beginTest ("Growth");
+        {
+            FlatHashMap<int64, int> map;
+
+            for (int i = 0; i < 100000; ++i)
+                map.set (i * (int64) 1000003, i);
+
+            expectEquals (map.size(), 100000);
+            expect (map.getNumSlots() > map.size() && isPowerOfTwo (map.getNumSlots()));
+
+            for (int i = 0; i < 100000; i += 7)
+                expectEquals (map[i * (int64) 1000003], i);
+
+            FlatHashMap<int64, int> reserved (100000);
+            const int numSlots = reserved.getNumSlots();
+
+            for (int i = 0; i < 100000; ++i)
+                reserved.set (i, i);
+
+            expectEquals (reserved.getNumSlots(), numSlots);
+        }
+
+        beginTest ("Remove values");
+        {
+            FlatHashMap<int, int> map;
+
+            for (int i = 0; i < 1000; ++i)
+                map.set (i, i % 3);
+
+            map.removeValue (1);
+            expectEquals (map.size(), 667);
+            expect (! map.containsValue (1));
+
+            for (int i = 0; i < 1000; ++i)
+                expect (map.contains (i) == (i % 3 != 1));
+        }
+
+        beginTest ("Heterogeneous lookup");
+        {
+            FlatHashMap<String, int> map;
+            map.set ("alpha", 1);
+            map.set (CharPointer_UTF8 ("\xce\xb2\xce\xb7\xcf\x84\xce\xb1"), 2);
+
+            const String alpha ("alpha");
+            expect (map.find (StringRef ("alpha")) != nullptr && *map.find (StringRef ("alpha")) == 1);
+            expect (map.find (alpha) != nullptr && *map.find (alpha) == 1);
+            expect (map.find ("alpha") != nullptr);
+            expect (map.find (StringRef ("beta")) == nullptr);
+            expect (map.find (StringRef (CharPointer_UTF8 ("\xce\xb2\xce\xb7\xcf\x84\xce\xb1"))) != nullptr);
+
+            *map.find (StringRef ("alpha")) = 3;
+            expectEquals (map["alpha"], 3);
+        }
+
+        beginTest ("Performance");
+        {
+            StringArray keys;
+
+            for (int i = 0; i < 20000; ++i)
+                keys.add ("parameter_" + String::toHexString (i * 7919));
+
+            HashMap<String, int> hashMap;
+            FlatHashMap<String, int> flatMap;
+
+            const double hashMapInsert = timeInserts (hashMap, keys);
+            const double flatMapInsert = timeInserts (flatMap, keys);
+            const double hashMapLookup = timeLookups (hashMap, keys);
+            const double flatMapLookup = timeLookups (flatMap, keys);
+
+            logMessage ("20000 String keys, HashMap: insert " + String (hashMapInsert, 2) + "ms, lookup " + String (hashMapLookup, 2)
+                          + "ms; FlatHashMap: insert " + String (flatMapInsert, 2) + "ms, lookup " + String (flatMapLookup, 2) + "ms");
+
+            HashMap<int, int> intHashMap;
+            FlatHashMap<int, int> intFlatMap;
+
+            const double intHashMapTime = timeIntOperations (intHashMap);
+            const double intFlatMapTime = timeIntOperations (intFlatMap);
+
+            logMessage ("200000 int keys, insert + lookup, HashMap: " + String (intHashMapTime, 2)
+                          + "ms; FlatHashMap: " + String (intFlatMapTime, 2) + "ms");
+        }
+    }
+
+    template <typename MapType>
+    static double timeInserts (MapType& map, const StringArray& keys)
+    {
+        const double start = Time::getMillisecondCounterHiRes();
+
+        for (int i = 0; i < keys.size(); ++i)
+            map.set (keys[i], i);
+
+        return Time::getMillisecondCounterHiRes() - start;
+    }
+
+    template <typename MapType>
+    double timeLookups (MapType& map, const StringArray& keys)
+    {
+        const double start = Time::getMillisecondCounterHiRes();
+        int total = 0;
+
+        for (int repeat = 0; repeat < 10; ++repeat)
+            for (int i = 0; i < keys.size(); ++i)
+                total += map[keys[i]];
+
+        const double elapsed = Time::getMillisecondCounterHiRes() - start;
+        expectEquals (total, 10 * (keys.size() * (keys.size() - 1) / 2));
+        return elapsed;
+    }
+
+    template <typename MapType>
+    double timeIntOperations (MapType& map)
+    {
+        const double start = Time::getMillisecondCounterHiRes();
+        int64 total = 0;
+
+        for (int i = 0; i < 200000; ++i)
+            map.set (i * 31, i);
+
+        for (int i = 0; i < 200000; ++i)
+            total += map[i * 31];
+
+        const double elapsed = Time::getMillisecondCounterHiRes() - start;
+        expect (total == 200000 * (int64) 199999 / 2);
+        return elapsed;
+    }
+};
+
+static FlatHashMapTests flatHashMapTests;
+
+#endif
@@ -0,0 +1,630 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+#ifndef JUCE_FLATHASHMAP_H_INCLUDED
+#define JUCE_FLATHASHMAP_H_INCLUDED
+
+
+//==============================================================================
+/**
+    Generates well-distributed 32-bit hashes for some primitive types, intended for
+    use with the FlatHashMap class.
+
+    Unlike DefaultHashFunctions, these return the full hash rather than reducing it to a
+    slot index, and all of the bits are mixed so that the map can use the low bits to pick
+    a slot and the high bits to quickly reject non-matching keys.
+
+    Strings are hashed by their unicode characters, so a String, a StringRef and a
+    UTF-8 const char* containing the same text will all produce the same hash. This is
+    what lets you use a StringRef to search a FlatHashMap that has String keys without
+    having to create a temporary String.
+
+    @see FlatHashMap
+*/
+struct DefaultFlatHashFunctions
+{
+    /** Generates a hash from an integer. */
+    uint32 generateHash (const int key) const noexcept             { return mix ((uint64) (uint32) key); }
+    /** Generates a hash from an unsigned integer. */
+    uint32 generateHash (const uint32 key) const noexcept          { return mix ((uint64) key); }
+    /** Generates a hash from an int64. */
+    uint32 generateHash (const int64 key) const noexcept           { return mix ((uint64) key); }
+    /** Generates a hash from a uint64. */
+    uint32 generateHash (const uint64 key) const noexcept          { return mix (key); }
+    /** Generates a hash from a string. */
+    uint32 generateHash (const String& key) const noexcept         { return hashCharacters (key.getCharPointer()); }
+    /** Generates a hash from a string. */
+    uint32 generateHash (StringRef key) const noexcept             { return hashCharacters (key.text); }
+    /** Generates a hash from a null-terminated UTF-8 string. */
+    uint32 generateHash (const char* key) const noexcept           { return hashCharacters (CharPointer_UTF8 (key)); }
+    /** Generates a hash from a variant. */
+    uint32 generateHash (const var& key) const noexcept            { return generateHash (key.toString()); }
+    /** Generates a hash from a void ptr. */
+    uint32 generateHash (const void* key) const noexcept           { return mix ((uint64) (pointer_sized_uint) key); }
+
+    /** Scrambles the bits of a 64-bit value and returns a 32-bit hash of it. */
+    static uint32 mix (uint64 h) noexcept
+    {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return (uint32) h;
+    }
+
+    /** Hashes the unicode characters in a string, using any of the CharPointer types. */
+    template <typename CharPointerType>
+    static uint32 hashCharacters (CharPointerType text) noexcept
+    {
+        uint64 h = 14695981039346656037ULL;
+
+        for (;;)
+        {
+            const juce_wchar c = text.getAndAdvance();
+
+            if (c == 0)
+                break;
+
+            h = (h ^ (uint64) c) * 1099511628211ULL;
+        }
+
+        return mix (h);
+    }
+
+    /** Hashes the unicode characters in a range of a string, producing the same
+        result as hashing a null-terminated string containing those characters.
+    */
+    template <typename CharPointerType>
+    static uint32 hashCharacters (CharPointerType start, const CharPointerType end) noexcept
+    {
+        uint64 h = 14695981039346656037ULL;
+
+        while (start < end)
+        {
+            const juce_wchar c = start.getAndAdvance();
+
+            if (c == 0)
+                break;
+
+            h = (h ^ (uint64) c) * 1099511628211ULL;
+        }
+
+        return mix (h);
+    }
+};
+
+
+//==============================================================================
+/**
+    Holds a set of mappings between some key/value pairs, using a flat open-addressed
+    hash table.
+
+    This does the same job as HashMap, and has a very similar interface, but rather than
+    allocating a separate linked list node for every item, the keys and values are stored
+    directly in a single array of slots. Collisions are resolved with "Robin Hood" linear
+    probing, which keeps the number of slots that a lookup has to inspect very small, and
+    each slot also has a 32-bit tag containing its probe distance and part of its hash, kept
+    in a separate compact array, so that most non-matching slots can be skipped without
+    touching the keys at all.
+
+    The table always has a power-of-two number of slots, and grows automatically when it
+    becomes more than 7/8 full, so there's no need to choose a number of slots up-front.
+    If you know roughly how many items you'll be adding, you can call reserve() to avoid
+    re-hashing as the map grows.
+
+    The hash function class must have a method that returns a well-distributed 32-bit
+    hash for each key type that you want to use:
+
+    @code
+    struct MyHashGenerator
+    {
+        uint32 generateHash (const MyKeyType& key) const
+        {
+            return DefaultFlatHashFunctions::mix (someFunctionOfMyKeyType (key));
+        }
+    };
+    @endcode
+
+    As well as looking up items by the map's own key type, the find() method lets you
+    use any type that the hash function understands and that can be compared with a key,
+    e.g. a StringRef or string literal when the keys are Strings:
+
+    @code
+    FlatHashMap<String, int> map;
+    map.set ("one", 1);
+
+    if (int* value = map.find (StringRef ("one")))  // no temporary String is created here
+        DBG (*value);
+
+    for (FlatHashMap<String, int>::Iterator i (map); i.next();)
+        DBG (i.getKey() << " -> " << i.getValue());
+    @endcode
+
+    Like the Array class, the key and value types are expected to be copy-by-value
+    types, so if you define them to be pointer types, this class won't delete the
+    objects that they point to.
+
+    Adding or removing items moves other items around within the table, so any pointers
+    returned by find() and any iterators become invalid when the map is modified.
+
+    @tparam HashFunctionType The class of hash function, which must be copy-constructible.
+    @see HashMap, DefaultFlatHashFunctions, CriticalSection
+*/
+template <typename KeyType,
+          typename ValueType,
+          class HashFunctionType = DefaultFlatHashFunctions,
+          class TypeOfCriticalSectionToUse = DummyCriticalSection>
+class FlatHashMap
+{
+private:
+    typedef PARAMETER_TYPE (KeyType)   KeyTypeParameter;
+    typedef PARAMETER_TYPE (ValueType) ValueTypeParameter;
+
+public:
+    //==============================================================================
+    /** Creates an empty hash-map.
+
+        @param numItemsToReserve  If this is greater than zero, enough space will be allocated
+                                  to hold this many items without the table needing to grow.
+        @param hashFunction       An instance of HashFunctionType, which will be copied and
+                                  stored to use with the map. This parameter can be omitted
+                                  if HashFunctionType has a default constructor.
+    */
+    explicit FlatHashMap (int numItemsToReserve = 0,
+                          HashFunctionType hashFunction = HashFunctionType())
+       : hashFunctionToUse (hashFunction), numItems (0), numSlots (0)
+    {
+        reserve (numItemsToReserve);
+    }
+
+    /** Destructor. */
+    ~FlatHashMap()
+    {
+        clear();
+    }
+
+    //==============================================================================
+    /** Removes all values from the map.
+        This doesn't release the memory that the table is using, so the map can be re-filled
+        without needing to grow again.
+    */
+    void clear()
+    {
+        const ScopedLockType sl (getLock());
+
+        for (int i = 0; i < numSlots; ++i)
+        {
+            if (tags[i] != 0)
+            {
+                entries[i].~Entry();
+                tags[i] = 0;
+            }
+        }
+
+        numItems = 0;
+    }
+
+    /** Returns the current number of items in the map. */
+    inline int size() const noexcept                { return numItems; }
+
+    /** Returns true if the map is empty. */
+    inline bool isEmpty() const noexcept            { return numItems == 0; }
+
+    /** Returns the number of slots in the table.
+        This is always a power of two, and is always larger than the number of items.
+    */
+    inline int getNumSlots() const noexcept         { return numSlots; }
+
+    //==============================================================================
+    /** Returns the value corresponding to a given key.
+        If the map doesn't contain the key, a default instance of the value type is returned.
+        @param keyToLookFor    the key of the item being requested
+    */
+    inline ValueType operator[] (KeyTypeParameter keyToLookFor) const
+    {
+        const ScopedLockType sl (getLock());
+        const int index = findIndexOf (keyToLookFor);
+        return index >= 0 ? entries[index].value : ValueType();
+    }
+
+    /** Returns true if the map contains an item with the specied key. */
+    bool contains (KeyTypeParameter keyToLookFor) const
+    {
+        const ScopedLockType sl (getLock());
+        return findIndexOf (keyToLookFor) >= 0;
+    }
+
+    /** Returns a pointer to the value for a key, or nullptr if the key isn't in the map.
+
+        The key can be any type for which the hash function produces the same hash as it
+        does for the equivalent KeyType, and which can be compared with a KeyType using the
+        == operator - e.g. with String keys, you can search using a StringRef or a string
+        literal without creating a temporary String object.
+
+        The pointer that is returned will become invalid as soon as the map is modified.
+    */
+    template <typename OtherKeyType>
+    ValueType* find (const OtherKeyType& keyToLookFor)
+    {
+        const ScopedLockType sl (getLock());
+        const int index = findIndexOf (keyToLookFor);
+        return index >= 0 ? &(entries[index].value) : nullptr;
+    }
+
+    /** Returns a pointer to the value for a key, or nullptr if the key isn't in the map.
+        @see find
+    */
+    template <typename OtherKeyType>
+    const ValueType* find (const OtherKeyType& keyToLookFor) const
+    {
+        const ScopedLockType sl (getLock());
+        const int index = findIndexOf (keyToLookFor);
+        return index >= 0 ? &(entries[index].value) : nullptr;
+    }
+
+    /** Returns true if the hash contains at least one occurrence of a given value. */
+    bool containsValue (ValueTypeParameter valueToLookFor) const
+    {
+        const ScopedLockType sl (getLock());
+
+        for (int i = 0; i < numSlots; ++i)
+            if (tags[i] != 0 && entries[i].value == valueToLookFor)
+                return true;
+
+        return false;
+    }
+
+    //==============================================================================
+    /** Adds or replaces an element in the hash-map.
+        If there's already an item with the given key, this will replace its value. Otherwise, a new item
+        will be added to the map.
+    */
+    void set (KeyTypeParameter newKey, ValueTypeParameter newValue)
+    {
+        const ScopedLockType sl (getLock());
+        const uint32 hash = hashFunctionToUse.generateHash (newKey);
+        const int index = findIndexOf (newKey, hash);
+
+        if (index >= 0)
+        {
+            entries[index].value = newValue;
+            return;
+        }
+
+        if (numItems >= getMaxItemsForSlots (numSlots))
+            resizeTable (jmax ((int) minimumNumSlots, numSlots * 2));
+
+        Entry newEntry (newKey, newValue);
+        insertNewEntry (newEntry, hash);
+    }
+
+    /** Removes the item with the given key, if there is one. */
+    void remove (KeyTypeParameter keyToRemove)
+    {
+        const ScopedLockType sl (getLock());
+        const int index = findIndexOf (keyToRemove);
+
+        if (index >= 0)
+            removeSlot ((uint32) index);
+    }
+
+    /** Removes all items with the given value. */
+    void removeValue (ValueTypeParameter valueToRemove)
+    {
+        const ScopedLockType sl (getLock());
+
+        for (int i = 0; i < numSlots;)
+        {
+            // (removing a slot shifts the next item back into it, so it has to be checked again)
+            if (tags[i] != 0 && entries[i].value == valueToRemove)
+                removeSlot ((uint32) i);
+            else
+                ++i;
+        }
+    }
+
+    /** Makes sure that the table is big enough to hold the given number of items
+        without having to grow.
+    */
+    void reserve (int numItemsToHold)
+    {
+        const ScopedLockType sl (getLock());
+        int newNumSlots = jmax ((int) minimumNumSlots, numSlots);
+
+        while (getMaxItemsForSlots (newNumSlots) < numItemsToHold)
+            newNumSlots *= 2;
+
+        if (newNumSlots > numSlots)
+            resizeTable (newNumSlots);
+    }
+
+    //==============================================================================
+    /** Efficiently swaps the contents of two hash-maps. */
+    template <class OtherHashMapType>
+    void swapWith (OtherHashMapType& otherHashMap) noexcept
+    {
+        const ScopedLockType lock1 (getLock());
+        const typename OtherHashMapType::ScopedLockType lock2 (otherHashMap.getLock());
+
+        tags.swapWith (otherHashMap.tags);
+        entries.swapWith (otherHashMap.entries);
+        std::swap (numItems, otherHashMap.numItems);
+        std::swap (numSlots, otherHashMap.numSlots);
+    }
+
+    //==============================================================================
+    /** Returns the CriticalSection that locks this structure.
+        To lock, you can call getLock().enter() and getLock().exit(), or preferably use
+        an object of ScopedLockType as an RAII lock for it.
+    */
+    inline const TypeOfCriticalSectionToUse& getLock() const noexcept      { return lock; }
+
+    /** Returns the type of scoped lock to use for locking this array */
+    typedef typename TypeOfCriticalSectionToUse::ScopedLockType ScopedLockType;
+
+private:
+    //==============================================================================
+    struct Entry
+    {
+        Entry (KeyTypeParameter k, ValueTypeParameter v)  : key (k), value (v) {}
+
+        KeyType key;
+        ValueType value;
+    };
+
+public:
+    //==============================================================================
+    /** Iterates over the items in a FlatHashMap.
+
+        To use it, repeatedly call next() until it returns false, e.g.
+        @code
+        for (FlatHashMap<String, String>::Iterator i (myMap); i.next();)
+            DBG (i.getKey() << " -> " << i.getValue());
+        @endcode
+
+        The items are returned in no particular order, and as soon as you call any non-const
+        methods on the original map, any iterators that were created beforehand will cease
+        to be valid, and should not be used.
+
+        @see FlatHashMap
+    */
+    struct Iterator
+    {
+        Iterator (const FlatHashMap& hashMapToIterate) noexcept
+            : hashMap (hashMapToIterate), index (-1)
+        {}
+
+        Iterator (const Iterator& other) noexcept
+            : hashMap (other.hashMap), index (other.index)
+        {}
+
+        /** Moves to the next item, if one is available.
+            When this returns true, you can get the item's key and value using getKey() and
+            getValue(). If it returns false, the iteration has finished and you should stop.
+        */
+        bool next() noexcept
+        {
+            while (++index < hashMap.numSlots)
+                if (hashMap.tags[index] != 0)
+                    return true;
+
+            index = hashMap.numSlots;
+            return false;
+        }
+
+        /** Returns the current item's key.
+            This should only be called when a call to next() has just returned true.
+        */
+        KeyType getKey() const
+        {
+            return isValid() ? hashMap.entries[index].key : KeyType();
+        }
+
+        /** Returns the current item's value.
+            This should only be called when a call to next() has just returned true.
+        */
+        ValueType getValue() const
+        {
+            return isValid() ? hashMap.entries[index].value : ValueType();
+        }
+
+        /** Resets the iterator to its starting position. */
+        void reset() noexcept                                   { index = -1; }
+
+        Iterator& operator++() noexcept                         { next(); return *this; }
+        ValueType operator*() const                             { return getValue(); }
+        bool operator!= (const Iterator& other) const noexcept  { return index != other.index; }
+        void resetToEnd() noexcept                              { index = hashMap.numSlots; }
+
+    private:
+        //==============================================================================
+        const FlatHashMap& hashMap;
+        int index;
+
+        bool isValid() const noexcept   { return isPositiveAndBelow (index, hashMap.numSlots) && hashMap.tags[index] != 0; }
+
+        JUCE_LEAK_DETECTOR (Iterator)
+    };
+
+    /** Returns a start iterator for the values in this map. */
+    Iterator begin() const noexcept             { Iterator i (*this); i.next(); return i; }
+
+    /** Returns an end iterator for the values in this map. */
+    Iterator end() const noexcept               { Iterator i (*this); i.resetToEnd(); return i; }
+
+private:
+    //==============================================================================
+    // Each slot's tag holds its distance from its ideal slot plus one in the low byte (so
+    // zero means that the slot is empty), and the top 24 bits of the item's hash.
+    enum
+    {
+        minimumNumSlots = 16,
+        distanceMask = 0xff,
+        maxDistance = 0xfe
+    };
+
+    friend struct Iterator;
+    template <typename, typename, class, class> friend class FlatHashMap;
+
+    HashFunctionType hashFunctionToUse;
+    HeapBlock<uint32> tags;
+    HeapBlock<Entry> entries;
+    int numItems, numSlots;
+    TypeOfCriticalSectionToUse lock;
+
+    static int getMaxItemsForSlots (int slots) noexcept     { return slots - slots / 8; }
+
+    template <typename OtherKeyType>
+    int findIndexOf (const OtherKeyType& key) const
+    {
+        return numItems > 0 ? findIndexOf (key, hashFunctionToUse.generateHash (key)) : -1;
+    }
+
+    template <typename OtherKeyType>
+    int findIndexOf (const OtherKeyType& key, const uint32 hash) const
+    {
+        if (numSlots == 0)
+            return -1;
+
+        const uint32 mask = (uint32) numSlots - 1;
+        const uint32 hashBits = hash & ~(uint32) distanceMask;
+        uint32 index = hash & mask;
+
+        for (uint32 distance = 1;; ++distance)
+        {
+            const uint32 tag = tags[index];
+
+            // If this slot is empty, or holds an item that's closer to its own ideal
+            // position than ours would be, then our key can't be in the table..
+            if ((tag & distanceMask) < distance)
+                return -1;
+
+            if ((tag & ~(uint32) distanceMask) == hashBits && entries[index].key == key)
+                return (int) index;
+
+            index = (index + 1) & mask;
+        }
+    }
+
+    void insertNewEntry (Entry& entry, const uint32 hash)
+    {
+        const uint32 mask = (uint32) numSlots - 1;
+        uint32 index = hash & mask;
+        uint32 tag = (hash & ~(uint32) distanceMask) | 1;
+
+        for (;;)
+        {
+            const uint32 existingTag = tags[index];
+
+            if (existingTag == 0)
+            {
+                new (entries + index) Entry (entry);
+                tags[index] = tag;
+                ++numItems;
+                return;
+            }
+
+            // Take the slot from any item that's nearer to its own ideal position,
+            // and carry on looking for a place to put that one instead..
+            if ((existingTag & distanceMask) < (tag & distanceMask))
+            {
+                std::swap (tags[index], tag);
+                std::swap (entries[index], entry);
+            }
+
+            index = (index + 1) & mask;
+
+            if ((tag & distanceMask) >= maxDistance)
+            {
+                // This only happens if the hash function is producing lots of collisions..
+                jassertfalse;
+                resizeTable (numSlots * 2);
+                insertNewEntry (entry, hashFunctionToUse.generateHash (entry.key));
+                return;
+            }
+
+            ++tag;
+        }
+    }
+
+    void removeSlot (uint32 index)
+    {
+        const uint32 mask = (uint32) numSlots - 1;
+
+        // Shift any following items that aren't in their ideal slot back by one place,
+        // so that there's no need for "deleted" markers..
+        for (;;)
+        {
+            const uint32 next = (index + 1) & mask;
+            const uint32 nextTag = tags[next];
+
+            if ((nextTag & distanceMask) <= 1)
+                break;
+
+            std::swap (entries[index], entries[next]);
+            tags[index] = nextTag - 1;
+            index = next;
+        }
+
+        entries[index].~Entry();
+        tags[index] = 0;
+        --numItems;
+    }
+
+    void resizeTable (const int newNumSlots)
+    {
+        jassert (isPowerOfTwo (newNumSlots) && getMaxItemsForSlots (newNumSlots) >= numItems);
+
+        HeapBlock<uint32> oldTags ((size_t) newNumSlots, true);
+        HeapBlock<Entry> oldEntries ((size_t) newNumSlots);
+        oldTags.swapWith (tags);
+        oldEntries.swapWith (entries);
+
+        const int oldNumSlots = numSlots;
+        numSlots = newNumSlots;
+        numItems = 0;
+
+        for (int i = 0; i < oldNumSlots; ++i)
+        {
+            if (oldTags[i] != 0)
+            {
+                Entry& e = oldEntries[i];
+                insertNewEntry (e, hashFunctionToUse.generateHash (e.key));
+                e.~Entry();
+            }
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FlatHashMap)
+};
+
+
+#endif   // JUCE_FLATHASHMAP_H_INCLUDED
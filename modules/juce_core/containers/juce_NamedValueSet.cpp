@@ -28,6 +28,16 @@
   ==============================================================================
 */
 
+//==============================================================================
+// Once a set contains this many values, it keeps a hash table which maps the address
+// of each name's pooled string to the index of its value.
+static const int minNumValuesForIndex = 16;
+
+struct NamedValueSet::Index  : public FlatHashMap<const void*, int>
+{
+    static const void* getKey (const Identifier& name) noexcept    { return name.getCharPointer().getAddress(); }
+};
+
 //==============================================================================
 NamedValueSet::NamedValueSet() noexcept
 {
@@ -36,24 +46,28 @@ NamedValueSet::NamedValueSet() noexcept
 NamedValueSet::NamedValueSet (const NamedValueSet& other)
    : values (other.values)
 {
+    updateIndex();
 }
 
 NamedValueSet& NamedValueSet::operator= (const NamedValueSet& other)
 {
     clear();
     values = other.values;
+    updateIndex();
     return *this;
 }
 
 #if JUCE_COMPILER_SUPPORTS_MOVE_SEMANTICS
 NamedValueSet::NamedValueSet (NamedValueSet&& other) noexcept
-    : values (static_cast<Array<NamedValue>&&> (other.values))
+    : values (static_cast<Array<NamedValue>&&> (other.values)),
+      nameIndex (other.nameIndex.release())
 {
 }
 
 NamedValueSet& NamedValueSet::operator= (NamedValueSet&& other) noexcept
 {
     other.values.swapWith (values);
+    other.nameIndex.swapWith (nameIndex);
     return *this;
 }
 #endif
@@ -64,9 +78,33 @@ NamedValueSet::~NamedValueSet() noexcept
 
 void NamedValueSet::clear()
 {
+    nameIndex = nullptr;
     values.clear();
 }
 
+void NamedValueSet::updateIndex()
+{
+    const int numValues = values.size();
+
+    if (numValues < minNumValuesForIndex)
+    {
+        nameIndex = nullptr;
+        return;
+    }
+
+    if (nameIndex == nullptr)
+        nameIndex = new Index();
+    else
+        nameIndex->clear();
+
+    nameIndex->reserve (numValues);
+
+    // (going backwards means that if there are any duplicate names, the
+    // first one wins, which is what a linear search would find)
+    for (int i = numValues; --i >= 0;)
+        nameIndex->set (Index::getKey (values.getReference (i).name), i);
+}
+
 bool NamedValueSet::operator== (const NamedValueSet& other) const
 {
     return values == other.values;
@@ -115,6 +153,14 @@ var NamedValueSet::getWithDefault (const Identifier& name, const var& defaultRet
 
 var* NamedValueSet::getVarPointer (const Identifier& name) const noexcept
 {
+    if (nameIndex != nullptr)
+    {
+        if (const int* const i = nameIndex->find (Index::getKey (name)))
+            return &(values.getReference (*i).value);
+
+        return nullptr;
+    }
+
     for (NamedValue* e = values.end(), *i = values.begin(); i != e; ++i)
         if (i->name == name)
             return &(i->value);
@@ -135,6 +181,12 @@ bool NamedValueSet::set (const Identifier& name, var&& newValue)
     }
 
     values.add (NamedValue (name, static_cast<var&&> (newValue)));
+
+    if (nameIndex != nullptr)
+        nameIndex->set (Index::getKey (name), values.size() - 1);
+    else if (values.size() >= minNumValuesForIndex)
+        updateIndex();
+
     return true;
 }
 #endif
@@ -151,6 +203,12 @@ bool NamedValueSet::set (const Identifier& name, const var& newValue)
     }
 
     values.add (NamedValue (name, newValue));
+
+    if (nameIndex != nullptr)
+        nameIndex->set (Index::getKey (name), values.size() - 1);
+    else if (values.size() >= minNumValuesForIndex)
+        updateIndex();
+
     return true;
 }
 
@@ -161,6 +219,12 @@ bool NamedValueSet::contains (const Identifier& name) const noexcept
 
 int NamedValueSet::indexOf (const Identifier& name) const noexcept
 {
+    if (nameIndex != nullptr)
+    {
+        const int* const i = nameIndex->find (Index::getKey (name));
+        return i != nullptr ? *i : -1;
+    }
+
     const int numValues = values.size();
 
     for (int i = 0; i < numValues; ++i)
@@ -171,19 +235,47 @@ int NamedValueSet::indexOf (const Identifier& name) const noexcept
 }
 
 bool NamedValueSet::remove (const Identifier& name)
+{
+    const int i = indexOf (name);
+
+    if (i < 0)
+        return false;
+
+    if (nameIndex != nullptr)
+        removeFromIndex (i);
+
+    values.remove (i);
+    return true;
+}
+
+void NamedValueSet::removeFromIndex (const int indexToRemove)
 {
     const int numValues = values.size();
 
-    for (int i = 0; i < numValues; ++i)
+    if (numValues <= minNumValuesForIndex)
     {
-        if (values.getReference(i).name == name)
+        nameIndex = nullptr;
+        return;
+    }
+
+    nameIndex->remove (Index::getKey (values.getReference (indexToRemove).name));
+
+    // (all the values after the one being removed are about to move down a place - if one
+    // of them has a duplicate of the removed name, it becomes the first value with that name)
+    for (int i = indexToRemove + 1; i < numValues; ++i)
+    {
+        const void* const key = Index::getKey (values.getReference (i).name);
+
+        if (int* const position = nameIndex->find (key))
         {
-            values.remove (i);
-            return true;
+            if (*position == i)
+                --*position;
+        }
+        else
+        {
+            nameIndex->set (key, i - 1);
         }
     }
-
-    return false;
 }
 
 Identifier NamedValueSet::getName (const int index) const noexcept
@@ -231,6 +323,8 @@ void NamedValueSet::setFromXmlAttributes (const XmlElement& xml)
 
         values.add (NamedValue (att->name, var (att->value)));
     }
+
+    updateIndex();
 }
 
 void NamedValueSet::copyToXmlAttributes (XmlElement& xml) const
@@ -253,3 +347,82 @@ void NamedValueSet::copyToXmlAttributes (XmlElement& xml) const
         }
     }
 }
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NamedValueSetTests  : public UnitTest
+{
+public:
+    NamedValueSetTests() : UnitTest ("NamedValueSet") {}
+
+    void runTest() override
+    {
+        beginTest ("Large sets");
+
+        Random r = getRandom();
+        NamedValueSet set;
+        Array<Identifier> names;
+
+        for (int i = 0; i < 500; ++i)
+        {
+            names.add (Identifier ("property" + String (i)));
+            expect (set.set (names.getLast(), i));
+            expect (! set.set (names.getLast(), i));
+        }
+
+        expectEquals (set.size(), 500);
+
+        for (int i = 0; i < 500; ++i)
+        {
+            expect (set.getName (i) == names[i]);
+            expectEquals (set.indexOf (names[i]), i);
+            expect (set[names[i]] == var (i));
+        }
+
+        expect (! set.contains ("missing"));
+
+        for (int i = 0; i < 200; ++i)
+        {
+            const int n = r.nextInt (names.size());
+            expect (set.remove (names[n]));
+            names.remove (n);
+        }
+
+        const NamedValueSet copy (set);
+
+        for (int i = 0; i < names.size(); ++i)
+        {
+            expectEquals (set.indexOf (names[i]), i);
+            expectEquals (copy.indexOf (names[i]), i);
+            expect (copy.getVarPointer (names[i]) == copy.getVarPointerAt (i));
+        }
+
+        int n = 0;
+
+        for (const NamedValueSet::NamedValue* i = set.begin(); i != set.end(); ++i)
+            expect (i->name == names[n++]);
+
+        expectEquals (n, names.size());
+
+        // (values can be changed while iterating, as long as the names are left alone)
+        for (NamedValueSet::NamedValue* i = set.begin(); i != set.end(); ++i)
+            i->value = i->name.toString();
+
+        for (int i = 0; i < names.size(); ++i)
+            expect (set[names[i]] == var (names[i].toString()));
+
+        while (set.size() > 3)
+            set.remove (set.getName (0));
+
+        for (int i = 0; i < 3; ++i)
+            expectEquals (set.indexOf (names[names.size() - 3 + i]), i);
+
+        set.clear();
+        expect (set.isEmpty() && ! set.contains (names[0]));
+    }
+};
+
+static NamedValueSetTests namedValueSetTests;
+
+#endif
@@ -37,6 +37,10 @@
 
     This can be used as a basic structure to hold a set of var object, which can
     be retrieved by using their identifier.
+
+    The values are kept in the order in which they were added. Small sets are searched
+    linearly, but once a set holds more than a few values it also builds a hash table of
+    its names, so that looking up a value stays fast however many properties an object has.
 */
 class JUCE_API  NamedValueSet
 {
@@ -96,8 +100,15 @@ public:
         var value;
     };
 
-    NamedValueSet::NamedValue* begin() { return values.begin(); }
-    NamedValueSet::NamedValue* end()   { return values.end();   }
+    /** Iterates the values in the set.
+        The values can be changed through these, but their names mustn't be, because large
+        sets keep an index of the names which wouldn't be updated. To rename a value, remove
+        it and set it again under the new name.
+    */
+    NamedValueSet::NamedValue* begin() noexcept                 { return values.begin(); }
+    NamedValueSet::NamedValue* end() noexcept                   { return values.end();   }
+    const NamedValueSet::NamedValue* begin() const noexcept     { return values.begin(); }
+    const NamedValueSet::NamedValue* end() const noexcept       { return values.end();   }
 
     //==============================================================================
 
@@ -181,8 +192,18 @@ public:
 
 private:
     //==============================================================================
+    struct Index;
+
     Array<NamedValue> values;
+    ScopedPointer<Index> nameIndex;
+
+    void updateIndex();
+    void removeFromIndex (int);
 };
 
+/** The properties in a NamedValueSet are allocated from the current thread's MemoryArena, if there is one. */
+template <>
+struct HeapBlockAllocator<NamedValueSet::NamedValue>  : public MemoryArena::HeapBlockAllocator {};
+
 
 #endif   // JUCE_NAMEDVALUESET_H_INCLUDED
@@ -362,6 +362,8 @@ public:
         RefCountedArray (Array<var>&& a)  : array (static_cast<Array<var>&&> (a)) { incReferenceCount(); }
        #endif
         Array<var> array;
+
+        JUCE_ALLOCATE_FROM_MEMORY_ARENA
     };
 };
 
@@ -780,7 +782,7 @@ var var::readFromStream (InputStream& input)
                 var v;
                 Array<var>* const destArray = v.convertToArray();
 
-                for (int i = input.readCompressedInt(); --i >= 0;)
+                for (int i = input.readCompressedInt(); --i >= 0 && ! input.isExhausted();)
                     destArray->add (readFromStream (input));
 
                 return v;
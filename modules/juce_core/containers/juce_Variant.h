@@ -323,6 +323,10 @@ private:
     var (const VariantType&) noexcept;
 };
 
+/** Arrays of vars are allocated from the current thread's MemoryArena, if there is one. */
+template <>
+struct HeapBlockAllocator<var>  : public MemoryArena::HeapBlockAllocator {};
+
 /** Compares the values of two var objects, using the var::equals() comparison. */
 JUCE_API bool operator== (const var&, const var&) noexcept;
 /** Compares the values of two var objects, using the var::equals() comparison. */
@@ -0,0 +1,567 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+void* juce_openFileForAsyncIO (const File&, bool forWriting);
+void juce_closeFileForAsyncIO (void* handle);
+int64 juce_fileReadAt (void* handle, int64 position, void* destBuffer, size_t numBytes);
+int64 juce_fileWriteAt (void* handle, int64 position, const void* sourceData, size_t numBytes);
+
+//==============================================================================
+class AsyncFileIO::Backend
+{
+public:
+    Backend (AsyncFileIO& o) noexcept  : owner (o) {}
+    virtual ~Backend() {}
+
+    // Starts performing some requests. A reference to each one has been taken, and the
+    // backend must call requestFinished() for each of them once it's done.
+    virtual void submit (const Array<Request*>& requests) = 0;
+
+protected:
+    AsyncFileIO& owner;
+
+    void requestFinished (Request& r, int64 result)             { owner.requestFinished (r, result); }
+    static void* getNativeHandle (const Request& r) noexcept    { return AsyncFileIO::getNativeHandle (r); }
+
+    JUCE_DECLARE_NON_COPYABLE (Backend)
+};
+
+//==============================================================================
+class AsyncFileIO::ThreadPoolBackend  : public AsyncFileIO::Backend
+{
+public:
+    ThreadPoolBackend (AsyncFileIO& o, int numThreads)
+        : Backend (o), nextRequestIndex (0)
+    {
+        for (int i = 0; i < numThreads; ++i)
+            workers.add (new Worker (*this))->startThread();
+    }
+
+    ~ThreadPoolBackend()
+    {
+        for (int i = 0; i < workers.size(); ++i)
+            workers.getUnchecked (i)->signalThreadShouldExit();
+
+        // (each worker passes this on to the next one as it exits)
+        workAvailable.signal();
+        workers.clear();
+    }
+
+    void submit (const Array<Request*>& requests) override
+    {
+        {
+            const ScopedLock sl (queueLock);
+            queue.addArray (requests);
+        }
+
+        workAvailable.signal();
+    }
+
+private:
+    struct Worker  : public Thread
+    {
+        Worker (ThreadPoolBackend& b)  : Thread ("AsyncFileIO worker"), backend (b) {}
+        ~Worker()   { stopThread (10000); }
+
+        void run() override
+        {
+            while (! threadShouldExit())
+            {
+                if (Request* const r = backend.getNextRequest())
+                    backend.perform (*r);
+                else
+                    backend.workAvailable.wait (-1);
+            }
+
+            backend.workAvailable.signal();
+        }
+
+        ThreadPoolBackend& backend;
+
+        JUCE_DECLARE_NON_COPYABLE (Worker)
+    };
+
+    OwnedArray<Worker> workers;
+    CriticalSection queueLock;
+    Array<Request*> queue;
+    int nextRequestIndex;
+    WaitableEvent workAvailable;
+
+    Request* getNextRequest()
+    {
+        const ScopedLock sl (queueLock);
+
+        if (nextRequestIndex >= queue.size())
+            return nullptr;
+
+        Request* const r = queue.getUnchecked (nextRequestIndex++);
+
+        if (nextRequestIndex < queue.size())
+        {
+            workAvailable.signal();  // wake up another worker to help with the rest
+        }
+        else
+        {
+            queue.clearQuick();
+            nextRequestIndex = 0;
+        }
+
+        return r;
+    }
+
+    void perform (Request& r)
+    {
+        void* const handle = getNativeHandle (r);
+
+        requestFinished (r, r.isWrite() ? juce_fileWriteAt (handle, r.getFilePosition(), r.getBuffer(), r.getNumBytesRequested())
+                                        : juce_fileReadAt  (handle, r.getFilePosition(), r.getBuffer(), r.getNumBytesRequested()));
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (ThreadPoolBackend)
+};
+
+#if ! JUCE_LINUX
+AsyncFileIO::Backend* AsyncFileIO::createNativeBackend (AsyncFileIO&)
+{
+    return nullptr;
+}
+#endif
+
+//==============================================================================
+AsyncFileIO::FileHandle::FileHandle (const File& f, void* h, bool canWrite)
+    : file (f), handle (h), writable (canWrite)
+{
+}
+
+AsyncFileIO::FileHandle::~FileHandle()
+{
+    juce_closeFileForAsyncIO (handle);
+}
+
+AsyncFileIO::Request::Request (FileHandle* f, int64 pos, void* buf, size_t num, bool isWriteOp, Callback* cb)
+    : fileHandle (f), position (pos), buffer (buf), numBytes (num),
+      write (isWriteOp), callback (cb), result (-1), finishedEvent (true)
+{
+}
+
+AsyncFileIO::Request::~Request()
+{
+}
+
+bool AsyncFileIO::Request::waitUntilFinished (const int timeOutMilliseconds) const
+{
+    // (this doesn't check isFinished(), because that becomes true before the callback is made)
+    return finishedEvent.wait (timeOutMilliseconds);
+}
+
+//==============================================================================
+AsyncFileIO::AsyncFileIO (const bool useNativeBackendIfAvailable, const int numThreads)
+    : usingNativeBackend (false), batchDepth (0)
+{
+    if (useNativeBackendIfAvailable)
+        backend = createNativeBackend (*this);
+
+    usingNativeBackend = (backend != nullptr);
+
+    if (backend == nullptr)
+        backend = new ThreadPoolBackend (*this, numThreads > 0 ? numThreads
+                                                               : jmax (2, SystemStats::getNumCpus()));
+}
+
+AsyncFileIO::~AsyncFileIO()
+{
+    // You can't delete this object while one of its ScopedBatch objects is still active!
+    jassert (batchDepth == 0);
+
+    waitForAllRequests();
+    backend = nullptr;
+}
+
+bool AsyncFileIO::isUsingNativeBackend() const noexcept
+{
+    return usingNativeBackend;
+}
+
+AsyncFileIO::FileHandle::Ptr AsyncFileIO::openFile (const File& file, const bool forWriting)
+{
+    if (void* const handle = juce_openFileForAsyncIO (file, forWriting))
+        return new FileHandle (file, handle, forWriting);
+
+    return nullptr;
+}
+
+void* AsyncFileIO::getNativeHandle (const Request& r) noexcept
+{
+    return r.fileHandle->handle;
+}
+
+//==============================================================================
+AsyncFileIO::Request::Ptr AsyncFileIO::read (FileHandle* const file, const int64 filePosition,
+                                             void* const destBuffer, const size_t numBytes,
+                                             Callback* const callback)
+{
+    jassert (file != nullptr && destBuffer != nullptr && filePosition >= 0);
+
+    if (file == nullptr)
+        return nullptr;
+
+    return addRequest (new Request (file, filePosition, destBuffer, numBytes, false, callback));
+}
+
+AsyncFileIO::Request::Ptr AsyncFileIO::write (FileHandle* const file, const int64 filePosition,
+                                              const void* const sourceData, const size_t numBytes,
+                                              Callback* const callback)
+{
+    jassert (file != nullptr && sourceData != nullptr && filePosition >= 0);
+
+    if (file == nullptr)
+        return nullptr;
+
+    // The file must have been opened for writing!
+    jassert (file->isWritable());
+
+    return addRequest (new Request (file, filePosition, const_cast<void*> (sourceData), numBytes, true, callback));
+}
+
+AsyncFileIO::Request::Ptr AsyncFileIO::addRequest (Request* const r)
+{
+    const Request::Ptr request (r);
+
+    // (this reference is released when the request finishes)
+    r->incReferenceCount();
+    ++numRequestsInProgress;
+
+    const ScopedLock sl (lock);
+    requestsInBatch.add (r);
+
+    if (batchDepth == 0)
+        submitBatch();
+
+    return request;
+}
+
+void AsyncFileIO::submitBatch()
+{
+    if (requestsInBatch.size() > 0)
+    {
+        backend->submit (requestsInBatch);
+        requestsInBatch.clearQuick();
+    }
+}
+
+void AsyncFileIO::requestFinished (Request& r, const int64 result)
+{
+    r.result = result;
+    r.finished = 1;
+
+    if (r.callback != nullptr)
+        r.callback->asyncFileOperationFinished (r);
+
+    r.finishedEvent.signal();
+    r.decReferenceCount();
+
+    if (--numRequestsInProgress == 0)
+        allRequestsFinished.signal();
+}
+
+bool AsyncFileIO::waitForAllRequests (const int timeOutMilliseconds)
+{
+    const uint32 startTime = Time::getMillisecondCounter();
+
+    while (numRequestsInProgress.get() > 0)
+    {
+        int timeToWait = 100;
+
+        if (timeOutMilliseconds >= 0)
+        {
+            const int timeLeft = timeOutMilliseconds - (int) (Time::getMillisecondCounter() - startTime);
+
+            if (timeLeft <= 0)
+                return false;
+
+            timeToWait = jmin (timeToWait, timeLeft);
+        }
+
+        allRequestsFinished.wait (timeToWait);
+    }
+
+    return true;
+}
+
+//==============================================================================
+AsyncFileIO::ScopedBatch::ScopedBatch (AsyncFileIO& io)  : owner (io)
+{
+    const ScopedLock sl (owner.lock);
+    ++owner.batchDepth;
+}
+
+AsyncFileIO::ScopedBatch::~ScopedBatch()
+{
+    const ScopedLock sl (owner.lock);
+
+    if (--owner.batchDepth == 0)
+        owner.submitBatch();
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class AsyncFileIOTests  : public UnitTest
+{
+public:
+    AsyncFileIOTests()   : UnitTest ("AsyncFileIO") {}
+
+    struct TestCallback  : public AsyncFileIO::Callback
+    {
+        void asyncFileOperationFinished (AsyncFileIO::Request& r) override
+        {
+            ++numFinished;
+
+            if (r.failed())
+                ++numFailed;
+        }
+
+        Atomic<int> numFinished, numFailed;
+    };
+
+    struct SlowCallback  : public AsyncFileIO::Callback
+    {
+        void asyncFileOperationFinished (AsyncFileIO::Request&) override
+        {
+            Thread::sleep (20);
+            ++numFinished;
+        }
+
+        Atomic<int> numFinished;
+    };
+
+    static MemoryBlock createTestData (Random& r, int size)
+    {
+        MemoryBlock data ((size_t) size);
+
+        for (int i = 0; i < size; ++i)
+            data[i] = (char) r.nextInt (256);
+
+        return data;
+    }
+
+    void testWriting (AsyncFileIO& io, const File& file, const MemoryBlock& data)
+    {
+        AsyncFileIO::FileHandle::Ptr handle (io.openFile (file, true));
+        expect (handle != nullptr && handle->isWritable());
+
+        TestCallback callback;
+        ReferenceCountedArray<AsyncFileIO::Request> requests;
+        const int chunkSize = 65536;
+
+        {
+            // (written in reverse order, to check that the positions are used)
+            const AsyncFileIO::ScopedBatch batch (io);
+
+            for (int pos = ((int) data.getSize() - 1) / chunkSize * chunkSize; pos >= 0; pos -= chunkSize)
+                requests.add (io.write (handle, pos, static_cast<const char*> (data.getData()) + pos,
+                                        (size_t) jmin (chunkSize, (int) data.getSize() - pos), &callback));
+        }
+
+        expect (io.waitForAllRequests (30000));
+        expectEquals (callback.numFinished.get(), requests.size());
+        expectEquals (callback.numFailed.get(), 0);
+
+        for (int i = 0; i < requests.size(); ++i)
+        {
+            AsyncFileIO::Request* const r = requests.getUnchecked (i);
+            expect (r->isFinished() && r->isWrite());
+            expect (r->getNumBytesTransferred() == (int64) r->getNumBytesRequested());
+        }
+
+        handle = nullptr;
+        requests.clear();
+
+        MemoryBlock written;
+        expect (file.loadFileAsData (written) && written == data);
+    }
+
+    void testReading (AsyncFileIO& io, const File& file, const MemoryBlock& data, Random& r)
+    {
+        AsyncFileIO::FileHandle::Ptr handle (io.openFile (file, false));
+        expect (handle != nullptr && ! handle->isWritable());
+
+        TestCallback callback;
+        ReferenceCountedArray<AsyncFileIO::Request> requests;
+        OwnedArray<MemoryBlock> buffers;
+
+        {
+            const AsyncFileIO::ScopedBatch batch (io);
+
+            for (int i = 0; i < 200; ++i)
+            {
+                // (some of these go past the end of the file)
+                MemoryBlock* const buffer = buffers.add (new MemoryBlock ((size_t) r.nextInt (100000) + 1));
+                requests.add (io.read (handle, r.nextInt ((int) data.getSize() + 100),
+                                       buffer->getData(), buffer->getSize(), &callback));
+            }
+        }
+
+        for (int i = 0; i < requests.size(); ++i)
+        {
+            AsyncFileIO::Request* const req = requests.getUnchecked (i);
+            expect (req->waitUntilFinished (30000));
+
+            const int64 expectedSize = jmax ((int64) 0, jmin ((int64) req->getNumBytesRequested(),
+                                                              (int64) data.getSize() - req->getFilePosition()));
+            expect (req->getNumBytesTransferred() == expectedSize);
+            expect (expectedSize == 0 || memcmp (req->getBuffer(), static_cast<const char*> (data.getData()) + req->getFilePosition(),
+                                                 (size_t) expectedSize) == 0);
+        }
+
+        expect (io.waitForAllRequests (30000));
+        expectEquals (callback.numFinished.get(), requests.size());
+        expectEquals (callback.numFailed.get(), 0);
+
+        expect (io.openFile (file.getSiblingFile ("doesnt_exist"), false) == nullptr);
+    }
+
+    void testStream (AsyncFileIO& io, const File& file, const MemoryBlock& data, Random& r)
+    {
+        const char* const original = static_cast<const char*> (data.getData());
+        const int size = (int) data.getSize();
+
+        AsyncFileInputStream in (io, file, 4096, 3);
+        expect (in.openedOk());
+        expectEquals (in.getTotalLength(), (int64) size);
+
+        MemoryBlock buffer ((size_t) size);
+        int pos = 0;
+
+        while (! in.isExhausted())
+        {
+            const int numRead = in.read (static_cast<char*> (buffer.getData()) + pos, jmin (size - pos, r.nextInt (10000)));
+            expect (numRead >= 0);
+            pos += numRead;
+            expectEquals (in.getPosition(), (int64) pos);
+        }
+
+        expectEquals (pos, size);
+        expect (buffer == data);
+
+        for (int i = 0; i < 100; ++i)
+        {
+            const int start = r.nextInt (size);
+            const int num = r.nextInt (20000);
+            expect (in.setPosition (start));
+
+            const int numRead = in.read (buffer.getData(), num);
+            expectEquals (numRead, jmin (num, size - start));
+            expect (memcmp (buffer.getData(), original + start, (size_t) numRead) == 0);
+        }
+
+        expect (in.setPosition (size + 100));
+        expectEquals (in.getPosition(), (int64) size);
+        expect (in.isExhausted());
+
+        AsyncFileInputStream missing (io, file.getSiblingFile ("doesnt_exist"));
+        expect (missing.failedToOpen() && missing.isExhausted());
+    }
+
+    void testEdgeCases (AsyncFileIO& io, const File& file, const MemoryBlock& data)
+    {
+        AsyncFileIO::FileHandle::Ptr handle (io.openFile (file, true));
+        SlowCallback callback;
+        char buffer[16];
+
+        // (an empty read or write succeeds without transferring anything, whichever backend is used)
+        AsyncFileIO::Request::Ptr emptyWrite (io.write (handle, 100, data.getData(), 0, &callback));
+        AsyncFileIO::Request::Ptr emptyRead (io.read (handle, 100, buffer, 0, &callback));
+
+        // ..and a request's callback has always returned by the time waitUntilFinished() does
+        expect (emptyWrite->waitUntilFinished (30000) && emptyRead->waitUntilFinished (30000));
+        expectEquals (callback.numFinished.get(), 2);
+
+        expect (! emptyWrite->failed() && ! emptyRead->failed());
+        expect (emptyWrite->getNumBytesTransferred() == 0 && emptyRead->getNumBytesTransferred() == 0);
+
+        AsyncFileIO::Request::Ptr read (io.read (handle, 100, buffer, sizeof (buffer), &callback));
+        expect (read->waitUntilFinished (30000));
+        expectEquals (callback.numFinished.get(), 3);
+        expect (read->getNumBytesTransferred() == (int64) sizeof (buffer));
+        expect (memcmp (buffer, static_cast<const char*> (data.getData()) + 100, sizeof (buffer)) == 0);
+
+        expect (io.waitForAllRequests (30000));
+    }
+
+    void logThroughput (AsyncFileIO& io, const File& file, const MemoryBlock& data)
+    {
+        AsyncFileIO::FileHandle::Ptr handle (io.openFile (file, false));
+        const size_t chunkSize = 16384;
+        HeapBlock<char> buffer (data.getSize());
+
+        const double startTime = Time::getMillisecondCounterHiRes();
+
+        for (int repeat = 0; repeat < 10; ++repeat)
+        {
+            const AsyncFileIO::ScopedBatch batch (io);
+
+            for (size_t pos = 0; pos < data.getSize(); pos += chunkSize)
+                io.read (handle, (int64) pos, buffer + pos, jmin (chunkSize, data.getSize() - pos));
+        }
+
+        io.waitForAllRequests();
+        const double seconds = (Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+
+        logMessage (String (io.isUsingNativeBackend() ? "io_uring" : "worker threads") + ": "
+                     + String (10.0 * (double) data.getSize() / (seconds * 1024.0 * 1024.0), 1)
+                     + " MB/sec in " + String ((int) chunkSize) + " byte reads");
+    }
+
+    void runTest() override
+    {
+        Random r = getRandom();
+        const MemoryBlock data (createTestData (r, 3 * 1024 * 1024 + r.nextInt (10000)));
+
+        for (int i = 0; i < 2; ++i)
+        {
+            AsyncFileIO io (i == 0);
+            const TemporaryFile temp;
+
+            beginTest (io.isUsingNativeBackend() ? "Native backend" : "Thread pool backend");
+            testWriting (io, temp.getFile(), data);
+            testReading (io, temp.getFile(), data, r);
+            testEdgeCases (io, temp.getFile(), data);
+            logThroughput (io, temp.getFile(), data);
+
+            beginTest ("AsyncFileInputStream");
+            testStream (io, temp.getFile(), data, r);
+        }
+    }
+};
+
+static AsyncFileIOTests asyncFileIOTests;
+
+#endif
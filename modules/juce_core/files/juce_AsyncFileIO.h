@@ -0,0 +1,290 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+#ifndef JUCE_ASYNCFILEIO_H_INCLUDED
+#define JUCE_ASYNCFILEIO_H_INCLUDED
+
+
+//==============================================================================
+/**
+    Performs file reads and writes asynchronously.
+
+    Instead of blocking a thread for each read or write that's in progress, you can
+    queue up as many requests as you like with an AsyncFileIO object, and then either
+    poll or wait for them, or be given a callback when each one finishes.
+
+    On Linux, the requests are passed to the kernel using io_uring, so they don't need
+    any threads at all apart from one that collects the results. Elsewhere (or if the
+    kernel doesn't support io_uring) a small set of worker threads performs them using
+    ordinary positioned reads and writes.
+
+    @code
+    AsyncFileIO io;
+
+    if (AsyncFileIO::FileHandle::Ptr file = io.openFile (myFile, false))
+    {
+        HeapBlock<char> buffer (65536);
+        AsyncFileIO::Request::Ptr request (io.read (file, 0, buffer, 65536));
+
+        ...do something else...
+
+        request->waitUntilFinished();
+        DBG (request->getNumBytesTransferred());
+    }
+    @endcode
+
+    @see AsyncFileInputStream
+*/
+class JUCE_API  AsyncFileIO
+{
+public:
+    //==============================================================================
+    /** Creates an AsyncFileIO object.
+
+        @param useNativeBackendIfAvailable  if true and the OS supports it, io_uring will be used
+                                            rather than a set of worker threads
+        @param numThreads                   the number of worker threads to use if the native
+                                            backend isn't used, or 0 to choose a default
+    */
+    explicit AsyncFileIO (bool useNativeBackendIfAvailable = true, int numThreads = 0);
+
+    /** Destructor.
+        This will wait for any requests that are still in progress to finish.
+    */
+    ~AsyncFileIO();
+
+    /** Returns true if the requests are being passed to the OS's asynchronous I/O
+        system rather than being performed by worker threads.
+    */
+    bool isUsingNativeBackend() const noexcept;
+
+    //==============================================================================
+    /** A file that has been opened for asynchronous reading or writing.
+        @see AsyncFileIO::openFile
+    */
+    class JUCE_API  FileHandle  : public ReferenceCountedObject
+    {
+    public:
+        /** Closes the file. */
+        ~FileHandle();
+
+        /** Returns the file. */
+        const File& getFile() const noexcept            { return file; }
+
+        /** Returns true if the file was opened for writing. */
+        bool isWritable() const noexcept                { return writable; }
+
+        typedef ReferenceCountedObjectPtr<FileHandle> Ptr;
+
+    private:
+        friend class AsyncFileIO;
+        FileHandle (const File&, void*, bool);
+
+        const File file;
+        void* const handle;
+        const bool writable;
+
+        JUCE_DECLARE_NON_COPYABLE (FileHandle)
+    };
+
+    /** Opens a file for asynchronous access.
+
+        If forWriting is true, the file will be created if it doesn't exist, but any
+        existing data isn't truncated. Returns nullptr if the file can't be opened.
+        The file stays open until the last pointer to the handle, including those held
+        by any requests that are using it, has been released.
+    */
+    FileHandle::Ptr openFile (const File& file, bool forWriting);
+
+    //==============================================================================
+    class Request;
+
+    /** Receives a callback when an asynchronous request finishes.
+        @see AsyncFileIO::read, AsyncFileIO::write
+    */
+    class JUCE_API  Callback
+    {
+    public:
+        /** Destructor. */
+        virtual ~Callback() {}
+
+        /** Called when a request has finished.
+
+            This is called on one of the AsyncFileIO's internal threads, so it should return
+            quickly, and must not wait for other requests to finish. It's OK to start new
+            requests from inside the callback.
+        */
+        virtual void asyncFileOperationFinished (Request& request) = 0;
+    };
+
+    //==============================================================================
+    /** An asynchronous read or write, which is returned by AsyncFileIO::read() and write().
+
+        You can use this to check or wait for the operation to finish, and find out how
+        much data was transferred.
+    */
+    class JUCE_API  Request  : public ReferenceCountedObject
+    {
+    public:
+        /** Destructor. */
+        ~Request();
+
+        /** Returns true once the operation has finished (whether it succeeded or not). */
+        bool isFinished() const noexcept                    { return finished.get() != 0; }
+
+        /** Waits for the operation to finish, and for its callback (if it has one) to return.
+            @returns true if it finished, or false if the timeout expired first
+        */
+        bool waitUntilFinished (int timeOutMilliseconds = -1) const;
+
+        /** Returns the number of bytes that were read or written, or -1 if the operation
+            failed. For a read, this can be less than the number requested if the end of
+            the file was reached. This can only be called once the request has finished.
+        */
+        int64 getNumBytesTransferred() const noexcept       { jassert (isFinished()); return result; }
+
+        /** Returns true if the request has finished, and the operation failed. */
+        bool failed() const noexcept                        { return isFinished() && result < 0; }
+
+        /** Returns true if this is a write rather than a read. */
+        bool isWrite() const noexcept                       { return write; }
+
+        /** Returns the file that is being used. */
+        const File& getFile() const noexcept                { return fileHandle->getFile(); }
+
+        /** Returns the position in the file at which the operation starts. */
+        int64 getFilePosition() const noexcept              { return position; }
+
+        /** Returns the buffer that is being read into or written from. */
+        void* getBuffer() const noexcept                    { return buffer; }
+
+        /** Returns the number of bytes that were asked for. */
+        size_t getNumBytesRequested() const noexcept        { return numBytes; }
+
+        typedef ReferenceCountedObjectPtr<Request> Ptr;
+
+    private:
+        friend class AsyncFileIO;
+        Request (FileHandle*, int64, void*, size_t, bool, Callback*);
+
+        const FileHandle::Ptr fileHandle;
+        const int64 position;
+        void* const buffer;
+        const size_t numBytes;
+        const bool write;
+        Callback* const callback;
+        int64 result;
+        Atomic<int> finished;
+        WaitableEvent finishedEvent;
+
+        JUCE_DECLARE_NON_COPYABLE (Request)
+    };
+
+    //==============================================================================
+    /** Starts reading some data from a file.
+
+        The destination buffer must remain valid until the request has finished.
+
+        @param file             the file to read from
+        @param filePosition     the position in the file at which to start reading
+        @param destBuffer       the buffer to read the data into
+        @param numBytes         the number of bytes to read
+        @param callback         an optional callback which will be called when the read finishes.
+                                This must remain valid until then.
+    */
+    Request::Ptr read (FileHandle* file, int64 filePosition, void* destBuffer, size_t numBytes,
+                       Callback* callback = nullptr);
+
+    /** Starts writing some data to a file.
+
+        The source data must remain valid and unchanged until the request has finished.
+
+        @param file             the file to write to - this must have been opened for writing
+        @param filePosition     the position in the file at which to write the data
+        @param sourceData       the data to write
+        @param numBytes         the number of bytes to write
+        @param callback         an optional callback which will be called when the write finishes.
+                                This must remain valid until then.
+    */
+    Request::Ptr write (FileHandle* file, int64 filePosition, const void* sourceData, size_t numBytes,
+                        Callback* callback = nullptr);
+
+    /** Waits for all the requests that have been started to finish.
+        @returns true if they finished, or false if the timeout expired first
+    */
+    bool waitForAllRequests (int timeOutMilliseconds = -1);
+
+    //==============================================================================
+    /** While one of these exists, any requests that are made with the AsyncFileIO object
+        are collected together, and then all submitted at once when it's deleted.
+
+        Submitting a batch of requests is cheaper than submitting them one at a time,
+        and lets the OS choose the best order in which to perform them. Note that the
+        batch applies to requests made by any thread, and none of them will start until
+        the batch is finished, so you must not wait for one of them inside it.
+    */
+    class JUCE_API  ScopedBatch
+    {
+    public:
+        ScopedBatch (AsyncFileIO&);
+        ~ScopedBatch();
+
+    private:
+        AsyncFileIO& owner;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedBatch)
+    };
+
+private:
+    //==============================================================================
+    class Backend;
+    class ThreadPoolBackend;
+    class NativeBackend;
+    friend class ScopedBatch;
+    friend struct ContainerDeletePolicy<Backend>;
+
+    ScopedPointer<Backend> backend;
+    bool usingNativeBackend;
+    CriticalSection lock;
+    Array<Request*> requestsInBatch;
+    int batchDepth;
+    Atomic<int> numRequestsInProgress;
+    WaitableEvent allRequestsFinished;
+
+    static Backend* createNativeBackend (AsyncFileIO&);
+    static void* getNativeHandle (const Request&) noexcept;
+    Request::Ptr addRequest (Request*);
+    void submitBatch();
+    void requestFinished (Request&, int64 result);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AsyncFileIO)
+};
+
+#endif   // JUCE_ASYNCFILEIO_H_INCLUDED
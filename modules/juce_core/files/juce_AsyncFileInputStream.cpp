@@ -0,0 +1,178 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+AsyncFileInputStream::AsyncFileInputStream (AsyncFileIO& asyncIO, const File& f,
+                                            const int size, const int numBlocksToReadAhead)
+    : io (asyncIO), file (f), fileHandle (asyncIO.openFile (f, false)),
+      blockSize (jmax (4096, size)), totalLength (0), currentPosition (0), failed (false)
+{
+    if (fileHandle != nullptr)
+    {
+        totalLength = file.getSize();
+
+        for (int i = jmax (2, numBlocksToReadAhead); --i >= 0;)
+            blocks.add (new Block ((size_t) blockSize));
+
+        startReadingAhead();
+    }
+}
+
+AsyncFileInputStream::~AsyncFileInputStream()
+{
+    // (any reads that are still in progress need their buffers until they finish)
+    for (int i = 0; i < blocks.size(); ++i)
+        if (AsyncFileIO::Request* const r = blocks.getUnchecked (i)->request)
+            r->waitUntilFinished();
+}
+
+//==============================================================================
+AsyncFileInputStream::Block* AsyncFileInputStream::getBlock (const int64 index)
+{
+    for (int i = 0; i < blocks.size(); ++i)
+        if (blocks.getUnchecked (i)->index == index)
+            return blocks.getUnchecked (i);
+
+    return nullptr;
+}
+
+void AsyncFileInputStream::startReadingAhead()
+{
+    const int64 firstBlock = currentPosition / blockSize;
+    const int64 endBlock = jmin (firstBlock + blocks.size(), (totalLength + blockSize - 1) / blockSize);
+
+    const AsyncFileIO::ScopedBatch batch (io);
+
+    for (int64 index = firstBlock; index < endBlock; ++index)
+    {
+        if (getBlock (index) != nullptr)
+            continue;
+
+        // Find a block that's no longer inside the read-ahead window to re-use..
+        for (int i = 0; i < blocks.size(); ++i)
+        {
+            Block& b = *blocks.getUnchecked (i);
+
+            if (b.index < firstBlock || b.index >= firstBlock + blocks.size())
+            {
+                // (a read that was started earlier may still be writing into this buffer)
+                if (b.request != nullptr)
+                    b.request->waitUntilFinished();
+
+                const int64 start = index * blockSize;
+
+                b.index = index;
+                b.request = io.read (fileHandle, start, b.data,
+                                     (size_t) jmin ((int64) blockSize, totalLength - start));
+                break;
+            }
+        }
+    }
+}
+
+//==============================================================================
+int64 AsyncFileInputStream::getTotalLength()
+{
+    return totalLength;
+}
+
+int64 AsyncFileInputStream::getPosition()
+{
+    return currentPosition;
+}
+
+bool AsyncFileInputStream::isExhausted()
+{
+    return failed || currentPosition >= totalLength;
+}
+
+bool AsyncFileInputStream::setPosition (const int64 pos)
+{
+    const int64 newPosition = jlimit ((int64) 0, totalLength, pos);
+
+    if (newPosition != currentPosition)
+    {
+        currentPosition = newPosition;
+        failed = false;
+
+        if (fileHandle != nullptr)
+            startReadingAhead();
+    }
+
+    return true;
+}
+
+int AsyncFileInputStream::read (void* const destBuffer, int bytesToRead)
+{
+    // The caller must check that the stream opened OK before trying to read from it!
+    jassert (openedOk());
+    jassert (destBuffer != nullptr && bytesToRead >= 0);
+
+    char* dest = static_cast<char*> (destBuffer);
+    int numRead = 0;
+
+    while (bytesToRead > 0 && ! isExhausted())
+    {
+        const int64 index = currentPosition / blockSize;
+        Block* block = getBlock (index);
+
+        if (block == nullptr)
+        {
+            startReadingAhead();
+            block = getBlock (index);
+            jassert (block != nullptr);
+        }
+
+        block->request->waitUntilFinished();
+
+        const int offsetInBlock = (int) (currentPosition - index * blockSize);
+        const int64 numAvailable = block->request->getNumBytesTransferred() - offsetInBlock;
+
+        if (numAvailable <= 0)
+        {
+            // the read failed, or the file must have got shorter since it was opened
+            failed = true;
+            break;
+        }
+
+        const int num = (int) jmin ((int64) bytesToRead, numAvailable);
+        memcpy (dest, block->data + offsetInBlock, (size_t) num);
+
+        dest += num;
+        numRead += num;
+        bytesToRead -= num;
+        currentPosition += num;
+
+        // when a block has been used up, its buffer can start reading the next one..
+        if (currentPosition == (index + 1) * blockSize)
+            startReadingAhead();
+    }
+
+    return numRead;
+}
@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+#ifndef JUCE_ASYNCFILEINPUTSTREAM_H_INCLUDED
+#define JUCE_ASYNCFILEINPUTSTREAM_H_INCLUDED
+
+
+//==============================================================================
+/**
+    An input stream that reads from a file using an AsyncFileIO object, reading ahead
+    of the current position.
+
+    The file is read in blocks, and the stream keeps reads of the next few blocks in
+    progress in the background, so that when data is read sequentially it's usually
+    already in memory by the time it's needed. When the position is moved somewhere
+    else, the blocks at the new position are requested straight away.
+
+    @see AsyncFileIO, FileInputStream
+*/
+class JUCE_API  AsyncFileInputStream  : public InputStream
+{
+public:
+    //==============================================================================
+    /** Creates a stream to read from a file.
+
+        @param asyncIO              the AsyncFileIO object to use - this must not be deleted
+                                    before the stream
+        @param fileToRead           the file to read
+        @param blockSize            the size of each read that is made from the file
+        @param numBlocksToReadAhead the number of blocks to keep in memory, which includes the
+                                    one currently being read from
+    */
+    AsyncFileInputStream (AsyncFileIO& asyncIO, const File& fileToRead,
+                          int blockSize = 256 * 1024, int numBlocksToReadAhead = 4);
+
+    /** Destructor. */
+    ~AsyncFileInputStream();
+
+    //==============================================================================
+    /** Returns the file that this stream is reading from. */
+    const File& getFile() const noexcept                { return file; }
+
+    /** Returns true if the file was opened successfully. */
+    bool openedOk() const noexcept                      { return fileHandle != nullptr; }
+
+    /** Returns true if the file couldn't be opened. */
+    bool failedToOpen() const noexcept                  { return fileHandle == nullptr; }
+
+    //==============================================================================
+    int64 getTotalLength() override;
+    int read (void*, int) override;
+    bool isExhausted() override;
+    int64 getPosition() override;
+    bool setPosition (int64) override;
+
+private:
+    //==============================================================================
+    struct Block
+    {
+        Block (size_t size)  : data (size), index (-1) {}
+
+        HeapBlock<char> data;
+        int64 index;
+        AsyncFileIO::Request::Ptr request;
+    };
+
+    AsyncFileIO& io;
+    const File file;
+    AsyncFileIO::FileHandle::Ptr fileHandle;
+    const int blockSize;
+    OwnedArray<Block> blocks;
+    int64 totalLength, currentPosition;
+    bool failed;
+
+    void startReadingAhead();
+    Block* getBlock (int64 index);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AsyncFileInputStream)
+};
+
+#endif   // JUCE_ASYNCFILEINPUTSTREAM_H_INCLUDED
@@ -0,0 +1,259 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+namespace DirectoryIndexHelpers
+{
+    enum
+    {
+        magicNumber = 0x5849444a,
+        formatVersion = 1,
+        directoryFlag = 1,
+        hiddenFlag = 2
+    };
+
+    static int compare (const DirectoryScanner::Entry& entry, const File& file) noexcept
+    {
+        return entry.file.getFullPathName().compare (file.getFullPathName());
+    }
+
+    static int getCommonPrefixLength (const String& s1, const String& s2) noexcept
+    {
+        String::CharPointerType p1 (s1.getCharPointer()), p2 (s2.getCharPointer());
+        int num = 0;
+
+        while (! p1.isEmpty() && p1.getAndAdvance() == p2.getAndAdvance())
+            ++num;
+
+        return num;
+    }
+}
+
+//==============================================================================
+DirectoryIndex::DirectoryIndex() {}
+DirectoryIndex::~DirectoryIndex() {}
+
+bool DirectoryIndex::Changes::isEmpty() const noexcept
+{
+    return added.size() == 0 && removed.size() == 0 && modified.size() == 0;
+}
+
+void DirectoryIndex::clear()
+{
+    entries.clear();
+}
+
+const DirectoryScanner::Entry* DirectoryIndex::findEntry (const File& file) const noexcept
+{
+    int start = 0, end = entries.size();
+
+    while (start < end)
+    {
+        const int mid = (start + end) / 2;
+        const int diff = DirectoryIndexHelpers::compare (entries.getReference (mid), file);
+
+        if (diff == 0)
+            return &entries.getReference (mid);
+
+        if (diff < 0)
+            start = mid + 1;
+        else
+            end = mid;
+    }
+
+    return nullptr;
+}
+
+DirectoryIndex::Changes DirectoryIndex::update (DirectoryScanner& scanner)
+{
+    scanner.setNeedsFileDetails (true);
+    Array<DirectoryScanner::Entry> newEntries (scanner.scan());
+
+    Changes changes;
+
+    // If the scan was abandoned half-way through, the results are incomplete, so
+    // it's better to keep the old ones
+    if (Thread::currentThreadShouldExit())
+        return changes;
+
+    // Both lists are sorted, so they can be compared in a single pass..
+    int oldIndex = 0, newIndex = 0;
+
+    while (oldIndex < entries.size() || newIndex < newEntries.size())
+    {
+        if (oldIndex >= entries.size())
+        {
+            changes.added.add (newEntries.getReference (newIndex++).file);
+            continue;
+        }
+
+        const DirectoryScanner::Entry& oldEntry = entries.getReference (oldIndex);
+
+        if (newIndex >= newEntries.size())
+        {
+            changes.removed.add (oldEntry.file);
+            ++oldIndex;
+            continue;
+        }
+
+        const DirectoryScanner::Entry& newEntry = newEntries.getReference (newIndex);
+        const int diff = DirectoryIndexHelpers::compare (oldEntry, newEntry.file);
+
+        if (diff < 0)
+        {
+            changes.removed.add (oldEntry.file);
+            ++oldIndex;
+        }
+        else if (diff > 0)
+        {
+            changes.added.add (newEntry.file);
+            ++newIndex;
+        }
+        else
+        {
+            if (oldEntry.size != newEntry.size
+                 || oldEntry.modificationTime != newEntry.modificationTime
+                 || oldEntry.isDirectory != newEntry.isDirectory)
+                changes.modified.add (newEntry.file);
+
+            ++oldIndex;
+            ++newIndex;
+        }
+    }
+
+    entries.swapWith (newEntries);
+    return changes;
+}
+
+//==============================================================================
+void DirectoryIndex::writeToStream (OutputStream& output) const
+{
+    using namespace DirectoryIndexHelpers;
+
+    output.writeInt (magicNumber);
+    output.writeInt (formatVersion);
+    output.writeCompressedInt (entries.size());
+
+    // Each path is stored as the number of characters it shares with the one before it,
+    // followed by the rest of it. As the entries are sorted, this saves a lot of space.
+    String previousPath;
+
+    for (int i = 0; i < entries.size(); ++i)
+    {
+        const DirectoryScanner::Entry& e = entries.getReference (i);
+        const String path (e.file.getFullPathName());
+        const int prefixLength = getCommonPrefixLength (previousPath, path);
+
+        output.writeCompressedInt (prefixLength);
+        output.writeString (path.substring (prefixLength));
+        output.writeInt64 (e.size);
+        output.writeInt64 (e.modificationTime.toMilliseconds());
+        output.writeByte ((char) ((e.isDirectory ? directoryFlag : 0) | (e.isHidden ? hiddenFlag : 0)));
+
+        previousPath = path;
+    }
+}
+
+bool DirectoryIndex::readFromStream (InputStream& input)
+{
+    using namespace DirectoryIndexHelpers;
+
+    clear();
+
+    if (input.readInt() != magicNumber || input.readInt() != formatVersion)
+        return false;
+
+    const int numEntries = input.readCompressedInt();
+
+    if (numEntries < 0)
+        return false;
+
+    Array<DirectoryScanner::Entry> newEntries;
+    newEntries.ensureStorageAllocated (jmin (numEntries, 1 << 20));
+    String previousPath;
+
+    for (int i = 0; i < numEntries; ++i)
+    {
+        const int prefixLength = input.readCompressedInt();
+
+        if (input.isExhausted() || prefixLength < 0 || prefixLength > previousPath.length())
+            return false;
+
+        const String path (previousPath.substring (0, prefixLength) + input.readString());
+
+        if (path.isEmpty())
+            return false;
+
+        DirectoryScanner::Entry e;
+        e.file = File::createFileWithoutCheckingPath (path);
+        e.size = input.readInt64();
+        e.modificationTime = Time (input.readInt64());
+
+        const int flags = input.readByte();
+        e.isDirectory = (flags & directoryFlag) != 0;
+        e.isHidden    = (flags & hiddenFlag) != 0;
+
+        newEntries.add (e);
+        previousPath = path;
+    }
+
+    entries.swapWith (newEntries);
+    return true;
+}
+
+bool DirectoryIndex::saveToFile (const File& file) const
+{
+    TemporaryFile temp (file);
+
+    {
+        FileOutputStream out (temp.getFile());
+
+        if (out.failedToOpen())
+            return false;
+
+        writeToStream (out);
+        out.flush();
+
+        if (out.getStatus().failed())
+            return false;
+    }
+
+    return temp.overwriteTargetFileWithTemporary();
+}
+
+bool DirectoryIndex::loadFromFile (const File& file)
+{
+    FileInputStream in (file);
+
+    if (in.openedOk())
+        return readFromStream (in);
+
+    clear();
+    return false;
+}
@@ -0,0 +1,135 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+#ifndef JUCE_DIRECTORYINDEX_H_INCLUDED
+#define JUCE_DIRECTORYINDEX_H_INCLUDED
+
+
+//==============================================================================
+/**
+    Keeps a record of the files in a directory tree, so that a later scan can quickly
+    find out which of them have been added, removed or modified.
+
+    Each time you call update(), the tree is re-scanned with a DirectoryScanner, and
+    the results are compared with the previous ones. A file counts as modified if its
+    size or modification time has changed. The index can be saved and re-loaded, so
+    that e.g. an app can find out what has changed in a library of files since the last
+    time it was run, without having to look inside any of the files that haven't.
+
+    @code
+    DirectoryIndex index;
+    index.loadFromFile (indexFile);
+
+    DirectoryScanner scanner (sampleFolder, true, "*.wav");
+    const DirectoryIndex::Changes changes (index.update (scanner));
+
+    for (int i = 0; i < changes.modified.size(); ++i)
+        reloadSample (changes.modified.getReference (i));
+
+    index.saveToFile (indexFile);
+    @endcode
+
+    @see DirectoryScanner
+*/
+class JUCE_API  DirectoryIndex
+{
+public:
+    //==============================================================================
+    /** Creates an empty index. */
+    DirectoryIndex();
+
+    /** Destructor. */
+    ~DirectoryIndex();
+
+    //==============================================================================
+    /** The differences that were found by a call to update(). */
+    struct Changes
+    {
+        /** The files that weren't in the index before. */
+        Array<File> added;
+
+        /** The files that were in the index, but which no longer exist. */
+        Array<File> removed;
+
+        /** The files whose size or modification time has changed. */
+        Array<File> modified;
+
+        /** Returns true if nothing has changed. */
+        bool isEmpty() const noexcept;
+    };
+
+    /** Re-scans the files using the given scanner, replaces the contents of the index with
+        the results, and returns the differences between the old and new contents.
+
+        The scanner will be told to find the details of the files, as these are needed
+        to find out whether the files have been modified.
+    */
+    Changes update (DirectoryScanner& scanner);
+
+    //==============================================================================
+    /** Returns the number of files in the index. */
+    int getNumEntries() const noexcept                                  { return entries.size(); }
+
+    /** Returns all the files in the index, sorted by their paths. */
+    const Array<DirectoryScanner::Entry>& getEntries() const noexcept  { return entries; }
+
+    /** Looks up a file in the index, returning nullptr if it isn't there. */
+    const DirectoryScanner::Entry* findEntry (const File& file) const noexcept;
+
+    /** Removes all the files from the index. */
+    void clear();
+
+    //==============================================================================
+    /** Writes the contents of the index to a stream.
+        @see readFromStream
+    */
+    void writeToStream (OutputStream& output) const;
+
+    /** Replaces the contents of the index with some data that was written by writeToStream().
+        Returns false (and leaves the index empty) if the data isn't valid.
+    */
+    bool readFromStream (InputStream& input);
+
+    /** Saves the index to a file, replacing the file if it already exists. */
+    bool saveToFile (const File& file) const;
+
+    /** Loads an index that was saved with saveToFile().
+        Returns false (and leaves the index empty) if the file can't be read.
+    */
+    bool loadFromFile (const File& file);
+
+private:
+    //==============================================================================
+    Array<DirectoryScanner::Entry> entries;
+
+    JUCE_LEAK_DETECTOR (DirectoryIndex)
+};
+
+#endif   // JUCE_DIRECTORYINDEX_H_INCLUDED
@@ -49,6 +49,21 @@ DirectoryIterator::~DirectoryIterator()
 {
 }
 
+// (used for the sub-iterators, so that they don't all need to re-parse the wildcard string)
+DirectoryIterator::DirectoryIterator (const File& directory, bool recursive, const String& pattern,
+                                      const int type, const StringArray& parsedWildCards)
+  : wildCards (parsedWildCards),
+    fileFinder (directory, (recursive || wildCards.size() > 1) ? "*" : pattern),
+    wildCard (pattern),
+    path (File::addTrailingSeparator (directory.getFullPathName())),
+    index (-1),
+    totalNumFiles (-1),
+    whatToLookFor (type),
+    isRecursive (recursive),
+    hasBeenAdvanced (false)
+{
+}
+
 StringArray DirectoryIterator::parseWildcards (const String& pattern)
 {
     StringArray s;
@@ -104,7 +119,7 @@ bool DirectoryIterator::next (bool* const isDirResult, bool* const isHiddenResul
                 {
                     if (isRecursive && ((whatToLookFor & File::ignoreHiddenFiles) == 0 || ! isHidden))
                         subIterator = new DirectoryIterator (File::createFileWithoutCheckingPath (path + filename),
-                                                             true, wildCard, whatToLookFor);
+                                                             true, wildCard, whatToLookFor, wildCards);
 
                     matches = (whatToLookFor & File::findDirectories) != 0;
                 }
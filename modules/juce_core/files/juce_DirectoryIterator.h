@@ -141,6 +141,7 @@ private:
     };
 
     friend struct ContainerDeletePolicy<NativeIterator::Pimpl>;
+    friend class DirectoryScanner;
     StringArray wildCards;
     NativeIterator fileFinder;
     String wildCard, path;
@@ -152,6 +153,8 @@ private:
     ScopedPointer<DirectoryIterator> subIterator;
     File currentFile;
 
+    DirectoryIterator (const File&, bool, const String&, int, const StringArray&);
+
     static StringArray parseWildcards (const String& pattern);
     static bool fileMatches (const StringArray& wildCards, const String& filename);
 
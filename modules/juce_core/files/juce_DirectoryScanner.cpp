@@ -0,0 +1,531 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+DirectoryScanner::Entry::Entry() noexcept
+    : size (0), isDirectory (false), isHidden (false)
+{
+}
+
+//==============================================================================
+class DirectoryScanner::Walker
+{
+public:
+    Walker (const DirectoryScanner& s)
+        : scanner (s),
+          ignoreHidden ((s.whatToLookFor & File::ignoreHiddenFiles) != 0),
+          root (File::addTrailingSeparator (s.directory.getFullPathName())),
+          usingHelperThreads (false)
+    {
+    }
+
+    Array<Entry> run (const int numThreads, const bool startThreadsImmediately)
+    {
+        addTask (new Task (root, true));
+
+        // A small tree is quicker to walk on this thread alone than to start any others for, so
+        // unless the caller asked for them, the helper threads are only started once it's clear
+        // that there's plenty of work to share
+        if (numThreads <= 1)
+            performTasks (true, -1);
+        else if (! startThreadsImmediately)
+            performTasks (true, minEntriesBeforeUsingThreads);
+
+        if (numTasksOutstanding.get() > 0 && aborted.get() == 0)
+        {
+            usingHelperThreads = true;
+            OwnedArray<HelperThread> helpers;
+
+            for (int i = 1; i < numThreads; ++i)
+                helpers.add (new HelperThread (*this))->startThread();
+
+            // (the calling thread does its share of the work too)
+            performTasks (true, -1);
+        }
+
+        Array<Entry> results;
+        addSortedResults (root, results);
+        return results;
+    }
+
+private:
+    //==============================================================================
+    // The results are collected separately for each directory, so that they can be sorted
+    // by comparing just the files' names rather than their whole paths.
+    struct Folder
+    {
+        Folder (const String& p)  : path (p) {}
+
+        const String path;              // (with a trailing separator)
+        CriticalSection lock;
+        Array<Entry> entries;
+        OwnedArray<Folder> subfolders;
+
+        JUCE_DECLARE_NON_COPYABLE (Folder)
+    };
+
+    struct Task
+    {
+        Task (Folder& f, bool listing)  : folder (f), needsListing (listing) {}
+
+        Folder& folder;
+        bool needsListing;          // if false, this just processes some entries that have already been read
+        Array<RawEntry> entries;
+
+        JUCE_DECLARE_NON_COPYABLE (Task)
+    };
+
+    struct HelperThread  : public Thread
+    {
+        HelperThread (Walker& w)  : Thread ("DirectoryScanner"), walker (w) {}
+        ~HelperThread()     { stopThread (-1); }
+
+        void run() override { walker.performTasks (false, -1); }
+
+        Walker& walker;
+
+        JUCE_DECLARE_NON_COPYABLE (HelperThread)
+    };
+
+    // Either one of a folder's entries, or one of its subfolders, whose contents all come
+    // just after the position of its name plus a separator (which is what comparing the
+    // full paths would do).
+    struct SortItem
+    {
+        const char* name;
+        const Entry* entry;
+        Folder* subfolder;
+    };
+
+    struct SortItemComparator
+    {
+        // (comparing the UTF-8 bytes gives the same order as String::compare(), but more quickly)
+        static int compareElements (const SortItem& first, const SortItem& second) noexcept
+        {
+            return strcmp (first.name, second.name);
+        }
+    };
+
+    enum { entriesPerTask = 256, minEntriesBeforeUsingThreads = 2000 };
+
+    const DirectoryScanner& scanner;
+    const bool ignoreHidden;
+    Folder root;
+    bool usingHelperThreads;
+
+    CriticalSection taskLock;
+    OwnedArray<Task> tasks;
+    Atomic<int> numTasksOutstanding, aborted;
+    WaitableEvent workAvailable;
+
+    void addTask (Task* const task)
+    {
+        ++numTasksOutstanding;
+
+        {
+            const ScopedLock sl (taskLock);
+            tasks.add (task);
+        }
+
+        workAvailable.signal();
+    }
+
+    Task* getNextTask()
+    {
+        const ScopedLock sl (taskLock);
+
+        // (taking the newest task first keeps the walk roughly depth-first, so the queue stays small)
+        Task* const task = tasks.removeAndReturn (tasks.size() - 1);
+
+        if (tasks.size() > 0)
+            workAvailable.signal();  // wake up another thread to help with the rest
+
+        return task;
+    }
+
+    // Performs tasks until there are none left, or until this thread has been through at least
+    // the given number of entries (if that's not negative).
+    void performTasks (const bool isCallingThread, const int maxNumEntries)
+    {
+        int numEntriesDone = 0;
+
+        while (aborted.get() == 0 && (maxNumEntries < 0 || numEntriesDone < maxNumEntries))
+        {
+            if (isCallingThread && Thread::currentThreadShouldExit())
+            {
+                aborted = 1;
+                break;
+            }
+
+            const ScopedPointer<Task> task (getNextTask());
+
+            if (task == nullptr)
+            {
+                if (numTasksOutstanding.get() == 0)
+                    break;
+
+                // (a thread that adds a task or finishes the last one always signals this)
+                workAvailable.wait (-1);
+                continue;
+            }
+
+            perform (*task);
+            numEntriesDone += task->entries.size();
+
+            if (--numTasksOutstanding == 0)
+                workAvailable.signal();
+        }
+
+        // (passes the wake-up on to the next thread that's waiting)
+        workAvailable.signal();
+    }
+
+    bool needsDetails (const RawEntry& e) const noexcept
+    {
+        return e.type < 0 || (scanner.needsDetails && ! e.hasDetails);
+    }
+
+    void perform (Task& task)
+    {
+        Folder& folder = task.folder;
+
+        if (task.needsListing)
+        {
+            // While this is the only thread, it's quickest to fetch the details while each directory
+            // is open, but once there are helper threads, the work in big directories is shared out
+            if (! readDirectory (folder.path, task.entries, scanner.needsDetails && ! usingHelperThreads))
+                return;
+
+            // If the entries in a big directory need to have their details fetched, they're
+            // split into chunks that the other threads can help with
+            if (task.entries.size() > entriesPerTask)
+            {
+                int numNeedingDetails = 0;
+
+                for (int i = 0; i < task.entries.size(); ++i)
+                    if (needsDetails (task.entries.getReference (i)))
+                        ++numNeedingDetails;
+
+                if (numNeedingDetails > entriesPerTask)
+                {
+                    for (int start = entriesPerTask; start < task.entries.size(); start += entriesPerTask)
+                    {
+                        Task* const chunk = new Task (folder, false);
+                        chunk->entries.addArray (task.entries, start, entriesPerTask);
+                        addTask (chunk);
+                    }
+
+                    task.entries.removeRange (entriesPerTask, task.entries.size());
+                }
+            }
+        }
+
+        Array<Entry> found;
+        OwnedArray<Folder> subfolders;
+
+        for (int i = 0; i < task.entries.size(); ++i)
+            processEntry (folder.path, task.entries.getReference (i), found, subfolders);
+
+        if (found.size() > 0 || subfolders.size() > 0)
+        {
+            const ScopedLock sl (folder.lock);
+            folder.entries.addArray (found);
+
+            while (subfolders.size() > 0)
+                folder.subfolders.add (subfolders.removeAndReturn (subfolders.size() - 1));
+        }
+    }
+
+    void processEntry (const String& parentPath, RawEntry& e, Array<Entry>& found, OwnedArray<Folder>& subfolders)
+    {
+        if (e.name.containsOnly (".") || (ignoreHidden && e.isHidden))
+            return;
+
+        const String path (parentPath + e.name);
+
+        if (needsDetails (e) && ! getDetails (path, e))
+            e.type = 0;  // (e.g. a broken link, which is treated as a file, like DirectoryIterator does)
+
+        const bool isDirectory = (e.type == 1);
+
+        if (isDirectory && scanner.isRecursive && ! e.isLink)
+            addTask (new Task (*subfolders.add (new Folder (path + File::separator)), true));
+
+        if ((scanner.whatToLookFor & (isDirectory ? File::findDirectories : File::findFiles)) != 0
+             && DirectoryIterator::fileMatches (scanner.wildCards, e.name))
+        {
+            Entry entry;
+            entry.file = File::createFileWithoutCheckingPath (path);
+            entry.isDirectory = isDirectory;
+            entry.isHidden = e.isHidden;
+
+            if (scanner.needsDetails)
+            {
+                entry.size = isDirectory ? 0 : e.size;
+                entry.modificationTime = Time (e.modificationTime);
+            }
+
+            found.add (entry);
+        }
+    }
+
+    // Appends a folder's entries to the results, with the contents of its subfolders in
+    // among them, in the order that sorting all their full paths would give.
+    static void addSortedResults (const Folder& folder, Array<Entry>& results)
+    {
+        const size_t pathLength = folder.path.getNumBytesAsUTF8();
+
+        Array<SortItem> items;
+        items.ensureStorageAllocated (folder.entries.size() + folder.subfolders.size());
+
+        for (int i = 0; i < folder.entries.size(); ++i)
+        {
+            const Entry& e = folder.entries.getReference (i);
+            const SortItem item = { e.file.getFullPathName().toRawUTF8() + pathLength, &e, nullptr };
+            items.add (item);
+        }
+
+        for (int i = 0; i < folder.subfolders.size(); ++i)
+        {
+            Folder* const f = folder.subfolders.getUnchecked (i);
+            const SortItem item = { f->path.toRawUTF8() + pathLength, nullptr, f };
+            items.add (item);
+        }
+
+        SortItemComparator comparator;
+        items.sort (comparator);
+
+        for (int i = 0; i < items.size(); ++i)
+        {
+            const SortItem& item = items.getReference (i);
+
+            if (item.entry != nullptr)
+                results.add (*item.entry);
+            else
+                addSortedResults (*item.subfolder, results);
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (Walker)
+};
+
+//==============================================================================
+DirectoryScanner::DirectoryScanner (const File& dir, bool recursive, const String& pattern, const int type)
+    : directory (dir),
+      wildCards (DirectoryIterator::parseWildcards (pattern)),
+      whatToLookFor (type),
+      isRecursive (recursive),
+      numThreads (0),
+      needsDetails (false)
+{
+    // you have to specify the type of files you're looking for!
+    jassert ((type & (File::findFiles | File::findDirectories)) != 0);
+    jassert (type > 0 && type <= 7);
+}
+
+DirectoryScanner::~DirectoryScanner() {}
+
+void DirectoryScanner::setNumThreads (const int newNumThreads) noexcept
+{
+    numThreads = jmax (0, newNumThreads);
+}
+
+void DirectoryScanner::setNeedsFileDetails (const bool shouldFindDetails) noexcept
+{
+    needsDetails = shouldFindDetails;
+}
+
+Array<DirectoryScanner::Entry> DirectoryScanner::scan()
+{
+    Walker walker (*this);
+
+    if (numThreads > 0)
+        return walker.run (numThreads, true);
+
+    return walker.run (jmax (1, SystemStats::getNumCpus()), false);
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class DirectoryScannerTests  : public UnitTest
+{
+public:
+    DirectoryScannerTests()   : UnitTest ("DirectoryScanner") {}
+
+    static void createFiles (const File& folder, Random& r, int depth, int& numCreated)
+    {
+        folder.createDirectory();
+
+        for (int i = 1 + r.nextInt (depth > 0 ? 30 : 600); --i >= 0;)
+        {
+            const String name ("file" + String (i) + (r.nextBool() ? ".wav" : ".txt"));
+            folder.getChildFile (name).replaceWithText (String::repeatedString ("x", r.nextInt (100)));
+            ++numCreated;
+        }
+
+        if (depth > 0)
+            for (int i = r.nextInt (5); --i >= 0;)
+                createFiles (folder.getChildFile ("folder" + String (i)), r, depth - 1, numCreated);
+    }
+
+    void checkScanMatchesIterator (const File& root, bool recursive, const String& wildcard, int whatToLookFor,
+                                   bool needsDetails, int numThreads)
+    {
+        DirectoryScanner scanner (root, recursive, wildcard, whatToLookFor);
+        scanner.setNumThreads (numThreads);
+        scanner.setNeedsFileDetails (needsDetails);
+        const Array<DirectoryScanner::Entry> found (scanner.scan());
+
+        StringArray expected;
+
+        for (DirectoryIterator i (root, recursive, wildcard, whatToLookFor); i.next();)
+            expected.add (i.getFile().getFullPathName());
+
+        expected.sort (false);
+        expectEquals (found.size(), expected.size());
+
+        for (int i = 0; i < jmin (found.size(), expected.size()); ++i)
+        {
+            const DirectoryScanner::Entry& e = found.getReference (i);
+            expectEquals (e.file.getFullPathName(), expected[i]);
+            expect (e.isDirectory == e.file.isDirectory());
+
+            if (needsDetails && ! e.isDirectory)
+            {
+                expectEquals (e.size, e.file.getSize());
+                expect (e.modificationTime == e.file.getLastModificationTime());
+            }
+        }
+    }
+
+    void runTest() override
+    {
+        Random r = getRandom();
+        const File root (File::createTempFile ("scannertest"));
+        int numFiles = 0;
+        createFiles (root, r, 3, numFiles);
+
+        beginTest ("Scanning");
+        {
+            for (int numThreads = 1; numThreads <= 8; numThreads *= 2)
+            {
+                checkScanMatchesIterator (root, true, "*", File::findFiles, true, numThreads);
+                checkScanMatchesIterator (root, true, "*.wav", File::findFilesAndDirectories, false, numThreads);
+                checkScanMatchesIterator (root, false, "*.wav;*.txt", File::findFiles, true, numThreads);
+                checkScanMatchesIterator (root, true, "folder*", File::findDirectories, false, numThreads);
+            }
+
+            expect (DirectoryScanner (root.getChildFile ("doesnt_exist"), true).scan().size() == 0);
+        }
+
+        beginTest ("Change detection");
+        {
+            DirectoryIndex index;
+            DirectoryScanner scanner (root, true);
+
+            DirectoryIndex::Changes changes (index.update (scanner));
+            expectEquals (changes.added.size(), numFiles);
+            expectEquals (index.getNumEntries(), numFiles);
+            expect (index.update (scanner).isEmpty());
+
+            const DirectoryScanner::Entry modifiedEntry (index.getEntries()[r.nextInt (numFiles)]);
+            const DirectoryScanner::Entry removedEntry (index.getEntries()[r.nextInt (numFiles)]);
+            const File addedFile (root.getChildFile ("newFile.wav"));
+
+            expect (index.findEntry (modifiedEntry.file) != nullptr);
+            expect (index.findEntry (addedFile) == nullptr);
+
+            modifiedEntry.file.appendText ("extra data");
+            addedFile.replaceWithText ("new");
+
+            if (removedEntry.file != modifiedEntry.file)
+                removedEntry.file.deleteFile();
+
+            // save and re-load it, to check that nothing is lost
+            const File indexFile (root.getSiblingFile ("scannertest.index"));
+            expect (index.saveToFile (indexFile));
+
+            DirectoryIndex reloaded;
+            expect (reloaded.loadFromFile (indexFile));
+            expectEquals (reloaded.getNumEntries(), index.getNumEntries());
+            indexFile.deleteFile();
+
+            changes = reloaded.update (scanner);
+            expect (changes.added.size() == 1 && changes.added.getFirst() == addedFile);
+            expect (changes.modified.contains (modifiedEntry.file));
+            expectEquals (changes.modified.size(), 1);
+
+            if (removedEntry.file != modifiedEntry.file)
+                expect (changes.removed.size() == 1 && changes.removed.getFirst() == removedEntry.file);
+
+            MemoryBlock junk;
+            junk.setSize (100, true);
+            MemoryInputStream junkStream (junk, false);
+            expect (! reloaded.readFromStream (junkStream));
+            expectEquals (reloaded.getNumEntries(), 0);
+        }
+
+        beginTest ("Performance");
+        {
+            // (the best of several runs is used for each, so that neither is slowed by a cold cache)
+            double iteratorTime = 0, scannerTime = 0;
+            int num = 0;
+
+            for (int run = 0; run < 5; ++run)
+            {
+                const double t1 = Time::getMillisecondCounterHiRes();
+                bool isDirectory;
+                int64 size;
+                Time modTime;
+
+                for (DirectoryIterator i (root, true, "*"); i.next (&isDirectory, nullptr, &size, &modTime, nullptr, nullptr);)
+                {}
+
+                const double t2 = Time::getMillisecondCounterHiRes();
+                DirectoryScanner scanner (root, true);
+                scanner.setNeedsFileDetails (true);
+                num = scanner.scan().size();
+                const double t3 = Time::getMillisecondCounterHiRes();
+
+                iteratorTime = run == 0 ? t2 - t1 : jmin (iteratorTime, t2 - t1);
+                scannerTime  = run == 0 ? t3 - t2 : jmin (scannerTime, t3 - t2);
+            }
+
+            logMessage (String (num) + " files, " + String (SystemStats::getNumCpus()) + " CPUs: DirectoryIterator "
+                         + String (iteratorTime, 2) + "ms, DirectoryScanner " + String (scannerTime, 2) + "ms");
+        }
+
+        root.deleteRecursively();
+    }
+};
+
+static DirectoryScannerTests directoryScannerTests;
+
+#endif
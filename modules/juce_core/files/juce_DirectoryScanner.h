@@ -0,0 +1,153 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+#ifndef JUCE_DIRECTORYSCANNER_H_INCLUDED
+#define JUCE_DIRECTORYSCANNER_H_INCLUDED
+
+
+//==============================================================================
+/**
+    Searches a directory tree for files, using several threads at once.
+
+    This finds the same files as a DirectoryIterator, but rather than returning them
+    one at a time, it collects the whole lot in one go, reading different directories
+    and fetching the details of different files on a set of threads in parallel. With
+    large trees of files, and especially on network drives or SSDs where many requests
+    can be in progress at the same time, this can be many times faster.
+
+    Where the OS can tell whether a directory entry is a file or a folder without any
+    extra work (e.g. from the d_type field on Linux and OSX, or on Windows where the
+    details come with the directory listing), the scanner avoids asking for the details
+    of each file unless you've asked for them with setNeedsFileDetails().
+
+    Symbolic links are reported with the type of the item they point to, but the scanner
+    won't follow a link to a directory, so there's no danger of getting stuck in a loop.
+
+    @code
+    DirectoryScanner scanner (File ("/samples"), true, "*.wav;*.aif");
+    Array<DirectoryScanner::Entry> files (scanner.scan());
+    @endcode
+
+    @see DirectoryIterator, DirectoryIndex
+*/
+class JUCE_API  DirectoryScanner
+{
+public:
+    //==============================================================================
+    /** Creates a scanner for a given directory.
+
+        @param directory        the directory to search in
+        @param isRecursive      whether all the subdirectories should also be searched
+        @param wildCard         the file pattern to match. This may contain multiple patterns
+                                separated by a semi-colon or comma, e.g. "*.jpg;*.png"
+        @param whatToLookFor    a value from the File::TypesOfFileToFind enum, specifying
+                                whether to look for files, directories, or both.
+    */
+    DirectoryScanner (const File& directory,
+                      bool isRecursive,
+                      const String& wildCard = "*",
+                      int whatToLookFor = File::findFiles);
+
+    /** Destructor. */
+    ~DirectoryScanner();
+
+    //==============================================================================
+    /** Sets the number of threads to use, including the one that calls scan().
+        If this is 0 (the default), there's one for each CPU, but they're only started
+        once the scan has found enough files to make it worthwhile, so a small tree is
+        searched by the calling thread alone.
+    */
+    void setNumThreads (int numThreads) noexcept;
+
+    /** Chooses whether the size and modification time of each file should be found.
+        If this is false (the default), these fields of the Entry objects are left empty,
+        which can save a lot of time if you only need the files' names.
+    */
+    void setNeedsFileDetails (bool shouldFindDetails) noexcept;
+
+    //==============================================================================
+    /** Describes a file that was found by a DirectoryScanner. */
+    struct Entry
+    {
+        /** Creates an empty entry. */
+        Entry() noexcept;
+
+        /** The file that was found. */
+        File file;
+
+        /** The size of the file in bytes, if the details were requested. */
+        int64 size;
+
+        /** The time the file was last modified, if the details were requested. */
+        Time modificationTime;
+
+        /** True if the item is a directory. */
+        bool isDirectory;
+
+        /** True if the item is hidden. */
+        bool isHidden;
+    };
+
+    /** Performs the scan, and returns all the matching files, sorted by their paths.
+
+        This blocks until the whole tree has been searched. If it's called on a thread
+        which is then asked to stop, it'll give up early and return the files that
+        it found so far.
+    */
+    Array<Entry> scan();
+
+private:
+    //==============================================================================
+    class Walker;
+
+    struct RawEntry
+    {
+        String name;
+        int64 size, modificationTime;
+        int type;   // 0 = file, 1 = directory, or -1 if it's not known
+        bool isLink, isHidden, hasDetails;
+    };
+
+    const File directory;
+    const StringArray wildCards;
+    const int whatToLookFor;
+    const bool isRecursive;
+    int numThreads;
+    bool needsDetails;
+
+    // (implemented in the native code - if fetchDetails is true, the native code may also fill
+    // in the entries' details, where it's quicker to do that while the directory is open)
+    static bool readDirectory (const String& path, Array<RawEntry>& results, bool fetchDetails);
+    static bool getDetails (const String& path, RawEntry& entry);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DirectoryScanner)
+};
+
+#endif   // JUCE_DIRECTORYSCANNER_H_INCLUDED
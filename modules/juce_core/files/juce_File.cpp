@@ -988,16 +988,49 @@ bool File::createSymbolicLink (const File& linkFileToCreate, bool overwriteExist
 }
 
 //==============================================================================
-MemoryMappedFile::MemoryMappedFile (const File& file, MemoryMappedFile::AccessMode mode, bool exclusive)
+MemoryMappedFile::MemoryMappedFile (const File& file, MemoryMappedFile::AccessMode mode, bool exclusive, int mappingOptions)
     : address (nullptr), range (0, file.getSize()), fileHandle (0)
 {
-    openInternal (file, mode, exclusive);
+    openInternal (file, mode, exclusive, mappingOptions);
 }
 
-MemoryMappedFile::MemoryMappedFile (const File& file, const Range<int64>& fileRange, AccessMode mode, bool exclusive)
+MemoryMappedFile::MemoryMappedFile (const File& file, const Range<int64>& fileRange, AccessMode mode, bool exclusive, int mappingOptions)
     : address (nullptr), range (fileRange.getIntersectionWith (Range<int64> (0, file.getSize()))), fileHandle (0)
 {
-    openInternal (file, mode, exclusive);
+    openInternal (file, mode, exclusive, mappingOptions);
+}
+
+// Returns a range of file positions as offsets from the start of the mapped memory,
+// with its start rounded down to a page boundary
+Range<int64> MemoryMappedFile::getPageAlignedRange (Range<int64> rangeOfFile) const noexcept
+{
+    rangeOfFile = rangeOfFile.getIntersectionWith (range);
+
+    if (address == nullptr || rangeOfFile.isEmpty())
+        return Range<int64>();
+
+    const int64 start = rangeOfFile.getStart() - range.getStart();
+    return Range<int64> (start - start % SystemStats::getPageSize(), rangeOfFile.getEnd() - range.getStart());
+}
+
+void MemoryMappedFile::prefault (Range<int64> rangeOfFile) const noexcept
+{
+    const Range<int64> r (getPageAlignedRange (rangeOfFile));
+
+    if (! r.isEmpty())
+    {
+        // (this lets the OS start reading the whole range, rather than one page at a time)
+        adviseAccess (rangeOfFile, willNeed);
+
+        const volatile char* const data = static_cast<const volatile char*> (address);
+        const int pageSize = SystemStats::getPageSize();
+        char total = 0;
+
+        for (int64 pos = r.getStart(); pos < r.getEnd(); pos += pageSize)
+            total = (char) (total + data[pos]);
+
+        ignoreUnused (total);
+    }
 }
 
 
@@ -1180,6 +1213,18 @@ public:
                 expect (memcmp (mmf.getData(), "abcdefghij", 10) == 0);
             }
 
+            {
+                MemoryMappedFile mmf (tempFile2, MemoryMappedFile::readOnly, false,
+                                      MemoryMappedFile::prefaultPages | MemoryMappedFile::lockPagesInMemory);
+                expect (mmf.getData() != nullptr);
+                expect (memcmp (mmf.getData(), "abcdefghij", 10) == 0);
+
+                mmf.adviseAccess (Range<int64> (2, 8), MemoryMappedFile::randomAccess);
+                mmf.prefault (Range<int64> (0, 100));
+                mmf.unlockPages (mmf.getRange());
+                expect (memcmp (mmf.getData(), "abcdefghij", 10) == 0);
+            }
+
             expect (tempFile2.deleteFile());
         }
 
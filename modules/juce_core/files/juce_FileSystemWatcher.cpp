@@ -0,0 +1,592 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+namespace FileSystemWatcherHelpers
+{
+    typedef FileSystemWatcher::Event Event;
+
+    static void mergeEvents (Array<Event>& events)
+    {
+        Array<Event> merged;
+        HashMap<String, int> lastEventForFile;
+        BigInteger removed;
+
+        for (int i = 0; i < events.size(); ++i)
+        {
+            const Event& e = events.getReference (i);
+            const String path (e.file.getFullPathName());
+
+            if (lastEventForFile.contains (path))
+            {
+                Event& previous = merged.getReference (lastEventForFile [path]);
+
+                if (e.type == FileSystemWatcher::fileModified && previous.type != FileSystemWatcher::fileDeleted)
+                    continue;
+
+                if (e.type == FileSystemWatcher::fileCreated && previous.type == FileSystemWatcher::fileCreated)
+                    continue;
+
+                // (deleting a file also changes its attributes, so any modifications that
+                // happened just before the deletion aren't worth reporting)
+                if (e.type == FileSystemWatcher::fileDeleted && previous.type == FileSystemWatcher::fileModified)
+                {
+                    previous.type = FileSystemWatcher::fileDeleted;
+                    continue;
+                }
+            }
+
+            if (e.type == FileSystemWatcher::fileRenamed)
+            {
+                const String previousPath (e.previousFile.getFullPathName());
+
+                if (lastEventForFile.contains (previousPath))
+                {
+                    const int index = lastEventForFile [previousPath];
+                    lastEventForFile.remove (previousPath);
+
+                    // A file that's written to a temporary file and then renamed, as File::replaceWithText()
+                    // does, is reported as just the rename. It can't become a creation, because the target
+                    // may have already existed, in which case the rename replaced it.
+                    if (merged.getReference (index).type == FileSystemWatcher::fileCreated)
+                        removed.setBit (index);
+                }
+            }
+
+            lastEventForFile.set (path, merged.size());
+            merged.add (e);
+        }
+
+        // (the events are only removed now, so that the indexes in lastEventForFile stay valid)
+        events.clearQuick();
+
+        for (int i = 0; i < merged.size(); ++i)
+            if (! removed[i])
+                events.add (merged.getReference (i));
+    }
+}
+
+//==============================================================================
+class FileSystemWatcher::Backend
+{
+public:
+    Backend() noexcept {}
+    virtual ~Backend() {}
+
+    virtual bool addFolder (const File&) = 0;
+    virtual void removeFolder (const File&) = 0;
+
+    // Waits for some changes to happen, and appends them to the array. If the timeout
+    // is negative, this may block until wakeUp() is called.
+    virtual void waitForEvents (Array<Event>& results, int timeOutMilliseconds) = 0;
+
+    // Makes any thread that's inside waitForEvents() return as soon as possible.
+    virtual void wakeUp() = 0;
+
+    virtual void setPollingInterval (int) {}
+
+private:
+    JUCE_DECLARE_NON_COPYABLE (Backend)
+};
+
+//==============================================================================
+class FileSystemWatcher::PollingBackend  : public FileSystemWatcher::Backend
+{
+public:
+    PollingBackend()  : pollingInterval (1000), nextPollTime (0) {}
+
+    bool addFolder (const File& folder) override
+    {
+        ScopedPointer<WatchedFolder> w (new WatchedFolder (folder));
+
+        // (the first scan is done here, so that nothing that changes after this
+        // method returns can be missed)
+        DirectoryScanner scanner (folder, true, "*", File::findFilesAndDirectories);
+        w->index.update (scanner);
+
+        const ScopedLock sl (lock);
+        folders.add (w.release());
+        return true;
+    }
+
+    void removeFolder (const File& folder) override
+    {
+        const ScopedLock sl (lock);
+
+        for (int i = folders.size(); --i >= 0;)
+            if (folders.getUnchecked (i)->folder == folder)
+                folders.remove (i);
+    }
+
+    void waitForEvents (Array<Event>& results, const int timeOutMilliseconds) override
+    {
+        const int msUntilNextPoll = jmax (0, (int) (nextPollTime - Time::getMillisecondCounter()));
+        const int msToWait = timeOutMilliseconds < 0 ? msUntilNextPoll
+                                                     : jmin (timeOutMilliseconds, msUntilNextPoll);
+
+        if (msToWait > 0)
+            wakeEvent.wait (msToWait);
+
+        if ((int) (Time::getMillisecondCounter() - nextPollTime) >= 0
+              && ! Thread::currentThreadShouldExit())
+        {
+            poll (results);
+            nextPollTime = Time::getMillisecondCounter() + (uint32) pollingInterval.get();
+        }
+    }
+
+    void wakeUp() override                                  { wakeEvent.signal(); }
+    void setPollingInterval (const int ms) override         { pollingInterval = jmax (1, ms); }
+
+private:
+    struct WatchedFolder
+    {
+        WatchedFolder (const File& f)  : folder (f) {}
+
+        const File folder;
+        DirectoryIndex index;
+    };
+
+    OwnedArray<WatchedFolder> folders;
+    CriticalSection lock;
+    WaitableEvent wakeEvent;
+    Atomic<int> pollingInterval;
+    uint32 nextPollTime;
+
+    void poll (Array<Event>& results)
+    {
+        const ScopedLock sl (lock);
+
+        for (int i = 0; i < folders.size(); ++i)
+        {
+            WatchedFolder& w = *folders.getUnchecked (i);
+            const DirectoryIndex previous (w.index);
+
+            DirectoryScanner scanner (w.folder, true, "*", File::findFilesAndDirectories);
+            const DirectoryIndex::Changes changes (w.index.update (scanner));
+
+            for (int j = 0; j < changes.removed.size(); ++j)
+            {
+                const File& f = changes.removed.getReference (j);
+                const DirectoryScanner::Entry* const e = previous.findEntry (f);
+                results.add (Event (fileDeleted, f, e != nullptr && e->isDirectory));
+            }
+
+            for (int j = 0; j < changes.added.size(); ++j)
+            {
+                const File& f = changes.added.getReference (j);
+                const DirectoryScanner::Entry* const e = w.index.findEntry (f);
+                results.add (Event (fileCreated, f, e != nullptr && e->isDirectory));
+            }
+
+            // (a folder's modification time changes whenever its contents do, but that's
+            // already been reported as the changes to the files inside it)
+            for (int j = 0; j < changes.modified.size(); ++j)
+            {
+                const File& f = changes.modified.getReference (j);
+                const DirectoryScanner::Entry* const e = w.index.findEntry (f);
+
+                if (e == nullptr || ! e->isDirectory)
+                    results.add (Event (fileModified, f, false));
+            }
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (PollingBackend)
+};
+
+#if ! JUCE_LINUX
+FileSystemWatcher::Backend* FileSystemWatcher::createNativeBackend()
+{
+    return nullptr;
+}
+#endif
+
+//==============================================================================
+FileSystemWatcher::Event::Event() noexcept
+    : type (fileModified), isDirectory (false)
+{
+}
+
+FileSystemWatcher::Event::Event (EventType t, const File& f, bool isDir, const File& previous)
+    : type (t), file (f), previousFile (previous), isDirectory (isDir)
+{
+}
+
+//==============================================================================
+FileSystemWatcher::FileSystemWatcher (const bool useNativeNotificationsIfAvailable)
+    : Thread ("FileSystemWatcher"),
+      usingNativeNotifications (false),
+      batchInterval (50)
+{
+    if (useNativeNotificationsIfAvailable)
+        backend = createNativeBackend();
+
+    usingNativeNotifications = (backend != nullptr);
+
+    if (backend == nullptr)
+        backend = new PollingBackend();
+}
+
+FileSystemWatcher::~FileSystemWatcher()
+{
+    signalThreadShouldExit();
+    backend->wakeUp();
+    stopThread (10000);
+    backend = nullptr;
+}
+
+//==============================================================================
+bool FileSystemWatcher::addFolder (const File& folder)
+{
+    if (! folder.isDirectory())
+        return false;
+
+    const ScopedLock sl (folderLock);
+
+    if (folders.contains (folder))
+        return true;
+
+    if (! backend->addFolder (folder))
+        return false;
+
+    folders.add (folder);
+    startThread();
+    return true;
+}
+
+void FileSystemWatcher::removeFolder (const File& folder)
+{
+    const ScopedLock sl (folderLock);
+
+    if (folders.contains (folder))
+    {
+        folders.removeFirstMatchingValue (folder);
+        backend->removeFolder (folder);
+    }
+}
+
+void FileSystemWatcher::removeAllFolders()
+{
+    const ScopedLock sl (folderLock);
+
+    while (folders.size() > 0)
+        removeFolder (folders.getLast());
+}
+
+Array<File> FileSystemWatcher::getWatchedFolders() const
+{
+    const ScopedLock sl (folderLock);
+    return folders;
+}
+
+bool FileSystemWatcher::isUsingNativeNotifications() const noexcept
+{
+    return usingNativeNotifications;
+}
+
+void FileSystemWatcher::setBatchInterval (const int milliseconds) noexcept
+{
+    batchInterval = jmax (0, milliseconds);
+}
+
+void FileSystemWatcher::setPollingInterval (const int milliseconds) noexcept
+{
+    backend->setPollingInterval (milliseconds);
+}
+
+void FileSystemWatcher::addListener (Listener* const listener)
+{
+    listeners.add (listener);
+}
+
+void FileSystemWatcher::removeListener (Listener* const listener)
+{
+    listeners.remove (listener);
+}
+
+//==============================================================================
+void FileSystemWatcher::run()
+{
+    Array<Event> events;
+    uint32 deliveryTime = 0;
+
+    while (! threadShouldExit())
+    {
+        const bool wasEmpty = events.isEmpty();
+
+        backend->waitForEvents (events, wasEmpty ? -1 : jmax (0, (int) (deliveryTime - Time::getMillisecondCounter())));
+
+        if (threadShouldExit())
+            break;
+
+        if (events.isEmpty())
+            continue;
+
+        if (wasEmpty)
+            deliveryTime = Time::getMillisecondCounter() + (uint32) batchInterval.get();
+
+        if ((int) (Time::getMillisecondCounter() - deliveryTime) >= 0)
+        {
+            FileSystemWatcherHelpers::mergeEvents (events);
+            listeners.call (&Listener::fileSystemChanged, *this, events);
+            events.clearQuick();
+        }
+    }
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class FileSystemWatcherTests  : public UnitTest
+{
+public:
+    FileSystemWatcherTests()  : UnitTest ("FileSystemWatcher") {}
+
+    struct EventCollector  : public FileSystemWatcher::Listener
+    {
+        EventCollector()  : received (true) {}
+
+        void fileSystemChanged (FileSystemWatcher&, const Array<FileSystemWatcher::Event>& newEvents) override
+        {
+            const ScopedLock sl (lock);
+            events.addArray (newEvents);
+            received.signal();
+        }
+
+        bool contains (FileSystemWatcher::EventType type, const File& file, const File& previousFile)
+        {
+            const ScopedLock sl (lock);
+
+            for (int i = 0; i < events.size(); ++i)
+            {
+                const FileSystemWatcher::Event& e = events.getReference (i);
+
+                if (e.type == type && e.file == file && e.previousFile == previousFile)
+                    return true;
+            }
+
+            return false;
+        }
+
+        bool waitFor (FileSystemWatcher::EventType type, const File& file, const File& previousFile = File())
+        {
+            const uint32 endTime = Time::getMillisecondCounter() + 10000;
+
+            while (! contains (type, file, previousFile))
+            {
+                if ((int) (endTime - Time::getMillisecondCounter()) <= 0)
+                    return false;
+
+                received.wait (100);
+            }
+
+            return true;
+        }
+
+        // A file that's written with File::replaceWithText() either appears as a new file, or
+        // (with native notifications) as a temporary file being renamed
+        bool containsWrittenFile (const File& file)
+        {
+            const ScopedLock sl (lock);
+
+            for (int i = 0; i < events.size(); ++i)
+            {
+                const FileSystemWatcher::Event& e = events.getReference (i);
+
+                if (e.file == file && (e.type == FileSystemWatcher::fileCreated || e.type == FileSystemWatcher::fileRenamed))
+                    return true;
+            }
+
+            return false;
+        }
+
+        bool waitForWrittenFile (const File& file)
+        {
+            const uint32 endTime = Time::getMillisecondCounter() + 10000;
+
+            while (! containsWrittenFile (file))
+            {
+                if ((int) (endTime - Time::getMillisecondCounter()) <= 0)
+                    return false;
+
+                received.wait (100);
+            }
+
+            return true;
+        }
+
+        int getNumEvents()
+        {
+            const ScopedLock sl (lock);
+            return events.size();
+        }
+
+        void clear()
+        {
+            const ScopedLock sl (lock);
+            events.clear();
+        }
+
+        CriticalSection lock;
+        Array<FileSystemWatcher::Event> events;
+        WaitableEvent received;
+    };
+
+    void testWatcher (FileSystemWatcher& watcher, const File& root)
+    {
+        EventCollector collector;
+        watcher.addListener (&collector);
+        watcher.setPollingInterval (50);
+
+        const File subFolder (root.getChildFile ("sub"));
+        expect (subFolder.createDirectory());
+
+        expect (watcher.addFolder (root));
+        expect (! watcher.addFolder (root.getChildFile ("doesnt_exist")));
+        expectEquals (watcher.getWatchedFolders().size(), 1);
+
+        const File file (subFolder.getChildFile ("a.txt"));
+        expect (file.replaceWithText ("hello"));
+        expect (collector.waitForWrittenFile (file));
+
+        collector.clear();
+        expect (file.appendText ("world"));
+        expect (collector.waitFor (FileSystemWatcher::fileModified, file));
+
+        // replacing a file that already exists mustn't be reported as creating it
+        collector.clear();
+        expect (file.replaceWithText ("replaced"));
+
+        if (watcher.isUsingNativeNotifications())
+            expect (collector.waitForWrittenFile (file));
+        else
+            expect (collector.waitFor (FileSystemWatcher::fileModified, file));
+
+        expect (! collector.contains (FileSystemWatcher::fileCreated, file, File()));
+
+        const File renamed (root.getChildFile ("b.txt"));
+        expect (file.moveFileTo (renamed));
+
+        if (watcher.isUsingNativeNotifications())
+        {
+            expect (collector.waitFor (FileSystemWatcher::fileRenamed, renamed, file));
+        }
+        else
+        {
+            expect (collector.waitFor (FileSystemWatcher::fileDeleted, file));
+            expect (collector.waitFor (FileSystemWatcher::fileCreated, renamed));
+        }
+
+        // files in new folders must be found, even if they're created before the
+        // watcher has had a chance to start watching the folder
+        const File newFolder (root.getChildFile ("new"));
+        expect (newFolder.createDirectory());
+        expect (newFolder.getChildFile ("c.txt").replaceWithText ("c"));
+        expect (collector.waitFor (FileSystemWatcher::fileCreated, newFolder));
+        expect (collector.waitForWrittenFile (newFolder.getChildFile ("c.txt")));
+
+        const File renamedFolder (root.getChildFile ("renamed"));
+        expect (newFolder.moveFileTo (renamedFolder));
+        expect (renamedFolder.getChildFile ("d.txt").replaceWithText ("d"));
+        expect (collector.waitForWrittenFile (renamedFolder.getChildFile ("d.txt")));
+
+        expect (renamed.deleteFile());
+        expect (collector.waitFor (FileSystemWatcher::fileDeleted, renamed));
+
+        watcher.removeFolder (root);
+        expectEquals (watcher.getWatchedFolders().size(), 0);
+        Thread::sleep (200);
+        collector.clear();
+
+        expect (root.getChildFile ("e.txt").replaceWithText ("e"));
+        Thread::sleep (300);
+        expectEquals (collector.getNumEvents(), 0);
+
+        watcher.removeListener (&collector);
+    }
+
+    void runTest() override
+    {
+        for (int i = 0; i < 2; ++i)
+        {
+            FileSystemWatcher watcher (i == 0);
+            const File root (File::createTempFile ("watchertest"));
+
+            beginTest (watcher.isUsingNativeNotifications() ? "Native notifications" : "Polling");
+            expect (root.createDirectory());
+            testWatcher (watcher, root);
+
+            expect (root.deleteRecursively());
+        }
+
+        beginTest ("Merging events");
+        {
+            const File f0 ("/a/0"), f1 ("/a/1"), f2 ("/a/2"), f3 ("/a/3"), f4 ("/a/4"), f5 ("/a/5"), f6 ("/a/6"), t6 ("/a/6.tmp");
+
+            Array<FileSystemWatcher::Event> events;
+            events.add (FileSystemWatcher::Event (FileSystemWatcher::fileCreated, f1, false));
+            events.add (FileSystemWatcher::Event (FileSystemWatcher::fileModified, f1, false));
+            events.add (FileSystemWatcher::Event (FileSystemWatcher::fileModified, f2, false));
+            events.add (FileSystemWatcher::Event (FileSystemWatcher::fileModified, f2, false));
+            events.add (FileSystemWatcher::Event (FileSystemWatcher::fileDeleted, f2, false));
+            events.add (FileSystemWatcher::Event (FileSystemWatcher::fileRenamed, f3, false, f0));
+            events.add (FileSystemWatcher::Event (FileSystemWatcher::fileModified, f3, false));
+            events.add (FileSystemWatcher::Event (FileSystemWatcher::fileDeleted, f1, false));
+            events.add (FileSystemWatcher::Event (FileSystemWatcher::fileCreated, f1, false));
+            events.add (FileSystemWatcher::Event (FileSystemWatcher::fileCreated, f4, false));
+            events.add (FileSystemWatcher::Event (FileSystemWatcher::fileModified, f4, false));
+            events.add (FileSystemWatcher::Event (FileSystemWatcher::fileRenamed, f5, false, f4));
+            events.add (FileSystemWatcher::Event (FileSystemWatcher::fileModified, f5, false));
+
+            // (a temporary file that replaces a file which already existed)
+            events.add (FileSystemWatcher::Event (FileSystemWatcher::fileCreated, t6, false));
+            events.add (FileSystemWatcher::Event (FileSystemWatcher::fileModified, t6, false));
+            events.add (FileSystemWatcher::Event (FileSystemWatcher::fileRenamed, f6, false, t6));
+
+            FileSystemWatcherHelpers::mergeEvents (events);
+
+            expectEquals (events.size(), 7);
+            expect (events[0].type == FileSystemWatcher::fileCreated  && events[0].file == f1);
+            expect (events[1].type == FileSystemWatcher::fileDeleted  && events[1].file == f2);
+            expect (events[2].type == FileSystemWatcher::fileRenamed  && events[2].file == f3);
+            expect (events[2].previousFile == f0);
+            expect (events[3].type == FileSystemWatcher::fileDeleted  && events[3].file == f1);
+            expect (events[4].type == FileSystemWatcher::fileCreated  && events[4].file == f1);
+            expect (events[5].type == FileSystemWatcher::fileRenamed  && events[5].file == f5);
+            expect (events[5].previousFile == f4);
+            expect (events[6].type == FileSystemWatcher::fileRenamed  && events[6].file == f6);
+            expect (events[6].previousFile == t6);
+        }
+    }
+};
+
+static FileSystemWatcherTests fileSystemWatcherTests;
+
+#endif
@@ -0,0 +1,202 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+#ifndef JUCE_FILESYSTEMWATCHER_H_INCLUDED
+#define JUCE_FILESYSTEMWATCHER_H_INCLUDED
+
+
+//==============================================================================
+/**
+    Watches one or more directory trees, and tells its listeners when any of the
+    files or folders inside them are created, modified, deleted or renamed.
+
+    On Linux the notifications come from inotify, so the cost of watching a folder
+    doesn't depend on how many files it contains. On other platforms, the folders are
+    re-scanned at regular intervals with a DirectoryScanner, and the results compared
+    with a DirectoryIndex - this can't tell a rename from a delete followed by a create,
+    and will be slower to notice changes, but the events are otherwise the same.
+
+    Events are collected for a short time after the first one arrives (see
+    setBatchInterval()), and are then passed to the listeners all together. Repeated
+    modifications of a file within a batch are merged into a single event, and when a
+    file is written to a temporary file which is then renamed (as File::replaceWithText()
+    does), only the rename is reported. (Its target may or may not have existed before,
+    so a listener should treat the renamed file as either new or changed.)
+
+    The listener callbacks are made on the watcher's own background thread. If you need
+    to respond to them on the message thread, your listener should copy the events it's
+    given and pass them on with e.g. an AsyncUpdater or MessageManager::callAsync().
+
+    @code
+    struct PresetFolderListener  : public FileSystemWatcher::Listener
+    {
+        void fileSystemChanged (FileSystemWatcher&, const Array<FileSystemWatcher::Event>& events) override
+        {
+            for (int i = 0; i < events.size(); ++i)
+                DBG (events.getReference (i).file.getFullPathName());
+        }
+    };
+
+    FileSystemWatcher watcher;
+    watcher.addListener (&presetFolderListener);
+    watcher.addFolder (presetFolder);
+    @endcode
+
+    @see DirectoryScanner, DirectoryIndex
+*/
+class JUCE_API  FileSystemWatcher  : private Thread
+{
+public:
+    //==============================================================================
+    /** Creates a watcher.
+
+        @param useNativeNotificationsIfAvailable    if true and the OS supports it, inotify
+                                                    will be used. If false, or if inotify isn't
+                                                    available, the folders will be polled.
+    */
+    explicit FileSystemWatcher (bool useNativeNotificationsIfAvailable = true);
+
+    /** Destructor. */
+    ~FileSystemWatcher();
+
+    //==============================================================================
+    /** Starts watching a folder and all of its sub-folders.
+        Returns false if the folder doesn't exist, or can't be watched.
+    */
+    bool addFolder (const File& folder);
+
+    /** Stops watching a folder that was previously added with addFolder(). */
+    void removeFolder (const File& folder);
+
+    /** Stops watching all the folders. */
+    void removeAllFolders();
+
+    /** Returns the folders that were added with addFolder(). */
+    Array<File> getWatchedFolders() const;
+
+    /** Returns true if the watcher is getting notifications from the OS, or false if it's
+        having to poll the folders.
+    */
+    bool isUsingNativeNotifications() const noexcept;
+
+    //==============================================================================
+    /** Sets how long the watcher waits after an event arrives for any others that may
+        follow it, before passing them all to the listeners. The default is 50ms.
+    */
+    void setBatchInterval (int milliseconds) noexcept;
+
+    /** When the folders are being polled, this sets how often they're re-scanned.
+        The default is 1000ms. This has no effect when native notifications are used.
+    */
+    void setPollingInterval (int milliseconds) noexcept;
+
+    //==============================================================================
+    /** The types of event that a FileSystemWatcher reports. */
+    enum EventType
+    {
+        fileCreated,    /**< A file or folder was created, or moved into a watched folder. */
+        fileModified,   /**< The contents or attributes of a file changed. */
+        fileDeleted,    /**< A file or folder was deleted, or moved out of the watched folders. */
+        fileRenamed,    /**< A file or folder was renamed or moved within the watched folders. */
+        eventsLost      /**< The OS couldn't keep up with the number of changes, so some events
+                             may be missing, and you should re-scan the folders yourself. */
+    };
+
+    /** Describes a single change that a FileSystemWatcher has seen. */
+    struct Event
+    {
+        /** Creates an empty event. */
+        Event() noexcept;
+
+        /** Creates an event. */
+        Event (EventType type, const File& file, bool isDirectory, const File& previousFile = File());
+
+        /** The type of change. */
+        EventType type;
+
+        /** The file that changed. For a fileRenamed event, this is its new name. */
+        File file;
+
+        /** For a fileRenamed event, this is the file's old name. */
+        File previousFile;
+
+        /** True if the item is a folder. */
+        bool isDirectory;
+    };
+
+    //==============================================================================
+    /** Receives the events from a FileSystemWatcher.
+        @see FileSystemWatcher::addListener
+    */
+    class JUCE_API  Listener
+    {
+    public:
+        /** Destructor. */
+        virtual ~Listener() {}
+
+        /** Called with a batch of changes, in the order that they happened.
+            This is called on the watcher's background thread.
+        */
+        virtual void fileSystemChanged (FileSystemWatcher& watcher, const Array<Event>& events) = 0;
+    };
+
+    /** Registers a listener to receive events.
+        This is thread-safe, and can be called from a listener callback.
+    */
+    void addListener (Listener* listener);
+
+    /** Removes a listener that was previously added.
+        Once this returns, the listener is guaranteed not to be called again, unless this
+        is being called from inside one of its callbacks.
+    */
+    void removeListener (Listener* listener);
+
+private:
+    //==============================================================================
+    class Backend;
+    class PollingBackend;
+    class NativeBackend;
+    friend struct ContainerDeletePolicy<Backend>;
+
+    ScopedPointer<Backend> backend;
+    Array<File> folders;
+    CriticalSection folderLock;
+    bool usingNativeNotifications;
+    Atomic<int> batchInterval;
+    ListenerList<Listener, Array<Listener*, CriticalSection> > listeners;
+
+    void run() override;
+    static Backend* createNativeBackend();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FileSystemWatcher)
+};
+
+#endif   // JUCE_FILESYSTEMWATCHER_H_INCLUDED
@@ -47,6 +47,38 @@ public:
                          made will be flushed back to disk at the whim of the OS. */
     };
 
+    /** Flags that can be passed to the constructor to control how the mapped memory
+        is loaded. These can be combined with a bitwise OR.
+    */
+    enum MappingOptions
+    {
+        defaultMapping      = 0,    /**< The pages are loaded lazily when they're first accessed. */
+        prefaultPages       = 1,    /**< All the pages are read into memory when the file is opened
+                                         (using MAP_POPULATE on Linux), so that accessing them later
+                                         won't cause any page faults. */
+        lockPagesInMemory   = 2     /**< The pages are read into memory when the file is opened, and
+                                         locked so that the OS can't page them out again. If the OS
+                                         won't allow this (e.g. because the process has reached its
+                                         limit for locked memory), the file is still mapped, but not
+                                         locked - you can call lockPages() to find out whether it
+                                         succeeds. */
+    };
+
+    /** Hints that can be given to the OS about how a region of the mapped memory will be
+        accessed.
+        @see adviseAccess
+    */
+    enum AccessHint
+    {
+        normalAccess,       /**< No particular access pattern - this resets any earlier hints. */
+        sequentialAccess,   /**< The memory will be read in order, so the OS can read ahead aggressively,
+                                 and free pages soon after they've been used. */
+        randomAccess,       /**< The memory will be accessed in a random order, so reading ahead is
+                                 likely to be a waste of time. */
+        willNeed            /**< The memory will be needed soon, so the OS should start reading it
+                                 into memory in the background. */
+    };
+
     /** Opens a file and maps it to an area of virtual memory.
 
         The file should already exist, and should already be the size that you want to work with
@@ -63,8 +95,11 @@ public:
         mapping as an effective way of communicating. If exclusive is true then the mapped file will
         be opened exclusively - preventing other apps to access the file which may improve the
         performance of accessing the file.
+
+        The mappingOptions parameter is a combination of values from the MappingOptions enum.
     */
-    MemoryMappedFile (const File& file, AccessMode mode, bool exclusive = false);
+    MemoryMappedFile (const File& file, AccessMode mode, bool exclusive = false,
+                      int mappingOptions = defaultMapping);
 
     /** Opens a section of a file and maps it to an area of virtual memory.
 
@@ -81,11 +116,14 @@ public:
         NOTE: the start of the actual range used may be rounded-down to a multiple of the OS's page-size,
         so do not assume that the mapped memory will begin at exactly the position you requested - always
         use getRange() to check the actual range that is being used.
+
+        The mappingOptions parameter is a combination of values from the MappingOptions enum.
     */
     MemoryMappedFile (const File& file,
                       const Range<int64>& fileRange,
                       AccessMode mode,
-                      bool exclusive = false);
+                      bool exclusive = false,
+                      int mappingOptions = defaultMapping);
 
     /** Destructor. */
     ~MemoryMappedFile();
@@ -103,6 +141,37 @@ public:
     /** Returns the section of the file at which the mapped memory represents. */
     Range<int64> getRange() const noexcept      { return range; }
 
+    //==============================================================================
+    /** Tells the OS how a section of the mapped memory is going to be accessed.
+
+        The range is given as positions in the file, and is clipped to the section that
+        has been mapped. By default, the whole file is marked for sequential access.
+        Returns false if the OS doesn't support the hint.
+    */
+    bool adviseAccess (Range<int64> rangeOfFile, AccessHint hint) const noexcept;
+
+    /** Reads a section of the mapped memory into physical memory, by touching each of
+        its pages. This blocks until the data has been loaded, so it's intended to be
+        called from a background thread, to make sure that a later access from a
+        time-critical thread won't have to wait for the disk.
+        The range is given as positions in the file, and is clipped to the mapped section.
+    */
+    void prefault (Range<int64> rangeOfFile) const noexcept;
+
+    /** Loads a section of the mapped memory and locks it into physical memory, so that
+        it can't be paged out again.
+        The range is given as positions in the file, and is clipped to the mapped section.
+        Returns false if the OS refuses, e.g. because the process has reached its limit
+        for locked memory.
+        @see unlockPages
+    */
+    bool lockPages (Range<int64> rangeOfFile) const noexcept;
+
+    /** Unlocks memory that was locked with lockPages(), or with the lockPagesInMemory
+        option. The memory is unlocked automatically when the file is unmapped.
+    */
+    void unlockPages (Range<int64> rangeOfFile) const noexcept;
+
 private:
     //==============================================================================
     void* address;
@@ -114,7 +183,8 @@ private:
     int fileHandle;
    #endif
 
-    void openInternal (const File&, AccessMode, bool);
+    void openInternal (const File&, AccessMode, bool, int);
+    Range<int64> getPageAlignedRange (Range<int64>) const noexcept;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MemoryMappedFile)
 };
@@ -33,7 +33,7 @@ class JSONParser
 public:
     static Result parseObjectOrArray (String::CharPointerType t, var& result)
     {
-        t = t.findEndOfWhitespace();
+        t = skipWhitespace (t);
 
         switch (t.getAndAdvance())
         {
@@ -47,10 +47,26 @@ public:
 
     static Result parseString (const juce_wchar quoteChar, String::CharPointerType& t, var& result)
     {
+        // Most strings don't contain any escape sequences, so if the closing quote is the
+        // first special character, the string can be created directly from the source text..
+        const String::CharPointerType end (findEndOfPlainText (t, quoteChar));
+
+        if (*end == quoteChar)
+        {
+            result = String (t, end);
+            t = end;
+            ++t;
+            return Result::ok();
+        }
+
         MemoryOutputStream buffer (256);
 
         for (;;)
         {
+            const String::CharPointerType runEnd (findEndOfPlainText (t, quoteChar));
+            appendText (buffer, t, runEnd);
+            t = runEnd;
+
             juce_wchar c = t.getAndAdvance();
 
             if (c == quoteChar)
@@ -104,7 +120,7 @@ public:
 
     static Result parseAny (String::CharPointerType& t, var& result)
     {
-        t = t.findEndOfWhitespace();
+        t = skipWhitespace (t);
         String::CharPointerType t2 (t);
 
         switch (t2.getAndAdvance())
@@ -115,7 +131,7 @@ public:
             case '\'':   t = t2; return parseString ('\'', t, result);
 
             case '-':
-                t2 = t2.findEndOfWhitespace();
+                t2 = skipWhitespace (t2);
                 if (! CharacterFunctions::isDigit (*t2))
                     break;
 
@@ -171,6 +187,110 @@ private:
         return Result::fail (m);
     }
 
+    //==============================================================================
+    static String::CharPointerType skipWhitespace (String::CharPointerType t) noexcept
+    {
+        const String::CharPointerType::CharType* p = t.getAddress();
+
+        // (this checks the raw characters for the common ASCII whitespace before falling
+        // back to the slower unicode-aware check)
+        while (*p == ' ' || (*p >= '\t' && *p <= '\r'))
+            ++p;
+
+        t = String::CharPointerType (p);
+        return static_cast<uint32> (*p) < 0x80 ? t : t.findEndOfWhitespace();
+    }
+
+    static const char* findEndOfPlainText (const char* const text, const juce_wchar quoteChar) noexcept
+    {
+        // strcspn is usually vectorised by the C library, so this is much quicker than
+        // decoding the UTF-8 a character at a time
+        const char specialChars[] = { (char) quoteChar, '\\', 0 };
+        return text + strcspn (text, specialChars);
+    }
+
+    template <typename CharType>
+    static const CharType* findEndOfPlainText (const CharType* text, const juce_wchar quoteChar) noexcept
+    {
+        while (*text != 0 && *text != '\\' && static_cast<juce_wchar> (*text) != quoteChar)
+            ++text;
+
+        return text;
+    }
+
+    static String::CharPointerType findEndOfPlainText (const String::CharPointerType t, const juce_wchar quoteChar) noexcept
+    {
+        return String::CharPointerType (findEndOfPlainText (t.getAddress(), quoteChar));
+    }
+
+    static void appendText (MemoryOutputStream& out, String::CharPointerType start, const String::CharPointerType end)
+    {
+       #if JUCE_STRING_UTF_TYPE == 8
+        out.write (start.getAddress(), (size_t) (end.getAddress() - start.getAddress()));
+       #else
+        while (start.getAddress() < end.getAddress())
+            out.appendUTF8Char (start.getAndAdvance());
+       #endif
+    }
+
+    // Converts a decimal number to a double using a single multiplication or division
+    // when it's possible to do that without any rounding errors (i.e. when the digits
+    // fit exactly into a double's mantissa, and the power of ten is exactly representable).
+    // Returns false if the number needs to be parsed the slow way.
+    static bool parseDoubleQuickly (String::CharPointerType& t, double& result) noexcept
+    {
+        static const double powersOfTen[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                              1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                              1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+        const String::CharPointerType::CharType* p = t.getAddress();
+        uint64 mantissa = 0;
+        int numDigits = 0, exponent = 0;
+
+        for (; *p >= '0' && *p <= '9'; ++p, ++numDigits)
+            mantissa = mantissa * 10 + (uint64) (*p - '0');
+
+        if (*p == '.')
+        {
+            ++p;
+
+            if (*p < '0' || *p > '9')
+                return false;
+
+            for (; *p >= '0' && *p <= '9'; ++p, ++numDigits, --exponent)
+                mantissa = mantissa * 10 + (uint64) (*p - '0');
+        }
+
+        if (*p == 'e' || *p == 'E')
+        {
+            ++p;
+            const bool negativeExponent = (*p == '-');
+
+            if (*p == '-' || *p == '+')
+                ++p;
+
+            if (*p < '0' || *p > '9')
+                return false;
+
+            int explicitExponent = 0;
+
+            for (; *p >= '0' && *p <= '9'; ++p)
+                if (explicitExponent < 10000)
+                    explicitExponent = explicitExponent * 10 + (*p - '0');
+
+            exponent += negativeExponent ? -explicitExponent : explicitExponent;
+        }
+
+        if (numDigits > 19 || mantissa > (((uint64) 1) << 53)
+             || exponent < -22 || exponent > 22)
+            return false;
+
+        result = exponent < 0 ? (double) mantissa / powersOfTen[-exponent]
+                              : (double) mantissa * powersOfTen[exponent];
+        t = String::CharPointerType (p);
+        return true;
+    }
+
     static Result parseNumber (String::CharPointerType& t, var& result, const bool isNegative)
     {
         String::CharPointerType oldT (t);
@@ -193,7 +313,14 @@ private:
             if (c == 'e' || c == 'E' || c == '.')
             {
                 t = oldT;
-                const double asDouble = CharacterFunctions::readDoubleValue (t);
+                double asDouble;
+
+                if (! parseDoubleQuickly (t, asDouble))
+                {
+                    t = oldT;
+                    asDouble = CharacterFunctions::readDoubleValue (t);
+                }
+
                 result = isNegative ? -asDouble : asDouble;
                 return Result::ok();
             }
@@ -226,7 +353,7 @@ private:
 
         for (;;)
         {
-            t = t.findEndOfWhitespace();
+            t = skipWhitespace (t);
 
             String::CharPointerType oldT (t);
             const juce_wchar c = t.getAndAdvance();
@@ -239,17 +366,30 @@ private:
 
             if (c == '"')
             {
-                var propertyNameVar;
-                Result r (parseString ('"', t, propertyNameVar));
+                Identifier propertyName;
+                const String::CharPointerType nameEnd (findEndOfPlainText (t, '"'));
+
+                if (*nameEnd == '"' && nameEnd.getAddress() > t.getAddress())
+                {
+                    // (if the name has no escape sequences, it can be pooled without making a temporary string)
+                    propertyName = Identifier (t, nameEnd);
+                    t = nameEnd;
+                    ++t;
+                }
+                else
+                {
+                    var propertyNameVar;
+                    Result r (parseString ('"', t, propertyNameVar));
 
-                if (r.failed())
-                    return r;
+                    if (r.failed())
+                        return r;
 
-                const Identifier propertyName (propertyNameVar.toString());
+                    propertyName = Identifier (propertyNameVar.toString());
+                }
 
                 if (propertyName.isValid())
                 {
-                    t = t.findEndOfWhitespace();
+                    t = skipWhitespace (t);
                     oldT = t;
 
                     const juce_wchar c2 = t.getAndAdvance();
@@ -264,7 +404,7 @@ private:
                     if (r2.failed())
                         return r2;
 
-                    t = t.findEndOfWhitespace();
+                    t = skipWhitespace (t);
                     oldT = t;
 
                     const juce_wchar nextChar = t.getAndAdvance();
@@ -290,7 +430,7 @@ private:
 
         for (;;)
         {
-            t = t.findEndOfWhitespace();
+            t = skipWhitespace (t);
 
             String::CharPointerType oldT (t);
             const juce_wchar c = t.getAndAdvance();
@@ -308,7 +448,7 @@ private:
             if (r.failed())
                 return r;
 
-            t = t.findEndOfWhitespace();
+            t = skipWhitespace (t);
             oldT = t;
 
             const juce_wchar nextChar = t.getAndAdvance();
@@ -351,6 +491,10 @@ public:
         {
             out << (static_cast<bool> (v) ? "true" : "false");
         }
+        else if (v.isInt() || v.isInt64())
+        {
+            writeInteger (out, static_cast<int64> (v));
+        }
         else if (v.isArray())
         {
             writeArray (out, *v.getArray(), indentLevel, allOnOneLine);
@@ -376,10 +520,50 @@ public:
         out << "\\u" << String::toHexString ((int) value).paddedLeft ('0', 4);
     }
 
+    static void writeInteger (OutputStream& out, const int64 value)
+    {
+        // (formats the number directly, rather than creating a temporary String)
+        char buffer[24];
+        char* const end = buffer + numElementsInArray (buffer);
+        char* p = end;
+        uint64 v = value < 0 ? (uint64) -(value + 1) + 1 : (uint64) value;
+
+        do
+        {
+            *--p = (char) ('0' + (int) (v % 10));
+            v /= 10;
+        }
+        while (v != 0);
+
+        if (value < 0)
+            *--p = '-';
+
+        out.write (p, (size_t) (end - p));
+    }
+
     static void writeString (OutputStream& out, String::CharPointerType t)
     {
         for (;;)
         {
+            // Write any run of characters that don't need escaping as a single block..
+            const String::CharPointerType::CharType* const runStart = t.getAddress();
+            const String::CharPointerType::CharType* runEnd = runStart;
+
+            while (*runEnd >= 32 && *runEnd < 127 && *runEnd != '"' && *runEnd != '\\')
+                ++runEnd;
+
+            if (runEnd > runStart)
+            {
+               #if JUCE_STRING_UTF_TYPE == 8
+                out.write (runStart, (size_t) (runEnd - runStart));
+               #else
+                for (const String::CharPointerType::CharType* p = runStart; p < runEnd; ++p)
+                    out.writeByte ((char) *p);
+               #endif
+
+                t = String::CharPointerType (runEnd);
+            }
+
             const juce_wchar c (t.getAndAdvance());
 
             switch (c)
@@ -465,6 +649,408 @@ public:
     enum { indentSize = 2 };
 };
 
+//==============================================================================
+class JSONBinaryFormat
+{
+public:
+    // The binary format is a header, followed by a single value. Each value is a one-byte
+    // type tag followed by its content. Integers are stored as zig-zag encoded variable-length
+    // numbers, and property names are only stored the first time they're used - after that,
+    // they're referred to by their index in the list of names that have been seen.
+    enum
+    {
+        tagVoid = 0,
+        tagUndefined,
+        tagFalse,
+        tagTrue,
+        tagInt,
+        tagInt64,
+        tagDouble,
+        tagString,
+        tagBinary,
+        tagArray,
+        tagObject
+    };
+
+    enum { headerByte1 = 'J', headerByte2 = 'B', formatVersion = 1 };
+
+    //==============================================================================
+    class Writer
+    {
+    public:
+        Writer (OutputStream& o) : out (o), numBytesBuffered (0)
+        {
+            writeByte (headerByte1);
+            writeByte (headerByte2);
+            writeByte (formatVersion);
+        }
+
+        ~Writer()
+        {
+            flush();
+        }
+
+        void write (const var& v)
+        {
+            if (v.isString())
+            {
+                const String s (v.toString());
+                writeByte (tagString);
+                writeBytes (s.toRawUTF8(), s.getNumBytesAsUTF8());
+            }
+            else if (v.isInt())
+            {
+                writeByte (tagInt);
+                writeVarInt (zigZagEncode (static_cast<int> (v)));
+            }
+            else if (v.isInt64())
+            {
+                writeByte (tagInt64);
+                writeVarInt (zigZagEncode (static_cast<int64> (v)));
+            }
+            else if (v.isDouble())
+            {
+                const double d = ByteOrder::swapIfBigEndian (static_cast<double> (v));
+                writeByte (tagDouble);
+                writeRaw (&d, sizeof (d));
+            }
+            else if (v.isBool())
+            {
+                writeByte (static_cast<bool> (v) ? tagTrue : tagFalse);
+            }
+            else if (v.isUndefined())
+            {
+                writeByte (tagUndefined);
+            }
+            else if (const Array<var>* array = v.getArray())
+            {
+                writeByte (tagArray);
+                writeVarInt ((uint64) array->size());
+
+                for (int i = 0; i < array->size(); ++i)
+                    write (array->getReference (i));
+            }
+            else if (const MemoryBlock* block = v.getBinaryData())
+            {
+                writeByte (tagBinary);
+                writeBytes (block->getData(), block->getSize());
+            }
+            else if (DynamicObject* object = v.getDynamicObject())
+            {
+                const NamedValueSet& properties = object->getProperties();
+
+                writeByte (tagObject);
+                writeVarInt ((uint64) properties.size());
+
+                for (int i = 0; i < properties.size(); ++i)
+                {
+                    writeName (properties.getName (i));
+                    write (properties.getValueAt (i));
+                }
+            }
+            else
+            {
+                // Only the types of var that can be represented in JSON can be stored!
+                jassert (v.isVoid());
+                writeByte (tagVoid);
+            }
+        }
+
+        void flush()
+        {
+            if (numBytesBuffered > 0)
+            {
+                out.write (buffer, numBytesBuffered);
+                numBytesBuffered = 0;
+            }
+        }
+
+    private:
+        OutputStream& out;
+        FlatHashMap<const void*, int> nameIndexes;
+        char buffer[8192];
+        size_t numBytesBuffered;
+
+        void writeRaw (const void* data, const size_t numBytes)
+        {
+            if (numBytesBuffered + numBytes > sizeof (buffer))
+            {
+                flush();
+
+                if (numBytes > sizeof (buffer) / 2)
+                {
+                    out.write (data, numBytes);
+                    return;
+                }
+            }
+
+            memcpy (buffer + numBytesBuffered, data, numBytes);
+            numBytesBuffered += numBytes;
+        }
+
+        void writeByte (const int byte)
+        {
+            if (numBytesBuffered >= sizeof (buffer))
+                flush();
+
+            buffer[numBytesBuffered++] = (char) byte;
+        }
+
+        void writeVarInt (uint64 value)
+        {
+            uint8 data[10];
+            size_t num = 0;
+
+            while (value >= 0x80)
+            {
+                data[num++] = (uint8) (value | 0x80);
+                value >>= 7;
+            }
+
+            data[num++] = (uint8) value;
+            writeRaw (data, num);
+        }
+
+        void writeBytes (const void* data, const size_t numBytes)
+        {
+            writeVarInt ((uint64) numBytes);
+            writeRaw (data, numBytes);
+        }
+
+        void writeName (const Identifier& name)
+        {
+            // (Identifiers are pooled, so the address of the text is enough to identify the name)
+            const void* const key = name.getCharPointer().getAddress();
+
+            if (const int* const index = nameIndexes.find (key))
+            {
+                writeVarInt ((uint64) *index + 1);
+            }
+            else
+            {
+                nameIndexes.set (key, nameIndexes.size());
+                writeVarInt (0);
+
+                const String& s = name.toString();
+                writeBytes (s.toRawUTF8(), s.getNumBytesAsUTF8());
+            }
+        }
+
+        static uint64 zigZagEncode (const int64 value) noexcept
+        {
+            return (((uint64) value) << 1) ^ (uint64) (value >> 63);
+        }
+
+        JUCE_DECLARE_NON_COPYABLE (Writer)
+    };
+
+    //==============================================================================
+    class Reader
+    {
+    public:
+        Reader (const void* data, const size_t numBytes) noexcept
+            : position (static_cast<const uint8*> (data)),
+              end (static_cast<const uint8*> (data) + numBytes),
+              failed (false)
+        {
+        }
+
+        var readDocument()
+        {
+            if (end - position < 3 || position[0] != headerByte1
+                 || position[1] != headerByte2 || position[2] != formatVersion)
+                return var();
+
+            position += 3;
+            const var result (read (0));
+            return failed ? var() : result;
+        }
+
+    private:
+        const uint8* position;
+        const uint8* const end;
+        Array<Identifier> names;
+        bool failed;
+
+        enum { maxDepth = 1000 };
+
+        var read (const int depth)
+        {
+            if (position >= end || depth > maxDepth)
+                return fail();
+
+            switch (*position++)
+            {
+                case tagVoid:       return var();
+                case tagUndefined:  return var::undefined();
+                case tagFalse:      return var (false);
+                case tagTrue:       return var (true);
+                case tagInt:        return var ((int) zigZagDecode (readVarInt()));
+                case tagInt64:      return var (zigZagDecode (readVarInt()));
+
+                case tagDouble:
+                {
+                    if (end - position < (int) sizeof (double))
+                        return fail();
+
+                    double d;
+                    memcpy (&d, position, sizeof (d));
+                    position += sizeof (d);
+                    return var (ByteOrder::swapIfBigEndian (d));
+                }
+
+                case tagString:
+                {
+                    const size_t numBytes = readLength();
+
+                    if (failed || ! isValidUTF8 (numBytes))
+                        return fail();
+
+                    const String s (String::fromUTF8 ((const char*) position, (int) numBytes));
+                    position += numBytes;
+                    return s;
+                }
+
+                case tagBinary:
+                {
+                    const size_t numBytes = readLength();
+
+                    if (failed)
+                        return var();
+
+                    const MemoryBlock block (position, numBytes);
+                    position += numBytes;
+                    return var (block);
+                }
+
+                case tagArray:
+                {
+                    const size_t numItems = readLength();
+
+                    if (failed)
+                        return var();
+
+                    var result = var (Array<var>());
+                    Array<var>& items = *result.getArray();
+                    items.ensureStorageAllocated ((int) numItems);
+
+                    for (size_t i = 0; i < numItems && ! failed; ++i)
+                        items.add (read (depth + 1));
+
+                    return result;
+                }
+
+                case tagObject:
+                {
+                    const size_t numProperties = readLength();
+
+                    if (failed)
+                        return var();
+
+                    DynamicObject* const object = new DynamicObject();
+                    var result (object);
+                    NamedValueSet& properties = object->getProperties();
+
+                    for (size_t i = 0; i < numProperties && ! failed; ++i)
+                    {
+                        const Identifier name (readName());
+
+                        if (! failed)
+                            properties.set (name, read (depth + 1));
+                    }
+
+                    return result;
+                }
+
+                default:
+                    return fail();
+            }
+        }
+
+        var fail() noexcept
+        {
+            failed = true;
+            position = end;
+            return var();
+        }
+
+        uint64 readVarInt() noexcept
+        {
+            uint64 result = 0;
+
+            for (int shift = 0; shift < 64; shift += 7)
+            {
+                if (position >= end)
+                    break;
+
+                const uint8 byte = *position++;
+                result |= ((uint64) (byte & 0x7f)) << shift;
+
+                if ((byte & 0x80) == 0)
+                    return result;
+            }
+
+            fail();
+            return 0;
+        }
+
+        // Reads a count or a number of bytes, which can't be more than the number of bytes
+        // that are left (as every item takes at least one byte)
+        size_t readLength() noexcept
+        {
+            const uint64 length = readVarInt();
+
+            if (length > (uint64) (end - position))
+            {
+                fail();
+                return 0;
+            }
+
+            return (size_t) length;
+        }
+
+        // (a String can't contain a null character, so one in the data means that it's corrupt)
+        bool isValidUTF8 (const size_t numBytes) const noexcept
+        {
+            return memchr (position, 0, numBytes) == nullptr
+                    && CharPointer_UTF8::isValidString ((const char*) position, (int) numBytes);
+        }
+
+        Identifier readName()
+        {
+            const uint64 index = readVarInt();
+
+            if (index > 0)
+            {
+                if (index <= (uint64) names.size())
+                    return names.getReference ((int) index - 1);
+            }
+            else
+            {
+                const size_t numBytes = readLength();
+
+                if (numBytes > 0 && isValidUTF8 (numBytes))
+                {
+                    const Identifier name (String::fromUTF8 ((const char*) position, (int) numBytes));
+                    position += numBytes;
+                    names.add (name);
+                    return name;
+                }
+            }
+
+            fail();
+            return Identifier();
+        }
+
+        static int64 zigZagDecode (const uint64 value) noexcept
+        {
+            return (int64) (value >> 1) ^ -(int64) (value & 1);
+        }
+
+        JUCE_DECLARE_NON_COPYABLE (Reader)
+    };
+};
+
 //==============================================================================
 var JSON::parse (const String& text)
 {
@@ -530,6 +1116,26 @@ Result JSON::parseQuotedString (String::CharPointerType& t, var& result)
     return Result::fail ("Not a quoted string!");
 }
 
+//==============================================================================
+void JSON::writeBinary (OutputStream& output, const var& data)
+{
+    JSONBinaryFormat::Writer writer (output);
+    writer.write (data);
+}
+
+var JSON::readBinary (const void* data, const size_t numBytes)
+{
+    JSONBinaryFormat::Reader reader (data, numBytes);
+    return reader.readDocument();
+}
+
+var JSON::readBinary (InputStream& input)
+{
+    MemoryBlock mb;
+    input.readIntoMemoryBlock (mb);
+    return readBinary (mb.getData(), mb.getSize());
+}
+
 //==============================================================================
 //==============================================================================
 #if JUCE_UNIT_TESTS
@@ -586,6 +1192,53 @@ public:
         }
     }
 
+    // (unlike var::operator==, this compares the contents of objects rather than their addresses)
+    static bool areIdentical (const var& a, const var& b)
+    {
+        if (const Array<var>* const itemsA = a.getArray())
+        {
+            const Array<var>* const itemsB = b.getArray();
+
+            if (itemsB == nullptr || itemsA->size() != itemsB->size())
+                return false;
+
+            for (int i = 0; i < itemsA->size(); ++i)
+                if (! areIdentical (itemsA->getReference (i), itemsB->getReference (i)))
+                    return false;
+
+            return true;
+        }
+
+        if (DynamicObject* const objectA = a.getDynamicObject())
+        {
+            DynamicObject* const objectB = b.getDynamicObject();
+
+            if (objectB == nullptr)
+                return false;
+
+            const NamedValueSet& propsA = objectA->getProperties();
+            const NamedValueSet& propsB = objectB->getProperties();
+
+            if (propsA.size() != propsB.size())
+                return false;
+
+            for (int i = 0; i < propsA.size(); ++i)
+                if (propsA.getName (i) != propsB.getName (i)
+                     || ! areIdentical (propsA.getValueAt (i), propsB.getValueAt (i)))
+                    return false;
+
+            return true;
+        }
+
+        if (const MemoryBlock* const blockA = a.getBinaryData())
+        {
+            const MemoryBlock* const blockB = b.getBinaryData();
+            return blockB != nullptr && *blockA == *blockB;
+        }
+
+        return a.equalsWithSameType (b);
+    }
+
     static var createRandomVar (Random& r, int depth)
     {
         switch (r.nextInt (depth > 3 ? 6 : 8))
@@ -650,6 +1303,140 @@ public:
             String parsedString (JSON::toString (parsed, oneLine));
             expect (asString.isNotEmpty() && parsedString == asString);
         }
+
+        beginTest ("Strings and numbers");
+        {
+            expectEquals (JSON::parse ("[\"abc\"]")[0].toString(), String ("abc"));
+            expectEquals (JSON::parse ("[\"a\\\"b\\\\c\\u0041\\n\"]")[0].toString(), String ("a\"b\\cA\n"));
+            expectEquals (JSON::parse (String (CharPointer_UTF8 ("[\"\xc3\xa9\\t\xc3\xa9\"]")))[0].toString(),
+                          String (CharPointer_UTF8 ("\xc3\xa9\t\xc3\xa9")));
+            expect (JSON::parse ("[\"abc").isVoid());
+            expect (JSON::parse ("{ \"a\\u0062c\": 1 }").getDynamicObject()->hasProperty ("abc"));
+
+            expectEquals ((double) JSON::parse ("[0.1]")[0], 0.1);
+            expectEquals ((double) JSON::parse ("[-2.5e-3]")[0], -2.5e-3);
+            expectEquals ((double) JSON::parse ("[123456.789e3]")[0], 123456789.0);
+            expectEquals ((double) JSON::parse ("[0.30000000000000004441]")[0], 0.30000000000000004441);
+
+            for (int i = 0; i < 1000; ++i)
+            {
+                const double d = (r.nextDouble() - 0.5) * std::pow (10.0, r.nextInt (30) - 15);
+                const String s (d, 15);
+                const double expected = std::strtod (s.toRawUTF8(), nullptr);
+                expect (std::abs ((double) JSON::parse ("[" + s + "]")[0] - expected) <= std::abs (expected) * 1.0e-15);
+            }
+
+            expectEquals (JSON::toString (var (-2147483647 - 1)), String ("-2147483648"));
+            expectEquals (JSON::toString (var ((int64) -9223372036854775807LL - 1)), String ("-9223372036854775808"));
+        }
+
+        beginTest ("Stream writer");
+        {
+            for (int i = 0; i < 50; ++i)
+            {
+                const var v (createRandomVar (r, 0));
+                const bool oneLine = r.nextBool();
+
+                MemoryOutputStream mo;
+
+                {
+                    JSONStreamWriter writer (mo, oneLine);
+                    writeWithStreamWriter (writer, v);
+                }
+
+                expectEquals (mo.toString(), JSON::toString (v, oneLine));
+            }
+        }
+
+        beginTest ("Binary format");
+        {
+            for (int i = 0; i < 100; ++i)
+            {
+                var v (createRandomVar (r, 0));
+
+                if (i == 0)
+                    v.append (var (MemoryBlock ("\x01\x02", 2)));
+
+                MemoryOutputStream mo;
+                JSON::writeBinary (mo, v);
+
+                expect (areIdentical (JSON::readBinary (mo.getData(), mo.getDataSize()), v));
+
+                MemoryInputStream in (mo.getData(), mo.getDataSize(), false);
+                expect (areIdentical (JSON::readBinary (in), v));
+
+                // truncated or corrupted data must fail safely
+                expect (JSON::readBinary (mo.getData(), (size_t) r.nextInt ((int) mo.getDataSize())).isVoid());
+
+                MemoryBlock corrupted (mo.getData(), mo.getDataSize());
+                corrupted[3 + r.nextInt ((int) corrupted.getSize() - 3)] = (char) r.nextInt (256);
+                JSON::readBinary (corrupted.getData(), corrupted.getSize());
+            }
+        }
+
+        beginTest ("Performance");
+        {
+            var data;
+
+            for (int i = 0; i < 20000; ++i)
+            {
+                DynamicObject* const o = new DynamicObject();
+                o->setProperty ("name", "Item number " + String (i));
+                o->setProperty ("index", i);
+                o->setProperty ("value", i * 0.25);
+                o->setProperty ("enabled", (i & 1) != 0);
+                data.append (o);
+            }
+
+            const double t1 = Time::getMillisecondCounterHiRes();
+            const String json (JSON::toString (data));
+            const double t2 = Time::getMillisecondCounterHiRes();
+            const var parsed (JSON::parse (json));
+            const double t3 = Time::getMillisecondCounterHiRes();
+
+            MemoryOutputStream binary;
+            JSON::writeBinary (binary, data);
+            const double t4 = Time::getMillisecondCounterHiRes();
+            const var fromBinary (JSON::readBinary (binary.getData(), binary.getDataSize()));
+            const double t5 = Time::getMillisecondCounterHiRes();
+
+            expectEquals (parsed.size(), 20000);
+            expectEquals (fromBinary.size(), 20000);
+
+            logMessage ("JSON: " + String (json.getNumBytesAsUTF8() / 1024) + "KB, write "
+                          + String (t2 - t1, 1) + "ms, parse " + String (t3 - t2, 1) + "ms");
+            logMessage ("Binary: " + String ((int) binary.getDataSize() / 1024) + "KB, write "
+                          + String (t4 - t3, 1) + "ms, read " + String (t5 - t4, 1) + "ms");
+        }
+    }
+
+    static void writeWithStreamWriter (JSONStreamWriter& writer, const var& v)
+    {
+        if (const Array<var>* array = v.getArray())
+        {
+            writer.startArray();
+
+            for (int i = 0; i < array->size(); ++i)
+                writeWithStreamWriter (writer, array->getReference (i));
+
+            writer.endArray();
+        }
+        else if (DynamicObject* object = v.getDynamicObject())
+        {
+            writer.startObject();
+
+            for (int i = 0; i < object->getProperties().size(); ++i)
+            {
+                writer.writeName (object->getProperties().getName (i).toString());
+                writeWithStreamWriter (writer, object->getProperties().getValueAt (i));
+            }
+
+            writer.endObject();
+        }
+        else
+        {
+            writer.writeValue (v);
+        }
     }
 };
 
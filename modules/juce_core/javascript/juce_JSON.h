@@ -129,6 +129,29 @@ public:
     */
     static Result parseQuotedString (String::CharPointerType& text, var& result);
 
+    //==============================================================================
+    /** Writes a compact binary representation of a JSON-compatible var to a stream.
+
+        This can store the same kinds of value as JSON can (including DynamicObjects,
+        which var::writeToStream() can't handle), plus binary data, but is much smaller
+        and faster to read back than the JSON text would be. Each property name is only
+        stored once, no matter how many objects use it.
+
+        The data can be read back with readBinary().
+        @see readBinary, var::writeToStream
+    */
+    static void writeBinary (OutputStream& output, const var& objectToWrite);
+
+    /** Reads a var that was stored with writeBinary().
+        If the data isn't valid, this returns var().
+    */
+    static var readBinary (const void* data, size_t numBytes);
+
+    /** Reads the rest of a stream, and parses it as data that was stored with writeBinary().
+        If the data isn't valid, this returns var().
+    */
+    static var readBinary (InputStream& input);
+
 private:
     //==============================================================================
     JSON() JUCE_DELETED_FUNCTION; // This class can't be instantiated - just use its static methods.
@@ -0,0 +1,158 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+JSONStreamWriter::JSONStreamWriter (OutputStream& destination, const bool shouldBeAllOnOneLine)
+    : out (destination), allOnOneLine (shouldBeAllOnOneLine), nameWritten (false)
+{
+}
+
+JSONStreamWriter::~JSONStreamWriter()
+{
+    while (scopes.size() > 0)
+        endScope (scopes.getLast().isObject);
+}
+
+//==============================================================================
+int JSONStreamWriter::getIndentLevel() const noexcept
+{
+    return scopes.size() * JSONFormatter::indentSize;
+}
+
+void JSONStreamWriter::startItem()
+{
+    if (scopes.size() == 0)
+        return;
+
+    Scope& scope = scopes.getReference (scopes.size() - 1);
+
+    if (scope.isObject)
+    {
+        // Inside an object, you need to call writeName() before writing each value!
+        jassert (nameWritten);
+        nameWritten = false;
+        return;
+    }
+
+    // (this follows the same layout as JSONFormatter::writeArray)
+    if (scope.hasItems)
+        out << (allOnOneLine ? ", " : ",");
+
+    if (! allOnOneLine)
+    {
+        out << newLine;
+        JSONFormatter::writeSpaces (out, getIndentLevel());
+    }
+
+    scope.hasItems = true;
+}
+
+void JSONStreamWriter::writeName (StringRef propertyName)
+{
+    // Names can only be written inside an object, and each one must be followed by a value!
+    jassert (scopes.size() > 0 && scopes.getLast().isObject && ! nameWritten);
+
+    if (scopes.size() == 0)
+        return;
+
+    Scope& scope = scopes.getReference (scopes.size() - 1);
+
+    // (this follows the same layout as DynamicObject::writeAsJSON)
+    if (scope.hasItems)
+    {
+        if (allOnOneLine)
+            out << ", ";
+        else
+            out << ',' << newLine;
+    }
+
+    if (! allOnOneLine)
+        JSONFormatter::writeSpaces (out, getIndentLevel());
+
+    out << '"';
+    JSONFormatter::writeString (out, propertyName.text);
+    out << "\": ";
+
+    scope.hasItems = true;
+    nameWritten = true;
+}
+
+void JSONStreamWriter::writeValue (const var& value)
+{
+    startItem();
+    JSONFormatter::write (out, value, getIndentLevel(), allOnOneLine);
+}
+
+void JSONStreamWriter::writeProperty (StringRef propertyName, const var& value)
+{
+    writeName (propertyName);
+    writeValue (value);
+}
+
+//==============================================================================
+void JSONStreamWriter::startScope (const bool isObject)
+{
+    startItem();
+
+    out << (isObject ? '{' : '[');
+
+    if (isObject && ! allOnOneLine)
+        out << newLine;
+
+    const Scope scope = { isObject, false };
+    scopes.add (scope);
+}
+
+void JSONStreamWriter::endScope (const bool isObject)
+{
+    // You're trying to close an object or array that hasn't been started!
+    jassert (scopes.size() > 0 && scopes.getLast().isObject == isObject);
+
+    if (scopes.size() == 0)
+        return;
+
+    const Scope scope (scopes.removeAndReturn (scopes.size() - 1));
+
+    if (! allOnOneLine)
+    {
+        if (scope.hasItems)
+            out << newLine;
+
+        if (scope.hasItems || isObject)
+            JSONFormatter::writeSpaces (out, getIndentLevel());
+    }
+
+    out << (isObject ? '}' : ']');
+    nameWritten = false;
+}
+
+void JSONStreamWriter::startObject()    { startScope (true); }
+void JSONStreamWriter::endObject()      { endScope (true); }
+void JSONStreamWriter::startArray()     { startScope (false); }
+void JSONStreamWriter::endArray()       { endScope (false); }
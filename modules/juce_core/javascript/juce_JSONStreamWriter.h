@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+#ifndef JUCE_JSONSTREAMWRITER_H_INCLUDED
+#define JUCE_JSONSTREAMWRITER_H_INCLUDED
+
+
+//==============================================================================
+/**
+    Writes JSON directly to a stream, one value at a time.
+
+    JSON::writeToStream() needs the whole structure to be built as a var first. This
+    class lets you write objects and arrays to a stream as you go, so that large documents
+    never need to be held in memory. The output is laid out in the same way that
+    JSON::writeToStream() would do it.
+
+    @code
+    JSONStreamWriter writer (out);
+
+    writer.startObject();
+    writer.writeProperty ("name", "Track 1");
+    writer.writeName ("events");
+    writer.startArray();
+
+    for (int i = 0; i < numEvents; ++i)
+        writer.writeValue (eventTimes[i]);
+
+    writer.endArray();
+    writer.endObject();
+    @endcode
+
+    @see JSON
+*/
+class JUCE_API  JSONStreamWriter
+{
+public:
+    //==============================================================================
+    /** Creates a writer which will send its output to the given stream.
+        The stream isn't deleted by the writer, so must remain valid until the writer
+        has been deleted.
+    */
+    JSONStreamWriter (OutputStream& destination, bool allOnOneLine = false);
+
+    /** Destructor.
+        If any objects or arrays are still open, they'll be closed.
+    */
+    ~JSONStreamWriter();
+
+    //==============================================================================
+    /** Starts writing an object.
+        Inside an object, each value must be preceded by a call to writeName().
+    */
+    void startObject();
+
+    /** Finishes the object that was most recently started. */
+    void endObject();
+
+    /** Starts writing an array. */
+    void startArray();
+
+    /** Finishes the array that was most recently started. */
+    void endArray();
+
+    /** Writes the name of the next property in the current object.
+        This must be followed by a call to writeValue(), startObject() or startArray().
+    */
+    void writeName (StringRef propertyName);
+
+    /** Writes a value, which may also be an array or DynamicObject.
+        If this is inside an object, you must call writeName() before it.
+    */
+    void writeValue (const var& value);
+
+    /** Writes a property name and its value to the current object. */
+    void writeProperty (StringRef propertyName, const var& value);
+
+    /** Returns the number of objects and arrays that are currently open. */
+    int getDepth() const noexcept               { return scopes.size(); }
+
+private:
+    //==============================================================================
+    struct Scope
+    {
+        bool isObject, hasItems;
+    };
+
+    OutputStream& out;
+    Array<Scope> scopes;
+    const bool allOnOneLine;
+    bool nameWritten;
+
+    int getIndentLevel() const noexcept;
+    void startItem();
+    void startScope (bool isObject);
+    void endScope (bool isObject);
+
+    JUCE_DECLARE_NON_COPYABLE (JSONStreamWriter)
+};
+
+
+#endif   // JUCE_JSONSTREAMWRITER_H_INCLUDED
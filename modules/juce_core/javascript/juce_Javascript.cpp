@@ -86,7 +86,15 @@ struct JavascriptEngine::RootObject   : public DynamicObject
     void execute (const String& code)
     {
         ExpressionTreeBuilder tb (code);
-        ScopedPointer<BlockStatement> (tb.parseStatementList())->perform (Scope (nullptr, this, this), nullptr);
+        const ScopedPointer<BlockStatement> block (tb.parseStatementList());
+        const Scope scope (nullptr, this, this);
+
+        const ScopedPointer<CompiledCode> compiledCode (compile (*block, nullptr));
+
+        if (compiledCode != nullptr)
+            runCompiledCode (*compiledCode, scope);
+        else
+            block->perform (scope, nullptr);
     }
 
     var evaluate (const String& code)
@@ -108,6 +116,7 @@ struct JavascriptEngine::RootObject   : public DynamicObject
     static bool isNumericOrUndefined (const var& v) noexcept  { return isNumeric (v) || v.isUndefined(); }
     static int64 getOctalValue (const String& s)              { BigInteger b; b.parseString (s.initialSectionContainingOnly ("01234567"), 8); return b.toInt64(); }
     static Identifier getPrototypeIdentifier()                { static const Identifier i ("prototype"); return i; }
+    static Identifier getThisIdentifier()                     { static const Identifier i ("this"); return i; }
     static var* getPropertyPointer (DynamicObject* o, const Identifier& i) noexcept   { return o->getProperties().getVarPointer (i); }
 
     //==============================================================================
@@ -226,6 +235,172 @@ struct JavascriptEngine::RootObject   : public DynamicObject
         }
     };
 
+    //==============================================================================
+    // Before a function or script is run, its syntax tree is compiled into a list of these
+    // instructions, which operate on a stack of values (see runCompiledCode()).
+    enum OpCode
+    {
+        opPushConstant,     // operand = constant index
+        opPushUndefined,
+        opPop,
+        opLoadLocal,        // operand = slot in the function's scope object
+        opStoreLocal,
+        opStoreLocalAndPop,
+        opLoadName,         // operand = name index
+        opStoreName,
+        opDeclareVar,
+        opGetProperty,      // operand = name index
+        opSetProperty,
+        opGetIndex,
+        opSetIndex,
+        opAdd, opSubtract, opMultiply,
+        opEquals, opNotEquals, opLessThan, opLessThanOrEqual, opGreaterThan, opGreaterThanOrEqual,
+        opBinaryOperator,   // any other operator, implemented by the BinaryOperator that's the source
+        opTypeEquals,
+        opTypeNotEquals,
+        opToBool,
+        opJump,             // operand = instruction index
+        opJumpIfFalse,
+        opJumpIfTrue,
+        opLookUpMethod,     // operand = name index
+        opCallMethod,       // operand = number of arguments
+        opCallFunction,
+        opNew,
+        opMakeObject,       // operand = number of properties
+        opMakeArray,        // operand = number of elements
+        opCheckTimeOut,
+        opReturn,
+        opReturnVoid
+    };
+
+    struct Statement;
+
+    struct Instruction
+    {
+        OpCode opcode;
+        int operand;
+        const Statement* source; // the syntax tree node that generated this instruction
+    };
+
+    struct CompiledCode
+    {
+        Array<Instruction> instructions;
+        Array<var> constants;
+        Array<Identifier> names, localNames;
+        mutable Array<int> nameIndexHints; // where each name was last found in the object that was searched for it
+        int maxStackSize;
+    };
+
+    // thrown when part of a syntax tree can't be compiled, in which case it gets interpreted instead
+    struct CompilationFailed {};
+
+    struct BytecodeCompiler
+    {
+        BytecodeCompiler (CompiledCode& c) noexcept : code (c), stackDepth (0), lastLabelPosition (-1), collectingVariables (false)
+        {
+            code.maxStackSize = 0;
+        }
+
+        void emit (OpCode opcode, int operand, const Statement& source, int stackChange)
+        {
+            const Instruction i = { opcode, operand, &source };
+            code.instructions.add (i);
+
+            stackDepth += stackChange;
+            jassert (stackDepth >= 0);
+            code.maxStackSize = jmax (code.maxStackSize, stackDepth);
+        }
+
+        void emitPop (const Statement& source)
+        {
+            // (a local variable that's assigned and then discarded can be stored without copying it)
+            if (code.instructions.size() > 0 && lastLabelPosition != code.instructions.size()
+                  && code.instructions.getLast().opcode == opStoreLocal)
+            {
+                code.instructions.getReference (code.instructions.size() - 1).opcode = opStoreLocalAndPop;
+                --stackDepth;
+                return;
+            }
+
+            emit (opPop, 0, source, -1);
+        }
+
+        void emitConstant (const var& value, const Statement& source)
+        {
+            emit (opPushConstant, code.constants.size(), source, 1);
+            code.constants.add (value);
+        }
+
+        int getNameIndex (const Identifier& name)
+        {
+            const int index = code.names.indexOf (name);
+
+            if (index >= 0)
+                return index;
+
+            code.names.add (name);
+            return code.names.size() - 1;
+        }
+
+        // Returns the scope slot that holds a function's parameter or local variable, or -1
+        int getLocalSlot (const Identifier& name) const noexcept
+        {
+            return code.localNames.indexOf (name);
+        }
+
+        void declareVariable (const Identifier& name)
+        {
+            if (collectingVariables)
+                code.localNames.addIfNotAlreadyThere (name);
+        }
+
+        //==============================================================================
+        int createLabel()
+        {
+            labelPositions.add (-1);
+            return labelPositions.size() - 1;
+        }
+
+        void placeLabel (int label) noexcept
+        {
+            labelPositions.set (label, code.instructions.size());
+            lastLabelPosition = code.instructions.size();
+        }
+
+        void emitJump (OpCode opcode, int label, const Statement& source, int stackChange)
+        {
+            jumpInstructions.add (code.instructions.size());
+            emit (opcode, label, source, stackChange);
+        }
+
+        void resolveJumps() noexcept
+        {
+            for (int i = 0; i < jumpInstructions.size(); ++i)
+            {
+                Instruction& ins = code.instructions.getReference (jumpInstructions.getUnchecked (i));
+                ins.operand = labelPositions.getUnchecked (ins.operand);
+                jassert (ins.operand >= 0);
+            }
+        }
+
+        void pushLoop (int breakLabel, int continueLabel)
+        {
+            loopLabels.add (breakLabel);
+            loopLabels.add (continueLabel);
+        }
+
+        void popLoop()                          { loopLabels.removeLast (2); }
+        int getBreakLabel() const noexcept      { return loopLabels.size() > 0 ? loopLabels.getUnchecked (loopLabels.size() - 2) : -1; }
+        int getContinueLabel() const noexcept   { return loopLabels.size() > 0 ? loopLabels.getLast() : -1; }
+
+        CompiledCode& code;
+        Array<int> labelPositions, jumpInstructions, loopLabels;
+        int stackDepth, lastLabelPosition;
+        bool collectingVariables;
+
+        JUCE_DECLARE_NON_COPYABLE (BytecodeCompiler)
+    };
+
     //==============================================================================
     struct Statement
     {
@@ -234,6 +409,7 @@ struct JavascriptEngine::RootObject   : public DynamicObject
 
         enum ResultCode  { ok = 0, returnWasHit, breakWasHit, continueWasHit };
         virtual ResultCode perform (const Scope&, var*) const  { return ok; }
+        virtual void compile (BytecodeCompiler&) const {}
 
         CodeLocation location;
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Statement)
@@ -247,6 +423,12 @@ struct JavascriptEngine::RootObject   : public DynamicObject
         virtual void assign (const Scope&, const var&) const  { location.throwError ("Cannot assign to this expression!"); }
 
         ResultCode perform (const Scope& s, var*) const override  { getResult (s); return ok; }
+
+        // compileValue() leaves the expression's result on the stack, and compileStore()
+        // assigns the value on top of the stack to it, leaving the value there
+        virtual void compileValue (BytecodeCompiler& c) const  { c.emit (opPushUndefined, 0, *this, 1); }
+        virtual void compileStore (BytecodeCompiler&) const    { throw CompilationFailed(); }
+        void compile (BytecodeCompiler& c) const override      { compileValue (c); c.emitPop (*this); }
     };
 
     typedef ScopedPointer<Expression> ExpPtr;
@@ -264,6 +446,12 @@ struct JavascriptEngine::RootObject   : public DynamicObject
             return ok;
         }
 
+        void compile (BytecodeCompiler& c) const override
+        {
+            for (int i = 0; i < statements.size(); ++i)
+                statements.getUnchecked(i)->compile (c);
+        }
+
         OwnedArray<Statement> statements;
     };
 
@@ -276,6 +464,19 @@ struct JavascriptEngine::RootObject   : public DynamicObject
             return (condition->getResult(s) ? trueBranch : falseBranch)->perform (s, returnedValue);
         }
 
+        void compile (BytecodeCompiler& c) const override
+        {
+            const int elseLabel = c.createLabel(), endLabel = c.createLabel();
+
+            condition->compileValue (c);
+            c.emitJump (opJumpIfFalse, elseLabel, *this, -1);
+            trueBranch->compile (c);
+            c.emitJump (opJump, endLabel, *this, 0);
+            c.placeLabel (elseLabel);
+            falseBranch->compile (c);
+            c.placeLabel (endLabel);
+        }
+
         ExpPtr condition;
         ScopedPointer<Statement> trueBranch, falseBranch;
     };
@@ -290,6 +491,24 @@ struct JavascriptEngine::RootObject   : public DynamicObject
             return ok;
         }
 
+        void compile (BytecodeCompiler& c) const override
+        {
+            c.declareVariable (name);
+            initialiser->compileValue (c);
+
+            const int slot = c.getLocalSlot (name);
+
+            if (slot >= 0)
+            {
+                c.emit (opStoreLocal, slot, *this, 0);
+                c.emitPop (*this);
+            }
+            else
+            {
+                c.emit (opDeclareVar, c.getNameIndex (name), *this, -1);
+            }
+        }
+
         Identifier name;
         ExpPtr initialiser;
     };
@@ -319,6 +538,39 @@ struct JavascriptEngine::RootObject   : public DynamicObject
             return ok;
         }
 
+        void compile (BytecodeCompiler& c) const override
+        {
+            const int startLabel = c.createLabel(), continueLabel = c.createLabel(), endLabel = c.createLabel();
+
+            initialiser->compile (c);
+            c.placeLabel (startLabel);
+
+            if (! isDoLoop)
+            {
+                condition->compileValue (c);
+                c.emitJump (opJumpIfFalse, endLabel, *this, -1);
+            }
+
+            c.emit (opCheckTimeOut, 0, *this, 0);
+
+            // (a continue in a do-loop goes back to the start without testing the condition)
+            c.pushLoop (endLabel, isDoLoop ? startLabel : continueLabel);
+            body->compile (c);
+            c.popLoop();
+
+            c.placeLabel (continueLabel);
+            iterator->compile (c);
+
+            if (isDoLoop)
+            {
+                condition->compileValue (c);
+                c.emitJump (opJumpIfFalse, endLabel, *this, -1);
+            }
+
+            c.emitJump (opJump, startLabel, *this, 0);
+            c.placeLabel (endLabel);
+        }
+
         ScopedPointer<Statement> initialiser, iterator, body;
         ExpPtr condition;
         bool isDoLoop;
@@ -334,6 +586,12 @@ struct JavascriptEngine::RootObject   : public DynamicObject
             return returnWasHit;
         }
 
+        void compile (BytecodeCompiler& c) const override
+        {
+            returnValue->compileValue (c);
+            c.emit (opReturn, 0, *this, -1);
+        }
+
         ExpPtr returnValue;
     };
 
@@ -341,18 +599,35 @@ struct JavascriptEngine::RootObject   : public DynamicObject
     {
         BreakStatement (const CodeLocation& l) noexcept : Statement (l) {}
         ResultCode perform (const Scope&, var*) const override  { return breakWasHit; }
+
+        void compile (BytecodeCompiler& c) const override
+        {
+            const int label = c.getBreakLabel();
+
+            if (label >= 0)  c.emitJump (opJump, label, *this, 0);
+            else             c.emit (opReturnVoid, 0, *this, 0);
+        }
     };
 
     struct ContinueStatement  : public Statement
     {
         ContinueStatement (const CodeLocation& l) noexcept : Statement (l) {}
         ResultCode perform (const Scope&, var*) const override  { return continueWasHit; }
+
+        void compile (BytecodeCompiler& c) const override
+        {
+            const int label = c.getContinueLabel();
+
+            if (label >= 0)  c.emitJump (opJump, label, *this, 0);
+            else             c.emit (opReturnVoid, 0, *this, 0);
+        }
     };
 
     struct LiteralValue  : public Expression
     {
         LiteralValue (const CodeLocation& l, const var& v) noexcept : Expression (l), value (v) {}
         var getResult (const Scope&) const override   { return value; }
+        void compileValue (BytecodeCompiler& c) const override  { c.emitConstant (value, *this); }
         var value;
     };
 
@@ -370,6 +645,22 @@ struct JavascriptEngine::RootObject   : public DynamicObject
                 s.root->setProperty (name, newValue);
         }
 
+        void compileValue (BytecodeCompiler& c) const override
+        {
+            const int slot = c.getLocalSlot (name);
+
+            if (slot >= 0)  c.emit (opLoadLocal, slot, *this, 1);
+            else            c.emit (opLoadName, c.getNameIndex (name), *this, 1);
+        }
+
+        void compileStore (BytecodeCompiler& c) const override
+        {
+            const int slot = c.getLocalSlot (name);
+
+            if (slot >= 0)  c.emit (opStoreLocal, slot, *this, 0);
+            else            c.emit (opStoreName, c.getNameIndex (name), *this, 0);
+        }
+
         Identifier name;
     };
 
@@ -379,7 +670,16 @@ struct JavascriptEngine::RootObject   : public DynamicObject
 
         var getResult (const Scope& s) const override
         {
-            var p (parent->getResult (s));
+            return getProperty (parent->getResult (s), child);
+        }
+
+        void assign (const Scope& s, const var& newValue) const override
+        {
+            setProperty (parent->getResult (s), newValue);
+        }
+
+        static var getProperty (const var& p, const Identifier& child)
+        {
             static const Identifier lengthID ("length");
 
             if (child == lengthID)
@@ -395,12 +695,24 @@ struct JavascriptEngine::RootObject   : public DynamicObject
             return var::undefined();
         }
 
-        void assign (const Scope& s, const var& newValue) const override
+        void setProperty (const var& p, const var& newValue) const
         {
-            if (DynamicObject* o = parent->getResult (s).getDynamicObject())
+            if (DynamicObject* o = p.getDynamicObject())
                 o->setProperty (child, newValue);
             else
-                Expression::assign (s, newValue);
+                location.throwError ("Cannot assign to this expression!");
+        }
+
+        void compileValue (BytecodeCompiler& c) const override
+        {
+            parent->compileValue (c);
+            c.emit (opGetProperty, c.getNameIndex (child), *this, 0);
+        }
+
+        void compileStore (BytecodeCompiler& c) const override
+        {
+            parent->compileValue (c);
+            c.emit (opSetProperty, c.getNameIndex (child), *this, -1);
         }
 
         ExpPtr parent;
@@ -414,8 +726,17 @@ struct JavascriptEngine::RootObject   : public DynamicObject
         var getResult (const Scope& s) const override
         {
             var arrayVar (object->getResult (s)); // must stay alive for the scope of this method
-            var key = index->getResult (s);
+            return getElement (arrayVar, index->getResult (s));
+        }
+
+        void assign (const Scope& s, const var& newValue) const override
+        {
+            var arrayVar (object->getResult (s)); // must stay alive for the scope of this method
+            setElement (arrayVar, index->getResult (s), newValue);
+        }
 
+        static var getElement (const var& arrayVar, const var& key)
+        {
             if (const Array<var>* array = arrayVar.getArray())
                 if (key.isInt() || key.isInt64() || key.isDouble())
                     return (*array) [static_cast<int> (key)];
@@ -428,11 +749,8 @@ struct JavascriptEngine::RootObject   : public DynamicObject
             return var::undefined();
         }
 
-        void assign (const Scope& s, const var& newValue) const override
+        void setElement (const var& arrayVar, const var& key, const var& newValue) const
         {
-            var arrayVar (object->getResult (s)); // must stay alive for the scope of this method
-            var key = index->getResult (s);
-
             if (Array<var>* array = arrayVar.getArray())
             {
                 if (key.isInt() || key.isInt64() || key.isDouble())
@@ -455,7 +773,21 @@ struct JavascriptEngine::RootObject   : public DynamicObject
                 }
             }
 
-            Expression::assign (s, newValue);
+            location.throwError ("Cannot assign to this expression!");
+        }
+
+        void compileValue (BytecodeCompiler& c) const override
+        {
+            object->compileValue (c);
+            index->compileValue (c);
+            c.emit (opGetIndex, 0, *this, -1);
+        }
+
+        void compileStore (BytecodeCompiler& c) const override
+        {
+            object->compileValue (c);
+            index->compileValue (c);
+            c.emit (opSetIndex, 0, *this, -2);
         }
 
         ExpPtr object, index;
@@ -484,7 +816,11 @@ struct JavascriptEngine::RootObject   : public DynamicObject
         var getResult (const Scope& s) const override
         {
             var a (lhs->getResult (s)), b (rhs->getResult (s));
+            return evaluate (a, b);
+        }
 
+        var evaluate (const var& a, const var& b) const
+        {
             if ((a.isUndefined() || a.isVoid()) && (b.isUndefined() || b.isVoid()))
                 return getWithUndefinedArg();
 
@@ -497,6 +833,28 @@ struct JavascriptEngine::RootObject   : public DynamicObject
             return getWithStrings (a.toString(), b.toString());
         }
 
+        void compileValue (BytecodeCompiler& c) const override
+        {
+            lhs->compileValue (c);
+            rhs->compileValue (c);
+            c.emit (getOpCode(), 0, *this, -1);
+        }
+
+        OpCode getOpCode() const noexcept
+        {
+            if (operation == TokenTypes::plus)                return opAdd;
+            if (operation == TokenTypes::minus)               return opSubtract;
+            if (operation == TokenTypes::times)               return opMultiply;
+            if (operation == TokenTypes::equals)              return opEquals;
+            if (operation == TokenTypes::notEquals)           return opNotEquals;
+            if (operation == TokenTypes::lessThan)            return opLessThan;
+            if (operation == TokenTypes::lessThanOrEqual)     return opLessThanOrEqual;
+            if (operation == TokenTypes::greaterThan)         return opGreaterThan;
+            if (operation == TokenTypes::greaterThanOrEqual)  return opGreaterThanOrEqual;
+
+            return opBinaryOperator;
+        }
+
         var throwError (const char* typeName) const
             { location.throwError (getTokenName (operation) + " is not allowed on the " + typeName + " type"); return var(); }
     };
@@ -628,24 +986,52 @@ struct JavascriptEngine::RootObject   : public DynamicObject
     {
         LogicalAndOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperatorBase (l, a, b, TokenTypes::logicalAnd) {}
         var getResult (const Scope& s) const override       { return lhs->getResult (s) && rhs->getResult (s); }
+        void compileValue (BytecodeCompiler& c) const override
+        {
+            const int falseLabel = c.createLabel(), endLabel = c.createLabel();
+
+            lhs->compileValue (c);
+            c.emitJump (opJumpIfFalse, falseLabel, *this, -1);
+            rhs->compileValue (c);
+            c.emit (opToBool, 0, *this, 0);
+            c.emitJump (opJump, endLabel, *this, -1);
+            c.placeLabel (falseLabel);
+            c.emitConstant (false, *this);
+            c.placeLabel (endLabel);
+        }
     };
 
     struct LogicalOrOp  : public BinaryOperatorBase
     {
         LogicalOrOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperatorBase (l, a, b, TokenTypes::logicalOr) {}
         var getResult (const Scope& s) const override       { return lhs->getResult (s) || rhs->getResult (s); }
+        void compileValue (BytecodeCompiler& c) const override
+        {
+            const int trueLabel = c.createLabel(), endLabel = c.createLabel();
+
+            lhs->compileValue (c);
+            c.emitJump (opJumpIfTrue, trueLabel, *this, -1);
+            rhs->compileValue (c);
+            c.emit (opToBool, 0, *this, 0);
+            c.emitJump (opJump, endLabel, *this, -1);
+            c.placeLabel (trueLabel);
+            c.emitConstant (true, *this);
+            c.placeLabel (endLabel);
+        }
     };
 
     struct TypeEqualsOp  : public BinaryOperatorBase
     {
         TypeEqualsOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperatorBase (l, a, b, TokenTypes::typeEquals) {}
         var getResult (const Scope& s) const override       { return areTypeEqual (lhs->getResult (s), rhs->getResult (s)); }
+        void compileValue (BytecodeCompiler& c) const override  { lhs->compileValue (c); rhs->compileValue (c); c.emit (opTypeEquals, 0, *this, -1); }
     };
 
     struct TypeNotEqualsOp  : public BinaryOperatorBase
     {
         TypeNotEqualsOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperatorBase (l, a, b, TokenTypes::typeNotEquals) {}
         var getResult (const Scope& s) const override       { return ! areTypeEqual (lhs->getResult (s), rhs->getResult (s)); }
+        void compileValue (BytecodeCompiler& c) const override  { lhs->compileValue (c); rhs->compileValue (c); c.emit (opTypeNotEquals, 0, *this, -1); }
     };
 
     struct ConditionalOp  : public Expression
@@ -655,6 +1041,19 @@ struct JavascriptEngine::RootObject   : public DynamicObject
         var getResult (const Scope& s) const override              { return (condition->getResult (s) ? trueBranch : falseBranch)->getResult (s); }
         void assign (const Scope& s, const var& v) const override  { (condition->getResult (s) ? trueBranch : falseBranch)->assign (s, v); }
 
+        void compileValue (BytecodeCompiler& c) const override
+        {
+            const int falseLabel = c.createLabel(), endLabel = c.createLabel();
+
+            condition->compileValue (c);
+            c.emitJump (opJumpIfFalse, falseLabel, *this, -1);
+            trueBranch->compileValue (c);
+            c.emitJump (opJump, endLabel, *this, -1); // (only one of the branches leaves a value)
+            c.placeLabel (falseLabel);
+            falseBranch->compileValue (c);
+            c.placeLabel (endLabel);
+        }
+
         ExpPtr condition, trueBranch, falseBranch;
     };
 
@@ -669,6 +1068,12 @@ struct JavascriptEngine::RootObject   : public DynamicObject
             return value;
         }
 
+        void compileValue (BytecodeCompiler& c) const override
+        {
+            newValue->compileValue (c);
+            target->compileStore (c);
+        }
+
         ExpPtr target, newValue;
     };
 
@@ -684,6 +1089,12 @@ struct JavascriptEngine::RootObject   : public DynamicObject
             return value;
         }
 
+        void compileValue (BytecodeCompiler& c) const override
+        {
+            newValue->compileValue (c);
+            target->compileStore (c);
+        }
+
         Expression* target; // Careful! this pointer aliases a sub-term of newValue!
         ExpPtr newValue;
         TokenType op;
@@ -699,6 +1110,13 @@ struct JavascriptEngine::RootObject   : public DynamicObject
             target->assign (s, newValue->getResult (s));
             return oldValue;
         }
+
+        void compileValue (BytecodeCompiler& c) const override
+        {
+            target->compileValue (c);
+            SelfAssignment::compileValue (c);
+            c.emitPop (*this);
+        }
     };
 
     struct FunctionCall  : public Expression
@@ -725,7 +1143,13 @@ struct JavascriptEngine::RootObject   : public DynamicObject
             for (int i = 0; i < arguments.size(); ++i)
                 argVars.add (arguments.getUnchecked(i)->getResult (s));
 
-            const var::NativeFunctionArgs args (thisObject, argVars.begin(), argVars.size());
+            return invokeWithArguments (s, function, thisObject, argVars.begin(), argVars.size());
+        }
+
+        var invokeWithArguments (const Scope& s, const var& function, const var& thisObject,
+                                 const var* argValues, int numArgs) const
+        {
+            const var::NativeFunctionArgs args (thisObject, argValues, numArgs);
 
             if (var::NativeFunction nativeFunction = function.getNativeFunction())
                 return nativeFunction (args);
@@ -741,6 +1165,29 @@ struct JavascriptEngine::RootObject   : public DynamicObject
             location.throwError ("This expression is not a function!"); return var();
         }
 
+        void compileValue (BytecodeCompiler& c) const override
+        {
+            if (DotOperator* dot = dynamic_cast<DotOperator*> (object.get()))
+            {
+                dot->parent->compileValue (c);
+                c.emit (opLookUpMethod, c.getNameIndex (dot->child), *this, 1);
+                compileArguments (c);
+                c.emit (opCallMethod, arguments.size(), *this, -1 - arguments.size());
+            }
+            else
+            {
+                object->compileValue (c);
+                compileArguments (c);
+                c.emit (opCallFunction, arguments.size(), *this, -arguments.size());
+            }
+        }
+
+        void compileArguments (BytecodeCompiler& c) const
+        {
+            for (int i = 0; i < arguments.size(); ++i)
+                arguments.getUnchecked(i)->compileValue (c);
+        }
+
         ExpPtr object;
         OwnedArray<Expression> arguments;
     };
@@ -766,6 +1213,29 @@ struct JavascriptEngine::RootObject   : public DynamicObject
 
             return newObject.get();
         }
+
+        var construct (const Scope& s, const var& classOrFunc, const var* argValues, int numArgs) const
+        {
+            const bool isFunc = isFunction (classOrFunc);
+            if (! (isFunc || classOrFunc.getDynamicObject() != nullptr))
+                return var::undefined();
+
+            DynamicObject::Ptr newObject (new DynamicObject());
+
+            if (isFunc)
+                invokeWithArguments (s, classOrFunc, newObject.get(), argValues, numArgs);
+            else
+                newObject->setProperty (getPrototypeIdentifier(), classOrFunc);
+
+            return newObject.get();
+        }
+
+        void compileValue (BytecodeCompiler& c) const override
+        {
+            object->compileValue (c);
+            compileArguments (c);
+            c.emit (opNew, arguments.size(), *this, -arguments.size());
+        }
     };
 
     struct ObjectDeclaration  : public Expression
@@ -782,6 +1252,14 @@ struct JavascriptEngine::RootObject   : public DynamicObject
             return newObject.get();
         }
 
+        void compileValue (BytecodeCompiler& c) const override
+        {
+            for (int i = 0; i < initialisers.size(); ++i)
+                initialisers.getUnchecked(i)->compileValue (c);
+
+            c.emit (opMakeObject, initialisers.size(), *this, 1 - initialisers.size());
+        }
+
         Array<Identifier> names;
         OwnedArray<Expression> initialisers;
     };
@@ -800,15 +1278,23 @@ struct JavascriptEngine::RootObject   : public DynamicObject
             return a;
         }
 
+        void compileValue (BytecodeCompiler& c) const override
+        {
+            for (int i = 0; i < values.size(); ++i)
+                values.getUnchecked(i)->compileValue (c);
+
+            c.emit (opMakeArray, values.size(), *this, 1 - values.size());
+        }
+
         OwnedArray<Expression> values;
     };
 
     //==============================================================================
     struct FunctionObject  : public DynamicObject
     {
-        FunctionObject() noexcept {}
+        FunctionObject() noexcept : compilationFailed (false) {}
 
-        FunctionObject (const FunctionObject& other)  : DynamicObject(), functionCode (other.functionCode)
+        FunctionObject (const FunctionObject& other)  : DynamicObject(), functionCode (other.functionCode), compilationFailed (false)
         {
             ExpressionTreeBuilder tb (functionCode);
             tb.parseFunctionParamsAndBody (*this);
@@ -823,10 +1309,12 @@ struct JavascriptEngine::RootObject   : public DynamicObject
 
         var invoke (const Scope& s, const var::NativeFunctionArgs& args) const
         {
+            if (const CompiledCode* code = getCompiledBody())
+                return invokeCompiledBody (*code, s, args);
+
             DynamicObject::Ptr functionRoot (new DynamicObject());
 
-            static const Identifier thisIdent ("this");
-            functionRoot->setProperty (thisIdent, args.thisObject);
+            functionRoot->setProperty (getThisIdentifier(), args.thisObject);
 
             for (int i = 0; i < parameters.size(); ++i)
                 functionRoot->setProperty (parameters.getReference(i),
@@ -840,8 +1328,410 @@ struct JavascriptEngine::RootObject   : public DynamicObject
         String functionCode;
         Array<Identifier> parameters;
         ScopedPointer<Statement> body;
+
+    private:
+        mutable ScopedPointer<CompiledCode> compiledBody;
+        mutable Array<int> parameterSlots;
+        mutable DynamicObject::Ptr spareScope;
+        mutable bool compilationFailed;
+
+        const CompiledCode* getCompiledBody() const
+        {
+            if (compiledBody == nullptr && ! compilationFailed)
+            {
+                Array<Identifier> locals;
+                locals.add (getThisIdentifier());
+
+                for (int i = 0; i < parameters.size(); ++i)
+                {
+                    locals.addIfNotAlreadyThere (parameters.getReference (i));
+                    parameterSlots.add (locals.indexOf (parameters.getReference (i)));
+                }
+
+                compiledBody = compile (*body, &locals);
+                compilationFailed = (compiledBody == nullptr);
+            }
+
+            return compiledBody;
+        }
+
+        var invokeCompiledBody (const CompiledCode& code, const Scope& s, const var::NativeFunctionArgs& args) const
+        {
+            // The function's local variables are all declared before it runs, so that the compiled
+            // code can find them in the scope object by position. When nothing has kept hold of a
+            // scope object after a call, it's kept to be re-used by the next one.
+            DynamicObject::Ptr functionRoot (spareScope);
+            spareScope = nullptr;
+
+            if (functionRoot == nullptr)
+            {
+                functionRoot = new DynamicObject();
+
+                for (int i = 0; i < code.localNames.size(); ++i)
+                    functionRoot->setProperty (code.localNames.getReference (i), var::undefined());
+            }
+
+            NamedValueSet::NamedValue* const locals = functionRoot->getProperties().begin();
+            locals[0].value = args.thisObject;
+
+            for (int i = 0; i < parameters.size(); ++i)
+                locals[parameterSlots.getUnchecked (i)].value = i < args.numArguments ? args.arguments[i] : var::undefined();
+
+            var result (runCompiledCode (code, Scope (&s, s.root, functionRoot)));
+
+            if (functionRoot->getReferenceCount() == 1
+                 && functionRoot->getProperties().size() == code.localNames.size())
+            {
+                for (int i = 0; i < code.localNames.size(); ++i)
+                    locals[i].value = var::undefined();
+
+                spareScope = functionRoot;
+            }
+
+            return result;
+        }
+    };
+
+    //==============================================================================
+    // Compiles a function body or a top-level script. If functionLocals is null, the code
+    // is treated as top-level, so its variables are declared in the scope by name, otherwise
+    // the function's parameters and local variables are given fixed slots.
+    // Returns nullptr if the code uses anything that the compiler doesn't support.
+    static CompiledCode* compile (const Statement& body, const Array<Identifier>* functionLocals)
+    {
+        ScopedPointer<CompiledCode> code (new CompiledCode());
+
+        try
+        {
+            if (functionLocals != nullptr)
+            {
+                // (a first pass finds all the var statements, so that they can be given slots)
+                code->localNames = *functionLocals;
+
+                BytecodeCompiler declarationFinder (*code);
+                declarationFinder.collectingVariables = true;
+                body.compile (declarationFinder);
+
+                code->instructions.clearQuick();
+                code->constants.clearQuick();
+                code->names.clearQuick();
+            }
+
+            BytecodeCompiler compiler (*code);
+            body.compile (compiler);
+            compiler.emit (opReturnVoid, 0, body, 0);
+            compiler.resolveJumps();
+            code->nameIndexHints.insertMultiple (0, -1, code->names.size());
+        }
+        catch (CompilationFailed&)
+        {
+            return nullptr;
+        }
+
+        return code.release();
+    }
+
+    //==============================================================================
+    struct ValueStack
+    {
+        ValueStack (int maxSize)
+        {
+            if (maxSize > (int) numLocalValues)
+                heapStorage.malloc ((size_t) maxSize * sizeof (var));
+
+            base = top = heapStorage != nullptr ? reinterpret_cast<var*> (heapStorage.getData())
+                                                : reinterpret_cast<var*> (localStorage);
+        }
+
+        ~ValueStack()                           { popMultiple ((int) (top - base)); }
+
+        void push (const var& v)                { new (top) var (v); ++top; }
+        void pop() noexcept                     { (--top)->~var(); }
+        void popMultiple (int num) noexcept     { while (--num >= 0) pop(); }
+
+        var* base;
+        var* top;
+
+    private:
+        enum { numLocalValues = 16 };
+        HeapBlock<char> heapStorage;
+        int64 localStorage [numLocalValues * sizeof (var) / sizeof (int64) + 1];
+
+        JUCE_DECLARE_NON_COPYABLE (ValueStack)
     };
 
+    static var* getLocalVariable (NamedValueSet& scopeValues, const CompiledCode& code, int slot) noexcept
+    {
+        // (a function may have added or removed properties from its scope object, in which
+        // case the slot won't match, and the variable has to be looked up by name)
+        if (slot < scopeValues.size())
+        {
+            NamedValueSet::NamedValue& v = scopeValues.begin()[slot];
+
+            if (v.name == code.localNames.getReference (slot))
+                return &v.value;
+        }
+
+        return nullptr;
+    }
+
+    // Objects like the root are searched linearly for a name, so the position where each name
+    // was last found is remembered, and checked first the next time.
+    static var* findProperty (DynamicObject& o, const CompiledCode& code, int nameIndex) noexcept
+    {
+        NamedValueSet& values = o.getProperties();
+        const Identifier& name = code.names.getReference (nameIndex);
+        int& hint = code.nameIndexHints.getReference (nameIndex);
+
+        if (isPositiveAndBelow (hint, values.size()))
+        {
+            NamedValueSet::NamedValue& v = values.begin()[hint];
+
+            if (v.name == name)
+                return &v.value;
+        }
+
+        const int index = values.indexOf (name);
+
+        if (index < 0)
+            return nullptr;
+
+        hint = index;
+        return &(values.begin()[index].value);
+    }
+
+    // Does the same search as Scope::findSymbolInParentScopes(), except that when a function's scope
+    // only contains its local variables (which have all been given slots), that scope gets skipped.
+    static var* findName (const Scope& s, const CompiledCode& code, int nameIndex) noexcept
+    {
+        const bool scopeOnlyHasLocals = code.localNames.size() > 0
+                                          && s.scope->getProperties().size() == code.localNames.size();
+
+        for (const Scope* scope = scopeOnlyHasLocals ? s.parent : &s; scope != nullptr; scope = scope->parent)
+        {
+            if (scope->scope == s.root)
+            {
+                if (var* v = findProperty (*s.root, code, nameIndex))
+                    return v;
+            }
+            else if (var* v = getPropertyPointer (scope->scope, code.names.getReference (nameIndex)))
+            {
+                return v;
+            }
+        }
+
+        return nullptr;
+    }
+
+    enum NumericOperands { notNumeric, integerOperands, doubleOperands };
+
+    static NumericOperands getNumericOperands (const var& a, const var& b) noexcept
+    {
+        const bool aIsInt = a.isInt() || a.isInt64();
+        const bool bIsInt = b.isInt() || b.isInt64();
+
+        if (aIsInt && bIsInt)
+            return integerOperands;
+
+        if ((aIsInt || a.isDouble()) && (bIsInt || b.isDouble()))
+            return doubleOperands;
+
+        return notNumeric;
+    }
+
+    static var runCompiledCode (const CompiledCode& code, const Scope& s)
+    {
+        ValueStack stack (code.maxStackSize);
+        NamedValueSet& scopeValues = s.scope->getProperties();
+        const Instruction* const instructions = code.instructions.begin();
+        const Instruction* ip = instructions;
+        uint32 loopIterations = 0;
+
+        for (;;)
+        {
+            const Instruction& i = *ip++;
+
+            switch (i.opcode)
+            {
+                case opPushConstant:    stack.push (code.constants.getReference (i.operand)); break;
+                case opPushUndefined:   stack.push (var::undefined()); break;
+                case opPop:             stack.pop(); break;
+
+                case opLoadLocal:
+                    if (const var* v = getLocalVariable (scopeValues, code, i.operand))
+                        stack.push (*v);
+                    else
+                        stack.push (s.findSymbolInParentScopes (code.localNames.getReference (i.operand)));
+                    break;
+
+                case opStoreLocal:
+                    if (var* v = getLocalVariable (scopeValues, code, i.operand))
+                        *v = stack.top[-1];
+                    else
+                        static_cast<const UnqualifiedName*> (i.source)->assign (s, stack.top[-1]);
+                    break;
+
+                case opStoreLocalAndPop:
+                    if (var* v = getLocalVariable (scopeValues, code, i.operand))
+                        v->swapWith (stack.top[-1]);
+                    else
+                        static_cast<const UnqualifiedName*> (i.source)->assign (s, stack.top[-1]);
+
+                    stack.pop();
+                    break;
+
+                case opLoadName:
+                    if (const var* v = findName (s, code, i.operand))
+                        stack.push (*v);
+                    else
+                        stack.push (var::undefined());
+                    break;
+
+                case opStoreName:
+                {
+                    // (the same as UnqualifiedName::assign)
+                    DynamicObject& target = (s.scope->getProperties().size() == code.localNames.size()) ? *s.root : *s.scope;
+
+                    if (var* v = findProperty (target, code, i.operand))
+                        *v = stack.top[-1];
+                    else
+                        s.root->setProperty (code.names.getReference (i.operand), stack.top[-1]);
+
+                    break;
+                }
+                case opDeclareVar:      s.scope->setProperty (code.names.getReference (i.operand), stack.top[-1]); stack.pop(); break;
+
+                case opGetProperty:
+                    stack.top[-1] = DotOperator::getProperty (stack.top[-1], code.names.getReference (i.operand));
+                    break;
+
+                case opSetProperty:
+                    static_cast<const DotOperator*> (i.source)->setProperty (stack.top[-1], stack.top[-2]);
+                    stack.pop();
+                    break;
+
+                case opGetIndex:
+                    stack.top[-2] = ArraySubscript::getElement (stack.top[-2], stack.top[-1]);
+                    stack.pop();
+                    break;
+
+                case opSetIndex:
+                    static_cast<const ArraySubscript*> (i.source)->setElement (stack.top[-2], stack.top[-1], stack.top[-3]);
+                    stack.popMultiple (2);
+                    break;
+
+               #define JUCE_JS_NUMERIC_OP(opcode, op) \
+                case opcode: \
+                { \
+                    var& a = stack.top[-2]; \
+                    const var& b = stack.top[-1]; \
+                    const NumericOperands type = getNumericOperands (a, b); \
+                    if (type == integerOperands)      a = (static_cast<int64> (a) op static_cast<int64> (b)); \
+                    else if (type == doubleOperands)  a = (static_cast<double> (a) op static_cast<double> (b)); \
+                    else                              a = static_cast<const BinaryOperator*> (i.source)->evaluate (a, b); \
+                    stack.pop(); \
+                    break; \
+                }
+
+                JUCE_JS_NUMERIC_OP (opAdd, +)
+                JUCE_JS_NUMERIC_OP (opSubtract, -)
+                JUCE_JS_NUMERIC_OP (opMultiply, *)
+                JUCE_JS_NUMERIC_OP (opEquals, ==)
+                JUCE_JS_NUMERIC_OP (opNotEquals, !=)
+                JUCE_JS_NUMERIC_OP (opLessThan, <)
+                JUCE_JS_NUMERIC_OP (opLessThanOrEqual, <=)
+                JUCE_JS_NUMERIC_OP (opGreaterThan, >)
+                JUCE_JS_NUMERIC_OP (opGreaterThanOrEqual, >=)
+               #undef JUCE_JS_NUMERIC_OP
+
+                case opBinaryOperator:
+                    stack.top[-2] = static_cast<const BinaryOperator*> (i.source)->evaluate (stack.top[-2], stack.top[-1]);
+                    stack.pop();
+                    break;
+
+                case opTypeEquals:      stack.top[-2] = areTypeEqual (stack.top[-2], stack.top[-1]);    stack.pop(); break;
+                case opTypeNotEquals:   stack.top[-2] = ! areTypeEqual (stack.top[-2], stack.top[-1]);  stack.pop(); break;
+                case opToBool:          stack.top[-1] = (bool) stack.top[-1]; break;
+
+                case opJump:            ip = instructions + i.operand; break;
+                case opJumpIfFalse:     if (! stack.top[-1])  ip = instructions + i.operand;  stack.pop(); break;
+                case opJumpIfTrue:      if (stack.top[-1])    ip = instructions + i.operand;  stack.pop(); break;
+
+                case opLookUpMethod:
+                {
+                    DynamicObject* o = stack.top[-1].getDynamicObject();
+
+                    if (const var* v = (o != nullptr ? findProperty (*o, code, i.operand) : nullptr))
+                        stack.push (*v);
+                    else
+                        stack.push (s.findFunctionCall (i.source->location, stack.top[-1], code.names.getReference (i.operand)));
+
+                    break;
+                }
+
+                case opCallMethod:
+                case opCallFunction:
+                {
+                    s.checkTimeOut (i.source->location);
+
+                    const int numArgs = i.operand;
+                    const var* args = stack.top - numArgs;
+                    const int numToPop = numArgs + (i.opcode == opCallMethod ? 2 : 1);
+                    const var thisObject (i.opcode == opCallMethod ? args[-2] : var (s.scope.get()));
+
+                    var result (static_cast<const FunctionCall*> (i.source)->invokeWithArguments (s, args[-1], thisObject, args, numArgs));
+                    stack.popMultiple (numToPop);
+                    stack.push (result);
+                    break;
+                }
+
+                case opNew:
+                {
+                    s.checkTimeOut (i.source->location);
+
+                    const int numArgs = i.operand;
+                    const var* args = stack.top - numArgs;
+                    var result (static_cast<const NewOperator*> (i.source)->construct (s, args[-1], args, numArgs));
+                    stack.popMultiple (numArgs + 1);
+                    stack.push (result);
+                    break;
+                }
+
+                case opMakeObject:
+                {
+                    const Array<Identifier>& names = static_cast<const ObjectDeclaration*> (i.source)->names;
+                    const var* values = stack.top - i.operand;
+                    DynamicObject::Ptr newObject (new DynamicObject());
+
+                    for (int n = 0; n < i.operand; ++n)
+                        newObject->setProperty (names.getReference (n), values[n]);
+
+                    stack.popMultiple (i.operand);
+                    stack.push (newObject.get());
+                    break;
+                }
+
+                case opMakeArray:
+                {
+                    Array<var> a (stack.top - i.operand, i.operand);
+                    stack.popMultiple (i.operand);
+                    stack.push (a);
+                    break;
+                }
+
+                case opCheckTimeOut:
+                    // (reading the clock costs more than a simple loop iteration, so it's only done periodically)
+                    if ((++loopIterations & 63) == 0)
+                        s.checkTimeOut (i.source->location);
+                    break;
+                case opReturn:          return stack.top[-1];
+                case opReturnVoid:      return var();
+
+                default:                jassertfalse; return var();
+            }
+        }
+    }
+
     //==============================================================================
     struct TokenIterator
     {
@@ -1857,3 +2747,193 @@ const NamedValueSet& JavascriptEngine::getRootObjectProperties() const noexcept
 #if JUCE_MSVC
  #pragma warning (pop)
 #endif
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class JavascriptEngineTests  : public UnitTest
+{
+public:
+    JavascriptEngineTests() : UnitTest ("JavascriptEngine") {}
+
+    struct NativeCounter  : public DynamicObject
+    {
+        NativeCounter()
+        {
+            setProperty ("count", 0);
+            setMethod ("increment", increment);
+        }
+
+        static var increment (const var::NativeFunctionArgs& a)
+        {
+            if (DynamicObject* o = a.thisObject.getDynamicObject())
+                o->setProperty ("count", (int) o->getProperty ("count") + (a.numArguments > 0 ? (int) a.arguments[0] : 1));
+
+            return a.thisObject;
+        }
+    };
+
+    var evaluate (JavascriptEngine& engine, const String& code)
+    {
+        Result r (Result::ok());
+        const var v (engine.evaluate (code, &r));
+        expect (r.wasOk(), r.getErrorMessage());
+        return v;
+    }
+
+    void run (JavascriptEngine& engine, const String& code)
+    {
+        const Result r (engine.execute (code));
+        expect (r.wasOk(), r.getErrorMessage());
+    }
+
+    void expectResult (const String& code, const String& expression, const var& expected)
+    {
+        JavascriptEngine engine;
+        run (engine, code);
+        const var result (evaluate (engine, expression));
+        expect (result == expected, code + "  -->  " + result.toString() + " (expected " + expected.toString() + ")");
+    }
+
+    double timeScript (const String& name, const String& setup, const String& code, const int repeats)
+    {
+        JavascriptEngine engine;
+        engine.maximumExecutionTime = RelativeTime::seconds (60);
+        run (engine, setup);
+
+        const double start = Time::getMillisecondCounterHiRes();
+
+        for (int i = 0; i < repeats; ++i)
+            run (engine, code);
+
+        const double elapsed = Time::getMillisecondCounterHiRes() - start;
+        logMessage (name.paddedRight (' ', 28) + String (elapsed, 1) + "ms");
+        return elapsed;
+    }
+
+    void runTest() override
+    {
+        beginTest ("Expressions and statements");
+
+        expectResult ("var a = 1 + 2 * 3;", "a", 7);
+        expectResult ("var a = 7 / 2; var b = 7 % 4;", "a + b", 6.5);
+        expectResult ("var a = 5; a += 3; a -= 1; a <<= 2;", "a", 28);
+        expectResult ("var s = \"ab\" + 'cd' + 1;", "s", "abcd1");
+        expectResult ("var a = [1, 2, 3]; a[1] = 5; a.push (4);", "a[0] + a[1] + a[2] + a[3] + a.length", 17);
+        expectResult ("var o = { x: 1, \"y\": 2 }; o.z = o.x + o.y; o[\"w\"] = 4;", "o.z * o.w", 12);
+        expectResult ("var a = 1; var b = a++; var c = ++a;", "a * 100 + b * 10 + c", 313);
+        expectResult ("var o = { n: 1 }; o.n++; ++o.n; o.n += 10;", "o.n", 13);
+        expectResult ("var a = [1, 2]; a[0]++; a[1] += 5;", "a[0] * 10 + a[1]", 27);
+        expectResult ("var a = 0; if (a == 0) a = 5; else a = 6;", "a", 5);
+        expectResult ("var a = 3 > 2 ? 'yes' : 'no';", "a", "yes");
+        expectResult ("var a = (1 && 0) || (2 && 3);", "a", true);
+        expectResult ("var a = 1 === 1 && 1 !== 'x' && !(2 < 1);", "a", true);
+        expectResult ("var a = (5 & 3) | (8 ^ 1) | (16 >> 2) | (1 << 6);", "a", 77);
+        expectResult ("var a = typeof 1 + typeof 'x' + typeof [] + typeof {} + typeof undefined;", "a", "numberstringobjectobjectundefined");
+        expectResult ("var s = 'hello'; var a = s.length + s.indexOf ('l');", "a", 7);
+
+        beginTest ("Loops");
+
+        expectResult ("var t = 0; for (var i = 0; i < 10; ++i) { if (i == 3) continue; if (i == 8) break; t += i; }", "t", 25);
+        expectResult ("var t = 0, i = 0; while (i < 10) { ++i; if (i % 2 == 0) continue; t += i; }", "t", 25);
+        expectResult ("var t = 0, i = 0; do { t += i; ++i; } while (i < 5);", "t", 10);
+        expectResult ("var t = 0; for (var i = 0; i < 3; ++i) for (var j = 0; j < 3; ++j) { if (j == 2) break; t += 1; }", "t", 6);
+        expectResult ("var t = 0; for (;;) { if (++t > 4) break; }", "t", 5);
+        expectResult ("var t = 0, i = 0; do { ++i; if (i < 3) continue; t += i; } while (i < 5);", "t", 12);
+
+        beginTest ("Functions");
+
+        expectResult ("function fib (n) { return n < 2 ? n : fib (n - 1) + fib (n - 2); }", "fib (15)", 610);
+        expectResult ("function f (a, b) { var c = a * 2; return c + b; }", "f (3, 4)", 10);
+        expectResult ("function f (a, b) { return typeof b; }", "f (1)", "undefined");
+        expectResult ("function f() { g = 5; } f();", "g", 5);
+        expectResult ("var x = 2; function f() { return x * 3; }", "f()", 6);
+        expectResult ("function f() { var t = 0; for (var i = 0; i < 10; ++i) { if (i == 5) return t; t += i; } return -1; }", "f()", 10);
+        expectResult ("var add = function (a, b) { return a + b; };", "add (2, 3)", 5);
+        expectResult ("var o = { v: 3, get: function() { return this.v; } };", "o.get()", 3);
+        expectResult ("function P (x) { this.x = x; } var p = new P (4);", "p.x", 4);
+        expectResult ("var c = { total: 0 }; function addTo (o, n) { o.total += n; } for (var i = 0; i < 5; ++i) addTo (c, i);", "c.total", 10);
+        expectResult ("var r = Math.max (3, 7) + Math.abs (-2);", "r", 9);
+        expectResult ("var a = [3, 1, 2]; var s = a.join (',');", "s", "3,1,2");
+        expectResult ("function f (n) { var a = n * 2; if (n > 0) f (n - 1); return a; }", "f (3)", 6);
+        expectResult ("function g() { return y; } function f() { var y = 7; return g(); }", "f()", 7);
+        expectResult ("function f (a, a) { return a; }", "f (1, 2)", 2);
+
+        beginTest ("Native objects");
+        {
+            JavascriptEngine engine;
+            NativeCounter* counter = new NativeCounter();
+            engine.registerNativeObject ("counter", counter);
+
+            run (engine, "for (var i = 0; i < 10; ++i) counter.increment (2); counter.increment(); counter.label = 'x';");
+            expectEquals ((int) counter->getProperty ("count"), 21);
+            expectEquals (counter->getProperty ("label").toString(), String ("x"));
+
+            run (engine, "function scale (v, lo, hi) { return lo + (hi - lo) * v; }");
+
+            var args[] = { 0.5, 10, 20 };
+            Result r (Result::ok());
+            const var result (engine.callFunction ("scale", var::NativeFunctionArgs (var(), args, 3), &r));
+            expect (r.wasOk());
+            expectEquals ((double) result, 15.0);
+        }
+
+        beginTest ("Errors");
+        {
+            JavascriptEngine engine;
+            expect (engine.execute ("var a = ;").failed());
+            expect (engine.execute ("nonExistent.foo();").failed());
+            expect (engine.execute ("function f() { return notAFunction(); } f();").failed());
+            expect (engine.execute ("function g() { return 1; } function h() { g() = 2; } h();").failed());
+
+            engine.maximumExecutionTime = RelativeTime::seconds (0.1);
+            expect (engine.execute ("while (true) {}").failed());
+        }
+
+        beginTest ("Benchmarks");
+        {
+            timeScript ("Loop arithmetic", String(),
+                        "var t = 0; for (var i = 0; i < 200000; ++i) t += i * 2 - 1;", 1);
+
+            timeScript ("Recursive calls", "function fib (n) { return n < 2 ? n : fib (n - 1) + fib (n - 2); }",
+                        "var f = fib (20);", 1);
+
+            timeScript ("Local variables", "function sum (n) { var t = 0; for (var i = 0; i < n; ++i) { var x = i & 7; t += x * x; } return t; }",
+                        "var r = sum (100000);", 1);
+
+            timeScript ("Objects and arrays", String(),
+                        "var a = []; for (var i = 0; i < 20000; ++i) a.push ({ id: i, v: i * 0.5 });"
+                        "var t = 0; for (var i = 0; i < a.length; ++i) t += a[i].v;", 1);
+
+            timeScript ("String building", String(),
+                        "var s = ''; for (var i = 0; i < 5000; ++i) s += 'x' + i;", 1);
+
+            {
+                // a typical controller-mapping script, called many times from C++
+                JavascriptEngine engine;
+                run (engine, "var curve = [0, 0.1, 0.3, 0.6, 1.0];"
+                             "function mapValue (v, lo, hi) { var i = Math.floor (v * 4); if (i > 3) i = 3;"
+                             "  var f = v * 4 - i; var c = curve[i] + (curve[i + 1] - curve[i]) * f;"
+                             "  return lo + (hi - lo) * c; }");
+
+                const double start = Time::getMillisecondCounterHiRes();
+                double total = 0;
+
+                for (int i = 0; i < 20000; ++i)
+                {
+                    var args[] = { (i % 100) / 100.0, 0, 127 };
+                    total += (double) engine.callFunction ("mapValue", var::NativeFunctionArgs (var(), args, 3));
+                }
+
+                logMessage (String ("Controller mapping calls").paddedRight (' ', 28)
+                              + String (Time::getMillisecondCounterHiRes() - start, 1) + "ms");
+                expect (total > 0);
+            }
+        }
+    }
+};
+
+static JavascriptEngineTests javascriptEngineTests;
+
+#endif
@@ -42,6 +42,25 @@ namespace HeapBlockHelper
 }
 #endif
 
+//==============================================================================
+/**
+    Provides the functions that a HeapBlock uses to allocate the memory for a
+    particular type of element.
+
+    By default this just uses std::malloc, std::calloc, std::realloc and std::free, but
+    it can be specialised for a type to make it use a different allocator - e.g. the
+    storage for var arrays is allocated via MemoryArena::HeapBlockAllocator.
+
+    @see HeapBlock, MemoryArena
+*/
+template <class ElementType>
+struct HeapBlockAllocator
+{
+    static void* allocate (size_t numBytes, bool clear)     { return clear ? std::calloc (numBytes, 1) : std::malloc (numBytes); }
+    static void* reallocate (void* data, size_t numBytes)   { return data == nullptr ? std::malloc (numBytes) : std::realloc (data, numBytes); }
+    static void release (void* data) noexcept               { std::free (data); }
+};
+
 //==============================================================================
 /**
     Very simple container class to hold a pointer to some data on the heap.
@@ -111,7 +130,7 @@ public:
         other constructor that takes an InitialisationState parameter.
     */
     explicit HeapBlock (const size_t numElements)
-        : data (static_cast<ElementType*> (std::malloc (numElements * sizeof (ElementType))))
+        : data (static_cast<ElementType*> (Allocator::allocate (numElements * sizeof (ElementType), false)))
     {
         throwOnAllocationFailure();
     }
@@ -122,9 +141,7 @@ public:
         or left uninitialised.
     */
     HeapBlock (const size_t numElements, const bool initialiseToZero)
-        : data (static_cast<ElementType*> (initialiseToZero
-                                               ? std::calloc (numElements, sizeof (ElementType))
-                                               : std::malloc (numElements * sizeof (ElementType))))
+        : data (static_cast<ElementType*> (Allocator::allocate (numElements * sizeof (ElementType), initialiseToZero)))
     {
         throwOnAllocationFailure();
     }
@@ -134,7 +151,7 @@ public:
     */
     ~HeapBlock()
     {
-        std::free (data);
+        Allocator::release (data);
     }
 
    #if JUCE_COMPILER_SUPPORTS_MOVE_SEMANTICS
@@ -221,8 +238,8 @@ public:
     */
     void malloc (const size_t newNumElements, const size_t elementSize = sizeof (ElementType))
     {
-        std::free (data);
-        data = static_cast<ElementType*> (std::malloc (newNumElements * elementSize));
+        Allocator::release (data);
+        data = static_cast<ElementType*> (Allocator::allocate (newNumElements * elementSize, false));
         throwOnAllocationFailure();
     }
 
@@ -231,8 +248,8 @@ public:
     */
     void calloc (const size_t newNumElements, const size_t elementSize = sizeof (ElementType))
     {
-        std::free (data);
-        data = static_cast<ElementType*> (std::calloc (newNumElements, elementSize));
+        Allocator::release (data);
+        data = static_cast<ElementType*> (Allocator::allocate (newNumElements * elementSize, true));
         throwOnAllocationFailure();
     }
 
@@ -242,10 +259,8 @@ public:
     */
     void allocate (const size_t newNumElements, bool initialiseToZero)
     {
-        std::free (data);
-        data = static_cast<ElementType*> (initialiseToZero
-                                             ? std::calloc (newNumElements, sizeof (ElementType))
-                                             : std::malloc (newNumElements * sizeof (ElementType)));
+        Allocator::release (data);
+        data = static_cast<ElementType*> (Allocator::allocate (newNumElements * sizeof (ElementType), initialiseToZero));
         throwOnAllocationFailure();
     }
 
@@ -256,8 +271,7 @@ public:
     */
     void realloc (const size_t newNumElements, const size_t elementSize = sizeof (ElementType))
     {
-        data = static_cast<ElementType*> (data == nullptr ? std::malloc (newNumElements * elementSize)
-                                                          : std::realloc (data, newNumElements * elementSize));
+        data = static_cast<ElementType*> (Allocator::reallocate (data, newNumElements * elementSize));
         throwOnAllocationFailure();
     }
 
@@ -266,7 +280,7 @@ public:
     */
     void free() noexcept
     {
-        std::free (data);
+        Allocator::release (data);
         data = nullptr;
     }
 
@@ -293,6 +307,8 @@ public:
 
 private:
     //==============================================================================
+    typedef HeapBlockAllocator<ElementType> Allocator;
+
     ElementType* data;
 
     void throwOnAllocationFailure() const
@@ -0,0 +1,523 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+struct MemoryArena::Block
+{
+    // (this counts the live allocations in the block, plus one while the arena is still filling it)
+    Atomic<int> numUsers;
+    size_t size, used;
+
+    char* getData() noexcept    { return reinterpret_cast<char*> (this) + dataOffset; }
+
+    enum { dataOffset = 32 };
+};
+
+// Every allocation in a block is preceded by one of these, so that it can be resized.
+// Memory that comes from the heap is just a plain malloc'ed block.
+struct MemoryArena::Header
+{
+    size_t size;
+
+    enum { headerSize = 16, alignment = 16 };
+
+    static size_t roundUp (size_t n) noexcept   { return (n + (alignment - 1)) & ~(size_t) (alignment - 1); }
+
+    static Header* fromData (void* data) noexcept
+    {
+        return reinterpret_cast<Header*> (static_cast<char*> (data) - headerSize);
+    }
+
+    void* getData() noexcept
+    {
+        return reinterpret_cast<char*> (this) + headerSize;
+    }
+};
+
+namespace MemoryArenaHelpers
+{
+    // The number of arenas that are active on any thread. When this is zero (which it normally
+    // will be), there's no need to look up the current thread's arena.
+    static Atomic<int> numActiveArenas;
+
+    static ThreadLocalValue<MemoryArena*>& getCurrentArenaHolder()
+    {
+        static ThreadLocalValue<MemoryArena*> current;
+        return current;
+    }
+}
+
+//==============================================================================
+// All the blocks that still contain live allocations, sorted by address, so that release()
+// can tell whether a pointer came from one of them. When there aren't any blocks (which is
+// usually the case), everything that gets released must have come from the heap.
+// (numBlocks is read without a barrier: a pointer that came from a block can only have been
+// handed to another thread after the block was added, so that thread will see the count)
+struct MemoryArena::LiveBlocks
+{
+    static LiveBlocks& getInstance()
+    {
+        static LiveBlocks blocks;
+        return blocks;
+    }
+
+    static Block* findBlockContaining (const void* const data) noexcept
+    {
+        if (numBlocks.value == 0)
+            return nullptr;
+
+        LiveBlocks& live = getInstance();
+        const SpinLock::ScopedLockType sl (live.lock);
+
+        const char* const p = static_cast<const char*> (data);
+        int start = 0, end = live.blocks.size();
+
+        // (finds the last block that starts at or before the pointer)
+        while (end - start > 1)
+        {
+            const int mid = (start + end) / 2;
+
+            if (p < live.blocks.getUnchecked (mid)->getData())
+                end = mid;
+            else
+                start = mid;
+        }
+
+        if (start < end)
+        {
+            Block* const b = live.blocks.getUnchecked (start);
+
+            if (p >= b->getData() && p < b->getData() + b->size)
+                return b;
+        }
+
+        return nullptr;
+    }
+
+    void add (Block* const b)
+    {
+        const SpinLock::ScopedLockType sl (lock);
+        int i = blocks.size();
+
+        while (i > 0 && blocks.getUnchecked (i - 1) > b)
+            --i;
+
+        blocks.insert (i, b);
+        ++numBlocks;
+    }
+
+    void remove (Block* const b) noexcept
+    {
+        const SpinLock::ScopedLockType sl (lock);
+        blocks.removeFirstMatchingValue (b);
+        --numBlocks;
+    }
+
+    static Atomic<int> numBlocks;
+
+    SpinLock lock;
+    Array<Block*> blocks;
+};
+
+Atomic<int> MemoryArena::LiveBlocks::numBlocks;
+
+//==============================================================================
+MemoryArena::MemoryArena (const size_t blockSizeInBytes)
+    : currentBlock (nullptr), lastAllocation (nullptr),
+      blockSize (jmax ((size_t) 1024, blockSizeInBytes)),
+      numAllocations (0), numBlocks (0)
+{
+    static_jassert (sizeof (Block) <= Block::dataOffset && sizeof (Header) <= Header::headerSize);
+}
+
+MemoryArena::~MemoryArena()
+{
+    // You're deleting an arena that's still active on a thread!
+    jassert (getCurrentArena() != this);
+
+    releaseCurrentBlock();
+}
+
+MemoryArena* MemoryArena::getCurrentArena() noexcept
+{
+    using namespace MemoryArenaHelpers;
+
+    // (this is read without a barrier because it's checked for every allocation - if the
+    // current thread has an arena active, then this thread was the one that incremented it)
+    return numActiveArenas.value != 0 ? getCurrentArenaHolder().get() : nullptr;
+}
+
+void MemoryArena::releaseBlockUser (Block* const b) noexcept
+{
+    if (--(b->numUsers) == 0)
+    {
+        LiveBlocks::getInstance().remove (b);
+        std::free (b);
+    }
+}
+
+void MemoryArena::releaseCurrentBlock() noexcept
+{
+    if (currentBlock != nullptr)
+    {
+        releaseBlockUser (currentBlock);
+        currentBlock = nullptr;
+        lastAllocation = nullptr;
+    }
+}
+
+void* MemoryArena::allocateInBlock (const size_t numBytes)
+{
+    const size_t spaceNeeded = Header::headerSize + Header::roundUp (numBytes);
+
+    // (large objects aren't worth putting in a block)
+    if (spaceNeeded > blockSize / 4)
+        return nullptr;
+
+    if (currentBlock == nullptr || currentBlock->used + spaceNeeded > currentBlock->size)
+    {
+        releaseCurrentBlock();
+
+        Block* const newBlock = static_cast<Block*> (std::malloc (Block::dataOffset + blockSize));
+
+        if (newBlock == nullptr)
+            return nullptr;
+
+        new (&(newBlock->numUsers)) Atomic<int> (1);
+        newBlock->size = blockSize;
+        newBlock->used = 0;
+        LiveBlocks::getInstance().add (newBlock);
+        currentBlock = newBlock;
+        ++numBlocks;
+    }
+
+    Header* const h = reinterpret_cast<Header*> (currentBlock->getData() + currentBlock->used);
+    h->size = numBytes;
+
+    currentBlock->used += spaceNeeded;
+    ++(currentBlock->numUsers);
+    ++numAllocations;
+    lastAllocation = h;
+
+    return h->getData();
+}
+
+bool MemoryArena::resizeInPlace (Header& h, const size_t newNumBytes) noexcept
+{
+    // only the most recent allocation can grow, into whatever space is left in its block
+    if (&h != lastAllocation)
+        return false;
+
+    const size_t newUsed = (size_t) (reinterpret_cast<char*> (&h) - currentBlock->getData()) + Header::headerSize + Header::roundUp (newNumBytes);
+
+    if (newUsed > currentBlock->size)
+        return false;
+
+    currentBlock->used = newUsed;
+    h.size = newNumBytes;
+    return true;
+}
+
+//==============================================================================
+void* MemoryArena::allocate (const size_t numBytes, const bool clearMemory)
+{
+    if (MemoryArena* const arena = getCurrentArena())
+    {
+        if (void* const data = arena->allocateInBlock (numBytes))
+        {
+            if (clearMemory)
+                zeromem (data, numBytes);
+
+            return data;
+        }
+    }
+
+    return clearMemory ? std::calloc (numBytes, 1) : std::malloc (numBytes);
+}
+
+void* MemoryArena::reallocate (void* const data, const size_t newNumBytes)
+{
+    if (data == nullptr)
+        return allocate (newNumBytes);
+
+    Block* const block = LiveBlocks::findBlockContaining (data);
+
+    // Memory that came from the heap stays there..
+    if (block == nullptr)
+        return std::realloc (data, newNumBytes);
+
+    Header* const h = Header::fromData (data);
+
+    if (MemoryArena* const arena = getCurrentArena())
+        if (arena->resizeInPlace (*h, newNumBytes))
+            return data;
+
+    void* const newData = allocate (newNumBytes);
+
+    if (newData != nullptr)
+    {
+        memcpy (newData, data, jmin (h->size, newNumBytes));
+        releaseBlockUser (block);
+    }
+
+    return newData;
+}
+
+void MemoryArena::release (void* const data) noexcept
+{
+    if (Block* const block = LiveBlocks::findBlockContaining (data))
+        releaseBlockUser (block);
+    else
+        std::free (data);
+}
+
+//==============================================================================
+ScopedMemoryArena::ScopedMemoryArena()  : arena (new MemoryArena(), true)
+{
+    activate();
+}
+
+ScopedMemoryArena::ScopedMemoryArena (MemoryArena& a)  : arena (&a, false)
+{
+    activate();
+}
+
+void ScopedMemoryArena::activate()
+{
+    using namespace MemoryArenaHelpers;
+
+    ThreadLocalValue<MemoryArena*>& current = getCurrentArenaHolder();
+    previousArena = current.get();
+    current = arena.get();
+    ++numActiveArenas;
+}
+
+ScopedMemoryArena::~ScopedMemoryArena()
+{
+    using namespace MemoryArenaHelpers;
+
+    --numActiveArenas;
+    getCurrentArenaHolder() = previousArena;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class MemoryArenaTests  : public UnitTest
+{
+public:
+    MemoryArenaTests() : UnitTest ("MemoryArena") {}
+
+    static String createTestDocument (Random& r, int numItems)
+    {
+        String json ("[");
+
+        for (int i = 0; i < numItems; ++i)
+        {
+            if (i > 0)
+                json << ",";
+
+            json << "{\"id\":" << i << ",\"value\":" << r.nextInt (1000)
+                 << ",\"list\":[1,2,3," << r.nextInt (100) << "],\"child\":{\"a\":true,\"b\":" << r.nextInt() << "}}";
+        }
+
+        return json + "]";
+    }
+
+    void runTest() override
+    {
+        Random r (getRandom());
+
+        beginTest ("Basics");
+        {
+            expect (MemoryArena::getCurrentArena() == nullptr);
+
+            {
+                ScopedMemoryArena outer;
+                expect (MemoryArena::getCurrentArena() == &outer.getArena());
+
+                {
+                    MemoryArena inner (4096);
+                    {
+                        ScopedMemoryArena sa (inner);
+                        expect (MemoryArena::getCurrentArena() == &inner);
+                    }
+
+                    expect (MemoryArena::getCurrentArena() == &outer.getArena());
+                }
+            }
+
+            expect (MemoryArena::getCurrentArena() == nullptr);
+        }
+
+        beginTest ("Allocation");
+        {
+            MemoryArena arena (4096);
+            ScopedMemoryArena sa (arena);
+
+            char* a = static_cast<char*> (MemoryArena::allocate (10, true));
+            char* b = static_cast<char*> (MemoryArena::allocate (20));
+
+            for (int i = 0; i < 10; ++i)
+                expect (a[i] == 0);
+
+            expect (((pointer_sized_int) a & 15) == 0 && ((pointer_sized_int) b & 15) == 0);
+            expectEquals (arena.getNumAllocations(), 2);
+
+            // the most recent allocation can grow in place..
+            memset (b, 'x', 20);
+            expect (MemoryArena::reallocate (b, 100) == b);
+
+            // ..but others have to move
+            memset (a, 'y', 10);
+            char* a2 = static_cast<char*> (MemoryArena::reallocate (a, 200));
+            expect (a2 != a);
+
+            for (int i = 0; i < 10; ++i)
+                expect (a2[i] == 'y' && b[i] == 'x');
+
+            // large blocks come from the heap
+            void* big = MemoryArena::allocate (100000);
+            expect (big != nullptr);
+            big = MemoryArena::reallocate (big, 200000);
+
+            MemoryArena::release (a2);
+            MemoryArena::release (b);
+            MemoryArena::release (big);
+            MemoryArena::release (nullptr);
+        }
+
+        beginTest ("Mixing heap and arena memory");
+        {
+            // with no arena active, this is just the heap, with nothing added to the blocks
+            void* heap = MemoryArena::allocate (64);
+            heap = MemoryArena::reallocate (heap, 128);
+            void* inArena = nullptr;
+
+            {
+                MemoryArena arena (4096);
+
+                {
+                    ScopedMemoryArena sa (arena);
+                    inArena = MemoryArena::allocate (64);
+                    memset (inArena, 'z', 64);
+
+                    // heap memory stays on the heap when it's resized..
+                    heap = MemoryArena::reallocate (heap, 256);
+                    expectEquals (arena.getNumAllocations(), 1);
+                }
+
+                // ..and arena memory moves to the heap if there's no arena to grow it in
+                inArena = MemoryArena::reallocate (inArena, 100);
+                expectEquals (arena.getNumAllocations(), 1);
+            }
+
+            for (int i = 0; i < 64; ++i)
+                expect (static_cast<char*> (inArena)[i] == 'z');
+
+            MemoryArena::release (inArena);
+            MemoryArena::release (heap);
+
+            // memory from different arenas can be released in any order
+            Array<void*> pointers;
+
+            {
+                MemoryArena a (1024), b (1024);
+
+                for (int i = 0; i < 100; ++i)
+                {
+                    ScopedMemoryArena sa (r.nextBool() ? a : b);
+                    pointers.add (MemoryArena::allocate ((size_t) r.nextInt (200)));
+                    pointers.add (MemoryArena::allocate (1000));
+                }
+
+                expect (a.getNumBlocksAllocated() + b.getNumBlocksAllocated() > 10);
+            }
+
+            while (pointers.size() > 0)
+                MemoryArena::release (pointers.removeAndReturn (r.nextInt (pointers.size())));
+        }
+
+        beginTest ("Parsing into an arena");
+        {
+            const String json (createTestDocument (r, 1000));
+            const var normal (JSON::parse (json));
+            var parsed;
+
+            {
+                ScopedMemoryArena sa;
+                parsed = JSON::parse (json);
+
+                expect (sa.getArena().getNumAllocations() > 1000);
+                expect (sa.getArena().getNumBlocksAllocated() < sa.getArena().getNumAllocations() / 50);
+            }
+
+            // objects are allowed to outlive the arena that they came from
+            expect (JSON::toString (parsed) == JSON::toString (normal));
+
+            parsed.getArray()->add (var (new DynamicObject()));
+            parsed.getArray()->removeRange (0, 500);
+            expectEquals (parsed.size(), 501);
+            parsed = var();
+        }
+
+        beginTest ("Benchmark");
+        {
+            const String json (createTestDocument (r, 20000));
+            const int numRuns = 5;
+            double normalTime = 0, arenaTime = 0;
+
+            for (int i = 0; i < numRuns; ++i)
+            {
+                {
+                    const double start = Time::getMillisecondCounterHiRes();
+                    var v (JSON::parse (json));
+                    v = var();
+                    normalTime += Time::getMillisecondCounterHiRes() - start;
+                }
+
+                {
+                    const double start = Time::getMillisecondCounterHiRes();
+                    ScopedMemoryArena sa;
+                    var v (JSON::parse (json));
+                    v = var();
+                    arenaTime += Time::getMillisecondCounterHiRes() - start;
+                }
+            }
+
+            logMessage ("Parse and discard " + String (json.length() / 1024) + "KB of JSON: heap "
+                          + String (normalTime / numRuns, 2) + "ms, arena "
+                          + String (arenaTime / numRuns, 2) + "ms");
+        }
+    }
+};
+
+static MemoryArenaTests memoryArenaTests;
+
+#endif
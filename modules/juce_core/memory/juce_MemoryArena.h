@@ -0,0 +1,189 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+#ifndef JUCE_MEMORYARENA_H_INCLUDED
+#define JUCE_MEMORYARENA_H_INCLUDED
+
+
+//==============================================================================
+/**
+    A monotonic allocator, which hands out memory from a few large blocks rather
+    than making a separate heap allocation for each object.
+
+    A MemoryArena is used by making it active on the current thread with a
+    ScopedMemoryArena. While it's active, any var arrays, DynamicObjects and their
+    property lists that get created on that thread are allocated from the arena's
+    blocks, so building a large object graph (e.g. parsing a JSON document) only
+    costs a handful of real allocations, and throwing it away again costs the same.
+
+    Individual objects can still be deleted in any order, and on any thread. The
+    memory that they used isn't re-used, but each block is given back to the system
+    as soon as all the objects that were allocated in it have been deleted. This means
+    that it's safe for objects to outlive the arena that created them - but a
+    long-lived object will keep its whole block allocated, so arenas are best used
+    for data that's built and discarded together.
+
+    A MemoryArena must only be active on one thread at a time.
+
+    @see ScopedMemoryArena
+*/
+class JUCE_API  MemoryArena
+{
+public:
+    //==============================================================================
+    /** Creates an arena, which will allocate its memory in blocks of the given size.
+        No memory is allocated until the arena is used.
+    */
+    explicit MemoryArena (size_t blockSizeInBytes = 65536);
+
+    /** Destructor.
+        Any blocks that still contain live objects are left allocated until those
+        objects have been deleted.
+    */
+    ~MemoryArena();
+
+    //==============================================================================
+    /** Returns the number of allocations that have been made from this arena. */
+    int getNumAllocations() const noexcept              { return numAllocations; }
+
+    /** Returns the number of blocks that the arena has allocated from the system. */
+    int getNumBlocksAllocated() const noexcept          { return numBlocks; }
+
+    /** Returns the arena that is active on the current thread, or nullptr if there isn't one. */
+    static MemoryArena* getCurrentArena() noexcept;
+
+    //==============================================================================
+    /** Allocates some memory from the current thread's arena, or from the heap if
+        there's no active arena (or if the size is too big to be worth putting in one).
+
+        When there's no arena active, this is just a std::malloc call. Memory allocated
+        this way must only be resized with reallocate() and freed with release().
+    */
+    static void* allocate (size_t numBytes, bool clearMemory = false);
+
+    /** Resizes a block that was allocated with allocate(), keeping its contents.
+        If the pointer is null, this behaves like allocate().
+    */
+    static void* reallocate (void* data, size_t newNumBytes);
+
+    /** Frees a block that was allocated with allocate() or reallocate(). */
+    static void release (void* data) noexcept;
+
+    //==============================================================================
+    /** A HeapBlockAllocator which makes the storage of a HeapBlock come from the current
+        thread's MemoryArena. @see HeapBlockAllocator
+    */
+    struct HeapBlockAllocator
+    {
+        static void* allocate (size_t numBytes, bool clear)     { return MemoryArena::allocate (numBytes, clear); }
+        static void* reallocate (void* data, size_t numBytes)   { return MemoryArena::reallocate (data, numBytes); }
+        static void release (void* data) noexcept               { MemoryArena::release (data); }
+    };
+
+private:
+    //==============================================================================
+    struct Block;
+    struct Header;
+    struct LiveBlocks;
+    friend class ScopedMemoryArena;
+
+    Block* currentBlock;
+    Header* lastAllocation;
+    const size_t blockSize;
+    int numAllocations, numBlocks;
+
+    void* allocateInBlock (size_t);
+    bool resizeInPlace (Header&, size_t) noexcept;
+    void releaseCurrentBlock() noexcept;
+    static void releaseBlockUser (Block*) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE (MemoryArena)
+};
+
+//==============================================================================
+/**
+    Makes a MemoryArena active on the current thread for the lifetime of this object.
+
+    While it exists, var arrays, DynamicObjects and their properties that are created
+    on this thread are allocated from the arena. When it's deleted, the arena that was
+    previously active (if any) is restored.
+
+    @code
+    {
+        ScopedMemoryArena arena;
+        var document (JSON::parse (hugeJSONString));
+        ...
+    }
+    @endcode
+
+    @see MemoryArena
+*/
+class JUCE_API  ScopedMemoryArena
+{
+public:
+    /** Creates a new MemoryArena and makes it active. */
+    ScopedMemoryArena();
+
+    /** Makes an existing MemoryArena active. The arena must not be deleted before this object. */
+    explicit ScopedMemoryArena (MemoryArena& arenaToUse);
+
+    /** Destructor. */
+    ~ScopedMemoryArena();
+
+    /** Returns the arena that this object has activated. */
+    MemoryArena& getArena() const noexcept              { return *arena; }
+
+private:
+    OptionalScopedPointer<MemoryArena> arena;
+    MemoryArena* previousArena;
+
+    void activate();
+
+    JUCE_DECLARE_NON_COPYABLE (ScopedMemoryArena)
+    JUCE_PREVENT_HEAP_ALLOCATION
+};
+
+//==============================================================================
+/** This macro adds operator new and delete to a class, so that its objects get
+    allocated from the current thread's MemoryArena, if there is one.
+    @see MemoryArena
+*/
+#if JUCE_MSVC && (defined (JUCE_DLL) || defined (JUCE_DLL_BUILD)) && ! (JUCE_DISABLE_DLL_ALLOCATORS || DOXYGEN)
+ #define JUCE_ALLOCATE_FROM_MEMORY_ARENA  // (in a DLL build, JUCE_LEAK_DETECTOR already supplies the allocators)
+#else
+ #define JUCE_ALLOCATE_FROM_MEMORY_ARENA  public: \
+    static void* operator new (size_t sz)           { return juce::MemoryArena::allocate (sz); } \
+    static void* operator new (size_t, void* p)     { return p; } \
+    static void operator delete (void* p)           { juce::MemoryArena::release (p); } \
+    static void operator delete (void*, void*)      {}
+#endif
+
+
+#endif   // JUCE_MEMORYARENA_H_INCLUDED
@@ -236,9 +236,18 @@
  #include <sys/sysinfo.h>
  #include <sys/file.h>
  #include <sys/prctl.h>
+ #include <sys/syscall.h>
+ #include <sys/inotify.h>
+ #include <poll.h>
  #include <signal.h>
  #include <stddef.h>
 
+ #if defined (__has_include)
+  #if __has_include (<linux/io_uring.h>)
+   #include <linux/io_uring.h>
+  #endif
+ #endif
+
 //==============================================================================
 #elif JUCE_ANDROID
  #include <jni.h>
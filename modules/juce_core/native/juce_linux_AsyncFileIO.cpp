@@ -0,0 +1,281 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+#if defined (IORING_FEAT_RW_CUR_POS) && defined (__NR_io_uring_setup)
+
+//==============================================================================
+class AsyncFileIO::NativeBackend  : public AsyncFileIO::Backend,
+                                    private Thread
+{
+public:
+    NativeBackend (AsyncFileIO& o)
+        : Backend (o), Thread ("AsyncFileIO io_uring"),
+          ringFD (-1), sqRing (nullptr), cqRing (nullptr), sqes (nullptr),
+          sqRingSize (0), cqRingSize (0), sqesSize (0),
+          numInFlight (0), maxInFlight (0), nextPendingIndex (0)
+    {
+    }
+
+    ~NativeBackend()
+    {
+        if (isThreadRunning())
+        {
+            signalThreadShouldExit();
+
+            {
+                // (a null operation gets turned into a no-op, which wakes up the thread)
+                const ScopedLock sl (lock);
+                pending.add (nullptr);
+                submitPending();
+            }
+
+            stopThread (10000);
+        }
+
+        // All the requests should have finished before this is deleted!
+        jassert (pending.size() == 0);
+
+        if (sqes != nullptr)                        munmap (sqes, sqesSize);
+        if (cqRing != nullptr && cqRing != sqRing)  munmap (cqRing, cqRingSize);
+        if (sqRing != nullptr)                      munmap (sqRing, sqRingSize);
+        if (ringFD >= 0)                            close (ringFD);
+    }
+
+    bool initialise()
+    {
+        io_uring_params params;
+        zerostruct (params);
+
+        ringFD = (int) syscall (__NR_io_uring_setup, 256, &params);
+
+        // (kernels older than 5.6 don't support the IORING_OP_READ and IORING_OP_WRITE operations,
+        // and the RW_CUR_POS feature flag arrived at the same time, so is used to detect them)
+        if (ringFD < 0 || (params.features & IORING_FEAT_RW_CUR_POS) == 0)
+            return false;
+
+        sqRingSize = params.sq_off.array + params.sq_entries * sizeof (uint32);
+        cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof (io_uring_cqe);
+        sqesSize   = params.sq_entries * sizeof (io_uring_sqe);
+
+        const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+
+        if (singleMap)
+            sqRingSize = cqRingSize = jmax (sqRingSize, cqRingSize);
+
+        sqRing = mapRing (sqRingSize, IORING_OFF_SQ_RING);
+        cqRing = singleMap ? sqRing : mapRing (cqRingSize, IORING_OFF_CQ_RING);
+        sqes = static_cast<io_uring_sqe*> (mapRing (sqesSize, IORING_OFF_SQES));
+
+        if (sqRing == nullptr || cqRing == nullptr || sqes == nullptr)
+            return false;
+
+        sqHead  = static_cast<uint32*> (addBytesToPointer (sqRing, params.sq_off.head));
+        sqTail  = static_cast<uint32*> (addBytesToPointer (sqRing, params.sq_off.tail));
+        sqArray = static_cast<uint32*> (addBytesToPointer (sqRing, params.sq_off.array));
+        sqMask  = *static_cast<uint32*> (addBytesToPointer (sqRing, params.sq_off.ring_mask));
+        numSQEntries = params.sq_entries;
+
+        cqHead = static_cast<uint32*> (addBytesToPointer (cqRing, params.cq_off.head));
+        cqTail = static_cast<uint32*> (addBytesToPointer (cqRing, params.cq_off.tail));
+        cqes   = static_cast<io_uring_cqe*> (addBytesToPointer (cqRing, params.cq_off.cqes));
+        cqMask = *static_cast<uint32*> (addBytesToPointer (cqRing, params.cq_off.ring_mask));
+
+        // Limiting the number of operations in progress to the size of the completion
+        // queue means that it can never overflow
+        maxInFlight = (int) params.cq_entries;
+
+        startThread();
+        return true;
+    }
+
+    void submit (const Array<Request*>& requests) override
+    {
+        const ScopedLock sl (lock);
+
+        for (int i = 0; i < requests.size(); ++i)
+            pending.add (new Operation (*requests.getUnchecked (i)));
+
+        submitPending();
+    }
+
+private:
+    //==============================================================================
+    struct Operation
+    {
+        Operation (Request& r) noexcept  : request (r), numDone (0) {}
+
+        Request& request;
+        int64 numDone;
+    };
+
+    int ringFD;
+    void* sqRing;
+    void* cqRing;
+    io_uring_sqe* sqes;
+    io_uring_cqe* cqes;
+    size_t sqRingSize, cqRingSize, sqesSize;
+    uint32* sqHead;
+    uint32* sqTail;
+    uint32* sqArray;
+    uint32* cqHead;
+    uint32* cqTail;
+    uint32 sqMask, cqMask, numSQEntries;
+
+    CriticalSection lock;
+    Array<Operation*> pending, finished;
+    int numInFlight, maxInFlight, nextPendingIndex;
+
+    void* mapRing (size_t size, int64 offset) const
+    {
+        void* const m = mmap (nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFD, (off_t) offset);
+        return m != MAP_FAILED ? m : nullptr;
+    }
+
+    // Moves as many pending operations into the submission queue as will fit. Must be called with the lock held.
+    void submitPending()
+    {
+        uint32 tail = *sqTail;
+        const uint32 head = __atomic_load_n (sqHead, __ATOMIC_ACQUIRE);
+
+        while (nextPendingIndex < pending.size() && numInFlight < maxInFlight && tail - head < numSQEntries)
+        {
+            Operation* const op = pending.getUnchecked (nextPendingIndex++);
+            const uint32 index = tail & sqMask;
+            io_uring_sqe& sqe = sqes[index];
+            zerostruct (sqe);
+
+            if (op == nullptr)
+            {
+                sqe.opcode = IORING_OP_NOP;
+            }
+            else
+            {
+                Request& r = op->request;
+
+                sqe.opcode = (uint8) (r.isWrite() ? IORING_OP_WRITE : IORING_OP_READ);
+                sqe.fd = (int) (pointer_sized_int) getNativeHandle (r);
+                sqe.off = (uint64) (r.getFilePosition() + op->numDone);
+                sqe.addr = (uint64) (pointer_sized_int) addBytesToPointer (r.getBuffer(), op->numDone);
+                sqe.len = (uint32) jmin ((size_t) 0x40000000, r.getNumBytesRequested() - (size_t) op->numDone);
+                sqe.user_data = (uint64) (pointer_sized_int) op;
+            }
+
+            sqArray[index] = index;
+            ++tail;
+            ++numInFlight;
+        }
+
+        if (nextPendingIndex >= pending.size())
+        {
+            pending.clearQuick();
+            nextPendingIndex = 0;
+        }
+
+        __atomic_store_n (sqTail, tail, __ATOMIC_RELEASE);
+
+        // (if an earlier call couldn't submit everything, those entries get submitted now too)
+        if (const uint32 numToSubmit = tail - __atomic_load_n (sqHead, __ATOMIC_ACQUIRE))
+            syscall (__NR_io_uring_enter, ringFD, numToSubmit, 0, 0, nullptr, 0);
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            if (syscall (__NR_io_uring_enter, ringFD, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0
+                 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                Thread::sleep (1);
+
+            {
+                const ScopedLock sl (lock);
+
+                uint32 head = *cqHead;
+                const uint32 tail = __atomic_load_n (cqTail, __ATOMIC_ACQUIRE);
+
+                for (; head != tail; ++head)
+                {
+                    const io_uring_cqe& cqe = cqes[head & cqMask];
+                    Operation* const op = (Operation*) (pointer_sized_int) cqe.user_data;
+                    --numInFlight;
+
+                    if (op == nullptr)
+                        continue;
+
+                    if (cqe.res == -EINTR || cqe.res == -EAGAIN)
+                    {
+                        pending.add (op);  // try again
+                    }
+                    else if (cqe.res < 0 || (cqe.res == 0 && op->request.isWrite() && op->request.getNumBytesRequested() > 0))
+                    {
+                        op->numDone = -1;
+                        finished.add (op);
+                    }
+                    else if (cqe.res == 0 || (op->numDone += cqe.res) >= (int64) op->request.getNumBytesRequested())
+                    {
+                        finished.add (op);
+                    }
+                    else
+                    {
+                        pending.add (op);  // a partial transfer, so carry on with the rest
+                    }
+                }
+
+                __atomic_store_n (cqHead, head, __ATOMIC_RELEASE);
+                submitPending();
+            }
+
+            // (the callbacks are made without the lock held, so they can start new requests)
+            for (int i = 0; i < finished.size(); ++i)
+            {
+                ScopedPointer<Operation> op (finished.getUnchecked (i));
+                requestFinished (op->request, op->numDone);
+            }
+
+            finished.clearQuick();
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (NativeBackend)
+};
+
+AsyncFileIO::Backend* AsyncFileIO::createNativeBackend (AsyncFileIO& owner)
+{
+    ScopedPointer<NativeBackend> b (new NativeBackend (owner));
+    return b->initialise() ? b.release() : nullptr;
+}
+
+#else
+
+AsyncFileIO::Backend* AsyncFileIO::createNativeBackend (AsyncFileIO&)
+{
+    return nullptr;
+}
+
+#endif
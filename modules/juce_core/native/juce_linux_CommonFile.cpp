@@ -120,7 +120,19 @@ public:
                 {
                     filenameFound = CharPointer_UTF8 (de->d_name);
 
-                    updateStatInfoForFile (parentDir + filenameFound, isDir, fileSize, modTime, creationTime, isReadOnly);
+                   #ifdef DT_DIR
+                    // if the type is all that's needed, and readdir knows it already, there's no need to stat the file
+                    if (isDir != nullptr && fileSize == nullptr && modTime == nullptr && creationTime == nullptr
+                         && (de->d_type == DT_DIR || de->d_type == DT_REG))
+                    {
+                        *isDir = (de->d_type == DT_DIR);
+                        updateStatInfoForFile (parentDir + filenameFound, nullptr, nullptr, nullptr, nullptr, isReadOnly);
+                    }
+                    else
+                   #endif
+                    {
+                        updateStatInfoForFile (parentDir + filenameFound, isDir, fileSize, modTime, creationTime, isReadOnly);
+                    }
 
                     if (isHidden != nullptr)
                         *isHidden = filenameFound.startsWithChar ('.');
@@ -0,0 +1,348 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+class FileSystemWatcher::NativeBackend  : public FileSystemWatcher::Backend
+{
+public:
+    NativeBackend()  : inotifyFD (-1), buffer (bufferSize)
+    {
+        wakePipe[0] = wakePipe[1] = -1;
+    }
+
+    ~NativeBackend()
+    {
+        if (wakePipe[0] >= 0)   close (wakePipe[0]);
+        if (wakePipe[1] >= 0)   close (wakePipe[1]);
+        if (inotifyFD >= 0)     close (inotifyFD);
+    }
+
+    bool initialise()
+    {
+        inotifyFD = inotify_init1 (IN_NONBLOCK | IN_CLOEXEC);
+
+        if (inotifyFD < 0 || pipe (wakePipe) != 0)
+            return false;
+
+        fcntl (wakePipe[0], F_SETFL, O_NONBLOCK);
+        fcntl (wakePipe[1], F_SETFL, O_NONBLOCK);
+        return true;
+    }
+
+    bool addFolder (const File& folder) override
+    {
+        const ScopedLock sl (lock);
+        roots.add (folder.getFullPathName());
+
+        if (addWatches (folder, true, nullptr))
+            return true;
+
+        // (if the kernel's limit on the number of watches has been reached, it's better
+        // to fail than to silently ignore part of the tree)
+        roots.remove (roots.size() - 1);
+        removeWatchesInside (folder.getFullPathName(), true);
+        return false;
+    }
+
+    void removeFolder (const File& folder) override
+    {
+        const ScopedLock sl (lock);
+        roots.removeString (folder.getFullPathName());
+        removeWatchesInside (folder.getFullPathName(), true);
+    }
+
+    void waitForEvents (Array<Event>& results, const int timeOutMilliseconds) override
+    {
+        pollfd fds[2];
+        zeromem (fds, sizeof (fds));
+        fds[0].fd = inotifyFD;
+        fds[0].events = POLLIN;
+        fds[1].fd = wakePipe[0];
+        fds[1].events = POLLIN;
+
+        if (poll (fds, 2, timeOutMilliseconds) <= 0)
+            return;
+
+        if (fds[1].revents != 0)
+        {
+            char dummy[64];
+            while (read (wakePipe[0], dummy, sizeof (dummy)) > 0) {}
+        }
+
+        if (fds[0].revents != 0)
+            readEvents (results);
+    }
+
+    void wakeUp() override
+    {
+        const char dummy = 0;
+        ignoreUnused (write (wakePipe[1], &dummy, 1));
+    }
+
+private:
+    //==============================================================================
+    enum
+    {
+        bufferSize = 65536,
+        watchMask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO
+                     | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR | IN_EXCL_UNLINK
+    };
+
+    struct PendingMove
+    {
+        uint32 cookie;
+        int eventIndex;
+    };
+
+    int inotifyFD, wakePipe[2];
+    HashMap<int, String> watchedPaths;
+    StringArray roots;
+    CriticalSection lock;
+    HeapBlock<char> buffer;
+
+    static bool isSameOrInside (const String& path, const String& folder)
+    {
+        return path.startsWith (folder)
+                && (path.length() == folder.length()
+                     || path[folder.length()] == File::separator
+                     || folder.endsWithChar (File::separator));
+    }
+
+    bool isInsideRoot (const String& path) const
+    {
+        for (int i = 0; i < roots.size(); ++i)
+            if (isSameOrInside (path, roots[i]))
+                return true;
+
+        return false;
+    }
+
+    bool addWatch (const String& path, const bool isRoot)
+    {
+        // (symlinks inside the tree aren't followed, and if the item has already been
+        // deleted or replaced by a file, there's nothing left to watch)
+        const int wd = inotify_add_watch (inotifyFD, path.toUTF8(), watchMask | (isRoot ? 0 : IN_DONT_FOLLOW));
+
+        if (wd < 0)
+            return ! isRoot && (errno == ENOTDIR || errno == ENOENT);
+
+        watchedPaths.set (wd, path);
+        return true;
+    }
+
+    // Adds watches for a folder and everything inside it. If the folder is new, then
+    // some files may already have been created in it before it was being watched, so
+    // these get reported too.
+    bool addWatches (const File& folder, const bool isRoot, Array<Event>* newItems)
+    {
+        if (! addWatch (folder.getFullPathName(), isRoot))
+            return false;
+
+        DirectoryScanner scanner (folder, true, "*", newItems != nullptr ? File::findFilesAndDirectories
+                                                                         : File::findDirectories);
+        const Array<DirectoryScanner::Entry> entries (scanner.scan());
+        bool ok = true;
+
+        for (int i = 0; i < entries.size(); ++i)
+        {
+            const DirectoryScanner::Entry& e = entries.getReference (i);
+
+            if (newItems != nullptr)
+                newItems->add (Event (fileCreated, e.file, e.isDirectory));
+
+            if (e.isDirectory && ! addWatch (e.file.getFullPathName(), false))
+                ok = false;
+        }
+
+        return ok;
+    }
+
+    void removeWatchesInside (const String& folder, const bool keepOnesInsideOtherRoots)
+    {
+        Array<int> watchesToRemove;
+
+        for (HashMap<int, String>::Iterator i (watchedPaths); i.next();)
+            if (isSameOrInside (i.getValue(), folder)
+                  && ! (keepOnesInsideOtherRoots && isInsideRoot (i.getValue())))
+                watchesToRemove.add (i.getKey());
+
+        for (int i = 0; i < watchesToRemove.size(); ++i)
+        {
+            inotify_rm_watch (inotifyFD, watchesToRemove.getUnchecked (i));
+            watchedPaths.remove (watchesToRemove.getUnchecked (i));
+        }
+    }
+
+    void renameWatchedPaths (const String& oldPath, const String& newPath)
+    {
+        Array<int> watches;
+        StringArray newPaths;
+
+        for (HashMap<int, String>::Iterator i (watchedPaths); i.next();)
+        {
+            if (isSameOrInside (i.getValue(), oldPath))
+            {
+                watches.add (i.getKey());
+                newPaths.add (newPath + i.getValue().substring (oldPath.length()));
+            }
+        }
+
+        for (int i = 0; i < watches.size(); ++i)
+            watchedPaths.set (watches.getUnchecked (i), newPaths[i]);
+    }
+
+    //==============================================================================
+    void readEvents (Array<Event>& results)
+    {
+        const ScopedLock sl (lock);
+        Array<PendingMove> moves;
+
+        for (;;)
+        {
+            const ssize_t numBytes = read (inotifyFD, buffer, bufferSize);
+
+            if (numBytes <= 0)
+                break;
+
+            for (ssize_t pos = 0; pos < numBytes;)
+            {
+                const inotify_event& e = *reinterpret_cast<const inotify_event*> (buffer + pos);
+                handleEvent (e, results, moves);
+                pos += (ssize_t) (sizeof (inotify_event) + e.len);
+            }
+        }
+
+        // Anything that was moved without a matching destination has left the watched
+        // folders, so has already been reported as deleted, but its watches must go too.
+        for (int i = 0; i < moves.size(); ++i)
+        {
+            const Event& e = results.getReference (moves.getReference (i).eventIndex);
+
+            if (e.isDirectory)
+                removeWatchesInside (e.file.getFullPathName(), false);
+        }
+    }
+
+    void handleEvent (const inotify_event& e, Array<Event>& results, Array<PendingMove>& moves)
+    {
+        if ((e.mask & IN_Q_OVERFLOW) != 0)
+        {
+            results.add (Event (eventsLost, File(), false));
+            return;
+        }
+
+        if ((e.mask & IN_IGNORED) != 0)
+        {
+            watchedPaths.remove (e.wd);
+            return;
+        }
+
+        if (! watchedPaths.contains (e.wd))
+            return;
+
+        const String folder (watchedPaths [e.wd]);
+
+        if ((e.mask & (IN_DELETE_SELF | IN_MOVE_SELF)) != 0)
+        {
+            // (for anything other than a root, the watch on its parent folder reports this)
+            if (roots.contains (folder))
+            {
+                results.add (Event (fileDeleted, File (folder), true));
+
+                if ((e.mask & IN_MOVE_SELF) != 0)
+                    removeWatchesInside (folder, false);
+            }
+
+            return;
+        }
+
+        if (e.len == 0)
+            return;
+
+        const File file (File (folder).getChildFile (String::fromUTF8 (e.name)));
+        const bool isDirectory = (e.mask & IN_ISDIR) != 0;
+
+        if ((e.mask & IN_CREATE) != 0)
+        {
+            results.add (Event (fileCreated, file, isDirectory));
+
+            if (isDirectory)
+                addWatches (file, false, &results);
+        }
+        else if ((e.mask & IN_DELETE) != 0)
+        {
+            results.add (Event (fileDeleted, file, isDirectory));
+        }
+        else if ((e.mask & (IN_MODIFY | IN_ATTRIB)) != 0)
+        {
+            if (! isDirectory)
+                results.add (Event (fileModified, file, false));
+        }
+        else if ((e.mask & IN_MOVED_FROM) != 0)
+        {
+            // (this becomes a rename if the matching IN_MOVED_TO event turns up)
+            const PendingMove move = { e.cookie, results.size() };
+            moves.add (move);
+            results.add (Event (fileDeleted, file, isDirectory));
+        }
+        else if ((e.mask & IN_MOVED_TO) != 0)
+        {
+            for (int i = 0; i < moves.size(); ++i)
+            {
+                if (moves.getReference (i).cookie == e.cookie)
+                {
+                    Event& renamed = results.getReference (moves.getReference (i).eventIndex);
+                    renamed.type = fileRenamed;
+                    renamed.previousFile = renamed.file;
+                    renamed.file = file;
+                    moves.remove (i);
+
+                    if (isDirectory)
+                        renameWatchedPaths (renamed.previousFile.getFullPathName(), file.getFullPathName());
+
+                    return;
+                }
+            }
+
+            results.add (Event (fileCreated, file, isDirectory));
+
+            if (isDirectory)
+                addWatches (file, false, &results);
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (NativeBackend)
+};
+
+FileSystemWatcher::Backend* FileSystemWatcher::createNativeBackend()
+{
+    ScopedPointer<NativeBackend> b (new NativeBackend());
+    return b->initialise() ? b.release() : nullptr;
+}
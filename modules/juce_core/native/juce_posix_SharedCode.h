@@ -240,9 +240,11 @@ namespace
    #if JUCE_LINUX || (JUCE_IOS && ! __DARWIN_ONLY_64_BIT_INO_T) // (this iOS stuff is to avoid a simulator bug)
     typedef struct stat64 juce_statStruct;
     #define JUCE_STAT     stat64
+    #define JUCE_LSTAT    lstat64
    #else
     typedef struct stat   juce_statStruct;
     #define JUCE_STAT     stat
+    #define JUCE_LSTAT    lstat
    #endif
 
     bool juce_stat (const String& fileName, juce_statStruct& info)
@@ -593,7 +595,173 @@ String SystemStats::getEnvironmentVariable (const String& name, const String& de
 }
 
 //==============================================================================
-void MemoryMappedFile::openInternal (const File& file, AccessMode mode, bool exclusive)
+#if JUCE_LINUX
+namespace
+{
+    // Finds the details of an item in an open directory, which is much quicker than looking up
+    // its full path. If its type isn't known, it might be a link, which the scanner needs to know.
+    bool statDirectoryEntry (const int dirFD, const char* const name, const bool typeIsKnown,
+                             bool& isLink, juce_statStruct& info)
+    {
+        if (! (typeIsKnown || isLink))
+        {
+            if (fstatat64 (dirFD, name, &info, AT_SYMLINK_NOFOLLOW) != 0)
+                return false;
+
+            if (! S_ISLNK (info.st_mode))
+                return true;
+
+            isLink = true;
+        }
+
+        return fstatat64 (dirFD, name, &info, 0) == 0;
+    }
+}
+#endif
+
+bool DirectoryScanner::readDirectory (const String& path, Array<RawEntry>& results, const bool fetchDetails)
+{
+    DIR* const dir = opendir (path.toUTF8());
+
+    if (dir == nullptr)
+        return false;
+
+    while (const struct dirent* const de = readdir (dir))
+    {
+        RawEntry e;
+        e.name = CharPointer_UTF8 (de->d_name);
+        e.size = 0;
+        e.modificationTime = 0;
+        e.type = -1;
+        e.isLink = false;
+        e.isHidden = e.name.startsWithChar ('.');
+        e.hasDetails = false;
+
+       #ifdef DT_DIR
+        switch (de->d_type)
+        {
+            case DT_DIR:        e.type = 1; break;
+            case DT_LNK:        e.isLink = true; break;
+            case DT_UNKNOWN:    break;
+            default:            e.type = 0; break;
+        }
+       #endif
+
+       #if JUCE_LINUX
+        juce_statStruct info;
+
+        if (fetchDetails && statDirectoryEntry (dirfd (dir), de->d_name, e.type >= 0, e.isLink, info))
+        {
+            e.type = (info.st_mode & S_IFDIR) != 0 ? 1 : 0;
+            e.size = (int64) info.st_size;
+            e.modificationTime = (int64) info.st_mtime * 1000;
+            e.hasDetails = true;
+        }
+       #else
+        ignoreUnused (fetchDetails);
+       #endif
+
+        results.add (e);
+    }
+
+    closedir (dir);
+    return true;
+}
+
+bool DirectoryScanner::getDetails (const String& path, RawEntry& e)
+{
+    juce_statStruct info;
+    bool ok;
+
+    if (e.type < 0 && ! e.isLink)
+    {
+        // if readdir couldn't say what type this is, it might also be a link, which needs to be known
+        // so that the scanner doesn't follow it
+        ok = JUCE_LSTAT (path.toUTF8(), &info) == 0;
+
+        if (ok && S_ISLNK (info.st_mode))
+        {
+            e.isLink = true;
+            ok = juce_stat (path, info);
+        }
+    }
+    else
+    {
+        ok = juce_stat (path, info);
+    }
+
+    if (! ok)
+        return false;
+
+    e.type = (info.st_mode & S_IFDIR) != 0 ? 1 : 0;
+    e.size = (int64) info.st_size;
+    e.modificationTime = (int64) info.st_mtime * 1000;
+    e.hasDetails = true;
+    return true;
+}
+
+//==============================================================================
+void* juce_openFileForAsyncIO (const File& file, const bool forWriting)
+{
+    const int f = open (file.getFullPathName().toUTF8(), forWriting ? (O_RDWR | O_CREAT) : O_RDONLY, 00644);
+    return f != -1 ? fdToVoidPointer (f) : nullptr;
+}
+
+void juce_closeFileForAsyncIO (void* handle)
+{
+    if (handle != 0)
+        close (getFD (handle));
+}
+
+int64 juce_fileReadAt (void* handle, int64 position, void* destBuffer, size_t numBytes)
+{
+    size_t numDone = 0;
+
+    while (numDone < numBytes)
+    {
+        const ssize_t result = pread (getFD (handle), static_cast<char*> (destBuffer) + numDone,
+                                      numBytes - numDone, (off_t) (position + (int64) numDone));
+        if (result == 0)
+            break;
+
+        if (result < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            return -1;
+        }
+
+        numDone += (size_t) result;
+    }
+
+    return (int64) numDone;
+}
+
+int64 juce_fileWriteAt (void* handle, int64 position, const void* sourceData, size_t numBytes)
+{
+    size_t numDone = 0;
+
+    while (numDone < numBytes)
+    {
+        const ssize_t result = pwrite (getFD (handle), static_cast<const char*> (sourceData) + numDone,
+                                       numBytes - numDone, (off_t) (position + (int64) numDone));
+        if (result <= 0)
+        {
+            if (result < 0 && errno == EINTR)
+                continue;
+
+            return -1;
+        }
+
+        numDone += (size_t) result;
+    }
+
+    return (int64) numDone;
+}
+
+//==============================================================================
+void MemoryMappedFile::openInternal (const File& file, AccessMode mode, bool exclusive, int mappingOptions)
 {
     jassert (mode == readOnly || mode == readWrite);
 
@@ -608,15 +776,30 @@ void MemoryMappedFile::openInternal (const File& file, AccessMode mode, bool exc
 
     if (fileHandle != -1)
     {
+        int flags = exclusive ? MAP_PRIVATE : MAP_SHARED;
+        bool populated = false;
+
+       #ifdef MAP_POPULATE
+        if ((mappingOptions & prefaultPages) != 0)
+        {
+            flags |= MAP_POPULATE;
+            populated = true;
+        }
+       #endif
+
         void* m = mmap (0, (size_t) range.getLength(),
                         mode == readWrite ? (PROT_READ | PROT_WRITE) : PROT_READ,
-                        exclusive ? MAP_PRIVATE : MAP_SHARED, fileHandle,
-                        (off_t) range.getStart());
+                        flags, fileHandle, (off_t) range.getStart());
 
         if (m != MAP_FAILED)
         {
             address = m;
             madvise (m, (size_t) range.getLength(), MADV_SEQUENTIAL);
+
+            const bool locked = (mappingOptions & lockPagesInMemory) != 0 && lockPages (range);
+
+            if (! (locked || populated) && (mappingOptions & (prefaultPages | lockPagesInMemory)) != 0)
+                prefault (range);
         }
         else
         {
@@ -625,6 +808,40 @@ void MemoryMappedFile::openInternal (const File& file, AccessMode mode, bool exc
     }
 }
 
+bool MemoryMappedFile::adviseAccess (Range<int64> rangeOfFile, AccessHint hint) const noexcept
+{
+    const Range<int64> r (getPageAlignedRange (rangeOfFile));
+
+    if (r.isEmpty())
+        return false;
+
+    int advice = MADV_NORMAL;
+
+    switch (hint)
+    {
+        case sequentialAccess:  advice = MADV_SEQUENTIAL; break;
+        case randomAccess:      advice = MADV_RANDOM; break;
+        case willNeed:          advice = MADV_WILLNEED; break;
+        default:                break;
+    }
+
+    return madvise (addBytesToPointer (address, r.getStart()), (size_t) r.getLength(), advice) == 0;
+}
+
+bool MemoryMappedFile::lockPages (Range<int64> rangeOfFile) const noexcept
+{
+    const Range<int64> r (getPageAlignedRange (rangeOfFile));
+    return ! r.isEmpty() && mlock (addBytesToPointer (address, r.getStart()), (size_t) r.getLength()) == 0;
+}
+
+void MemoryMappedFile::unlockPages (Range<int64> rangeOfFile) const noexcept
+{
+    const Range<int64> r (getPageAlignedRange (rangeOfFile));
+
+    if (! r.isEmpty())
+        munlock (addBytesToPointer (address, r.getStart()), (size_t) r.getLength());
+}
+
 MemoryMappedFile::~MemoryMappedFile()
 {
     if (address != nullptr)
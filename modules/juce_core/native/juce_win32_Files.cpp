@@ -336,7 +336,62 @@ Result FileOutputStream::truncate()
 }
 
 //==============================================================================
-void MemoryMappedFile::openInternal (const File& file, AccessMode mode, bool exclusive)
+void* juce_openFileForAsyncIO (const File& file, const bool forWriting)
+{
+    HANDLE h = CreateFile (file.getFullPathName().toWideCharPointer(),
+                           forWriting ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+                           FILE_SHARE_READ | FILE_SHARE_WRITE, 0,
+                           forWriting ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+
+    return h != INVALID_HANDLE_VALUE ? (void*) h : nullptr;
+}
+
+void juce_closeFileForAsyncIO (void* handle)
+{
+    CloseHandle ((HANDLE) handle);
+}
+
+static int64 juce_fileTransferAt (void* handle, int64 position, void* buffer, size_t numBytes, bool isWrite)
+{
+    size_t numDone = 0;
+
+    while (numDone < numBytes)
+    {
+        // (passing an OVERLAPPED to a synchronous handle makes it use the position it contains)
+        const int64 pos = position + (int64) numDone;
+        OVERLAPPED overlapped = { 0 };
+        overlapped.Offset = (DWORD) pos;
+        overlapped.OffsetHigh = (DWORD) (pos >> 32);
+
+        char* const data = static_cast<char*> (buffer) + numDone;
+        const DWORD numToDo = (DWORD) jmin (numBytes - numDone, (size_t) 0x40000000);
+        DWORD actualNum = 0;
+
+        if (! (isWrite ? WriteFile ((HANDLE) handle, data, numToDo, &actualNum, &overlapped)
+                       : ReadFile  ((HANDLE) handle, data, numToDo, &actualNum, &overlapped)))
+            return (! isWrite && GetLastError() == ERROR_HANDLE_EOF) ? (int64) numDone : -1;
+
+        if (actualNum == 0)
+            break;
+
+        numDone += actualNum;
+    }
+
+    return (int64) numDone;
+}
+
+int64 juce_fileReadAt (void* handle, int64 position, void* destBuffer, size_t numBytes)
+{
+    return juce_fileTransferAt (handle, position, destBuffer, numBytes, false);
+}
+
+int64 juce_fileWriteAt (void* handle, int64 position, const void* sourceData, size_t numBytes)
+{
+    return juce_fileTransferAt (handle, position, const_cast<void*> (sourceData), numBytes, true);
+}
+
+//==============================================================================
+void MemoryMappedFile::openInternal (const File& file, AccessMode mode, bool exclusive, int mappingOptions)
 {
     jassert (mode == readOnly || mode == readWrite);
 
@@ -378,10 +433,59 @@ void MemoryMappedFile::openInternal (const File& file, AccessMode mode, bool exc
                 range = Range<int64>();
 
             CloseHandle (mappingHandle);
+
+            if (address != nullptr)
+            {
+                const bool locked = (mappingOptions & lockPagesInMemory) != 0 && lockPages (range);
+
+                if (! locked && (mappingOptions & (prefaultPages | lockPagesInMemory)) != 0)
+                    prefault (range);
+            }
         }
     }
 }
 
+bool MemoryMappedFile::adviseAccess (Range<int64> rangeOfFile, AccessHint hint) const noexcept
+{
+    const Range<int64> r (getPageAlignedRange (rangeOfFile));
+
+    // (prefetching is the only kind of hint that Windows supports for mapped memory)
+    if (r.isEmpty() || hint != willNeed)
+        return false;
+
+    struct MemoryRangeEntry
+    {
+        void* virtualAddress;
+        SIZE_T numberOfBytes;
+    };
+
+    typedef BOOL (WINAPI* PrefetchVirtualMemoryFunc) (HANDLE, ULONG_PTR, MemoryRangeEntry*, ULONG);
+
+    // (only available in Windows 8 or later)
+    static PrefetchVirtualMemoryFunc prefetchVirtualMemory
+        = (PrefetchVirtualMemoryFunc) GetProcAddress (GetModuleHandleA ("kernel32"), "PrefetchVirtualMemory");
+
+    if (prefetchVirtualMemory == nullptr)
+        return false;
+
+    MemoryRangeEntry entry = { addBytesToPointer (address, r.getStart()), (SIZE_T) r.getLength() };
+    return prefetchVirtualMemory (GetCurrentProcess(), 1, &entry, 0) != 0;
+}
+
+bool MemoryMappedFile::lockPages (Range<int64> rangeOfFile) const noexcept
+{
+    const Range<int64> r (getPageAlignedRange (rangeOfFile));
+    return ! r.isEmpty() && VirtualLock (addBytesToPointer (address, r.getStart()), (SIZE_T) r.getLength()) != 0;
+}
+
+void MemoryMappedFile::unlockPages (Range<int64> rangeOfFile) const noexcept
+{
+    const Range<int64> r (getPageAlignedRange (rangeOfFile));
+
+    if (! r.isEmpty())
+        VirtualUnlock (addBytesToPointer (address, r.getStart()), (SIZE_T) r.getLength());
+}
+
 MemoryMappedFile::~MemoryMappedFile()
 {
     if (address != nullptr)
@@ -808,6 +912,52 @@ bool DirectoryIterator::NativeIterator::next (String& filenameFound,
     return pimpl->next (filenameFound, isDir, isHidden, fileSize, modTime, creationTime, isReadOnly);
 }
 
+//==============================================================================
+bool DirectoryScanner::readDirectory (const String& path, Array<RawEntry>& results, bool)
+{
+    using namespace WindowsFileHelpers;
+    WIN32_FIND_DATA findData;
+
+    // (the directory listing includes all the details, so there's never any need to call getDetails())
+    HANDLE h = FindFirstFile ((path + "*").toWideCharPointer(), &findData);
+
+    if (h == INVALID_HANDLE_VALUE)
+        return false;
+
+    do
+    {
+        RawEntry e;
+        e.name = findData.cFileName;
+        e.type = (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0 ? 1 : 0;
+        e.isLink = (findData.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0;
+        e.isHidden = (findData.dwFileAttributes & FILE_ATTRIBUTE_HIDDEN) != 0;
+        e.size = findData.nFileSizeLow + (((int64) findData.nFileSizeHigh) << 32);
+        e.modificationTime = fileTimeToTime (&findData.ftLastWriteTime);
+        e.hasDetails = true;
+
+        results.add (e);
+    }
+    while (FindNextFile (h, &findData) != 0);
+
+    FindClose (h);
+    return true;
+}
+
+bool DirectoryScanner::getDetails (const String& path, RawEntry& e)
+{
+    using namespace WindowsFileHelpers;
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+
+    if (! GetFileAttributesEx (path.toWideCharPointer(), GetFileExInfoStandard, &attributes))
+        return false;
+
+    e.type = (attributes.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0 ? 1 : 0;
+    e.size = attributes.nFileSizeLow + (((int64) attributes.nFileSizeHigh) << 32);
+    e.modificationTime = fileTimeToTime (&attributes.ftLastWriteTime);
+    e.hasDetails = true;
+    return true;
+}
+
 
 //==============================================================================
 bool JUCE_CALLTYPE Process::openDocument (const String& fileName, const String& parameters)
@@ -40,7 +40,7 @@
     them can be slower than just using a String directly, so the optimal way to use them
     is to keep some static Identifier objects for the things you use often.
 
-    @see NamedValueSet, ValueTree
+    @see JUCE_DECLARE_ID, NamedValueSet, ValueTree
 */
 class JUCE_API  Identifier
 {
@@ -138,5 +138,25 @@ private:
     String name;
 };
 
+//==============================================================================
+/** Declares a static Identifier constant whose name is the same as the variable's.
+
+    The string gets interned in the global StringPool once, while the program is
+    starting up, so using the constant later on costs no more than copying a pointer.
+
+    @code
+    namespace IDs
+    {
+        JUCE_DECLARE_ID (width);
+        JUCE_DECLARE_ID (height);
+    }
+
+    tree.setProperty (IDs::width, 100, nullptr);
+    @endcode
+
+    @see Identifier
+*/
+#define JUCE_DECLARE_ID(name)      static const juce::Identifier name (#name)
+
 
 #endif   // JUCE_IDENTIFIER_H_INCLUDED
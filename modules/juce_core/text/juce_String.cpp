@@ -183,7 +183,8 @@ public:
     }
 
     //==============================================================================
-    static CharPointerType makeUniqueWithByteSize (const CharPointerType text, size_t numBytes)
+    static CharPointerType makeUniqueWithByteSize (const CharPointerType text, size_t numBytes,
+                                                   const bool growGeometrically = false)
     {
         StringHolder* const b = bufferFromText (text);
 
@@ -194,8 +195,16 @@ public:
             return newText;
         }
 
-        if (b->allocatedNumBytes >= numBytes && b->refCount.get() <= 0)
-            return text;
+        if (b->refCount.get() <= 0)
+        {
+            if (b->allocatedNumBytes >= numBytes)
+                return text;
+
+            // If we own this string and it's being appended to, grow it geometrically so that
+            // repeatedly appending to it doesn't need to re-allocate it every time..
+            if (growGeometrically)
+                numBytes = jmax (numBytes, b->allocatedNumBytes + b->allocatedNumBytes / 2);
+        }
 
         CharPointerType newText (createUninitialisedBytes (jmax (b->allocatedNumBytes, numBytes)));
         memcpy (newText.getAddress(), text.getAddress(), b->allocatedNumBytes);
@@ -301,6 +310,11 @@ void String::preallocateBytes (const size_t numBytesNeeded)
     text = StringHolder::makeUniqueWithByteSize (text, numBytesNeeded + sizeof (CharPointerType::CharType));
 }
 
+void String::preallocateBytesForAppend (const size_t numBytesNeeded)
+{
+    text = StringHolder::makeUniqueWithByteSize (text, numBytesNeeded + sizeof (CharPointerType::CharType), true);
+}
+
 int String::getReferenceCount() const noexcept
 {
     return StringHolder::getReferenceCount (text);
@@ -758,7 +772,7 @@ void String::appendCharPointer (const CharPointerType startOfTextToAppend,
     if (extraBytesNeeded > 0)
     {
         const size_t byteOffsetOfNull = getByteOffsetOfEnd();
-        preallocateBytes (byteOffsetOfNull + (size_t) extraBytesNeeded);
+        preallocateBytesForAppend (byteOffsetOfNull + (size_t) extraBytesNeeded);
 
         CharPointerType::CharType* const newStringStart = addBytesToPointer (text.getAddress(), (int) byteOffsetOfNull);
         memcpy (newStringStart, startOfTextToAppend.getAddress(), (size_t) extraBytesNeeded);
@@ -2305,6 +2319,25 @@ public:
             expect (String ("abc foo bar").containsWholeWord ("abc") && String ("abc foo bar").containsWholeWord ("abc"));
         }
 
+        {
+            beginTest ("Preallocation");
+
+            typedef String::CharPointerType::CharType CharType;
+
+            String s ("abcd");
+            s.preallocateBytes (1000);
+            s.preallocateBytes (1001);
+            // an explicit request should only be rounded up for alignment, not grown
+            expect (StringHolder::getAllocatedNumBytes (s.getCharPointer()) >= 1001 + sizeof (CharType));
+            expect (StringHolder::getAllocatedNumBytes (s.getCharPointer()) <= 1008 + sizeof (CharType));
+
+            // appending needs to grow the string geometrically, or it'd be re-allocated every time
+            const size_t initialSize = StringHolder::getAllocatedNumBytes (s.getCharPointer());
+            s << String::repeatedString ("x", (int) (initialSize / sizeof (CharType)));
+            expect (StringHolder::getAllocatedNumBytes (s.getCharPointer()) >= initialSize + initialSize / 2);
+            expect (s.startsWith ("abcdxxx") && s.length() == 4 + (int) (initialSize / sizeof (CharType)));
+        }
+
         {
             beginTest ("Operations");
 
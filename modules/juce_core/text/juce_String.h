@@ -264,7 +264,7 @@ public:
         {
             const size_t byteOffsetOfNull = getByteOffsetOfEnd();
 
-            preallocateBytes (byteOffsetOfNull + extraBytesNeeded);
+            preallocateBytesForAppend (byteOffsetOfNull + extraBytesNeeded);
             CharPointerType (addBytesToPointer (text.getAddress(), (int) byteOffsetOfNull))
                 .writeWithCharLimit (startOfTextToAppend, (int) numChars);
         }
@@ -292,7 +292,7 @@ public:
             {
                 const size_t byteOffsetOfNull = getByteOffsetOfEnd();
 
-                preallocateBytes (byteOffsetOfNull + extraBytesNeeded);
+                preallocateBytesForAppend (byteOffsetOfNull + extraBytesNeeded);
                 CharPointerType (addBytesToPointer (text.getAddress(), (int) byteOffsetOfNull))
                     .writeWithCharLimit (textToAppend, (int) numChars);
             }
@@ -1260,6 +1260,7 @@ private:
 
     explicit String (const PreallocationBytes&); // This constructor preallocates a certain amount of memory
     size_t getByteOffsetOfEnd() const noexcept;
+    void preallocateBytesForAppend (size_t numBytesNeeded);
     JUCE_DEPRECATED (String (const String&, size_t));
 
     // This private cast operator should prevent strings being accidentally cast
@@ -0,0 +1,245 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+StringBuilder::StringBuilder() noexcept
+    : numBytesUsed (0), numBytesAllocated (0)
+{
+}
+
+StringBuilder::StringBuilder (const size_t initialNumBytesToAllocate)
+    : numBytesUsed (0), numBytesAllocated (0)
+{
+    preallocateBytes (initialNumBytesToAllocate);
+}
+
+StringBuilder::~StringBuilder() {}
+
+void StringBuilder::preallocateBytes (const size_t numBytesNeeded)
+{
+    if (numBytesNeeded > numBytesAllocated)
+    {
+        numBytesAllocated = jmax ((size_t) 64, (numBytesNeeded + 31) & ~(size_t) 31);
+
+        // (there's always space left after the end for a terminating null)
+        data.realloc (numBytesAllocated + sizeof (String::CharPointerType::CharType));
+    }
+}
+
+void StringBuilder::clear() noexcept
+{
+    numBytesUsed = 0;
+}
+
+String StringBuilder::toString() const
+{
+    if (numBytesUsed == 0)
+        return String();
+
+    getEnd().writeNull();
+    return String (String::CharPointerType (reinterpret_cast<String::CharPointerType::CharType*> (data.getData())), getEnd());
+}
+
+//==============================================================================
+void StringBuilder::append (const String::CharPointerType start, const String::CharPointerType end)
+{
+    const size_t numBytes = (size_t) getAddressDifference (end.getAddress(), start.getAddress());
+
+    if (numBytes > 0)
+    {
+        ensureSpace (numBytes);
+        memcpy (data + numBytesUsed, start.getAddress(), numBytes);
+        numBytesUsed += numBytes;
+    }
+}
+
+void StringBuilder::appendASCII (const char* const start, const size_t numChars)
+{
+   #if (JUCE_STRING_UTF_TYPE == 8)
+    ensureSpace (numChars);
+    memcpy (data + numBytesUsed, start, numChars);
+    numBytesUsed += numChars;
+   #else
+    ensureSpace (numChars * sizeof (String::CharPointerType::CharType));
+    getEnd().writeWithCharLimit (CharPointer_ASCII (start), (int) numChars + 1);
+    numBytesUsed += numChars * sizeof (String::CharPointerType::CharType);
+   #endif
+}
+
+void StringBuilder::appendCharacter (const juce_wchar character)
+{
+    if (character != 0)
+    {
+        ensureSpace (8);
+        String::CharPointerType end (getEnd());
+        end.write (character);
+        numBytesUsed = (size_t) getAddressDifference (end.getAddress(), data.getData());
+    }
+}
+
+void StringBuilder::appendNumber (const double number, const int numberOfDecimalPlaces)
+{
+    char buffer [NumberToStringConverters::charsNeededForDouble];
+    size_t len;
+    const char* const start = NumberToStringConverters::doubleToString (buffer, numElementsInArray (buffer),
+                                                                        number, numberOfDecimalPlaces, len);
+    appendASCII (start, len);
+}
+
+//==============================================================================
+template <typename IntegerType>
+static void appendInteger (StringBuilder& builder, const IntegerType number)
+{
+    char buffer [NumberToStringConverters::charsNeededForInt];
+    char* const end = buffer + numElementsInArray (buffer);
+    builder.appendCharPointer (CharPointer_ASCII (NumberToStringConverters::numberToString (end, number)));
+}
+
+StringBuilder& StringBuilder::operator<< (const String& s)
+{
+    const String::CharPointerType t (s.getCharPointer());
+    append (t, t.findTerminatingNull());
+    return *this;
+}
+
+StringBuilder& StringBuilder::operator<< (StringRef s)
+{
+    append (s.text, s.text.findTerminatingNull());
+    return *this;
+}
+
+StringBuilder& StringBuilder::operator<< (const char* const s)          { appendCharPointer (CharPointer_UTF8 (s)); return *this; }
+StringBuilder& StringBuilder::operator<< (const wchar_t* const s)       { appendCharPointer (castToCharPointer_wchar_t (s)); return *this; }
+StringBuilder& StringBuilder::operator<< (const char c)                 { appendCharacter ((juce_wchar) (uint8) c); return *this; }
+StringBuilder& StringBuilder::operator<< (const wchar_t c)              { appendCharacter ((juce_wchar) c); return *this; }
+StringBuilder& StringBuilder::operator<< (const NewLine&)               { appendASCII (NewLine::getDefault(), 2); return *this; }
+StringBuilder& StringBuilder::operator<< (const int number)             { appendInteger (*this, number); return *this; }
+StringBuilder& StringBuilder::operator<< (const unsigned int number)    { appendInteger (*this, number); return *this; }
+StringBuilder& StringBuilder::operator<< (const long number)            { appendInteger (*this, number); return *this; }
+StringBuilder& StringBuilder::operator<< (const unsigned long number)   { appendInteger (*this, number); return *this; }
+StringBuilder& StringBuilder::operator<< (const int64 number)           { appendInteger (*this, number); return *this; }
+StringBuilder& StringBuilder::operator<< (const uint64 number)          { appendInteger (*this, number); return *this; }
+StringBuilder& StringBuilder::operator<< (const float number)           { appendNumber ((double) number, 0); return *this; }
+StringBuilder& StringBuilder::operator<< (const double number)          { appendNumber (number, 0); return *this; }
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class StringBuilderTests  : public UnitTest
+{
+public:
+    StringBuilderTests() : UnitTest ("StringBuilder") {}
+
+    void runTest() override
+    {
+        beginTest ("Appending");
+        {
+            StringBuilder sb;
+            expect (sb.isEmpty() && sb.toString().isEmpty());
+
+            sb << "abc" << String ("def") << StringRef ("ghi") << L"jkl" << 'm' << L'n';
+            expectEquals (sb.toString(), String ("abcdefghijklmn"));
+
+            sb.clear();
+            sb << 123 << ' ' << -456 << ' ' << (int64) -9876543210LL << ' ' << (uint64) 18446744073709551615ULL
+               << ' ' << 1.5 << ' ' << 0.25f << ' ' << (unsigned int) 7 << ' ' << (long) -8;
+            expectEquals (sb.toString(), String ("123 -456 -9876543210 18446744073709551615 1.5 0.25 7 -8"));
+
+            sb.clear();
+            sb.appendNumber (3.14159, 2);
+            sb.appendCharacter (0x1f600);
+            sb.appendCharPointer (CharPointer_UTF8 ("\xc3\xa9"));
+            sb << newLine;
+
+            String expected (String (3.14159, 2));
+            expected << String::charToString (0x1f600) << String (CharPointer_UTF8 ("\xc3\xa9")) << newLine;
+            expectEquals (sb.toString(), expected);
+        }
+
+        beginTest ("Growth");
+        {
+            StringBuilder sb;
+            String reference;
+            Random r = getRandom();
+
+            for (int i = 0; i < 5000; ++i)
+            {
+                const String s (String::repeatedString ("x", r.nextInt (20)) + String (i));
+                sb << s;
+                reference << s;
+            }
+
+            expectEquals (sb.toString(), reference);
+            expect (sb.getNumBytes() == reference.getNumBytesAsUTF8());
+        }
+
+        beginTest ("Performance");
+        {
+            const int numItems = 20000;
+            const String item ("item");
+            double start = Time::getMillisecondCounterHiRes();
+
+            String s;
+
+            for (int i = 0; i < numItems; ++i)
+                s << item << i << ", ";
+
+            const double stringTime = Time::getMillisecondCounterHiRes() - start;
+            start = Time::getMillisecondCounterHiRes();
+
+            MemoryOutputStream mo;
+
+            for (int i = 0; i < numItems; ++i)
+                mo << item << i << ", ";
+
+            const String streamResult (mo.toString());
+            const double streamTime = Time::getMillisecondCounterHiRes() - start;
+            start = Time::getMillisecondCounterHiRes();
+
+            StringBuilder sb;
+
+            for (int i = 0; i < numItems; ++i)
+                sb << item << i << ", ";
+
+            const String builderResult (sb.toString());
+            const double builderTime = Time::getMillisecondCounterHiRes() - start;
+
+            expectEquals (builderResult, s);
+            expectEquals (streamResult, s);
+
+            logMessage ("Appending " + String (numItems * 3) + " items: String " + String (stringTime, 2)
+                          + "ms, MemoryOutputStream " + String (streamTime, 2)
+                          + "ms, StringBuilder " + String (builderTime, 2) + "ms");
+        }
+    }
+};
+
+static StringBuilderTests stringBuilderTests;
+
+#endif
@@ -0,0 +1,171 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+#ifndef JUCE_STRINGBUILDER_H_INCLUDED
+#define JUCE_STRINGBUILDER_H_INCLUDED
+
+
+//==============================================================================
+/**
+    Assembles a String from many smaller pieces of text.
+
+    Each time you append something to a String with += or <<, it has to scan the existing
+    text to find its end, and may need to re-allocate it. When a long string is being built
+    up out of lots of small pieces (e.g. when writing out a log, some XML or some JSON),
+    a StringBuilder is much faster: it keeps track of where the text ends, writes everything
+    into a single buffer which grows geometrically, and only creates a String when you
+    call toString().
+
+    @code
+    StringBuilder sb;
+
+    for (int i = 0; i < items.size(); ++i)
+        sb << items[i].name << " = " << items[i].value << newLine;
+
+    const String result (sb.toString());
+    @endcode
+
+    If you call clear() and re-use a builder, it keeps its buffer, so it can go on creating
+    strings without needing to allocate any more memory for the text.
+
+    @see String, MemoryOutputStream
+*/
+class JUCE_API  StringBuilder
+{
+public:
+    //==============================================================================
+    /** Creates an empty builder. */
+    StringBuilder() noexcept;
+
+    /** Creates an empty builder, with space for a given number of bytes of text
+        already allocated.
+    */
+    explicit StringBuilder (size_t initialNumBytesToAllocate);
+
+    /** Destructor. */
+    ~StringBuilder();
+
+    //==============================================================================
+    /** Appends a string. */
+    StringBuilder& operator<< (const String&);
+    /** Appends a string. */
+    StringBuilder& operator<< (StringRef);
+    /** Appends a null-terminated UTF-8 string. */
+    StringBuilder& operator<< (const char*);
+    /** Appends a null-terminated wide-character string. */
+    StringBuilder& operator<< (const wchar_t*);
+    /** Appends a character. */
+    StringBuilder& operator<< (char);
+    /** Appends a character. */
+    StringBuilder& operator<< (wchar_t);
+    /** Appends the default new-line sequence. */
+    StringBuilder& operator<< (const NewLine&);
+    /** Appends the decimal representation of a number. */
+    StringBuilder& operator<< (int);
+    /** Appends the decimal representation of a number. */
+    StringBuilder& operator<< (unsigned int);
+    /** Appends the decimal representation of a number. */
+    StringBuilder& operator<< (long);
+    /** Appends the decimal representation of a number. */
+    StringBuilder& operator<< (unsigned long);
+    /** Appends the decimal representation of a number. */
+    StringBuilder& operator<< (int64);
+    /** Appends the decimal representation of a number. */
+    StringBuilder& operator<< (uint64);
+    /** Appends a number, in the same format that String (float) would produce. */
+    StringBuilder& operator<< (float);
+    /** Appends a number, in the same format that String (double) would produce. */
+    StringBuilder& operator<< (double);
+
+    /** Appends a unicode character. */
+    void appendCharacter (juce_wchar character);
+
+    /** Appends a number with a given number of decimal places, in the same format that
+        String (double, int) would produce.
+    */
+    void appendNumber (double number, int numberOfDecimalPlaces);
+
+    /** Appends a range of characters. */
+    void append (String::CharPointerType start, String::CharPointerType end);
+
+    /** Appends a null-terminated string in any of the supported encodings. */
+    template <class CharPointer>
+    void appendCharPointer (const CharPointer text)
+    {
+        if (text.getAddress() != nullptr)
+        {
+            const size_t numBytes = String::CharPointerType::getBytesRequiredFor (text);
+            ensureSpace (numBytes);
+            getEnd().writeAll (text);
+            numBytesUsed += numBytes;
+        }
+    }
+
+    //==============================================================================
+    /** Creates a String containing all the text that has been appended. */
+    String toString() const;
+
+    /** Returns true if nothing has been appended. */
+    bool isEmpty() const noexcept                           { return numBytesUsed == 0; }
+
+    /** Returns the size of the text, in bytes (not including a null terminator). */
+    size_t getNumBytes() const noexcept                     { return numBytesUsed; }
+
+    /** Removes all the text, but keeps the memory that was allocated, so that the
+        builder can be re-used without needing to allocate any more.
+    */
+    void clear() noexcept;
+
+    /** Makes sure that the buffer has space for at least this many bytes of text. */
+    void preallocateBytes (size_t numBytesNeeded);
+
+private:
+    //==============================================================================
+    HeapBlock<char> data;
+    size_t numBytesUsed, numBytesAllocated;
+
+    String::CharPointerType getEnd() const noexcept
+    {
+        return String::CharPointerType (reinterpret_cast<String::CharPointerType::CharType*> (data + numBytesUsed));
+    }
+
+    void ensureSpace (const size_t numExtraBytes)
+    {
+        if (numBytesUsed + numExtraBytes > numBytesAllocated)
+            preallocateBytes (jmax (numBytesUsed + numExtraBytes, numBytesAllocated * 2));
+    }
+
+    void appendASCII (const char* start, size_t numChars);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StringBuilder)
+};
+
+
+#endif   // JUCE_STRINGBUILDER_H_INCLUDED
@@ -31,10 +31,6 @@
 static const int minNumberOfStringsForGarbageCollection = 300;
 static const uint32 garbageCollectionInterval = 30000;
 
-
-StringPool::StringPool() noexcept  : lastGarbageCollectionTime (0) {}
-StringPool::~StringPool() {}
-
 struct StartEndString
 {
     StartEndString (String::CharPointerType s, String::CharPointerType e) noexcept : start (s), end (e) {}
@@ -63,44 +59,111 @@ static int compareStrings (const StartEndString& string1, const String& string2)
     return 0;
 }
 
-template <typename NewStringType>
-static String addPooledString (Array<String>& strings, const NewStringType& newString)
+//==============================================================================
+// Each shard is a simple open-addressed hash table with its own lock. The strings are
+// spread across the shards using the top bits of their hashes, so threads that are
+// adding different strings will very rarely need the same lock.
+struct StringPool::Shard
 {
-    int start = 0;
-    int end = strings.size();
+    Shard() noexcept  : numStrings (0), lastGarbageCollectionTime (0) {}
+
+    enum { minNumSlots = 16 };
 
-    while (start < end)
+    template <typename NewStringType>
+    String getPooledString (const NewStringType& newString, const uint32 hash)
     {
-        const String& startString = strings.getReference (start);
-        const int startComp = compareStrings (newString, startString);
+        const ScopedLock sl (lock);
 
-        if (startComp == 0)
-            return startString;
+        if (numStrings > minNumberOfStringsForGarbageCollection / numShards
+             && Time::getApproximateMillisecondCounter() > lastGarbageCollectionTime + garbageCollectionInterval)
+            removeUnusedStrings();
 
-        const int halfway = (start + end) / 2;
+        if ((numStrings + 1) * 4 > slots.size() * 3)
+            rebuild (jmax ((int) minNumSlots, slots.size() * 2), false);
 
-        if (halfway == start)
+        const int index = findSlot (newString, hash);
+        String& s = slots.getReference (index);
+
+        if (s.isEmpty())
         {
-            if (startComp > 0)
-                ++start;
+            s = newString;
+            hashes.set (index, hash);
+            ++numStrings;
+        }
 
-            break;
+        return s;
+    }
+
+    void removeUnusedStrings()
+    {
+        rebuild (slots.size(), true);
+        lastGarbageCollectionTime = Time::getApproximateMillisecondCounter();
+    }
+
+    template <typename NewStringType>
+    int findSlot (const NewStringType& newString, const uint32 hash) const noexcept
+    {
+        const int mask = slots.size() - 1;
+
+        for (int i = (int) (hash & (uint32) mask);; i = (i + 1) & mask)
+        {
+            const String& s = slots.getReference (i);
+
+            if (s.isEmpty() || (hashes.getUnchecked (i) == hash && compareStrings (newString, s) == 0))
+                return i;
         }
+    }
+
+    void rebuild (const int newNumSlots, const bool removeUnreferencedStrings)
+    {
+        jassert (isPowerOfTwo (newNumSlots));
 
-        const String& halfwayString = strings.getReference (halfway);
-        const int halfwayComp = compareStrings (newString, halfwayString);
+        Array<String> oldSlots;
+        Array<uint32> oldHashes;
+        oldSlots.swapWith (slots);
+        oldHashes.swapWith (hashes);
 
-        if (halfwayComp == 0)
-            return halfwayString;
+        slots.insertMultiple (0, String(), newNumSlots);
+        hashes.insertMultiple (0, 0, newNumSlots);
+        numStrings = 0;
 
-        if (halfwayComp > 0)
-            start = halfway;
-        else
-            end = halfway;
+        for (int i = 0; i < oldSlots.size(); ++i)
+        {
+            const String& s = oldSlots.getReference (i);
+
+            if (s.isNotEmpty() && ! (removeUnreferencedStrings && s.getReferenceCount() == 1))
+            {
+                const uint32 hash = oldHashes.getUnchecked (i);
+                const int index = findSlot (s, hash);
+                slots.setUnchecked (index, s);
+                hashes.setUnchecked (index, hash);
+                ++numStrings;
+            }
+        }
     }
 
-    strings.insert (start, newString);
-    return strings.getReference (start);
+    CriticalSection lock;
+    Array<String> slots;
+    Array<uint32> hashes;
+    int numStrings;
+    uint32 lastGarbageCollectionTime;
+
+    JUCE_DECLARE_NON_COPYABLE (Shard)
+};
+
+//==============================================================================
+StringPool::StringPool() noexcept
+{
+    for (int i = 0; i < numShards; ++i)
+        shards.add (new Shard());
+}
+
+StringPool::~StringPool() {}
+
+template <typename NewStringType>
+String StringPool::addPooledString (const NewStringType& newString, const uint32 hash)
+{
+    return shards.getUnchecked ((int) (hash >> 28))->getPooledString (newString, hash);
 }
 
 String StringPool::getPooledString (const char* const newString)
@@ -108,9 +171,8 @@ String StringPool::getPooledString (const char* const newString)
     if (newString == nullptr || *newString == 0)
         return String();
 
-    const ScopedLock sl (lock);
-    garbageCollectIfNeeded();
-    return addPooledString (strings, CharPointer_UTF8 (newString));
+    const CharPointer_UTF8 text (newString);
+    return addPooledString (text, DefaultFlatHashFunctions::hashCharacters (text));
 }
 
 String StringPool::getPooledString (String::CharPointerType start, String::CharPointerType end)
@@ -118,9 +180,7 @@ String StringPool::getPooledString (String::CharPointerType start, String::CharP
     if (start.isEmpty() || start == end)
         return String();
 
-    const ScopedLock sl (lock);
-    garbageCollectIfNeeded();
-    return addPooledString (strings, StartEndString (start, end));
+    return addPooledString (StartEndString (start, end), DefaultFlatHashFunctions::hashCharacters (start, end));
 }
 
 String StringPool::getPooledString (StringRef newString)
@@ -128,9 +188,7 @@ String StringPool::getPooledString (StringRef newString)
     if (newString.isEmpty())
         return String();
 
-    const ScopedLock sl (lock);
-    garbageCollectIfNeeded();
-    return addPooledString (strings, newString.text);
+    return addPooledString (newString.text, DefaultFlatHashFunctions::hashCharacters (newString.text));
 }
 
 String StringPool::getPooledString (const String& newString)
@@ -138,27 +196,17 @@ String StringPool::getPooledString (const String& newString)
     if (newString.isEmpty())
         return String();
 
-    const ScopedLock sl (lock);
-    garbageCollectIfNeeded();
-    return addPooledString (strings, newString);
-}
-
-void StringPool::garbageCollectIfNeeded()
-{
-    if (strings.size() > minNumberOfStringsForGarbageCollection
-         && Time::getApproximateMillisecondCounter() > lastGarbageCollectionTime + garbageCollectionInterval)
-        garbageCollect();
+    return addPooledString (newString, DefaultFlatHashFunctions::hashCharacters (newString.getCharPointer()));
 }
 
 void StringPool::garbageCollect()
 {
-    const ScopedLock sl (lock);
-
-    for (int i = strings.size(); --i >= 0;)
-        if (strings.getReference(i).getReferenceCount() == 1)
-            strings.remove (i);
-
-    lastGarbageCollectionTime = Time::getApproximateMillisecondCounter();
+    for (int i = 0; i < numShards; ++i)
+    {
+        Shard& shard = *shards.getUnchecked (i);
+        const ScopedLock sl (shard.lock);
+        shard.removeUnusedStrings();
+    }
 }
 
 StringPool& StringPool::getGlobalPool() noexcept
@@ -166,3 +214,95 @@ StringPool& StringPool::getGlobalPool() noexcept
     static StringPool pool;
     return pool;
 }
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class StringPoolTests  : public UnitTest
+{
+public:
+    StringPoolTests() : UnitTest ("StringPool") {}
+
+    struct PoolingThread  : public Thread
+    {
+        PoolingThread (StringPool& p, const StringArray& names)
+            : Thread ("pool tester"), pool (p), strings (names)
+        {
+        }
+
+        void run() override
+        {
+            for (int repeat = 0; repeat < 20; ++repeat)
+                for (int i = 0; i < strings.size(); ++i)
+                    pooled.set (i, pool.getPooledString (strings[i]));
+        }
+
+        StringPool& pool;
+        const StringArray& strings;
+        Array<String> pooled;
+    };
+
+    void runTest() override
+    {
+        beginTest ("Pooling");
+        {
+            StringPool pool;
+            const String abc (pool.getPooledString ("abc"));
+
+            expect (abc == "abc");
+            expect (pool.getPooledString (String ("abc")).getCharPointer() == abc.getCharPointer());
+            expect (pool.getPooledString (StringRef ("abc")).getCharPointer() == abc.getCharPointer());
+
+            const String abcdef ("abcdef");
+            expect (pool.getPooledString (abcdef.getCharPointer(), abcdef.getCharPointer() + 3).getCharPointer()
+                      == abc.getCharPointer());
+
+            expect (pool.getPooledString ("abd").getCharPointer() != abc.getCharPointer());
+            expect (pool.getPooledString ("").isEmpty());
+        }
+
+        beginTest ("Garbage collection");
+        {
+            StringPool pool;
+            const String kept (pool.getPooledString ("kept"));
+
+            for (int i = 0; i < 2000; ++i)
+                pool.getPooledString ("temp" + String (i));
+
+            pool.garbageCollect();
+
+            expect (pool.getPooledString ("kept").getCharPointer() == kept.getCharPointer());
+            expect (pool.getPooledString ("temp1") == "temp1");
+        }
+
+        beginTest ("Multiple threads");
+        {
+            StringArray names;
+
+            for (int i = 0; i < 3000; ++i)
+                names.add ("identifier_" + String (i));
+
+            StringPool pool;
+            OwnedArray<PoolingThread> threads;
+
+            for (int i = 0; i < 4; ++i)
+                threads.add (new PoolingThread (pool, names))->startThread();
+
+            for (int i = 0; i < threads.size(); ++i)
+                threads.getUnchecked (i)->waitForThreadToExit (-1);
+
+            for (int i = 0; i < names.size(); ++i)
+            {
+                const String s (pool.getPooledString (names[i]));
+                expect (s == names[i]);
+
+                for (int j = 0; j < threads.size(); ++j)
+                    expect (threads.getUnchecked (j)->pooled[i].getCharPointer() == s.getCharPointer());
+            }
+        }
+    }
+};
+
+static StringPoolTests stringPoolTests;
+
+#endif
@@ -42,6 +42,10 @@
     is returned every time a matching string is asked for. This means that it's trivial to
     compare two pooled strings for equality, as you can simply compare their pointers. It
     also cuts down on storage if you're using many copies of the same string.
+
+    The pool is split into a number of independently-locked hash tables, chosen by each
+    string's hash, so many threads can add strings to it at the same time (e.g. when
+    several XML documents are being parsed in parallel) without waiting for each other.
 */
 class JUCE_API  StringPool
 {
@@ -85,11 +89,12 @@ public:
     static StringPool& getGlobalPool() noexcept;
 
 private:
-    Array<String> strings;
-    CriticalSection lock;
-    uint32 lastGarbageCollectionTime;
+    struct Shard;
+    enum { numShards = 16 };
+    OwnedArray<Shard> shards;
 
-    void garbageCollectIfNeeded();
+    template <typename NewStringType>
+    String addPooledString (const NewStringType&, uint32 hash);
 
     JUCE_DECLARE_NON_COPYABLE (StringPool)
 };
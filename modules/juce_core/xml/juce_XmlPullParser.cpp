@@ -0,0 +1,1036 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+namespace XmlPullParserHelpers
+{
+    static bool isWhitespace (const char c) noexcept
+    {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    static bool isNameChar (const char c) noexcept
+    {
+        // (any non-ascii bytes are assumed to be part of a multi-byte UTF-8 name character)
+        return (uint8) c >= 0x80 || XmlIdentifierChars::isIdentifierChar ((juce_wchar) (uint8) c);
+    }
+
+    static const char* findSequence (const char* start, const char* const end,
+                                     const char* const sequence, const size_t length) noexcept
+    {
+        while (start + length <= end)
+        {
+            const char* const found = static_cast<const char*> (memchr (start, sequence[0], (size_t) (end - start)));
+
+            if (found == nullptr || found + length > end)
+                break;
+
+            if (memcmp (found, sequence, length) == 0)
+                return found;
+
+            start = found + 1;
+        }
+
+        return nullptr;
+    }
+
+    static bool containsChar (const char* start, const char* const end, const char c) noexcept
+    {
+        return memchr (start, c, (size_t) (end - start)) != nullptr;
+    }
+}
+
+//==============================================================================
+String XmlPullParser::TextView::toString() const
+{
+    if (isEmpty())
+        return String();
+
+    return String::fromUTF8 (start, (int) getNumBytes());
+}
+
+bool XmlPullParser::TextView::operator== (StringRef other) const noexcept
+{
+    CharPointer_UTF8 t (start);
+    String::CharPointerType o (other.text);
+
+    while (t.getAddress() < end)
+        if (t.getAndAdvance() != o.getAndAdvance())
+            return false;
+
+    return o.isEmpty();
+}
+
+bool XmlPullParser::TextView::operator!= (StringRef other) const noexcept
+{
+    return ! operator== (other);
+}
+
+//==============================================================================
+XmlPullParser::XmlPullParser (const void* const data, const size_t numBytes)
+    : stream (nullptr), bufferSize (0),
+      position (static_cast<const char*> (data)),
+      dataEnd (static_cast<const char*> (data) + numBytes)
+{
+    initialise();
+}
+
+XmlPullParser::XmlPullParser (InputStream& source, const size_t bufferSizeToUse)
+    : stream (&source), bufferSize (jmax ((size_t) 256, bufferSizeToUse)),
+      position (nullptr), dataEnd (nullptr)
+{
+    buffer.malloc (bufferSize);
+    position = dataEnd = buffer;
+    initialise();
+}
+
+XmlPullParser::XmlPullParser (const File& file)
+    : stream (nullptr), bufferSize (0), position (nullptr), dataEnd (nullptr)
+{
+    mappedFile = new MemoryMappedFile (file, MemoryMappedFile::readOnly);
+
+    if (mappedFile->getData() != nullptr)
+    {
+        position = static_cast<const char*> (mappedFile->getData());
+        dataEnd = position + mappedFile->getSize();
+    }
+    else
+    {
+        mappedFile = nullptr;
+        ownedStream = file.createInputStream();
+
+        if (ownedStream != nullptr)
+        {
+            stream = ownedStream;
+            bufferSize = 65536;
+            buffer.malloc (bufferSize);
+            position = dataEnd = buffer;
+        }
+    }
+
+    initialise();
+}
+
+XmlPullParser::~XmlPullParser() {}
+
+void XmlPullParser::initialise()
+{
+    currentEvent = startOfDocument;
+    textNeedsDecoding = false;
+    pendingEndElement = false;
+    ignoreEmptyText = true;
+    atStartOfData = true;
+    hasFoundElement = false;
+    openTagNamesSize = 0;
+}
+
+//==============================================================================
+XmlPullParser::EventType XmlPullParser::next()
+{
+    if (currentEvent == endOfDocument || currentEvent == parseError)
+        return currentEvent;
+
+    attributes.clearQuick();
+    textContent = TextView();
+
+    if (pendingEndElement)
+    {
+        // (the name is still the one from the self-closing start tag)
+        pendingEndElement = false;
+        popOpenTag();
+        return currentEvent = endElement;
+    }
+
+    for (;;)
+    {
+        const char* const tokenStart = position;
+        const TokenResult result = readNextToken();
+
+        if (result == tokenFound || result == tokenError)
+            return currentEvent;
+
+        if (result == needMoreData)
+        {
+            // The token runs off the end of the data that's available, so go back to
+            // its start, and try again after getting some more..
+            position = tokenStart;
+            attributes.clearQuick();
+
+            if (! readMoreData())
+                return reachedEndOfData();
+        }
+    }
+}
+
+bool XmlPullParser::readMoreData()
+{
+    if (stream == nullptr)
+        return false;
+
+    const size_t bytesLeft = (size_t) (dataEnd - position);
+    memmove (buffer, position, bytesLeft);
+
+    // If a single token is bigger than the whole buffer, it'll need to grow..
+    if (bytesLeft >= bufferSize)
+    {
+        bufferSize *= 2;
+        buffer.realloc (bufferSize);
+    }
+
+    position = buffer;
+    dataEnd = buffer + bytesLeft;
+
+    const int bytesRead = stream->read (buffer + bytesLeft, (int) (bufferSize - bytesLeft));
+
+    if (bytesRead <= 0)
+        return false;
+
+    dataEnd += bytesRead;
+    return true;
+}
+
+XmlPullParser::EventType XmlPullParser::reachedEndOfData()
+{
+    for (const char* p = position; p < dataEnd; ++p)
+    {
+        if (! XmlPullParserHelpers::isWhitespace (*p))
+        {
+            setError ("unexpected end of input");
+            return currentEvent;
+        }
+    }
+
+    if (getDepth() > 0)
+        setError ("unmatched tags");
+    else if (! hasFoundElement)
+        setError ("no document element found");
+    else
+        currentEvent = endOfDocument;
+
+    position = dataEnd;
+    return currentEvent;
+}
+
+XmlPullParser::TokenResult XmlPullParser::setError (const String& description)
+{
+    lastError = description;
+    currentEvent = parseError;
+    return tokenError;
+}
+
+//==============================================================================
+void XmlPullParser::pushOpenTag (const TextView tagName)
+{
+    const size_t newSize = openTagNamesSize + tagName.getNumBytes();
+
+    if (newSize > openTagNames.getSize())
+        openTagNames.setSize (jmax (newSize, openTagNames.getSize() * 2, (size_t) 256));
+
+    memcpy (addBytesToPointer (openTagNames.getData(), openTagNamesSize), tagName.start, tagName.getNumBytes());
+    openTagStarts.add ((int) openTagNamesSize);
+    openTagNamesSize = newSize;
+}
+
+void XmlPullParser::popOpenTag() noexcept
+{
+    openTagNamesSize = (size_t) openTagStarts.getLast();
+    openTagStarts.removeLast();
+}
+
+XmlPullParser::TextView XmlPullParser::getInnermostOpenTag() const noexcept
+{
+    const char* const names = static_cast<const char*> (openTagNames.getData());
+    return TextView (names + openTagStarts.getLast(), names + openTagNamesSize);
+}
+
+//==============================================================================
+XmlPullParser::TokenResult XmlPullParser::readNextToken()
+{
+    if (atStartOfData)
+    {
+        if (dataEnd - position < 3 && stream != nullptr)
+            return needMoreData;
+
+        if (dataEnd - position >= 3 && CharPointer_UTF8::isByteOrderMark (position))
+            position += 3;
+
+        atStartOfData = false;
+    }
+
+    if (position >= dataEnd)
+        return needMoreData;
+
+    if (*position != '<')
+        return readText();
+
+    if (dataEnd - position < 4)
+        return needMoreData;
+
+    const char c = position[1];
+
+    if (c == '/')
+        return readEndTag();
+
+    if (c == '?')
+        return skipPast (position + 2, "?>", 2);
+
+    if (c == '!')
+    {
+        if (position[2] == '-' && position[3] == '-')
+            return skipPast (position + 4, "-->", 3);
+
+        if (dataEnd - position < 9)
+            return needMoreData;
+
+        if (memcmp (position + 2, "[CDATA[", 7) == 0)
+            return readCDATA();
+
+        return skipDTD();
+    }
+
+    return readStartTag();
+}
+
+XmlPullParser::TokenResult XmlPullParser::readStartTag()
+{
+    using namespace XmlPullParserHelpers;
+
+    const char* p = position + 1;
+    const char* const nameStart = p;
+
+    while (p < dataEnd && isNameChar (*p))
+        ++p;
+
+    if (p >= dataEnd)
+        return needMoreData;
+
+    if (p == nameStart)
+        return setError ("tag name missing");
+
+    if (getDepth() == 0 && hasFoundElement)
+        return setError ("found more than one document element");
+
+    const TextView tagName (nameStart, p);
+    bool isSelfClosing = false;
+
+    for (;;)
+    {
+        while (p < dataEnd && isWhitespace (*p))
+            ++p;
+
+        if (p >= dataEnd)
+            return needMoreData;
+
+        const char c = *p;
+
+        if (c == '>')
+        {
+            ++p;
+            break;
+        }
+
+        if (c == '/')
+        {
+            if (p + 1 >= dataEnd)
+                return needMoreData;
+
+            if (p[1] != '>')
+                return setError ("illegal character found in " + tagName.toString() + ": '/'");
+
+            p += 2;
+            isSelfClosing = true;
+            break;
+        }
+
+        if (! isNameChar (c))
+            return setError ("illegal character found in " + tagName.toString() + ": '" + c + "'");
+
+        Attribute att;
+        att.name.start = p;
+
+        while (p < dataEnd && isNameChar (*p))
+            ++p;
+
+        att.name.end = p;
+
+        while (p < dataEnd && isWhitespace (*p))
+            ++p;
+
+        if (p >= dataEnd)
+            return needMoreData;
+
+        if (*p != '=')
+            return setError ("expected '=' after attribute '" + att.name.toString() + "'");
+
+        ++p;
+
+        while (p < dataEnd && isWhitespace (*p))
+            ++p;
+
+        if (p >= dataEnd)
+            return needMoreData;
+
+        const char quote = *p;
+
+        if (quote != '"' && quote != '\'')
+            return setError ("expected a quoted value for attribute '" + att.name.toString() + "'");
+
+        att.value.start = ++p;
+        att.value.end = static_cast<const char*> (memchr (p, quote, (size_t) (dataEnd - p)));
+
+        if (att.value.end == nullptr)
+            return needMoreData;
+
+        att.needsDecoding = containsChar (att.value.start, att.value.end, '&')
+                             || containsChar (att.value.start, att.value.end, '\r');
+        attributes.add (att);
+        p = att.value.end + 1;
+    }
+
+    position = p;
+    name = tagName;
+    pushOpenTag (tagName);
+    hasFoundElement = true;
+    pendingEndElement = isSelfClosing;
+    currentEvent = startElement;
+    return tokenFound;
+}
+
+XmlPullParser::TokenResult XmlPullParser::readEndTag()
+{
+    using namespace XmlPullParserHelpers;
+
+    const char* p = position + 2;
+    const char* const nameStart = p;
+
+    while (p < dataEnd && isNameChar (*p))
+        ++p;
+
+    const TextView tagName (nameStart, p);
+
+    while (p < dataEnd && isWhitespace (*p))
+        ++p;
+
+    if (p >= dataEnd)
+        return needMoreData;
+
+    if (*p != '>')
+        return setError ("illegal character found in end tag: '" + String::charToString ((juce_wchar) (uint8) *p) + "'");
+
+    if (getDepth() == 0)
+        return setError ("unexpected end tag: </" + tagName.toString() + ">");
+
+    const TextView expected (getInnermostOpenTag());
+
+    if (tagName.getNumBytes() != expected.getNumBytes()
+         || memcmp (tagName.start, expected.start, tagName.getNumBytes()) != 0)
+        return setError ("mismatched end tag: expected </" + expected.toString() + ">, but found </" + tagName.toString() + ">");
+
+    position = p + 1;
+    name = tagName;
+    popOpenTag();
+    currentEvent = endElement;
+    return tokenFound;
+}
+
+XmlPullParser::TokenResult XmlPullParser::readText()
+{
+    using namespace XmlPullParserHelpers;
+
+    const char* const start = position;
+    const char* const end = static_cast<const char*> (memchr (start, '<', (size_t) (dataEnd - start)));
+
+    if (end == nullptr)
+        return needMoreData;
+
+    bool isAllWhitespace = true;
+
+    for (const char* p = start; p < end; ++p)
+    {
+        if (! isWhitespace (*p))
+        {
+            isAllWhitespace = false;
+            break;
+        }
+    }
+
+    position = end;
+
+    if (getDepth() == 0)
+        return isAllWhitespace ? tokenSkipped
+                               : setError ("text found outside the document element");
+
+    if (isAllWhitespace && ignoreEmptyText)
+        return tokenSkipped;
+
+    textContent = TextView (start, end);
+    textNeedsDecoding = containsChar (start, end, '&') || containsChar (start, end, '\r');
+    currentEvent = text;
+    return tokenFound;
+}
+
+XmlPullParser::TokenResult XmlPullParser::readCDATA()
+{
+    const char* const start = position + 9;
+    const char* const end = XmlPullParserHelpers::findSequence (start, dataEnd, "]]>", 3);
+
+    if (end == nullptr)
+        return needMoreData;
+
+    if (getDepth() == 0)
+        return setError ("CDATA found outside the document element");
+
+    position = end + 3;
+    textContent = TextView (start, end);
+    textNeedsDecoding = false;
+    currentEvent = text;
+    return tokenFound;
+}
+
+XmlPullParser::TokenResult XmlPullParser::skipPast (const char* const start, const char* const terminator,
+                                                    const size_t terminatorLength)
+{
+    const char* const found = XmlPullParserHelpers::findSequence (start, dataEnd, terminator, terminatorLength);
+
+    if (found == nullptr)
+        return needMoreData;
+
+    position = found + terminatorLength;
+    return tokenSkipped;
+}
+
+XmlPullParser::TokenResult XmlPullParser::skipDTD()
+{
+    // (this needs to step over any internal subset in square brackets, which can
+    // contain '>' characters, as can any quoted strings)
+    int bracketDepth = 0;
+    char quote = 0;
+
+    for (const char* p = position + 2; p < dataEnd; ++p)
+    {
+        const char c = *p;
+
+        if (quote != 0)
+        {
+            if (c == quote)
+                quote = 0;
+        }
+        else if (c == '"' || c == '\'')  quote = c;
+        else if (c == '[')               ++bracketDepth;
+        else if (c == ']')               --bracketDepth;
+        else if (c == '>' && bracketDepth <= 0)
+        {
+            position = p + 1;
+            return tokenSkipped;
+        }
+    }
+
+    return needMoreData;
+}
+
+//==============================================================================
+XmlPullParser::TextView XmlPullParser::getAttributeName (const int index) const noexcept
+{
+    if (isPositiveAndBelow (index, attributes.size()))
+        return attributes.getReference (index).name;
+
+    jassertfalse;
+    return TextView();
+}
+
+XmlPullParser::TextView XmlPullParser::getRawAttributeValue (const int index) const noexcept
+{
+    if (isPositiveAndBelow (index, attributes.size()))
+        return attributes.getReference (index).value;
+
+    jassertfalse;
+    return TextView();
+}
+
+String XmlPullParser::getAttributeValue (const int index) const
+{
+    if (isPositiveAndBelow (index, attributes.size()))
+    {
+        const Attribute& att = attributes.getReference (index);
+        return decodeText (att.value, att.needsDecoding);
+    }
+
+    jassertfalse;
+    return String();
+}
+
+String XmlPullParser::getAttributeValue (StringRef attributeName, const String& defaultReturnValue) const
+{
+    const int index = indexOfAttribute (attributeName);
+    return index >= 0 ? getAttributeValue (index) : defaultReturnValue;
+}
+
+int XmlPullParser::indexOfAttribute (StringRef attributeName) const noexcept
+{
+    for (int i = 0; i < attributes.size(); ++i)
+        if (attributes.getReference (i).name == attributeName)
+            return i;
+
+    return -1;
+}
+
+String XmlPullParser::getText() const
+{
+    return decodeText (textContent, textNeedsDecoding);
+}
+
+static bool decodeXmlEntity (const char* p, const char* const end, juce_wchar& result) noexcept
+{
+    const size_t length = (size_t) (end - p);
+
+    if (length == 3 && memcmp (p, "amp", 3) == 0)   { result = '&';  return true; }
+    if (length == 2 && memcmp (p, "lt", 2) == 0)    { result = '<';  return true; }
+    if (length == 2 && memcmp (p, "gt", 2) == 0)    { result = '>';  return true; }
+    if (length == 4 && memcmp (p, "quot", 4) == 0)  { result = '"';  return true; }
+    if (length == 4 && memcmp (p, "apos", 4) == 0)  { result = '\''; return true; }
+
+    if (length < 2 || *p != '#')
+        return false;
+
+    uint32 charCode = 0;
+
+    if (p[1] == 'x' || p[1] == 'X')
+    {
+        if (length < 3 || length > 10)
+            return false;
+
+        for (p += 2; p < end; ++p)
+        {
+            const int digit = CharacterFunctions::getHexDigitValue ((juce_wchar) (uint8) *p);
+
+            if (digit < 0)
+                return false;
+
+            charCode = (charCode << 4) | (uint32) digit;
+        }
+    }
+    else
+    {
+        if (length > 11)
+            return false;
+
+        for (++p; p < end; ++p)
+        {
+            if (*p < '0' || *p > '9')
+                return false;
+
+            charCode = charCode * 10 + (uint32) (*p - '0');
+        }
+    }
+
+    result = (juce_wchar) charCode;
+    return charCode != 0;
+}
+
+String XmlPullParser::decodeText (const TextView source, const bool needsDecoding)
+{
+    if (! needsDecoding)
+        return source.toString();
+
+    MemoryOutputStream out (source.getNumBytes());
+    const char* p = source.start;
+
+    while (p < source.end)
+    {
+        const char c = *p;
+
+        if (c == '\r')
+        {
+            // (line-breaks are normalised to a single '\n', as required by the XML spec)
+            out.writeByte ('\n');
+
+            if (++p < source.end && *p == '\n')
+                ++p;
+
+            continue;
+        }
+
+        if (c == '&')
+        {
+            if (const char* const semiColon = static_cast<const char*> (memchr (p, ';', (size_t) (source.end - p))))
+            {
+                juce_wchar character;
+
+                if (decodeXmlEntity (p + 1, semiColon, character))
+                {
+                    out.appendUTF8Char (character);
+                    p = semiColon + 1;
+                    continue;
+                }
+            }
+        }
+
+        const char* runEnd = p + 1;
+
+        while (runEnd < source.end && *runEnd != '&' && *runEnd != '\r')
+            ++runEnd;
+
+        out.write (p, (size_t) (runEnd - p));
+        p = runEnd;
+    }
+
+    return out.toUTF8();
+}
+
+//==============================================================================
+void XmlPullParser::skipElement()
+{
+    // this must be called when the parser is positioned at the start of an element!
+    jassert (currentEvent == startElement);
+
+    if (currentEvent == startElement)
+    {
+        const int depth = getDepth();
+
+        while (getDepth() >= depth)
+        {
+            const EventType e = next();
+
+            if (e == endOfDocument || e == parseError)
+                break;
+        }
+    }
+}
+
+XmlElement* XmlPullParser::readElement()
+{
+    // this must be called when the parser is positioned at the start of an element!
+    jassert (currentEvent == startElement);
+
+    ScopedPointer<XmlElement> root;
+    Array<XmlElement*> openElements;
+
+    for (;;)
+    {
+        if (currentEvent == startElement)
+        {
+            XmlElement* const e = new XmlElement (name.toString());
+
+            if (openElements.size() == 0)
+                root = e;
+            else
+                openElements.getLast()->addChildElement (e);
+
+            for (int i = 0; i < attributes.size(); ++i)
+                e->setAttribute (Identifier (attributes.getReference (i).name.toString()), getAttributeValue (i));
+
+            openElements.add (e);
+        }
+        else if (currentEvent == endElement)
+        {
+            openElements.removeLast();
+
+            if (openElements.size() == 0)
+                return root.release();
+        }
+        else if (currentEvent == text)
+        {
+            openElements.getLast()->addChildElement (XmlElement::createTextElement (getText()));
+        }
+        else
+        {
+            return nullptr;
+        }
+
+        next();
+    }
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class XmlPullParserTests  : public UnitTest
+{
+public:
+    XmlPullParserTests() : UnitTest ("XmlPullParser") {}
+
+    static String createRandomName (Random& r)
+    {
+        String s;
+        s << (juce_wchar) ('a' + r.nextInt (26));
+
+        for (int i = r.nextInt (8); --i >= 0;)
+            s << (juce_wchar) ('a' + r.nextInt (26));
+
+        return s;
+    }
+
+    static String createRandomText (Random& r)
+    {
+        static const char* const samples[] = { "abc", " ", "&", "<", ">", "\"", "'", "\n", "x y", "\xc3\xa9", "123" };
+
+        String s;
+
+        for (int i = 1 + r.nextInt (6); --i >= 0;)
+            s << String (CharPointer_UTF8 (samples [r.nextInt (numElementsInArray (samples))]));
+
+        return s;
+    }
+
+    static XmlElement* createRandomElement (Random& r, const int depth)
+    {
+        XmlElement* const e = new XmlElement (createRandomName (r));
+
+        for (int i = r.nextInt (4); --i >= 0;)
+            e->setAttribute (createRandomName (r) + String (i), createRandomText (r));
+
+        if (depth < 4)
+        {
+            for (int i = r.nextInt (5); --i >= 0;)
+            {
+                if (r.nextInt (3) == 0)
+                    e->addTextElement (createRandomText (r));
+                else
+                    e->addChildElement (createRandomElement (r, depth + 1));
+            }
+        }
+
+        return e;
+    }
+
+    static void writeElement (XmlStreamWriter& writer, const XmlElement& e)
+    {
+        writer.startElement (e.getTagName());
+
+        for (int i = 0; i < e.getNumAttributes(); ++i)
+            writer.writeAttribute (e.getAttributeName (i), e.getAttributeValue (i));
+
+        forEachXmlChildElement (e, child)
+        {
+            if (child->isTextElement())
+                writer.writeText (child->getText());
+            else
+                writeElement (writer, *child);
+        }
+
+        writer.endElement();
+    }
+
+    static XmlElement* readDocument (XmlPullParser& parser)
+    {
+        for (;;)
+        {
+            const XmlPullParser::EventType e = parser.next();
+
+            if (e == XmlPullParser::startElement)
+                return parser.readElement();
+
+            if (e == XmlPullParser::endOfDocument || e == XmlPullParser::parseError)
+                return nullptr;
+        }
+    }
+
+    static int countEvents (XmlPullParser& parser, XmlPullParser::EventType type)
+    {
+        int num = 0;
+
+        for (;;)
+        {
+            const XmlPullParser::EventType e = parser.next();
+
+            if (e == XmlPullParser::endOfDocument || e == XmlPullParser::parseError)
+                return num;
+
+            if (e == type)
+                ++num;
+        }
+    }
+
+    void runTest() override
+    {
+        Random r = getRandom();
+
+        beginTest ("Basic parsing");
+        {
+            const char* const doc = "\xef\xbb\xbf<?xml version=\"1.0\"?>\n<!DOCTYPE x [ <!ENTITY e \"<>\"> ]>\n"
+                                    "<!-- comment --><ROOT a=\"1\" b='two &amp; &#x33;'>\r\n"
+                                    "  <CHILD/>text &lt;&#233;&gt;<![CDATA[<raw&>]]><X y=\"&quot;\"></X>\n"
+                                    "</ROOT>\n";
+
+            XmlPullParser parser (doc, strlen (doc));
+            expect (parser.getEventType() == XmlPullParser::startOfDocument);
+
+            expect (parser.next() == XmlPullParser::startElement);
+            expect (parser.getName() == "ROOT");
+            expect (parser.getDepth() == 1);
+            expectEquals (parser.getNumAttributes(), 2);
+            expect (parser.getAttributeName (1) == "b");
+            expect (parser.getRawAttributeValue (1) == "two &amp; &#x33;");
+            expectEquals (parser.getAttributeValue ("b"), String ("two & 3"));
+            expectEquals (parser.getAttributeValue ("a"), String ("1"));
+            expectEquals (parser.getAttributeValue ("c", "none"), String ("none"));
+            expect (! parser.hasAttribute ("c"));
+
+            expect (parser.next() == XmlPullParser::startElement);
+            expect (parser.getName() == "CHILD");
+            expect (parser.getDepth() == 2);
+            expect (parser.next() == XmlPullParser::endElement);
+            expect (parser.getName() == "CHILD");
+            expect (parser.getDepth() == 1);
+
+            expect (parser.next() == XmlPullParser::text);
+            expectEquals (parser.getText(), String (CharPointer_UTF8 ("text <\xc3\xa9>")));
+            expect (parser.next() == XmlPullParser::text);
+            expectEquals (parser.getText(), String ("<raw&>"));
+
+            expect (parser.next() == XmlPullParser::startElement);
+            expectEquals (parser.getAttributeValue (0), String ("\""));
+            expect (parser.next() == XmlPullParser::endElement);
+            expect (parser.getName() == "X");
+
+            expect (parser.next() == XmlPullParser::endElement);
+            expect (parser.getName() == "ROOT");
+            expect (parser.next() == XmlPullParser::endOfDocument);
+            expect (parser.next() == XmlPullParser::endOfDocument);
+        }
+
+        beginTest ("Errors");
+        {
+            const char* const badDocs[] = { "", "   ", "<a>", "<a></b>", "<a><b></a>", "<a x=1/>", "<a x></a>",
+                                            "text<a/>", "<a/>text", "</a>", "<a/><b/>", "<a><!-- </a>" };
+
+            for (int i = 0; i < numElementsInArray (badDocs); ++i)
+            {
+                XmlPullParser parser (badDocs[i], strlen (badDocs[i]));
+                countEvents (parser, XmlPullParser::startElement);
+                expect (parser.getEventType() == XmlPullParser::parseError, badDocs[i]);
+                expect (parser.getLastError().isNotEmpty());
+            }
+        }
+
+        beginTest ("Skipping elements");
+        {
+            const char* const doc = "<a><b><c/><c>x</c></b><d/></a>";
+            XmlPullParser parser (doc, strlen (doc));
+
+            expect (parser.next() == XmlPullParser::startElement);
+            expect (parser.next() == XmlPullParser::startElement);
+            expect (parser.getName() == "b");
+            parser.skipElement();
+            expect (parser.next() == XmlPullParser::startElement);
+            expect (parser.getName() == "d");
+            parser.skipElement();
+            expect (parser.next() == XmlPullParser::endElement);
+            expect (parser.getName() == "a");
+            expect (parser.next() == XmlPullParser::endOfDocument);
+        }
+
+        beginTest ("Writing and reading random documents");
+        {
+            for (int i = 0; i < 100; ++i)
+            {
+                ScopedPointer<XmlElement> original (createRandomElement (r, 0));
+                const bool allOnOneLine = r.nextBool();
+
+                MemoryOutputStream written;
+
+                {
+                    XmlStreamWriter writer (written, true, allOnOneLine);
+                    writeElement (writer, *original);
+                }
+
+                // (XmlElement goes back to indenting any elements that follow a text element, even
+                // when it's writing everything on one line, so the output only matches in multi-line mode)
+                if (! allOnOneLine)
+                    expectEquals (written.toString(), original->createDocument (String(), false, true, "UTF-8", 1000000));
+
+                const String text (written.toString());
+                ScopedPointer<XmlElement> fromXmlDocument (XmlDocument::parse (text));
+                expect (fromXmlDocument != nullptr);
+
+                {
+                    XmlPullParser parser (text.toRawUTF8(), text.getNumBytesAsUTF8());
+                    ScopedPointer<XmlElement> parsed (readDocument (parser));
+                    expect (parsed != nullptr && parsed->isEquivalentTo (fromXmlDocument, false));
+                    expect (parser.next() == XmlPullParser::endOfDocument);
+                }
+
+                {
+                    MemoryInputStream in (written.getData(), written.getDataSize(), false);
+                    XmlPullParser parser (in, (size_t) (16 + r.nextInt (64)));
+                    ScopedPointer<XmlElement> parsed (readDocument (parser));
+                    expect (parsed != nullptr && parsed->isEquivalentTo (fromXmlDocument, false));
+                    expect (parser.next() == XmlPullParser::endOfDocument);
+                }
+            }
+        }
+
+        beginTest ("Performance");
+        {
+            MemoryOutputStream written;
+
+            {
+                XmlStreamWriter writer (written);
+                writer.startElement ("TRACKS");
+
+                for (int i = 0; i < 20000; ++i)
+                {
+                    writer.startElement ("TRACK");
+                    writer.writeAttribute ("name", "Track " + String (i));
+                    writer.writeAttribute ("volume", r.nextDouble());
+                    writer.startElement ("PLUGIN");
+                    writer.writeAttribute ("state", "a &amp; b");
+                    writer.writeText ("some text");
+                    writer.endElement();
+                    writer.endElement();
+                }
+
+                writer.endElement();
+            }
+
+            const String text (written.toString());
+            expect (text.length() > 1000000);
+
+            const double t1 = Time::getMillisecondCounterHiRes();
+            ScopedPointer<XmlElement> doc (XmlDocument::parse (text));
+            const double t2 = Time::getMillisecondCounterHiRes();
+
+            XmlPullParser parser (text.toRawUTF8(), text.getNumBytesAsUTF8());
+            const int numTracks = countEvents (parser, XmlPullParser::startElement);
+            const double t3 = Time::getMillisecondCounterHiRes();
+
+            expect (doc != nullptr && doc->getNumChildElements() == 20000);
+            expectEquals (numTracks, 40001);
+            expect (parser.getEventType() == XmlPullParser::endOfDocument);
+
+            logMessage ("Parsing " + String (text.getNumBytesAsUTF8() / 1024) + "KB: XmlDocument "
+                          + String (t2 - t1, 1) + "ms, XmlPullParser " + String (t3 - t2, 1) + "ms");
+        }
+    }
+};
+
+static XmlPullParserTests xmlPullParserTests;
+
+#endif
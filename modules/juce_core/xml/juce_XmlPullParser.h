@@ -0,0 +1,258 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+#ifndef JUCE_XMLPULLPARSER_H_INCLUDED
+#define JUCE_XMLPULLPARSER_H_INCLUDED
+
+
+//==============================================================================
+/**
+    Reads an XML document as a sequence of events, without building an XmlElement tree.
+
+    XmlDocument creates a complete XmlElement object for the whole document, copying every
+    tag name, attribute and piece of text into a String. For very large documents that's
+    slow and uses a lot of memory, so this class lets you step through the document one
+    element at a time instead, and pick out only the parts that you need.
+
+    Each call to next() moves to the next start tag, end tag or block of text. The names,
+    attributes and text of the current item are returned as TextView objects that point
+    directly into the parser's buffer, so no memory is allocated for them - but this also
+    means that they're only valid until the next call to next(). Use TextView::toString(),
+    getAttributeValue() or getText() if you need to keep a copy (these will also expand any
+    entities such as &amp;amp; in the text).
+
+    @code
+    XmlPullParser parser (File ("session.xml"));
+
+    for (;;)
+    {
+        const XmlPullParser::EventType event = parser.next();
+
+        if (event == XmlPullParser::startElement && parser.getName() == "TRACK")
+        {
+            DBG (parser.getAttributeValue ("name"));
+            parser.skipElement();   // not interested in what's inside it
+        }
+        else if (event == XmlPullParser::endOfDocument || event == XmlPullParser::parseError)
+        {
+            break;
+        }
+    }
+    @endcode
+
+    The parser can read from a block of memory, an InputStream (which it reads in chunks,
+    so the whole document never needs to be in memory at once), or a file, which it will
+    memory-map if possible.
+
+    The document must be encoded as UTF-8 (or ASCII). Comments, processing instructions
+    and DTDs are skipped, and any entities other than the standard XML ones and numeric
+    character references are left un-expanded.
+
+    @see XmlStreamWriter, XmlDocument
+*/
+class JUCE_API  XmlPullParser
+{
+public:
+    //==============================================================================
+    /** Creates a parser to read a block of UTF-8 data.
+        The data isn't copied, so it must remain valid for the lifetime of the parser.
+    */
+    XmlPullParser (const void* data, size_t numBytes);
+
+    /** Creates a parser to read from a stream.
+        The stream will be read in chunks as the document is parsed. It isn't deleted by
+        the parser, so must stay valid until the parser has been deleted.
+    */
+    XmlPullParser (InputStream& source, size_t bufferSizeToUse = 65536);
+
+    /** Creates a parser to read a file.
+        If possible, the file will be memory-mapped, otherwise it'll be read as a stream.
+    */
+    explicit XmlPullParser (const File& file);
+
+    /** Destructor. */
+    ~XmlPullParser();
+
+    //==============================================================================
+    /** The different kinds of item that the parser can find. */
+    enum EventType
+    {
+        startOfDocument, /**< The initial state, before next() has been called. */
+        startElement,   /**< The start of an element, e.g. <TAG a="1">. For a self-closing tag like <TAG/>,
+                             a startElement event is followed immediately by an endElement event. */
+        endElement,     /**< The end of an element. */
+        text,           /**< A block of text or CDATA between two tags. */
+        endOfDocument,  /**< The whole document has been read. */
+        parseError      /**< The document isn't valid XML - use getLastError() to find out why. */
+    };
+
+    /** Moves on to the next item in the document, and returns its type.
+        Once this returns endOfDocument or parseError, it'll keep returning the same value.
+    */
+    EventType next();
+
+    /** Returns the type of the current item. */
+    EventType getEventType() const noexcept                 { return currentEvent; }
+
+    /** Returns the number of elements that enclose the current position.
+        While a startElement event is current, this includes the element that was just started.
+    */
+    int getDepth() const noexcept                           { return openTagStarts.size(); }
+
+    /** If the current item is a startElement, this skips over its content and stops
+        after its matching end tag, so that the next call to next() returns the item
+        that follows the element.
+    */
+    void skipElement();
+
+    /** If the current item is a startElement, this reads the element and all of its
+        content, and returns it as an XmlElement. The parser is left positioned at the
+        element's end tag.
+        @returns a new XmlElement which the caller must delete, or nullptr if there's an error
+    */
+    XmlElement* readElement();
+
+    /** Sets whether blocks of text that contain only whitespace should be skipped (which
+        is the default).
+    */
+    void setEmptyTextIgnored (bool shouldBeIgnored) noexcept    { ignoreEmptyText = shouldBeIgnored; }
+
+    /** Returns a description of the error, after next() has returned parseError. */
+    const String& getLastError() const noexcept             { return lastError; }
+
+    //==============================================================================
+    /** Refers to a range of UTF-8 characters inside the parser's buffer.
+        This is only valid until the parser moves to its next item.
+    */
+    struct JUCE_API  TextView
+    {
+        TextView() noexcept : start (nullptr), end (nullptr) {}
+        TextView (const char* s, const char* e) noexcept  : start (s), end (e) {}
+
+        /** Returns the number of bytes in the text. */
+        size_t getNumBytes() const noexcept                 { return (size_t) (end - start); }
+        /** Returns true if the text is empty. */
+        bool isEmpty() const noexcept                       { return start == end; }
+        /** Creates a String containing a copy of the text, exactly as it appears in the document. */
+        String toString() const;
+
+        /** Compares the text with a string. */
+        bool operator== (StringRef) const noexcept;
+        /** Compares the text with a string. */
+        bool operator!= (StringRef) const noexcept;
+
+        const char* start;
+        const char* end;
+    };
+
+    /** Returns the tag name of the current startElement or endElement. */
+    TextView getName() const noexcept                       { return name; }
+
+    /** Returns the number of attributes that the current startElement has. */
+    int getNumAttributes() const noexcept                   { return attributes.size(); }
+
+    /** Returns the name of one of the current element's attributes. */
+    TextView getAttributeName (int index) const noexcept;
+
+    /** Returns the value of one of the current element's attributes, as it appears in the
+        document, i.e. without any entities being expanded.
+    */
+    TextView getRawAttributeValue (int index) const noexcept;
+
+    /** Returns the value of one of the current element's attributes, with any entities expanded. */
+    String getAttributeValue (int index) const;
+
+    /** Returns the value of the named attribute, with any entities expanded, or a default
+        value if the current element doesn't have this attribute.
+    */
+    String getAttributeValue (StringRef attributeName, const String& defaultReturnValue = String()) const;
+
+    /** Returns the index of the named attribute, or -1 if there isn't one. */
+    int indexOfAttribute (StringRef attributeName) const noexcept;
+
+    /** Returns true if the current element has the named attribute. */
+    bool hasAttribute (StringRef attributeName) const noexcept      { return indexOfAttribute (attributeName) >= 0; }
+
+    /** Returns the current text item, as it appears in the document, i.e. without any
+        entities being expanded.
+    */
+    TextView getRawText() const noexcept                    { return textContent; }
+
+    /** Returns the current text item, with any entities expanded. */
+    String getText() const;
+
+private:
+    //==============================================================================
+    struct Attribute
+    {
+        TextView name, value;
+        bool needsDecoding;
+    };
+
+    enum TokenResult { tokenFound, tokenSkipped, needMoreData, tokenError };
+
+    ScopedPointer<MemoryMappedFile> mappedFile;
+    ScopedPointer<InputStream> ownedStream;
+    InputStream* stream;
+    HeapBlock<char> buffer;
+    size_t bufferSize;
+    const char* position;
+    const char* dataEnd;
+
+    EventType currentEvent;
+    TextView name, textContent;
+    bool textNeedsDecoding, pendingEndElement, ignoreEmptyText, atStartOfData, hasFoundElement;
+    Array<Attribute> attributes;
+    MemoryBlock openTagNames;
+    size_t openTagNamesSize;
+    Array<int> openTagStarts;
+    String lastError;
+
+    void initialise();
+    bool readMoreData();
+    TokenResult readNextToken();
+    TokenResult readStartTag();
+    TokenResult readEndTag();
+    TokenResult readText();
+    TokenResult readCDATA();
+    TokenResult skipPast (const char* start, const char* terminator, size_t terminatorLength);
+    TokenResult skipDTD();
+    TokenResult setError (const String&);
+    EventType reachedEndOfData();
+    void pushOpenTag (TextView);
+    void popOpenTag() noexcept;
+    TextView getInnermostOpenTag() const noexcept;
+    static String decodeText (TextView, bool needsDecoding);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (XmlPullParser)
+};
+
+
+#endif   // JUCE_XMLPULLPARSER_H_INCLUDED
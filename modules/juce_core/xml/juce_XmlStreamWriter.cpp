@@ -0,0 +1,215 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+XmlStreamWriter::XmlStreamWriter (OutputStream& destination, const bool includeXmlHeader,
+                                  const bool shouldBeAllOnOneLine, StringRef encodingType)
+    : out (destination), allOnOneLine (shouldBeAllOnOneLine),
+      startTagOpen (false), lastWasText (false)
+{
+    if (includeXmlHeader)
+    {
+        out << "<?xml version=\"1.0\" encoding=\"" << encodingType << "\"?>";
+
+        if (allOnOneLine)
+            out.writeByte (' ');
+        else
+            out << newLine << newLine;
+    }
+}
+
+XmlStreamWriter::~XmlStreamWriter()
+{
+    while (openElements.size() > 0)
+        endElement();
+}
+
+//==============================================================================
+void XmlStreamWriter::startElement (StringRef tagName)
+{
+    int indent = allOnOneLine ? -1 : 0;
+
+    if (openElements.size() > 0)
+    {
+        closeStartTag();
+
+        if (! allOnOneLine)
+        {
+            // (this follows the same layout rules as XmlElement::writeElementAsText)
+            if (lastWasText)
+            {
+                indent = 0;
+            }
+            else
+            {
+                out << newLine;
+                indent = indents.getLast() + 2;
+            }
+        }
+    }
+
+    if (indent > 0)
+        out.writeRepeatedByte (' ', (size_t) indent);
+
+    out.writeByte ('<');
+    out << tagName;
+
+    openElements.add (tagName.text);
+    indents.add (indent);
+    startTagOpen = true;
+    lastWasText = false;
+}
+
+void XmlStreamWriter::writeAttribute (StringRef attributeName, const String& value)
+{
+    // Attributes can only be written immediately after the element's start tag!
+    jassert (startTagOpen);
+
+    if (startTagOpen)
+    {
+        out.writeByte (' ');
+        out << attributeName;
+        out.write ("=\"", 2);
+        writeEscaped (value, true);
+        out.writeByte ('"');
+    }
+}
+
+void XmlStreamWriter::writeAttribute (StringRef attributeName, const int value)
+{
+    writeAttribute (attributeName, String (value));
+}
+
+void XmlStreamWriter::writeAttribute (StringRef attributeName, const double value)
+{
+    writeAttribute (attributeName, String (value, 20));
+}
+
+void XmlStreamWriter::writeText (StringRef text)
+{
+    // Text has to go inside an element!
+    jassert (openElements.size() > 0);
+
+    closeStartTag();
+    writeEscaped (text, false);
+    lastWasText = true;
+}
+
+void XmlStreamWriter::endElement()
+{
+    // There aren't any elements left to close!
+    jassert (openElements.size() > 0);
+
+    if (openElements.size() == 0)
+        return;
+
+    const int indent = indents.getLast();
+
+    if (startTagOpen)
+    {
+        out.write ("/>", 2);
+        startTagOpen = false;
+    }
+    else
+    {
+        if (indent >= 0 && ! lastWasText)
+        {
+            out << newLine;
+            out.writeRepeatedByte (' ', (size_t) indent);
+        }
+
+        out.write ("</", 2);
+        out << openElements[openElements.size() - 1];
+        out.writeByte ('>');
+    }
+
+    openElements.remove (openElements.size() - 1);
+    indents.removeLast();
+    lastWasText = false;
+
+    if (openElements.size() == 0 && ! allOnOneLine)
+        out << newLine;
+}
+
+//==============================================================================
+void XmlStreamWriter::closeStartTag()
+{
+    if (startTagOpen)
+    {
+        out.writeByte ('>');
+        startTagOpen = false;
+    }
+}
+
+void XmlStreamWriter::writeEscaped (StringRef text, const bool changeNewLines)
+{
+    using namespace XmlOutputFunctions;
+
+    // Rather than writing the characters one at a time like XmlElement does, any runs
+    // of characters that don't need escaping are written to the stream as a single block
+    String::CharPointerType t (text.text);
+    const char* runStart = t.getAddress();
+
+    for (;;)
+    {
+        const char* const charStart = t.getAddress();
+        const uint32 character = (uint32) t.getAndAdvance();
+
+        if (character != 0 && isLegalXmlChar (character))
+            continue;
+
+        if (charStart > runStart)
+            out.write (runStart, (size_t) (charStart - runStart));
+
+        if (character == 0)
+            break;
+
+        runStart = t.getAddress();
+
+        switch (character)
+        {
+            case '&':   out.write ("&amp;", 5); break;
+            case '"':   out.write ("&quot;", 6); break;
+            case '>':   out.write ("&gt;", 4); break;
+            case '<':   out.write ("&lt;", 4); break;
+
+            case '\n':
+            case '\r':
+                if (! changeNewLines)
+                {
+                    out.writeByte ((char) character);
+                    break;
+                }
+                // Note: deliberate fall-through here!
+            default:
+                out << "&#" << ((int) character) << ';';
+                break;
+        }
+    }
+}
@@ -0,0 +1,131 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+#ifndef JUCE_XMLSTREAMWRITER_H_INCLUDED
+#define JUCE_XMLSTREAMWRITER_H_INCLUDED
+
+
+//==============================================================================
+/**
+    Writes an XML document directly to a stream, one element at a time.
+
+    To write a document with XmlElement::writeToStream(), the whole document has to be
+    built as a tree of XmlElement objects first. This class lets you write the elements
+    straight to the output as you go, so there's no need to ever hold the whole document
+    in memory.
+
+    The output is formatted in the same way as XmlElement::writeToStream() would do it
+    (except that long lists of attributes aren't wrapped onto multiple lines).
+
+    @code
+    FileOutputStream out (file);
+    XmlStreamWriter writer (out);
+
+    writer.startElement ("TRACKS");
+
+    for (int i = 0; i < numTracks; ++i)
+    {
+        writer.startElement ("TRACK");
+        writer.writeAttribute ("name", trackNames[i]);
+        writer.endElement();
+    }
+
+    writer.endElement();
+    @endcode
+
+    @see XmlPullParser, XmlElement::writeToStream
+*/
+class JUCE_API  XmlStreamWriter
+{
+public:
+    //==============================================================================
+    /** Creates a writer which will send its output to the given stream.
+
+        The stream isn't deleted by the writer, so must remain valid until the writer has
+        been deleted. If includeXmlHeader is true, an "<?xml version..." header line will
+        be written immediately.
+    */
+    XmlStreamWriter (OutputStream& destination,
+                     bool includeXmlHeader = true,
+                     bool allOnOneLine = false,
+                     StringRef encodingType = "UTF-8");
+
+    /** Destructor.
+        If any elements are still open, their end tags will be written.
+    */
+    ~XmlStreamWriter();
+
+    //==============================================================================
+    /** Writes the start tag of a new element.
+        The element becomes a child of any element that is currently open. After calling
+        this, you can add attributes to it with writeAttribute(), before writing its
+        content or calling endElement().
+    */
+    void startElement (StringRef tagName);
+
+    /** Adds an attribute to the element that was most recently started.
+        This must be called immediately after startElement(), before any text or child
+        elements are written.
+    */
+    void writeAttribute (StringRef attributeName, const String& value);
+
+    /** Adds an attribute to the element that was most recently started. */
+    void writeAttribute (StringRef attributeName, int value);
+
+    /** Adds an attribute to the element that was most recently started. */
+    void writeAttribute (StringRef attributeName, double value);
+
+    /** Writes some text inside the current element.
+        Any characters that aren't legal in XML will be escaped.
+    */
+    void writeText (StringRef text);
+
+    /** Writes the end tag for the innermost element that is open. */
+    void endElement();
+
+    /** Returns the number of elements that are currently open. */
+    int getDepth() const noexcept                   { return openElements.size(); }
+
+private:
+    //==============================================================================
+    OutputStream& out;
+    StringArray openElements;
+    Array<int> indents;
+    const bool allOnOneLine;
+    bool startTagOpen, lastWasText;
+
+    void closeStartTag();
+    void writeEscaped (StringRef text, bool changeNewLines);
+
+    JUCE_DECLARE_NON_COPYABLE (XmlStreamWriter)
+};
+
+
+#endif   // JUCE_XMLSTREAMWRITER_H_INCLUDED
@@ -0,0 +1,391 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+class IndexedCompressorOutputStream::Compressor
+{
+public:
+    Compressor (const int compressionLevel, const int blockSize)
+        : streamIsValid (false), compressedData ((size_t) blockSize)
+    {
+        using namespace zlibNamespace;
+        zerostruct (stream);
+
+        streamIsValid = (deflateInit2 (&stream, (compressionLevel < 1 || compressionLevel > 9) ? Z_DEFAULT_COMPRESSION
+                                                                                                : compressionLevel,
+                                       Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+    }
+
+    ~Compressor()
+    {
+        if (streamIsValid)
+            zlibNamespace::deflateEnd (&stream);
+    }
+
+    // Returns the compressed size, or 0 if the data couldn't be made any smaller
+    int compress (const uint8* data, const int size)
+    {
+        using namespace zlibNamespace;
+
+        if (! streamIsValid || deflateReset (&stream) != Z_OK)
+            return 0;
+
+        stream.next_in   = const_cast<uint8*> (data);
+        stream.avail_in  = (z_uInt) size;
+        stream.next_out  = compressedData;
+        stream.avail_out = (z_uInt) (size - 1);
+
+        if (deflate (&stream, Z_FINISH) != Z_STREAM_END)
+            return 0;
+
+        return size - 1 - (int) stream.avail_out;
+    }
+
+    const uint8* getCompressedData() const noexcept     { return compressedData; }
+
+private:
+    zlibNamespace::z_stream stream;
+    bool streamIsValid;
+    HeapBlock<uint8> compressedData;
+
+    JUCE_DECLARE_NON_COPYABLE (Compressor)
+};
+
+//==============================================================================
+IndexedCompressorOutputStream::IndexedCompressorOutputStream (OutputStream* const out,
+                                                              const bool deleteDestStream,
+                                                              const int compressionLevel,
+                                                              const int size)
+    : destStream (out, deleteDestStream),
+      blockSize (jlimit ((int) IndexedCompressedStreamFormat::minBlockSize,
+                         (int) IndexedCompressedStreamFormat::maxBlockSize, size)),
+      blockData ((size_t) blockSize),
+      numBytesInBlock (0),
+      totalLength (0), compressedLength (0),
+      finished (false), failed (false),
+      compressor (new Compressor (compressionLevel, blockSize))
+{
+    jassert (out != nullptr);
+
+    MemoryOutputStream header ((size_t) IndexedCompressedStreamFormat::headerSize);
+    header.writeInt ((int) IndexedCompressedStreamFormat::headerMagic);
+    header.writeInt ((int) IndexedCompressedStreamFormat::formatVersion);
+    header.writeInt (blockSize);
+    header.writeInt (0); // reserved
+
+    writeToDest (header.getData(), header.getDataSize());
+}
+
+IndexedCompressorOutputStream::~IndexedCompressorOutputStream()
+{
+    flush();
+}
+
+bool IndexedCompressorOutputStream::writeToDest (const void* data, const size_t size)
+{
+    if (! (failed || destStream->write (data, size)))
+        failed = true;
+
+    compressedLength += (int64) size;
+    return ! failed;
+}
+
+bool IndexedCompressorOutputStream::writeBlock (const uint8* data, const int size)
+{
+    blockOffsets.add (compressedLength);
+
+    const int compressedSize = compressor->compress (data, size);
+
+    return compressedSize > 0 ? writeToDest (compressor->getCompressedData(), (size_t) compressedSize)
+                              : writeToDest (data, (size_t) size);
+}
+
+void IndexedCompressorOutputStream::flush()
+{
+    if (! finished)
+    {
+        finished = true;
+
+        if (numBytesInBlock > 0)
+            writeBlock (blockData, numBytesInBlock);
+
+        const int64 indexStart = compressedLength;
+        blockOffsets.add (indexStart);
+
+        MemoryOutputStream index ((size_t) blockOffsets.size() * 8 + IndexedCompressedStreamFormat::trailerSize);
+
+        for (int i = 0; i < blockOffsets.size(); ++i)
+            index.writeInt64 (blockOffsets.getUnchecked (i));
+
+        index.writeInt64 (totalLength);
+        index.writeInt64 (indexStart);
+        index.writeInt ((int) IndexedCompressedStreamFormat::trailerMagic);
+
+        writeToDest (index.getData(), index.getDataSize());
+    }
+
+    destStream->flush();
+}
+
+bool IndexedCompressorOutputStream::write (const void* data, size_t howMany)
+{
+    jassert (data != nullptr && (ssize_t) howMany >= 0);
+
+    // When you call flush() on an IndexedCompressorOutputStream, the index gets written
+    // and the stream is closed, so you can't write any more data to it!
+    jassert (! finished);
+
+    if (finished)
+        return false;
+
+    const uint8* d = static_cast<const uint8*> (data);
+
+    while (howMany > 0)
+    {
+        // (whole blocks can be compressed straight from the caller's data)
+        if (numBytesInBlock == 0 && howMany >= (size_t) blockSize)
+        {
+            if (! writeBlock (d, blockSize))
+                return false;
+
+            d += blockSize;
+            howMany -= (size_t) blockSize;
+            totalLength += blockSize;
+            continue;
+        }
+
+        const int numToCopy = (int) jmin ((size_t) (blockSize - numBytesInBlock), howMany);
+        memcpy (blockData + numBytesInBlock, d, (size_t) numToCopy);
+
+        d += numToCopy;
+        howMany -= (size_t) numToCopy;
+        totalLength += numToCopy;
+        numBytesInBlock += numToCopy;
+
+        if (numBytesInBlock == blockSize)
+        {
+            numBytesInBlock = 0;
+
+            if (! writeBlock (blockData, blockSize))
+                return false;
+        }
+    }
+
+    return ! failed;
+}
+
+int64 IndexedCompressorOutputStream::getPosition()
+{
+    return totalLength;
+}
+
+bool IndexedCompressorOutputStream::setPosition (int64 /*newPosition*/)
+{
+    jassertfalse; // can't do it!
+    return false;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class IndexedCompressedStreamTests  : public UnitTest
+{
+public:
+    IndexedCompressedStreamTests()   : UnitTest ("Indexed compressed streams") {}
+
+    static MemoryBlock createTestData (Random& r, int size)
+    {
+        MemoryOutputStream out ((size_t) size);
+
+        // A mixture of text, which compresses well, and noise, which doesn't compress at all
+        while ((int) out.getDataSize() < size)
+        {
+            if (r.nextInt (4) == 0)
+                for (int i = r.nextInt (5000); --i >= 0;)
+                    out.writeByte ((char) r.nextInt (256));
+            else
+                for (int i = r.nextInt (200); --i >= 0;)
+                    out << "Sample " << r.nextInt (1000) << " = " << r.nextInt (100) << newLine;
+        }
+
+        MemoryBlock data (out.getMemoryBlock());
+        data.setSize ((size_t) size);
+        return data;
+    }
+
+    static MemoryBlock compress (const MemoryBlock& data, int blockSize)
+    {
+        MemoryOutputStream compressed;
+
+        {
+            IndexedCompressorOutputStream out (&compressed, false, 6, blockSize);
+
+            // (written in uneven pieces to exercise the block buffering)
+            Random r (data.getSize());
+
+            for (size_t pos = 0; pos < data.getSize();)
+            {
+                const size_t num = jmin (data.getSize() - pos, (size_t) r.nextInt (3 * blockSize));
+                out.write (static_cast<const char*> (data.getData()) + pos, num);
+                pos += num;
+            }
+        }
+
+        return compressed.getMemoryBlock();
+    }
+
+    void runTest() override
+    {
+        Random r = getRandom();
+
+        beginTest ("Round trip");
+        {
+            for (int i = 0; i < 50; ++i)
+            {
+                const MemoryBlock original (createTestData (r, r.nextInt (i < 5 ? 10 : 300000)));
+                const int blockSize = 1024 << r.nextInt (5);
+                const MemoryBlock compressed (compress (original, blockSize));
+
+                MemoryInputStream compressedInput (compressed, false);
+                IndexedDecompressorInputStream in (compressedInput);
+
+                expect (in.isValid());
+                expectEquals (in.getBlockSize(), blockSize);
+                expectEquals (in.getTotalLength(), (int64) original.getSize());
+                expectEquals (in.getNumBlocks(), (int) ((original.getSize() + (size_t) blockSize - 1) / (size_t) blockSize));
+
+                MemoryBlock result;
+                in.readIntoMemoryBlock (result);
+                expect (result == original);
+                expect (in.isExhausted());
+            }
+        }
+
+        beginTest ("Random access");
+        {
+            const MemoryBlock original (createTestData (r, 1000000));
+            const MemoryBlock compressed (compress (original, 8192));
+
+            MemoryInputStream compressedInput (compressed, false);
+            IndexedDecompressorInputStream in (compressedInput);
+            HeapBlock<char> buffer (20000);
+
+            for (int i = 0; i < 500; ++i)
+            {
+                const int64 pos = r.nextInt ((int) original.getSize() + 100);
+                const int num = r.nextInt (20000);
+
+                expect (in.setPosition (pos));
+                const int numRead = in.read (buffer, num);
+
+                expectEquals (numRead, (int) jlimit ((int64) 0, (int64) num, (int64) original.getSize() - pos));
+                expect (memcmp (buffer, static_cast<const char*> (original.getData()) + jmin (pos, (int64) original.getSize()), (size_t) numRead) == 0);
+            }
+        }
+
+        beginTest ("Invalid data");
+        {
+            const MemoryBlock original (createTestData (r, 50000));
+            MemoryBlock compressed (compress (original, 4096));
+
+            {
+                MemoryInputStream truncated (compressed.getData(), compressed.getSize() - 1, false);
+                IndexedDecompressorInputStream in (truncated);
+                expect (! in.isValid());
+                expectEquals (in.getTotalLength(), (int64) 0);
+                expect (in.isExhausted());
+            }
+
+            {
+                // Corrupt the start of the first block, which will be compressed text, so
+                // that it uses the invalid deflate block type 3..
+                MemoryOutputStream text;
+
+                while (text.getDataSize() < 20000)
+                    text << "Sample " << r.nextInt (1000) << newLine;
+
+                MemoryBlock textBlocks (compress (text.getMemoryBlock(), 4096));
+                textBlocks[16] = (char) 0xff;
+
+                MemoryInputStream corrupted (textBlocks, false);
+                IndexedDecompressorInputStream in (corrupted);
+                HeapBlock<char> buffer (4096);
+
+                expect (in.isValid());
+                in.read (buffer, 4096);
+                expect (in.isExhausted());
+            }
+        }
+
+        beginTest ("Performance");
+        {
+            const MemoryBlock original (createTestData (r, 4 * 1024 * 1024));
+            const MemoryBlock indexed (compress (original, 65536));
+            MemoryOutputStream gzipped;
+
+            {
+                GZIPCompressorOutputStream out (&gzipped, 6);
+                out << original;
+            }
+
+            MemoryInputStream indexedInput (indexed, false), gzipInput (gzipped.getData(), gzipped.getDataSize(), false);
+            IndexedDecompressorInputStream indexedStream (indexedInput);
+            GZIPDecompressorInputStream gzipStream (gzipInput);
+            char buffer [256];
+
+            const int numGZIPReads = 20, numIndexedReads = 2000;
+            double start = Time::getMillisecondCounterHiRes();
+
+            for (int i = 0; i < numGZIPReads; ++i)
+            {
+                gzipStream.setPosition (r.nextInt ((int) original.getSize() - 256));
+                gzipStream.read (buffer, 256);
+            }
+
+            const double gzipTime = (Time::getMillisecondCounterHiRes() - start) / numGZIPReads;
+            start = Time::getMillisecondCounterHiRes();
+
+            for (int i = 0; i < numIndexedReads; ++i)
+            {
+                indexedStream.setPosition (r.nextInt ((int) original.getSize() - 256));
+                indexedStream.read (buffer, 256);
+            }
+
+            const double indexedTime = (Time::getMillisecondCounterHiRes() - start) / numIndexedReads;
+
+            logMessage ("Random 256-byte reads from 4MB: GZIP " + String (gzipTime, 3) + "ms each, indexed "
+                          + String (indexedTime, 3) + "ms each. Compressed sizes: GZIP "
+                          + String ((int) gzipped.getDataSize() / 1024) + "KB, indexed " + String ((int) indexed.getSize() / 1024) + "KB");
+        }
+    }
+};
+
+static IndexedCompressedStreamTests indexedCompressedStreamTests;
+
+#endif
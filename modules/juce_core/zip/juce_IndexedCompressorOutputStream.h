@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+#ifndef JUCE_INDEXEDCOMPRESSOROUTPUTSTREAM_H_INCLUDED
+#define JUCE_INDEXEDCOMPRESSOROUTPUTSTREAM_H_INCLUDED
+
+
+//==============================================================================
+/**
+    A stream which compresses the data written into it in a format that can be read
+    back with random access, using an IndexedDecompressorInputStream.
+
+    The data is split into fixed-size blocks which are each deflated independently,
+    and an index of where each block begins is written at the end of the stream, so
+    that a reader can jump straight to any position by decompressing just the block
+    that contains it. (Blocks which zlib can't make any smaller are stored as they are).
+
+    Smaller blocks make seeking cheaper, because less data needs to be decompressed
+    to get to a given position, but they compress less well - the default of 64K is
+    a good compromise for most data.
+
+    Like the GZIPCompressorOutputStream, the data is finished off when you call flush()
+    or delete the stream, and after that no more data can be written to it.
+
+    @see IndexedDecompressorInputStream, GZIPCompressorOutputStream
+*/
+class JUCE_API  IndexedCompressorOutputStream  : public OutputStream
+{
+public:
+    //==============================================================================
+    /** Creates a compression stream.
+
+        @param destStream                       the stream into which the compressed data should
+                                                be written
+        @param deleteDestStreamWhenDestroyed    whether or not to delete the destStream object when
+                                                this stream is destroyed
+        @param compressionLevel                 how much to compress the data, between 1 (the fastest)
+                                                and 9 (the smallest). Any value outside this range
+                                                indicates that a default compression level should be used.
+        @param blockSize                        the number of uncompressed bytes in each independently
+                                                compressed block
+    */
+    IndexedCompressorOutputStream (OutputStream* destStream,
+                                   bool deleteDestStreamWhenDestroyed = false,
+                                   int compressionLevel = -1,
+                                   int blockSize = 65536);
+
+    /** Destructor. */
+    ~IndexedCompressorOutputStream();
+
+    //==============================================================================
+    /** Writes the last block and the index, and closes the stream.
+        After this has been called, no more data can be written to it.
+    */
+    void flush() override;
+
+    /** Returns the number of uncompressed bytes that have been written so far. */
+    int64 getPosition() override;
+
+    bool setPosition (int64) override;
+    bool write (const void*, size_t) override;
+
+private:
+    //==============================================================================
+    OptionalScopedPointer<OutputStream> destStream;
+    const int blockSize;
+    HeapBlock<uint8> blockData;
+    int numBytesInBlock;
+    int64 totalLength, compressedLength;
+    Array<int64> blockOffsets;
+    bool finished, failed;
+
+    class Compressor;
+    friend struct ContainerDeletePolicy<Compressor>;
+    ScopedPointer<Compressor> compressor;
+
+    bool writeToDest (const void*, size_t);
+    bool writeBlock (const uint8* data, int size);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (IndexedCompressorOutputStream)
+};
+
+#endif   // JUCE_INDEXEDCOMPRESSOROUTPUTSTREAM_H_INCLUDED
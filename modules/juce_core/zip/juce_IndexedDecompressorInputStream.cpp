@@ -0,0 +1,268 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+namespace IndexedCompressedStreamFormat
+{
+    /*  The stream starts with a header containing a magic number, the format version, the
+        block size and a reserved value. That's followed by the compressed blocks, then an
+        index holding the offset of each block from the start of the stream (with one extra
+        entry for the end of the last block), and finally a trailer with the total uncompressed
+        length, the offset of the index, and another magic number. All values are little-endian.
+
+        A block whose compressed size is the same as its uncompressed size has been stored
+        without compression, because zlib couldn't make it any smaller.
+    */
+    enum
+    {
+        headerMagic     = 0x58495a4a,  // "JZIX"
+        trailerMagic    = 0x45495a4a,  // "JZIE"
+        formatVersion   = 1,
+        headerSize      = 16,
+        trailerSize     = 20,
+        minBlockSize    = 1024,
+        maxBlockSize    = 64 * 1024 * 1024
+    };
+}
+
+//==============================================================================
+class IndexedDecompressorInputStream::Decompressor
+{
+public:
+    Decompressor()  : streamIsValid (false)
+    {
+        using namespace zlibNamespace;
+        zerostruct (stream);
+        streamIsValid = (inflateInit2 (&stream, -MAX_WBITS) == Z_OK);
+    }
+
+    ~Decompressor()
+    {
+        if (streamIsValid)
+            zlibNamespace::inflateEnd (&stream);
+    }
+
+    bool decompress (const uint8* source, int sourceSize, uint8* dest, int destSize)
+    {
+        using namespace zlibNamespace;
+
+        if (! streamIsValid || inflateReset (&stream) != Z_OK)
+            return false;
+
+        stream.next_in   = const_cast<uint8*> (source);
+        stream.avail_in  = (z_uInt) sourceSize;
+        stream.next_out  = dest;
+        stream.avail_out = (z_uInt) destSize;
+
+        return inflate (&stream, Z_FINISH) == Z_STREAM_END && stream.avail_out == 0;
+    }
+
+private:
+    zlibNamespace::z_stream stream;
+    bool streamIsValid;
+
+    JUCE_DECLARE_NON_COPYABLE (Decompressor)
+};
+
+//==============================================================================
+IndexedDecompressorInputStream::IndexedDecompressorInputStream (InputStream* source, bool deleteSourceWhenDestroyed)
+    : sourceStream (source, deleteSourceWhenDestroyed),
+      sourceStart (source->getPosition()),
+      totalLength (0), currentPos (0),
+      blockSize (0), currentBlock (-1),
+      error (false),
+      decompressor (new Decompressor())
+{
+    readIndex();
+}
+
+IndexedDecompressorInputStream::IndexedDecompressorInputStream (InputStream& source)
+    : sourceStream (&source, false),
+      sourceStart (source.getPosition()),
+      totalLength (0), currentPos (0),
+      blockSize (0), currentBlock (-1),
+      error (false),
+      decompressor (new Decompressor())
+{
+    readIndex();
+}
+
+IndexedDecompressorInputStream::~IndexedDecompressorInputStream()
+{
+}
+
+void IndexedDecompressorInputStream::readIndex()
+{
+    using namespace IndexedCompressedStreamFormat;
+
+    const int64 sourceLength = sourceStream->getTotalLength() - sourceStart;
+    char header [headerSize], trailer [trailerSize];
+
+    if (sourceLength < headerSize + trailerSize + 8
+         || ! sourceStream->setPosition (sourceStart)
+         || sourceStream->read (header, headerSize) != headerSize
+         || ByteOrder::littleEndianInt (header) != (uint32) headerMagic
+         || ByteOrder::littleEndianInt (header + 4) != (uint32) formatVersion
+         || ! sourceStream->setPosition (sourceStart + sourceLength - trailerSize)
+         || sourceStream->read (trailer, trailerSize) != trailerSize
+         || ByteOrder::littleEndianInt (trailer + 16) != (uint32) trailerMagic)
+        return;
+
+    const int size = (int) ByteOrder::littleEndianInt (header + 8);
+    const int64 length = (int64) ByteOrder::littleEndianInt64 (trailer);
+    const int64 indexStart = (int64) ByteOrder::littleEndianInt64 (trailer + 8);
+
+    if (size < minBlockSize || size > maxBlockSize || length < 0)
+        return;
+
+    const int64 numBlocks = (length + size - 1) / size;
+
+    if (numBlocks >= sourceLength / 8
+         || indexStart < headerSize
+         || indexStart + (numBlocks + 1) * 8 + trailerSize != sourceLength)
+        return;
+
+    const size_t indexSize = (size_t) (numBlocks + 1) * 8;
+    HeapBlock<char> indexData (indexSize);
+
+    if (! sourceStream->setPosition (sourceStart + indexStart)
+         || sourceStream->read (indexData, (int) indexSize) != (int) indexSize)
+        return;
+
+    blockSize = size;
+    totalLength = length;
+    blockOffsets.ensureStorageAllocated ((int) numBlocks + 1);
+
+    for (int i = 0; i <= (int) numBlocks; ++i)
+    {
+        const int64 offset = (int64) ByteOrder::littleEndianInt64 (indexData + i * 8);
+
+        // Each block must follow the previous one, and can't be bigger than its uncompressed size
+        if (offset < (i == 0 ? (int64) headerSize : blockOffsets.getLast())
+             || (i > 0 && offset - blockOffsets.getLast() > getBlockLength (i - 1))
+             || (i == (int) numBlocks && offset != indexStart))
+        {
+            blockSize = 0;
+            totalLength = 0;
+            blockOffsets.clear();
+            return;
+        }
+
+        blockOffsets.add (offset);
+    }
+
+    blockData.malloc ((size_t) blockSize);
+    compressedData.malloc ((size_t) blockSize);
+}
+
+int IndexedDecompressorInputStream::getBlockLength (const int block) const noexcept
+{
+    return (int) jmin ((int64) blockSize, totalLength - block * (int64) blockSize);
+}
+
+bool IndexedDecompressorInputStream::decompressBlock (const int block, uint8* const dest)
+{
+    const int64 start = blockOffsets.getUnchecked (block);
+    const int compressedSize = (int) (blockOffsets.getUnchecked (block + 1) - start);
+    const int blockLength = getBlockLength (block);
+
+    if (! sourceStream->setPosition (sourceStart + start))
+        return false;
+
+    if (compressedSize == blockLength)
+        return sourceStream->read (dest, blockLength) == blockLength;
+
+    return sourceStream->read (compressedData, compressedSize) == compressedSize
+            && decompressor->decompress (compressedData, compressedSize, dest, blockLength);
+}
+
+//==============================================================================
+int64 IndexedDecompressorInputStream::getTotalLength()
+{
+    return totalLength;
+}
+
+int64 IndexedDecompressorInputStream::getPosition()
+{
+    return currentPos;
+}
+
+bool IndexedDecompressorInputStream::setPosition (int64 newPos)
+{
+    currentPos = jlimit ((int64) 0, totalLength, newPos);
+    return true;
+}
+
+bool IndexedDecompressorInputStream::isExhausted()
+{
+    return error || currentPos >= totalLength;
+}
+
+int IndexedDecompressorInputStream::read (void* destBuffer, int howMany)
+{
+    jassert (destBuffer != nullptr && howMany >= 0);
+
+    uint8* d = static_cast<uint8*> (destBuffer);
+    int numRead = 0;
+
+    while (howMany > 0 && currentPos < totalLength && ! error)
+    {
+        const int block = (int) (currentPos / blockSize);
+        const int offsetInBlock = (int) (currentPos % blockSize);
+        const int blockLength = getBlockLength (block);
+        const int numToCopy = jmin (howMany, blockLength - offsetInBlock);
+
+        if (block != currentBlock && numToCopy == blockLength)
+        {
+            // (if the whole block is wanted, it can be decompressed straight into the destination)
+            error = ! decompressBlock (block, d);
+        }
+        else
+        {
+            if (block != currentBlock)
+            {
+                currentBlock = block;
+                error = ! decompressBlock (block, blockData);
+            }
+
+            if (! error)
+                memcpy (d, blockData + offsetInBlock, (size_t) numToCopy);
+        }
+
+        if (error)
+            break;
+
+        d += numToCopy;
+        numRead += numToCopy;
+        howMany -= numToCopy;
+        currentPos += numToCopy;
+    }
+
+    return numRead;
+}
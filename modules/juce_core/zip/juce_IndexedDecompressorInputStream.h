@@ -0,0 +1,116 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2016 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license/
+
+   Permission to use, copy, modify, and/or distribute this software for any
+   purpose with or without fee is hereby granted, provided that the above
+   copyright notice and this permission notice appear in all copies.
+
+   THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+   TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+   FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+   OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+   USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+   TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+   OF THIS SOFTWARE.
+
+   -----------------------------------------------------------------------------
+
+   To release a closed-source product which uses other parts of JUCE not
+   licensed under the ISC terms, commercial licenses are available: visit
+   www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+#ifndef JUCE_INDEXEDDECOMPRESSORINPUTSTREAM_H_INCLUDED
+#define JUCE_INDEXEDDECOMPRESSORINPUTSTREAM_H_INCLUDED
+
+
+//==============================================================================
+/**
+    Reads data that was written by an IndexedCompressorOutputStream, allowing random
+    access to it.
+
+    Unlike a GZIPDecompressorInputStream, which has to decompress everything before a
+    position to get there (and start again from the beginning to go backwards), this can
+    seek to any position by decompressing only the one block that contains it. The block
+    that was most recently decompressed is kept, so reading sequentially or making small
+    jumps around the same area doesn't decompress anything twice.
+
+    The source stream must be seekable, and know its total length, because the index is
+    read from the end of the data when the stream is created.
+
+    @see IndexedCompressorOutputStream, GZIPDecompressorInputStream
+*/
+class JUCE_API  IndexedDecompressorInputStream  : public InputStream
+{
+public:
+    //==============================================================================
+    /** Creates a decompressor stream.
+
+        The compressed data must start at the source stream's current position, and run
+        up to the end of the stream.
+
+        @param sourceStream                 the stream to read from
+        @param deleteSourceWhenDestroyed    whether or not to delete the source stream
+                                            when this object is destroyed
+    */
+    IndexedDecompressorInputStream (InputStream* sourceStream,
+                                    bool deleteSourceWhenDestroyed);
+
+    /** Creates a decompressor stream.
+
+        @param sourceStream     the stream to read from - the source stream must not be
+                                deleted until this object has been destroyed
+    */
+    IndexedDecompressorInputStream (InputStream& sourceStream);
+
+    /** Destructor. */
+    ~IndexedDecompressorInputStream();
+
+    //==============================================================================
+    /** Returns true if the source contained a valid header and index.
+        If not, the stream will behave as if it was empty.
+    */
+    bool isValid() const noexcept                   { return blockSize > 0; }
+
+    /** Returns the number of uncompressed bytes in each of the stream's blocks. */
+    int getBlockSize() const noexcept               { return blockSize; }
+
+    /** Returns the number of independently compressed blocks in the stream. */
+    int getNumBlocks() const noexcept               { return jmax (0, blockOffsets.size() - 1); }
+
+    //==============================================================================
+    int64 getPosition() override;
+    bool setPosition (int64 pos) override;
+    int64 getTotalLength() override;
+    bool isExhausted() override;
+    int read (void* destBuffer, int maxBytesToRead) override;
+
+private:
+    //==============================================================================
+    OptionalScopedPointer<InputStream> sourceStream;
+    int64 sourceStart, totalLength, currentPos;
+    int blockSize, currentBlock;
+    Array<int64> blockOffsets;
+    HeapBlock<uint8> blockData, compressedData;
+    bool error;
+
+    class Decompressor;
+    friend struct ContainerDeletePolicy<Decompressor>;
+    ScopedPointer<Decompressor> decompressor;
+
+    void readIndex();
+    int getBlockLength (int block) const noexcept;
+    bool decompressBlock (int block, uint8* dest);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (IndexedDecompressorInputStream)
+};
+
+#endif   // JUCE_INDEXEDDECOMPRESSORINPUTSTREAM_H_INCLUDED
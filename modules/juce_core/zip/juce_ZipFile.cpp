@@ -31,7 +31,7 @@
 class ZipFile::ZipEntryHolder
 {
 public:
-    ZipEntryHolder (const char* const buffer, const int fileNameLen)
+    ZipEntryHolder (const char* const buffer, const int fileNameLen, const int extraFieldLen)
     {
         isCompressed            = ByteOrder::littleEndianShort (buffer + 10) != 0;
         entry.fileTime          = parseFileTime ((uint32) ByteOrder::littleEndianShort (buffer + 12),
@@ -40,6 +40,8 @@ public:
         entry.uncompressedSize  = (int64) (uint32) ByteOrder::littleEndianInt (buffer + 24);
         streamOffset            = (int64) (uint32) ByteOrder::littleEndianInt (buffer + 42);
         entry.filename          = String::fromUTF8 (buffer + 46, fileNameLen);
+
+        readZip64ExtraField (buffer + 46 + fileNameLen, extraFieldLen);
     }
 
     struct FileNameComparator
@@ -55,6 +57,43 @@ public:
     bool isCompressed;
 
 private:
+    // When any of the sizes or the offset are too big for 32 bits, they're set to 0xffffffff,
+    // and their real values are stored (in that order) in a ZIP64 extra field.
+    void readZip64ExtraField (const char* extra, int extraLen) noexcept
+    {
+        while (extraLen >= 4)
+        {
+            const int fieldId   = ByteOrder::littleEndianShort (extra);
+            const int fieldSize = ByteOrder::littleEndianShort (extra + 2);
+
+            if (fieldSize > extraLen - 4)
+                break;
+
+            if (fieldId == 0x0001)
+            {
+                const char* value = extra + 4;
+                const char* const end = value + fieldSize;
+
+                readZip64Value (entry.uncompressedSize, value, end);
+                readZip64Value (compressedSize, value, end);
+                readZip64Value (streamOffset, value, end);
+                break;
+            }
+
+            extra += 4 + fieldSize;
+            extraLen -= 4 + fieldSize;
+        }
+    }
+
+    static void readZip64Value (int64& value, const char*& data, const char* end) noexcept
+    {
+        if (value == (int64) 0xffffffff && data + 8 <= end)
+        {
+            value = (int64) ByteOrder::littleEndianInt64 (data);
+            data += 8;
+        }
+    }
+
     static Time parseFileTime (uint32 time, uint32 date) noexcept
     {
         const int year      = 1980 + (date >> 9);
@@ -71,7 +110,35 @@ private:
 //==============================================================================
 namespace
 {
-    int findEndOfZipEntryTable (InputStream& input, int& numEntries)
+    // If there's a ZIP64 end-of-directory locator just before the standard end-of-directory
+    // record, this reads the real number of entries and directory offset from the ZIP64 record.
+    int64 findZip64EndOfZipEntryTable (InputStream& in, const int64 endOfDirectoryPos, int& numEntries)
+    {
+        char buffer [56];
+
+        if (endOfDirectoryPos >= 20
+             && in.setPosition (endOfDirectoryPos - 20)
+             && in.read (buffer, 20) == 20
+             && ByteOrder::littleEndianInt (buffer) == 0x07064b50)
+        {
+            const int64 recordPos = (int64) ByteOrder::littleEndianInt64 (buffer + 8);
+
+            if (recordPos >= 0
+                 && in.setPosition (recordPos)
+                 && in.read (buffer, 56) == 56
+                 && ByteOrder::littleEndianInt (buffer) == 0x06064b50)
+            {
+                numEntries = (int) jmin ((uint64) std::numeric_limits<int>::max(),
+                                         ByteOrder::littleEndianInt64 (buffer + 32));
+
+                return (int64) ByteOrder::littleEndianInt64 (buffer + 48);
+            }
+        }
+
+        return -1;
+    }
+
+    int64 findEndOfZipEntryTable (InputStream& input, int& numEntries)
     {
         BufferedInputStream in (input, 8192);
 
@@ -97,8 +164,10 @@ namespace
                     in.setPosition (pos + i);
                     in.read (buffer, 22);
                     numEntries = ByteOrder::littleEndianShort (buffer + 10);
+                    const int64 directoryStart = (int64) ByteOrder::littleEndianInt (buffer + 16);
 
-                    return (int) ByteOrder::littleEndianInt (buffer + 16);
+                    const int64 zip64DirectoryStart = findZip64EndOfZipEntryTable (in, pos + i, numEntries);
+                    return zip64DirectoryStart >= 0 ? zip64DirectoryStart : directoryStart;
                 }
             }
         }
@@ -337,18 +406,20 @@ void ZipFile::init()
     if (in != nullptr)
     {
         int numEntries = 0;
-        int pos = findEndOfZipEntryTable (*in, numEntries);
+        const int64 directoryStart = findEndOfZipEntryTable (*in, numEntries);
 
-        if (pos >= 0 && pos < in->getTotalLength())
+        if (directoryStart >= 0 && directoryStart < in->getTotalLength())
         {
-            const int size = (int) (in->getTotalLength() - pos);
+            const int size = (int) jmin ((int64) std::numeric_limits<int>::max(),
+                                         in->getTotalLength() - directoryStart);
 
-            in->setPosition (pos);
+            in->setPosition (directoryStart);
             MemoryBlock headerData;
 
             if (in->readIntoMemoryBlock (headerData, size) == (size_t) size)
             {
-                pos = 0;
+                int pos = 0;
+                entries.ensureStorageAllocated (jmin (numEntries, size / 46));
 
                 for (int i = 0; i < numEntries; ++i)
                 {
@@ -358,14 +429,14 @@ void ZipFile::init()
                     const char* const buffer = static_cast<const char*> (headerData.getData()) + pos;
 
                     const int fileNameLen = ByteOrder::littleEndianShort (buffer + 28);
+                    const int extraFieldLen = ByteOrder::littleEndianShort (buffer + 30);
 
-                    if (pos + 46 + fileNameLen > size)
+                    if (pos + 46 + fileNameLen + extraFieldLen > size)
                         break;
 
-                    entries.add (new ZipEntryHolder (buffer, fileNameLen));
+                    entries.add (new ZipEntryHolder (buffer, fileNameLen, extraFieldLen));
 
-                    pos += 46 + fileNameLen
-                            + ByteOrder::littleEndianShort (buffer + 30)
+                    pos += 46 + fileNameLen + extraFieldLen
                             + ByteOrder::littleEndianShort (buffer + 32);
                 }
             }
@@ -373,12 +444,165 @@ void ZipFile::init()
     }
 }
 
+//==============================================================================
+struct ParallelZipExtractor
+{
+    ParallelZipExtractor (ZipFile& z, const File& target, bool overwrite)
+        : zip (z), targetDirectory (target), shouldOverwriteFiles (overwrite)
+    {
+    }
+
+    void extractRemainingEntries()
+    {
+        while (failed.get() == 0)
+        {
+            const int index = (++nextIndex) - 1;
+
+            if (index >= entryIndexes.size())
+                break;
+
+            const int entryIndex = entryIndexes.getUnchecked (index);
+            const Result result (zip.uncompressEntry (entryIndex, targetDirectory, shouldOverwriteFiles));
+
+            if (result.failed())
+            {
+                results.getReference (entryIndex) = result;
+                failed = 1;
+            }
+        }
+    }
+
+    struct Job  : public ThreadPoolJob
+    {
+        Job (ParallelZipExtractor& e)  : ThreadPoolJob ("Zip extractor"), extractor (e) {}
+
+        JobStatus runJob() override
+        {
+            extractor.extractRemainingEntries();
+            return jobHasFinished;
+        }
+
+        ParallelZipExtractor& extractor;
+
+        JUCE_DECLARE_NON_COPYABLE (Job)
+    };
+
+    // Starting with the biggest entries stops one large file from being left until last
+    struct SizeComparator
+    {
+        SizeComparator (ZipFile& z) : zip (z) {}
+
+        int compareElements (int first, int second) const noexcept
+        {
+            const int64 size1 = zip.getEntry (first)->uncompressedSize;
+            const int64 size2 = zip.getEntry (second)->uncompressedSize;
+
+            return size1 > size2 ? -1 : (size1 < size2 ? 1 : 0);
+        }
+
+        ZipFile& zip;
+    };
+
+    ZipFile& zip;
+    const File targetDirectory;
+    const bool shouldOverwriteFiles;
+    Array<int> entryIndexes;
+    Array<Result> results;
+    Atomic<int> nextIndex, failed;
+
+    JUCE_DECLARE_NON_COPYABLE (ParallelZipExtractor)
+};
+
 Result ZipFile::uncompressTo (const File& targetDirectory,
-                              const bool shouldOverwriteFiles)
+                              const bool shouldOverwriteFiles,
+                              int numThreads)
 {
+    if (numThreads <= 0)
+        numThreads = SystemStats::getNumCpus();
+
+    // (if all the entries have to share the same input stream, there's nothing to gain)
+    if (inputSource == nullptr)
+        numThreads = 1;
+
+    numThreads = jmin (numThreads, entries.size());
+
+    if (numThreads <= 1)
+    {
+        for (int i = 0; i < entries.size(); ++i)
+        {
+            Result result (uncompressEntry (i, targetDirectory, shouldOverwriteFiles));
+            if (result.failed())
+                return result;
+        }
+
+        return Result::ok();
+    }
+
+    // All the folders are created first, so that the threads don't race to create the same
+    // ones, and any entries that have the same target file as an earlier one are done in order
+    // afterwards, so the results are the same as when extracting them one at a time.
+    ParallelZipExtractor extractor (*this, targetDirectory, shouldOverwriteFiles);
+    extractor.results.insertMultiple (0, Result::ok(), entries.size());
+
+    Array<int> duplicateEntries;
+    HashMap<String, int> targetPaths;
+    const bool caseSensitive = File::areFileNamesCaseSensitive();
+
     for (int i = 0; i < entries.size(); ++i)
     {
-        Result result (uncompressEntry (i, targetDirectory, shouldOverwriteFiles));
+       #if JUCE_WINDOWS
+        const String entryPath (entries.getUnchecked (i)->entry.filename);
+       #else
+        const String entryPath (entries.getUnchecked (i)->entry.filename.replaceCharacter ('\\', '/'));
+       #endif
+
+        const File targetFile (targetDirectory.getChildFile (entryPath));
+        const bool isDirectory = entryPath.endsWithChar ('/') || entryPath.endsWithChar ('\\');
+        const File folder (isDirectory ? targetFile : targetFile.getParentDirectory());
+
+        const Result result (folder.createDirectory());
+
+        if (result.failed())
+            return isDirectory ? result
+                               : Result::fail ("Failed to create target folder: " + folder.getFullPathName());
+
+        if (! isDirectory)
+        {
+            const String path (caseSensitive ? targetFile.getFullPathName()
+                                             : targetFile.getFullPathName().toLowerCase());
+
+            if (targetPaths.contains (path))
+            {
+                duplicateEntries.add (i);
+            }
+            else
+            {
+                targetPaths.set (path, i);
+                extractor.entryIndexes.add (i);
+            }
+        }
+    }
+
+    ParallelZipExtractor::SizeComparator sorter (*this);
+    extractor.entryIndexes.sort (sorter, true);
+
+    {
+        ThreadPool pool (numThreads - 1);
+
+        for (int i = 1; i < numThreads; ++i)
+            pool.addJob (new ParallelZipExtractor::Job (extractor), true);
+
+        extractor.extractRemainingEntries();
+        pool.removeAllJobs (false, -1);
+    }
+
+    for (int i = 0; i < extractor.results.size(); ++i)
+        if (extractor.results.getReference (i).failed())
+            return extractor.results.getReference (i);
+
+    for (int i = 0; i < duplicateEntries.size(); ++i)
+    {
+        Result result (uncompressEntry (duplicateEntries.getUnchecked (i), targetDirectory, shouldOverwriteFiles));
         if (result.failed())
             return result;
     }
@@ -438,55 +662,110 @@ Result ZipFile::uncompressEntry (const int index,
 
 
 //==============================================================================
-class ZipFile::Builder::Item
+namespace
+{
+    // Any size or offset which reaches this is stored in a ZIP64 field instead. (The unit tests
+    // lower it, so that they can check the ZIP64 code without needing gigabytes of data).
+    int64 maxZip32Value = 0xffffffff;
+    const int64 maxInMemoryZipItemSize = 32 * 1024 * 1024;
+
+    // A value that's too big is written as 0xffffffff, to show that it's in the ZIP64 field
+    int toZip32Value (const int64 value) noexcept
+    {
+        return (int) (value >= maxZip32Value ? (uint32) 0xffffffff : (uint32) value);
+    }
+}
+
+class ZipFile::Builder::Item  : public ThreadPoolJob
 {
 public:
     Item (const File& f, InputStream* s, int compression, const String& storedPath, Time time)
-        : file (f), stream (s), storedPathname (storedPath), fileTime (time),
+        : ThreadPoolJob ("Zip compressor"),
+          file (f), stream (s), storedPathname (storedPath), fileTime (time),
           compressedSize (0), uncompressedSize (0), headerStart (0),
-          compressionLevel (compression), checksum (0)
+          compressionLevel (compression), checksum (0),
+          hasCompressedData (false), hasDataDescriptor (false), usesZip64DataDescriptor (false)
     {
     }
 
-    bool writeData (OutputStream& target, const int64 overallStartPosition)
+    // Small items are compressed into memory before being written, which can be done on a
+    // background thread, and means that their sizes and checksum are known when the header is
+    // written. Anything bigger, or whose size is unknown, is compressed straight into the target.
+    bool shouldCompressInMemory() const
     {
-        MemoryOutputStream compressedData ((size_t) file.getSize());
+        const int64 size = getSourceSize();
+        return size >= 0 && size <= maxInMemoryZipItemSize;
+    }
+
+    int64 getSourceSize() const
+    {
+        return stream != nullptr ? stream->getTotalLength() : file.getSize();
+    }
+
+    JobStatus runJob() override
+    {
+        compressIntoMemory();
+        return jobHasFinished;
+    }
+
+    bool compressIntoMemory()
+    {
+        compressedData.ensureSize ((size_t) getSourceSize() + 64);
 
-        if (compressionLevel > 0)
-        {
-            GZIPCompressorOutputStream compressor (&compressedData, compressionLevel, false,
-                                                   GZIPCompressorOutputStream::windowBitsRaw);
-            if (! writeSource (compressor))
-                return false;
-        }
-        else
         {
-            if (! writeSource (compressedData))
-                return false;
+            MemoryOutputStream out (compressedData, false);
+
+            if (compressionLevel > 0)
+            {
+                GZIPCompressorOutputStream compressor (&out, compressionLevel, false,
+                                                       GZIPCompressorOutputStream::windowBitsRaw);
+                hasCompressedData = writeSource (compressor);
+            }
+            else
+            {
+                hasCompressedData = writeSource (out);
+            }
         }
 
-        compressedSize = (int64) compressedData.getDataSize();
+        compressedSize = (int64) compressedData.getSize();
+        return hasCompressedData;
+    }
+
+    bool hasBeenCompressedInMemory() const noexcept     { return hasCompressedData; }
+
+    bool writeData (OutputStream& target, const int64 overallStartPosition)
+    {
         headerStart = target.getPosition() - overallStartPosition;
 
+        if (! hasCompressedData)
+            return writeStreamedData (target);
+
+        const MemoryBlock extraField (createZip64ExtraField (false));
+
         target.writeInt (0x04034b50);
-        writeFlagsAndSizes (target);
+        writeFlagsAndSizes (target, false, (int) extraField.getSize());
         target << storedPathname
+               << extraField
                << compressedData;
 
+        compressedData.reset();
         return true;
     }
 
     bool writeDirectoryEntry (OutputStream& target)
     {
+        const MemoryBlock extraField (createZip64ExtraField (true));
+
         target.writeInt (0x02014b50);
-        target.writeShort (20); // version written
-        writeFlagsAndSizes (target);
+        target.writeShort (needsZip64() ? 45 : 20); // version written
+        writeFlagsAndSizes (target, true, (int) extraField.getSize());
         target.writeShort (0); // comment length
         target.writeShort (0); // start disk num
         target.writeShort (0); // internal attributes
         target.writeInt (0); // external attributes
-        target.writeInt ((int) (uint32) headerStart);
-        target << storedPathname;
+        target.writeInt (toZip32Value (headerStart));
+        target << storedPathname
+               << extraField;
 
         return true;
     }
@@ -496,9 +775,11 @@ private:
     ScopedPointer<InputStream> stream;
     String storedPathname;
     Time fileTime;
+    MemoryBlock compressedData;
     int64 compressedSize, uncompressedSize, headerStart;
     int compressionLevel;
     unsigned long checksum;
+    bool hasCompressedData, hasDataDescriptor, usesZip64DataDescriptor;
 
     static void writeTimeAndDate (OutputStream& target, Time t)
     {
@@ -506,19 +787,22 @@ private:
         target.writeShort ((short) (t.getDayOfMonth() + ((t.getMonth() + 1) << 5) + ((t.getYear() - 1980) << 9)));
     }
 
-    bool writeSource (OutputStream& target)
+    bool openSource()
     {
         if (stream == nullptr)
-        {
             stream = file.createInputStream();
 
-            if (stream == nullptr)
-                return false;
-        }
+        return stream != nullptr;
+    }
+
+    bool writeSource (OutputStream& target)
+    {
+        if (! openSource())
+            return false;
 
         checksum = 0;
         uncompressedSize = 0;
-        const int bufferSize = 4096;
+        const int bufferSize = 32768;
         HeapBlock<unsigned char> buffer (bufferSize);
 
         while (! stream->isExhausted())
@@ -537,17 +821,125 @@ private:
         return true;
     }
 
-    void writeFlagsAndSizes (OutputStream& target) const
+    // The sizes and checksum of a streamed item aren't known until it has been written, so
+    // they go into a data descriptor after the data, and the central directory.
+    bool writeStreamedData (OutputStream& target)
     {
-        target.writeShort (10); // version needed
-        target.writeShort ((short) (1 << 11)); // this flag indicates UTF-8 filename encoding
-        target.writeShort (compressionLevel > 0 ? (short) 8 : (short) 0);
-        writeTimeAndDate (target, fileTime);
+        if (! openSource())
+            return false;
+
+        const int64 sourceSize = stream->getTotalLength();
+
+        hasDataDescriptor = true;
+        usesZip64DataDescriptor = sourceSize < 0 || sourceSize > maxZip32Value - maxZip32Value / 16;
+
+        const MemoryBlock extraField (createZip64ExtraField (false));
+
+        target.writeInt (0x04034b50);
+        writeFlagsAndSizes (target, false, (int) extraField.getSize());
+        target << storedPathname
+               << extraField;
+
+        const int64 dataStart = target.getPosition();
+
+        if (compressionLevel > 0)
+        {
+            GZIPCompressorOutputStream compressor (&target, compressionLevel, false,
+                                                   GZIPCompressorOutputStream::windowBitsRaw);
+            if (! writeSource (compressor))
+                return false;
+        }
+        else
+        {
+            if (! writeSource (target))
+                return false;
+        }
+
+        compressedSize = target.getPosition() - dataStart;
+
+        target.writeInt (0x08074b50);
         target.writeInt ((int) checksum);
+
+        if (usesZip64DataDescriptor)
+        {
+            target.writeInt64 (compressedSize);
+            target.writeInt64 (uncompressedSize);
+            return true;
+        }
+
         target.writeInt ((int) (uint32) compressedSize);
         target.writeInt ((int) (uint32) uncompressedSize);
+
+        // (if this happens, the stream must have returned more data than its length said it would)
+        return ! needsZip64Sizes();
+    }
+
+    bool needsZip64Sizes() const noexcept
+    {
+        return compressedSize >= maxZip32Value || uncompressedSize >= maxZip32Value;
+    }
+
+    bool needsZip64() const noexcept
+    {
+        return usesZip64DataDescriptor || needsZip64Sizes() || headerStart >= maxZip32Value;
+    }
+
+    // In the central directory, only the values that don't fit into 32 bits are stored in the
+    // ZIP64 field. A local header's ZIP64 field has to contain both sizes (or zeros, if the real
+    // sizes follow the data).
+    MemoryBlock createZip64ExtraField (const bool forDirectory) const
+    {
+        MemoryOutputStream values;
+
+        if (forDirectory)
+        {
+            if (uncompressedSize >= maxZip32Value)  values.writeInt64 (uncompressedSize);
+            if (compressedSize >= maxZip32Value)    values.writeInt64 (compressedSize);
+            if (headerStart >= maxZip32Value)       values.writeInt64 (headerStart);
+        }
+        else if (hasDataDescriptor ? usesZip64DataDescriptor : needsZip64Sizes())
+        {
+            values.writeInt64 (hasDataDescriptor ? 0 : uncompressedSize);
+            values.writeInt64 (hasDataDescriptor ? 0 : compressedSize);
+        }
+
+        MemoryOutputStream field;
+
+        if (values.getDataSize() > 0)
+        {
+            field.writeShort (0x0001);
+            field.writeShort ((short) values.getDataSize());
+            field << values;
+        }
+
+        return field.getMemoryBlock();
+    }
+
+    void writeFlagsAndSizes (OutputStream& target, const bool forDirectory, const int extraFieldLength) const
+    {
+        const bool sizesFollowData = hasDataDescriptor && ! forDirectory;
+        const bool sizesAreInExtraField = ! forDirectory && (hasDataDescriptor ? usesZip64DataDescriptor
+                                                                               : needsZip64Sizes());
+
+        target.writeShort ((short) (needsZip64() ? 45 : (hasDataDescriptor ? 20 : 10))); // version needed
+        target.writeShort ((short) ((1 << 11) | (hasDataDescriptor ? (1 << 3) : 0))); // UTF-8 filename, and whether sizes follow the data
+        target.writeShort (compressionLevel > 0 ? (short) 8 : (short) 0);
+        writeTimeAndDate (target, fileTime);
+        target.writeInt (sizesFollowData ? 0 : (int) checksum);
+
+        if (sizesAreInExtraField)
+        {
+            target.writeInt ((int) (uint32) 0xffffffff);
+            target.writeInt ((int) (uint32) 0xffffffff);
+        }
+        else
+        {
+            target.writeInt (toZip32Value (compressedSize));
+            target.writeInt (toZip32Value (uncompressedSize));
+        }
+
         target.writeShort ((short) storedPathname.toUTF8().sizeInBytes() - 1);
-        target.writeShort (0); // extra field length
+        target.writeShort ((short) extraFieldLength);
     }
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Item)
@@ -571,19 +963,74 @@ void ZipFile::Builder::addEntry (InputStream* stream, int compression, const Str
     items.add (new Item (File(), stream, compression, path, time));
 }
 
-bool ZipFile::Builder::writeToStream (OutputStream& target, double* const progress) const
+bool ZipFile::Builder::writeToStream (OutputStream& target, double* const progress, int numThreads) const
 {
     const int64 fileStart = target.getPosition();
 
+    if (numThreads <= 0)
+        numThreads = SystemStats::getNumCpus();
+
+    numThreads = jmin (numThreads, items.size());
+
+    // The pool compresses the small items that are coming up, while the ones before them
+    // are being written. The amount it can get ahead is limited, to keep the memory use down.
+    ScopedPointer<ThreadPool> pool;
+
+    if (numThreads > 1)
+        pool = new ThreadPool (numThreads);
+
+    const int64 maxBytesQueued = 4 * maxInMemoryZipItemSize;
+    const int maxItemsQueued = numThreads * 4;
+    Array<int64> queuedSizes;
+    queuedSizes.insertMultiple (0, -1, items.size());
+    int64 bytesQueued = 0;
+    int nextItemToQueue = 0;
+
     for (int i = 0; i < items.size(); ++i)
     {
         if (progress != nullptr)
             *progress = (i + 0.5) / items.size();
 
-        if (! items.getUnchecked (i)->writeData (target, fileStart))
+        Item& item = *items.getUnchecked (i);
+
+        if (pool != nullptr)
+        {
+            while (nextItemToQueue < items.size()
+                    && (nextItemToQueue <= i || (bytesQueued < maxBytesQueued && nextItemToQueue < i + maxItemsQueued)))
+            {
+                Item& nextItem = *items.getUnchecked (nextItemToQueue);
+
+                if (nextItem.shouldCompressInMemory())
+                {
+                    queuedSizes.set (nextItemToQueue, nextItem.getSourceSize());
+                    bytesQueued += queuedSizes.getUnchecked (nextItemToQueue);
+                    pool->addJob (&nextItem, false);
+                }
+
+                ++nextItemToQueue;
+            }
+
+            if (queuedSizes.getUnchecked (i) >= 0)
+            {
+                pool->waitForJobToFinish (&item, -1);
+                bytesQueued -= queuedSizes.getUnchecked (i);
+
+                if (! item.hasBeenCompressedInMemory())
+                    return false;
+            }
+        }
+        else if (item.shouldCompressInMemory())
+        {
+            if (! item.compressIntoMemory())
+                return false;
+        }
+
+        if (! item.writeData (target, fileStart))
             return false;
     }
 
+    pool = nullptr;
+
     const int64 directoryStart = target.getPosition();
 
     for (int i = 0; i < items.size(); ++i)
@@ -591,14 +1038,35 @@ bool ZipFile::Builder::writeToStream (OutputStream& target, double* const progre
             return false;
 
     const int64 directoryEnd = target.getPosition();
+    const int64 directorySize = directoryEnd - directoryStart;
+    const int64 directoryOffset = directoryStart - fileStart;
+
+    if (items.size() >= 0xffff || directorySize >= maxZip32Value || directoryOffset >= maxZip32Value)
+    {
+        target.writeInt (0x06064b50); // ZIP64 end of central directory record
+        target.writeInt64 (44); // size of the rest of this record
+        target.writeShort (45); // version written
+        target.writeShort (45); // version needed
+        target.writeInt (0); // disk number
+        target.writeInt (0); // disk containing the directory
+        target.writeInt64 (items.size());
+        target.writeInt64 (items.size());
+        target.writeInt64 (directorySize);
+        target.writeInt64 (directoryOffset);
+
+        target.writeInt (0x07064b50); // ZIP64 end of central directory locator
+        target.writeInt (0); // disk containing the ZIP64 record
+        target.writeInt64 (directoryEnd - fileStart);
+        target.writeInt (1); // total number of disks
+    }
 
     target.writeInt (0x06054b50);
     target.writeShort (0);
     target.writeShort (0);
-    target.writeShort ((short) items.size());
-    target.writeShort ((short) items.size());
-    target.writeInt ((int) (directoryEnd - directoryStart));
-    target.writeInt ((int) (directoryStart - fileStart));
+    target.writeShort ((short) jmin (items.size(), 0xffff));
+    target.writeShort ((short) jmin (items.size(), 0xffff));
+    target.writeInt (toZip32Value (directorySize));
+    target.writeInt (toZip32Value (directoryOffset));
     target.writeShort (0);
 
     if (progress != nullptr)
@@ -606,3 +1074,234 @@ bool ZipFile::Builder::writeToStream (OutputStream& target, double* const progre
 
     return true;
 }
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ZipFileTests  : public UnitTest
+{
+public:
+    ZipFileTests()   : UnitTest ("ZipFile") {}
+
+    // A stream which doesn't know its length, like the ones you'd get from a network connection
+    struct UnknownLengthStream  : public InputStream
+    {
+        UnknownLengthStream (const MemoryBlock& data)  : source (data, false) {}
+
+        int64 getTotalLength() override                   { return -1; }
+        bool isExhausted() override                       { return source.isExhausted(); }
+        int read (void* dest, int numBytes) override      { return source.read (dest, numBytes); }
+        int64 getPosition() override                      { return source.getPosition(); }
+        bool setPosition (int64 pos) override             { return source.setPosition (pos); }
+
+        MemoryInputStream source;
+    };
+
+    static MemoryBlock createTestData (Random& r, int size)
+    {
+        MemoryOutputStream out ((size_t) size);
+
+        // (text-like data, so that it compresses realistically)
+        while ((int) out.getDataSize() < size)
+            out << "Item " << r.nextInt (1000) << ", value " << r.nextInt (100) << newLine;
+
+        MemoryBlock data (out.getData(), (size_t) size);
+        return data;
+    }
+
+    static bool containsSignature (const MemoryOutputStream& data, const uint32 signature)
+    {
+        for (size_t i = 0; i + 4 <= data.getDataSize(); ++i)
+            if (ByteOrder::littleEndianInt (addBytesToPointer (data.getData(), i)) == signature)
+                return true;
+
+        return false;
+    }
+
+    static String getEntryAsString (ZipFile& zip, int index)
+    {
+        ScopedPointer<InputStream> in (zip.createStreamForEntry (index));
+        return in != nullptr ? in->readEntireStreamAsString() : String();
+    }
+
+    void runTest() override
+    {
+        Random r = getRandom();
+
+        beginTest ("ZIP64 archive with many entries");
+        {
+            // More than 65535 entries need the ZIP64 end-of-directory records, and a stream
+            // with an unknown length needs a ZIP64 data descriptor
+            const int numEntries = 70000;
+            const MemoryBlock streamedData (createTestData (r, 300000));
+
+            ZipFile::Builder builder;
+
+            for (int i = 0; i < numEntries; ++i)
+            {
+                const String text ("Entry " + String (i));
+
+                builder.addEntry (new MemoryInputStream (text.toRawUTF8(), text.getNumBytesAsUTF8(), true),
+                                  i % 1000 == 0 ? 6 : 0, "entries/" + String (i) + ".txt", Time());
+            }
+
+            builder.addEntry (new UnknownLengthStream (streamedData), 6, "streamed.txt", Time());
+
+            MemoryOutputStream archive;
+            expect (builder.writeToStream (archive, nullptr));
+
+            MemoryInputStream archiveStream (archive.getData(), archive.getDataSize(), false);
+            ZipFile zip (archiveStream);
+
+            expectEquals (zip.getNumEntries(), numEntries + 1);
+            expectEquals (getEntryAsString (zip, 0), String ("Entry 0"));
+            expectEquals (getEntryAsString (zip, 65537), String ("Entry 65537"));
+            expectEquals (getEntryAsString (zip, numEntries - 1), String ("Entry " + String (numEntries - 1)));
+
+            const int streamedIndex = zip.getIndexOfFileName ("streamed.txt");
+            expectEquals (streamedIndex, numEntries);
+            expectEquals (zip.getEntry (streamedIndex)->uncompressedSize, (int64) streamedData.getSize());
+
+            ScopedPointer<InputStream> in (zip.createStreamForEntry (streamedIndex));
+            MemoryBlock result;
+            in->readIntoMemoryBlock (result);
+            expect (result == streamedData);
+        }
+
+        beginTest ("ZIP64 sizes and offsets");
+        {
+            Array<MemoryBlock> contents;
+            contents.ensureStorageAllocated (20);
+
+            for (int i = 0; i < 20; ++i)
+                contents.add (createTestData (r, i % 3 == 0 ? 100 : 2000 + r.nextInt (20000)));
+
+            for (int numThreads = 1; numThreads <= 4; numThreads += 3)
+            {
+                // Lowering the limit means that these entries get the same ZIP64 fields that they
+                // would if they were over 4GB: most of the sizes, the offsets of all but the first
+                // few entries, the data descriptors of the streamed entries, and the directory
+                // offset, which needs the ZIP64 end-of-directory records.
+                const ScopedValueSetter<int64> zip64Limit (maxZip32Value, 5000);
+
+                ZipFile::Builder builder;
+
+                for (int i = 0; i < contents.size(); ++i)
+                {
+                    const String name ("item" + String (i) + ".txt");
+                    const int compression = i % 2 == 0 ? 0 : 6;
+
+                    if (i % 5 == 4)
+                        builder.addEntry (new UnknownLengthStream (contents.getReference (i)), compression, name, Time());
+                    else
+                        builder.addEntry (new MemoryInputStream (contents.getReference (i), false), compression, name, Time());
+                }
+
+                MemoryOutputStream archive;
+                expect (builder.writeToStream (archive, nullptr, numThreads));
+
+                expect (containsSignature (archive, 0x06064b50));
+                expect (containsSignature (archive, 0x07064b50));
+
+                MemoryInputStream archiveStream (archive.getData(), archive.getDataSize(), false);
+                ZipFile zip (archiveStream);
+                expectEquals (zip.getNumEntries(), contents.size());
+
+                for (int i = 0; i < contents.size(); ++i)
+                {
+                    const MemoryBlock& expected = contents.getReference (i);
+                    const int index = zip.getIndexOfFileName ("item" + String (i) + ".txt");
+                    const ZipFile::ZipEntry* const entry = zip.getEntry (index);
+
+                    expect (entry != nullptr && entry->uncompressedSize == (int64) expected.getSize());
+
+                    ScopedPointer<InputStream> in (zip.createStreamForEntry (index));
+                    MemoryBlock result;
+
+                    if (in != nullptr)
+                        in->readIntoMemoryBlock (result);
+
+                    expect (result == expected);
+                }
+            }
+
+            // ..and with the normal limit, a small archive doesn't need any of them
+            ZipFile::Builder builder;
+            builder.addEntry (new MemoryInputStream (contents.getReference (1), false), 6, "item.txt", Time());
+
+            MemoryOutputStream archive;
+            expect (builder.writeToStream (archive, nullptr));
+            expect (! containsSignature (archive, 0x06064b50));
+
+            MemoryInputStream archiveStream (archive.getData(), archive.getDataSize(), false);
+            ZipFile zip (archiveStream);
+            expect (getEntryAsString (zip, 0) == contents.getReference (1).toString());
+        }
+
+        beginTest ("Parallel compression and extraction");
+        {
+            const File folder (File::getSpecialLocation (File::tempDirectory).getNonexistentChildFile ("ZipFileTests", String(), false));
+            const File zipFile (folder.getChildFile ("test.zip"));
+            expect (folder.createDirectory());
+
+            Array<MemoryBlock> contents;
+            int64 totalSize = 0;
+
+            for (int i = 0; i < 48; ++i)
+            {
+                contents.add (createTestData (r, 1000 + r.nextInt (400000)));
+                totalSize += (int64) contents.getReference (i).getSize();
+            }
+
+            const int threadCounts[] = { 1, 4 };
+            double compressionTimes[2], extractionTimes[2];
+
+            for (int pass = 0; pass < 2; ++pass)
+            {
+                const int numThreads = threadCounts[pass];
+
+                ZipFile::Builder builder;
+
+                for (int i = 0; i < contents.size(); ++i)
+                    builder.addEntry (new MemoryInputStream (contents.getReference (i), false), 6,
+                                      "folder" + String (i % 4) + "/item" + String (i) + ".txt", Time::getCurrentTime());
+
+                zipFile.deleteFile();
+                double start = Time::getMillisecondCounterHiRes();
+
+                {
+                    FileOutputStream out (zipFile);
+                    expect (builder.writeToStream (out, nullptr, numThreads));
+                }
+
+                compressionTimes[pass] = Time::getMillisecondCounterHiRes() - start;
+
+                const File target (folder.getChildFile ("extracted" + String (pass)));
+                ZipFile zip (zipFile);
+                expectEquals (zip.getNumEntries(), contents.size());
+
+                start = Time::getMillisecondCounterHiRes();
+                expect (zip.uncompressTo (target, true, numThreads).wasOk());
+                extractionTimes[pass] = Time::getMillisecondCounterHiRes() - start;
+
+                for (int i = 0; i < contents.size(); ++i)
+                {
+                    MemoryBlock extracted;
+                    expect (target.getChildFile ("folder" + String (i % 4) + "/item" + String (i) + ".txt").loadFileAsData (extracted));
+                    expect (extracted == contents.getReference (i));
+                }
+            }
+
+            logMessage ("Zipping " + String (totalSize / (1024 * 1024)) + "MB in " + String (contents.size())
+                          + " entries, 1 thread: " + String (compressionTimes[0], 1) + "ms, 4 threads: "
+                          + String (compressionTimes[1], 1) + "ms. Extracting, 1 thread: " + String (extractionTimes[0], 1)
+                          + "ms, 4 threads: " + String (extractionTimes[1], 1) + "ms");
+
+            expect (folder.deleteRecursively());
+        }
+    }
+};
+
+static ZipFileTests zipFileTests;
+
+#endif
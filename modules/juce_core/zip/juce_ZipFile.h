@@ -38,6 +38,10 @@
 
     This can enumerate the items in a ZIP file and can create suitable stream objects
     to read each one.
+
+    Archives that use the ZIP64 extensions (which are needed for archives or entries
+    bigger than 4GB, or with more than 65535 entries) can be read, and will be written
+    by the Builder class when necessary.
 */
 class JUCE_API  ZipFile
 {
@@ -155,12 +159,20 @@ public:
         This will expand all the entries into a target directory. The relative
         paths of the entries are used.
 
+        If the ZipFile was created from a File or an InputSource, the entries are
+        decompressed in parallel using several threads. (If it was created from an
+        InputStream, they all have to share that stream, so they're done one at a time).
+        If an entry fails, any entries that are already being written will still be
+        finished, and the error for the first failed entry is returned.
+
         @param targetDirectory      the root folder to uncompress to
         @param shouldOverwriteFiles whether to overwrite existing files with similarly-named ones
+        @param numThreads           the maximum number of threads to use, or 0 to use one per CPU core
         @returns success if the file is successfully unzipped
     */
     Result uncompressTo (const File& targetDirectory,
-                         bool shouldOverwriteFiles = true);
+                         bool shouldOverwriteFiles = true,
+                         int numThreads = 0);
 
     /** Uncompresses one of the entries from the zip file.
 
@@ -210,7 +222,8 @@ public:
                                 stored, then used later when the writeToStream() method is called, and
                                 deleted by the Builder object when no longer needed, so be very careful
                                 about its lifetime and the lifetime of any objects on which it depends!
-                                This must not be null.
+                                Note that writeToStream() may read it on a background thread, at the
+                                same time as the other items' streams. This must not be null.
             @param compressionLevel     this can be between 0 (no compression), and 9 (maximum compression).
             @param storedPathName       the partial pathname that will be stored for this file
             @param fileModificationTime the timestamp that will be stored as the last modification time
@@ -220,10 +233,20 @@ public:
                        const String& storedPathName, Time fileModificationTime);
 
         /** Generates the zip file, writing it to the specified stream.
+
             If the progress parameter is non-null, it will be updated with an approximate
             progress status between 0 and 1.0
+
+            Items smaller than 32MB are compressed in memory by a set of background threads,
+            a little ahead of the point at which they're written to the target.
+            Bigger items, and streams whose length isn't known, are compressed directly into
+            the target, so that writing an archive never needs much more memory than that.
+            The ZIP64 extensions will be used for any items, offsets or counts that are too
+            big for the standard zip format.
+
+            @param numThreads   the maximum number of threads to use, or 0 to use one per CPU core
         */
-        bool writeToStream (OutputStream& target, double* progress) const;
+        bool writeToStream (OutputStream& target, double* progress, int numThreads = 0) const;
 
         //==============================================================================
     private:
@@ -59,6 +59,7 @@ namespace juce
 #include "undomanager/juce_UndoManager.h"
 #include "values/juce_Value.h"
 #include "values/juce_ValueTree.h"
+#include "values/juce_ValueTreeSnapshot.h"
 #include "values/juce_ValueTreeSynchroniser.h"
 #include "values/juce_CachedValue.h"
 #include "app_properties/juce_PropertiesFile.h"
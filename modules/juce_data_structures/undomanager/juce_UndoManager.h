@@ -41,6 +41,11 @@
     together - all actions performed between calls to beginNewTransaction() are
     grouped together and are all undone/redone as a group.
 
+    Within a transaction, each new action is offered to the previous one's
+    UndoableAction::createCoalescedAction() method, so that e.g. the hundreds of
+    changes to a ValueTree property that happen while a slider is being dragged
+    only take up the space of a single action.
+
     The UndoManager is a ChangeBroadcaster, so listeners can register to be told
     when actions are performed or undone.
 
@@ -78,7 +78,10 @@ public:
         can work out how many to keep.
 
         The default value returned here is 10 - units are arbitrary and
-        don't have to be accurate.
+        don't have to be accurate. The actions that ValueTree creates return
+        the approximate number of bytes that they use, including any property
+        values or removed sub-trees that they're keeping alive, so if your own
+        actions do the same, the UndoManager's limit becomes a memory limit.
 
         @see UndoManager::getNumberOfUnitsTakenUpByStoredCommands,
              UndoManager::setMaxNumberOfStoredUnits
@@ -22,20 +22,235 @@
   ==============================================================================
 */
 
+class ValueTreeSnapshot::Node  : public ReferenceCountedObject
+{
+public:
+    typedef ReferenceCountedObjectPtr<Node> Ptr;
+
+    Node (const Identifier& t, const NamedValueSet& props)
+        : type (t), properties (props)
+    {
+    }
+
+    const Identifier type;
+    const NamedValueSet properties;
+    ReferenceCountedArray<Node> children;
+
+private:
+    JUCE_DECLARE_NON_COPYABLE (Node)
+};
+
+//==============================================================================
+/*  The data of a tree that was written by ValueTree::writeToIndexedStream(). This is
+    kept alive by any nodes whose children haven't been loaded yet.
+
+    The format is:
+      - a magic number
+      - the number of distinct identifiers, followed by the identifiers as strings
+      - the nodes. Each node is written after all its children, and holds its type and
+        property names as indexes into the identifier table, its property values (in the
+        format used by var::writeToStream), then the number of children and a table of the
+        32-bit offsets of the children's nodes from the start of the data
+      - the offset of the root node, followed by the magic number again
+*/
+class ValueTreeIndexedData  : public ReferenceCountedObject
+{
+public:
+    typedef ReferenceCountedObjectPtr<ValueTreeIndexedData> Ptr;
+
+    enum { magicNumber = 0x31425456 }; // "VTB1"
+
+    ValueTreeIndexedData (MemoryMappedFile* file)
+        : mappedFile (file),
+          data (static_cast<const char*> (file->getData())),
+          size (file->getSize()),
+          rootOffset (0), firstNodeOffset (0)
+    {
+    }
+
+    ValueTreeIndexedData (const void* sourceData, size_t numBytes)
+        : block (sourceData, numBytes),
+          data (static_cast<const char*> (block.getData())),
+          size (numBytes),
+          rootOffset (0), firstNodeOffset (0)
+    {
+    }
+
+    bool readHeader()
+    {
+        if (data == nullptr || size < 12 || size > 0xffffffff)
+            return false;
+
+        MemoryInputStream trailer (data + size - 8, 8, false);
+        rootOffset = (uint32) trailer.readInt();
+
+        if (trailer.readInt() != (int) magicNumber)
+            return false;
+
+        MemoryInputStream in (data, size - 8, false);
+
+        if (in.readInt() != (int) magicNumber)
+            return false;
+
+        int numIdentifiers;
+
+        if (! readCount (in, numIdentifiers))
+            return false;
+
+        identifiers.ensureStorageAllocated (numIdentifiers);
+
+        for (int i = 0; i < numIdentifiers; ++i)
+        {
+            String name;
+
+            if (! readString (in, name) || name.isEmpty())
+                return false;
+
+            identifiers.add (name);
+        }
+
+        firstNodeOffset = (uint32) in.getPosition();
+        return rootOffset >= firstNodeOffset && rootOffset < size - 8;
+    }
+
+    //==============================================================================
+    // The data may be corrupted, so these check everything that they read, and fail
+    // instead of making the InputStream and var methods assert.
+    static bool readCompressedInt (MemoryInputStream& in, int& result)
+    {
+        if (in.isExhausted())
+            return false;
+
+        const uint8 sizeByte = *getCurrentData (in);
+        const int numBytes = sizeByte & 0x7f;
+
+        if (numBytes > 4 || numBytes >= in.getNumBytesRemaining())
+            return false;
+
+        result = in.readCompressedInt();
+        return true;
+    }
+
+    // Reads a number of items, each of which must take up at least one byte
+    static bool readCount (MemoryInputStream& in, int& result)
+    {
+        return readCompressedInt (in, result)
+                && result >= 0 && result <= in.getNumBytesRemaining();
+    }
+
+    static bool readString (MemoryInputStream& in, String& result)
+    {
+        const char* const text = getCurrentData (in);
+        const size_t maxBytes = (size_t) in.getNumBytesRemaining();
+        const char* const terminator = static_cast<const char*> (memchr (text, 0, maxBytes));
+
+        if (terminator == nullptr || ! CharPointer_UTF8::isValidString (text, (int) (terminator - text)))
+            return false;
+
+        result = String::fromUTF8 (text, (int) (terminator - text));
+        in.skipNextBytes ((int64) (terminator - text) + 1);
+        return true;
+    }
+
+    static bool readVar (MemoryInputStream& in, var& result)
+    {
+        const int64 start = in.getPosition();
+
+        if (! skipVar (in, 0))
+            return false;
+
+        const int64 end = in.getPosition();
+        in.setPosition (start);
+        result = var::readFromStream (in);
+        return in.setPosition (end);
+    }
+
+    // Checks a value that was written by var::writeToStream()
+    static bool skipVar (MemoryInputStream& in, const int depth)
+    {
+        // (these are the type markers that var::writeToStream() uses)
+        enum { intMarker = 1, boolTrueMarker, boolFalseMarker, doubleMarker, stringMarker, int64Marker, arrayMarker };
+
+        int numBytes;
+
+        if (depth > 100 || ! readCompressedInt (in, numBytes)
+             || numBytes < 0 || numBytes > in.getNumBytesRemaining())
+            return false;
+
+        if (numBytes == 0)
+            return true;
+
+        const char* const item = getCurrentData (in);
+        const int64 end = in.getPosition() + numBytes;
+
+        switch (*item)
+        {
+            case intMarker:         if (numBytes != 5) return false; break;
+            case boolTrueMarker:
+            case boolFalseMarker:   if (numBytes != 1) return false; break;
+            case doubleMarker:
+            case int64Marker:       if (numBytes != 9) return false; break;
+            default:                break;
+        }
+
+        if (*item == stringMarker)
+        {
+            if (! CharPointer_UTF8::isValidString (item + 1, numBytes - 1))
+                return false;
+        }
+        else if (*item == arrayMarker)
+        {
+            MemoryInputStream items (item + 1, (size_t) numBytes - 1, false);
+            int numItems;
+
+            if (! readCount (items, numItems))
+                return false;
+
+            while (--numItems >= 0)
+                if (! skipVar (items, depth + 1))
+                    return false;
+
+            if (! items.isExhausted())
+                return false;
+        }
+
+        return in.setPosition (end);
+    }
+
+    static const char* getCurrentData (MemoryInputStream& in) noexcept
+    {
+        return static_cast<const char*> (in.getData()) + in.getPosition();
+    }
+
+    ScopedPointer<MemoryMappedFile> mappedFile;
+    MemoryBlock block;
+    const char* const data;
+    const size_t size;
+    Array<Identifier> identifiers;
+    uint32 rootOffset, firstNodeOffset;
+
+private:
+    JUCE_DECLARE_NON_COPYABLE (ValueTreeIndexedData)
+};
+
+//==============================================================================
 class ValueTree::SharedObject  : public ReferenceCountedObject
 {
 public:
     typedef ReferenceCountedObjectPtr<SharedObject> Ptr;
 
     explicit SharedObject (const Identifier& t) noexcept
-        : type (t), parent (nullptr)
+        : type (t), parent (nullptr), lazyChildListOffset (0), lazySubtreeStart (0)
     {
     }
 
     SharedObject (const SharedObject& other)
         : ReferenceCountedObject(),
-          type (other.type), properties (other.properties), parent (nullptr)
+          type (other.type), properties (other.properties), snapshot (other.snapshot), parent (nullptr),
+          lazyChildListOffset (0), lazySubtreeStart (0)
     {
+        other.loadChildren();
+
         for (int i = 0; i < other.children.size(); ++i)
         {
             SharedObject* const child = new SharedObject (*other.children.getObjectPointerUnchecked(i));
@@ -62,6 +277,187 @@ public:
         return parent == nullptr ? this : parent->getRoot();
     }
 
+    //==============================================================================
+    // Creates a node from the indexed format, leaving its children to be loaded when they're needed.
+    // The node and all its descendents must lie between subtreeStart and subtreeEnd, which stops a
+    // corrupted file from creating loops, or from making nodes share the same children.
+    static SharedObject* createFromIndexedData (ValueTreeIndexedData& source, const uint32 offset,
+                                                const uint32 subtreeStart, const uint32 subtreeEnd,
+                                                uint32& endOfNode)
+    {
+        if (offset < subtreeStart || offset >= subtreeEnd)
+            return nullptr;
+
+        MemoryInputStream in (source.data + offset, subtreeEnd - offset, false);
+
+        int typeIndex, numProperties;
+
+        if (! (ValueTreeIndexedData::readCompressedInt (in, typeIndex)
+                && isPositiveAndBelow (typeIndex, source.identifiers.size())
+                && ValueTreeIndexedData::readCount (in, numProperties)))
+            return nullptr;
+
+        ScopedPointer<SharedObject> s (new SharedObject (source.identifiers.getReference (typeIndex)));
+
+        for (int i = numProperties; --i >= 0;)
+        {
+            int nameIndex;
+            var value;
+
+            if (! (ValueTreeIndexedData::readCompressedInt (in, nameIndex)
+                    && isPositiveAndBelow (nameIndex, source.identifiers.size())
+                    && ValueTreeIndexedData::readVar (in, value)))
+                return nullptr;
+
+            s->properties.set (source.identifiers.getReference (nameIndex), value);
+        }
+
+        s->lazyChildListOffset = offset + (uint32) in.getPosition();
+        int numChildren;
+
+        if (! ValueTreeIndexedData::readCompressedInt (in, numChildren)
+             || numChildren < 0 || numChildren > in.getNumBytesRemaining() / 4)
+            return nullptr;
+
+        endOfNode = offset + (uint32) in.getPosition() + 4 * (uint32) numChildren;
+
+        if (numChildren > 0)
+        {
+            s->lazyData = &source;
+            s->lazySubtreeStart = subtreeStart;
+        }
+
+        return s.release();
+    }
+
+    static ValueTree createTreeFromIndexedData (ValueTreeIndexedData* const data)
+    {
+        const ValueTreeIndexedData::Ptr source (data);
+        uint32 endOfNode;
+
+        if (source->readHeader())
+            if (SharedObject* const root = createFromIndexedData (*source, source->rootOffset, source->firstNodeOffset,
+                                                                  (uint32) source->size - 8, endOfNode))
+                return ValueTree (root);
+
+        return ValueTree();
+    }
+
+    void loadChildren() const
+    {
+        if (lazyData != nullptr)
+            const_cast<SharedObject*> (this)->loadChildrenFromIndexedData();
+    }
+
+    void loadChildrenFromIndexedData()
+    {
+        const ValueTreeIndexedData::Ptr source (lazyData);
+        lazyData = nullptr;
+
+        MemoryInputStream in (source->data + lazyChildListOffset, source->size - lazyChildListOffset, false);
+        const int numChildren = in.readCompressedInt();
+        children.ensureStorageAllocated (numChildren);
+
+        // Each child's sub-tree comes after the previous one's, and before this node
+        uint32 childSubtreeStart = lazySubtreeStart;
+
+        for (int i = 0; i < numChildren; ++i)
+        {
+            const uint32 childOffset = (uint32) in.readInt();
+            uint32 endOfChild;
+
+            SharedObject* const child = createFromIndexedData (*source, childOffset, childSubtreeStart,
+                                                               lazyChildListOffset, endOfChild);
+            // (if the data is corrupted, the node just keeps the children that could be read)
+            if (child == nullptr)
+                break;
+
+            children.add (child);
+            child->parent = this;
+            childSubtreeStart = endOfChild;
+        }
+    }
+
+    static void addIdentifier (const Identifier& name, StringArray& names, HashMap<String, int>& indexes)
+    {
+        if (! indexes.contains (name.toString()))
+        {
+            indexes.set (name.toString(), names.size());
+            names.add (name.toString());
+        }
+    }
+
+    void findIdentifiers (StringArray& names, HashMap<String, int>& indexes) const
+    {
+        loadChildren();
+        addIdentifier (type, names, indexes);
+
+        for (int i = 0; i < properties.size(); ++i)
+            addIdentifier (properties.getName (i), names, indexes);
+
+        for (int i = 0; i < children.size(); ++i)
+            children.getObjectPointerUnchecked (i)->findIdentifiers (names, indexes);
+    }
+
+    uint32 writeToIndexedStream (OutputStream& output, const int64 startPosition,
+                                 const HashMap<String, int>& indexes) const
+    {
+        Array<uint32> childOffsets;
+        childOffsets.ensureStorageAllocated (children.size());
+
+        for (int i = 0; i < children.size(); ++i)
+            childOffsets.add (children.getObjectPointerUnchecked (i)->writeToIndexedStream (output, startPosition, indexes));
+
+        const int64 offset = output.getPosition() - startPosition;
+
+        // the indexed format can't hold more than 4GB!
+        jassert (offset < 0xffffffff);
+
+        output.writeCompressedInt (indexes [type.toString()]);
+        output.writeCompressedInt (properties.size());
+
+        for (int i = 0; i < properties.size(); ++i)
+        {
+            output.writeCompressedInt (indexes [properties.getName (i).toString()]);
+            properties.getValueAt (i).writeToStream (output);
+        }
+
+        output.writeCompressedInt (childOffsets.size());
+
+        for (int i = 0; i < childOffsets.size(); ++i)
+            output.writeInt ((int) childOffsets.getUnchecked (i));
+
+        return (uint32) offset;
+    }
+
+    //==============================================================================
+    ValueTreeSnapshot::Node* getSnapshot()
+    {
+        if (snapshot == nullptr)
+        {
+            loadChildren();
+
+            ValueTreeSnapshot::Node* const node = new ValueTreeSnapshot::Node (type, properties);
+            node->children.ensureStorageAllocated (children.size());
+
+            for (int i = 0; i < children.size(); ++i)
+                node->children.add (children.getObjectPointerUnchecked (i)->getSnapshot());
+
+            snapshot = node;
+        }
+
+        return snapshot;
+    }
+
+    // A node's snapshot includes those of all its children, so whenever a node changes, the
+    // snapshots of it and all its parents have to go. (And if a node hasn't got a snapshot,
+    // then its parents won't have one either)
+    void invalidateSnapshots() noexcept
+    {
+        for (SharedObject* t = this; t != nullptr && t->snapshot != nullptr; t = t->parent)
+            t->snapshot = nullptr;
+    }
+
     template <typename Method>
     void callListeners (Method method, ValueTree& tree) const
     {
@@ -207,7 +603,10 @@ public:
         if (undoManager == nullptr)
         {
             if (properties.set (name, newValue))
+            {
+                invalidateSnapshots();
                 sendPropertyChangeMessage (name, listenerToExclude);
+            }
         }
         else
         {
@@ -233,7 +632,10 @@ public:
         if (undoManager == nullptr)
         {
             if (properties.remove (name))
+            {
+                invalidateSnapshots();
                 sendPropertyChangeMessage (name);
+            }
         }
         else
         {
@@ -250,6 +652,7 @@ public:
             {
                 const Identifier name (properties.getName (properties.size() - 1));
                 properties.remove (name);
+                invalidateSnapshots();
                 sendPropertyChangeMessage (name);
             }
         }
@@ -273,6 +676,8 @@ public:
 
     ValueTree getChildWithName (const Identifier& typeToMatch) const
     {
+        loadChildren();
+
         for (int i = 0; i < children.size(); ++i)
         {
             SharedObject* const s = children.getObjectPointerUnchecked (i);
@@ -285,6 +690,8 @@ public:
 
     ValueTree getOrCreateChildWithName (const Identifier& typeToMatch, UndoManager* undoManager)
     {
+        loadChildren();
+
         for (int i = 0; i < children.size(); ++i)
         {
             SharedObject* const s = children.getObjectPointerUnchecked (i);
@@ -300,6 +707,8 @@ public:
 
     ValueTree getChildWithProperty (const Identifier& propertyName, const var& propertyValue) const
     {
+        loadChildren();
+
         for (int i = 0; i < children.size(); ++i)
         {
             SharedObject* const s = children.getObjectPointerUnchecked (i);
@@ -326,6 +735,8 @@ public:
 
     void addChild (SharedObject* child, int index, UndoManager* const undoManager)
     {
+        loadChildren();
+
         if (child != nullptr && child->parent != this)
         {
             if (child != this && ! isAChildOf (child))
@@ -345,6 +756,7 @@ public:
                 {
                     children.insert (index, child);
                     child->parent = this;
+                    invalidateSnapshots();
                     sendChildAddedMessage (ValueTree (child));
                     child->sendParentChangeMessage();
                 }
@@ -367,12 +779,15 @@ public:
 
     void removeChild (const int childIndex, UndoManager* const undoManager)
     {
+        loadChildren();
+
         if (const Ptr child = children.getObjectPointer (childIndex))
         {
             if (undoManager == nullptr)
             {
                 children.remove (childIndex);
                 child->parent = nullptr;
+                invalidateSnapshots();
                 sendChildRemovedMessage (ValueTree (child), childIndex);
                 child->sendParentChangeMessage();
             }
@@ -385,12 +800,16 @@ public:
 
     void removeAllChildren (UndoManager* const undoManager)
     {
+        loadChildren();
+
         while (children.size() > 0)
             removeChild (children.size() - 1, undoManager);
     }
 
     void moveChild (int currentIndex, int newIndex, UndoManager* undoManager)
     {
+        loadChildren();
+
         // The source index must be a valid index!
         jassert (isPositiveAndBelow (currentIndex, children.size()));
 
@@ -400,6 +819,7 @@ public:
             if (undoManager == nullptr)
             {
                 children.move (currentIndex, newIndex);
+                invalidateSnapshots();
                 sendChildOrderChangedMessage (currentIndex, newIndex);
             }
             else
@@ -414,6 +834,7 @@ public:
 
     void reorderChildren (const OwnedArray<ValueTree>& newOrder, UndoManager* undoManager)
     {
+        loadChildren();
         jassert (newOrder.size() == children.size());
 
         for (int i = 0; i < children.size(); ++i)
@@ -429,8 +850,11 @@ public:
         }
     }
 
-    bool isEquivalentTo (const SharedObject& other) const noexcept
+    bool isEquivalentTo (const SharedObject& other) const
     {
+        loadChildren();
+        other.loadChildren();
+
         if (type != other.type
              || properties.size() != other.properties.size()
              || children.size() != other.children.size()
@@ -446,6 +870,8 @@ public:
 
     XmlElement* createXml() const
     {
+        loadChildren();
+
         XmlElement* const xml = new XmlElement (type);
         properties.copyToXmlAttributes (*xml);
 
@@ -458,6 +884,8 @@ public:
 
     void writeToStream (OutputStream& output) const
     {
+        loadChildren();
+
         output.writeString (type.toString());
         output.writeCompressedInt (properties.size());
 
@@ -487,6 +915,56 @@ public:
         }
     }
 
+    //==============================================================================
+    // These return the approximate number of bytes that a value or tree uses on the heap,
+    // which is what the undoable actions report as their size to the UndoManager.
+    static int getHeapSizeInBytes (const var& v, const int depth = 0)
+    {
+        if (v.isString())
+            return (int) v.toString().getCharPointer().sizeInBytes();
+
+        if (const MemoryBlock* const block = v.getBinaryData())
+            return (int) block->getSize();
+
+        if (DynamicObject* const object = v.getDynamicObject())
+            return (int) sizeof (DynamicObject) + getHeapSizeInBytes (object->getProperties(), depth + 1);
+
+        if (const Array<var>* const array = v.getArray())
+        {
+            int total = array->size() * (int) sizeof (var);
+
+            // (arrays and objects can contain references to themselves, so don't go too deep)
+            if (depth < 8)
+                for (int i = 0; i < array->size(); ++i)
+                    total += getHeapSizeInBytes (array->getReference (i), depth + 1);
+
+            return total;
+        }
+
+        return 0;
+    }
+
+    static int getHeapSizeInBytes (const NamedValueSet& values, const int depth = 0)
+    {
+        int total = values.size() * (int) (sizeof (Identifier) + sizeof (var));
+
+        if (depth < 8)
+            for (int i = 0; i < values.size(); ++i)
+                total += getHeapSizeInBytes (values.getValueAt (i), depth + 1);
+
+        return total;
+    }
+
+    int getSubtreeSizeInBytes() const
+    {
+        int total = (int) sizeof (SharedObject) + getHeapSizeInBytes (properties);
+
+        for (int i = 0; i < children.size(); ++i)
+            total += (int) sizeof (Ptr) + children.getObjectPointerUnchecked (i)->getSubtreeSizeInBytes();
+
+        return total;
+    }
+
     //==============================================================================
     struct SetPropertyAction  : public UndoableAction
     {
@@ -495,7 +973,8 @@ public:
                            ValueTree::Listener* listenerToExclude = nullptr)
             : target (so), name (propertyName), newValue (newVal), oldValue (oldVal),
               isAddingNewProperty (isAdding), isDeletingProperty (isDeleting),
-              excludeListener (listenerToExclude)
+              excludeListener (listenerToExclude),
+              sizeInBytes ((int) sizeof (SetPropertyAction) + getHeapSizeInBytes (newVal) + getHeapSizeInBytes (oldVal))
         {
         }
 
@@ -523,17 +1002,25 @@ public:
 
         int getSizeInUnits() override
         {
-            return (int) sizeof (*this); //xxx should be more accurate
+            return sizeInBytes;
         }
 
         UndoableAction* createCoalescedAction (UndoableAction* nextAction) override
         {
-            if (! (isAddingNewProperty || isDeletingProperty))
+            if (SetPropertyAction* const next = dynamic_cast<SetPropertyAction*> (nextAction))
             {
-                if (SetPropertyAction* const next = dynamic_cast<SetPropertyAction*> (nextAction))
-                    if (next->target == target && next->name == name
-                          && ! (next->isAddingNewProperty || next->isDeletingProperty))
-                        return new SetPropertyAction (target, name, next->newValue, oldValue, false, false);
+                if (next->target == target && next->name == name && ! isDeletingProperty)
+                {
+                    // Adding or changing a property and then changing it again is the same as
+                    // adding or changing it to the final value, and changing it and then deleting
+                    // it is the same as just deleting it. (But adding a property and then deleting
+                    // it has to stay as two actions, because there's no action that does nothing)
+                    if (! (next->isAddingNewProperty || next->isDeletingProperty))
+                        return new SetPropertyAction (target, name, next->newValue, oldValue, isAddingNewProperty, false);
+
+                    if (next->isDeletingProperty && ! isAddingNewProperty)
+                        return new SetPropertyAction (target, name, var(), oldValue, false, true);
+                }
             }
 
             return nullptr;
@@ -546,6 +1033,7 @@ public:
         var oldValue;
         const bool isAddingNewProperty : 1, isDeletingProperty : 1;
         ValueTree::Listener* excludeListener;
+        const int sizeInBytes;
 
         JUCE_DECLARE_NON_COPYABLE (SetPropertyAction)
     };
@@ -557,9 +1045,16 @@ public:
             : target (parentObject),
               child (newChild != nullptr ? newChild : parentObject->children.getObjectPointer (index)),
               childIndex (index),
-              isDeleting (newChild == nullptr)
+              isDeleting (newChild == nullptr),
+              sizeInBytes ((int) sizeof (AddOrRemoveChildAction))
         {
             jassert (child != nullptr);
+
+            // Once it's been removed, the undo history may be the only thing that's keeping the
+            // child alive. (This is measured once now, because the size that an action reports
+            // mustn't change while the UndoManager is holding it)
+            if (isDeleting)
+                sizeInBytes += child->getSubtreeSizeInBytes();
         }
 
         bool perform() override
@@ -591,13 +1086,24 @@ public:
 
         int getSizeInUnits() override
         {
-            return (int) sizeof (*this); //xxx should be more accurate
+            return sizeInBytes;
+        }
+
+        UndoableAction* createCoalescedAction (UndoableAction* nextAction) override
+        {
+            // removing a child and then putting it back into the same parent is just a move..
+            if (AddOrRemoveChildAction* const next = dynamic_cast<AddOrRemoveChildAction*> (nextAction))
+                if (isDeleting && ! next->isDeleting && next->target == target && next->child == child)
+                    return new MoveChildAction (target, childIndex, next->childIndex);
+
+            return nullptr;
         }
 
     private:
         const Ptr target, child;
         const int childIndex;
         const bool isDeleting;
+        int sizeInBytes;
 
         JUCE_DECLARE_NON_COPYABLE (AddOrRemoveChildAction)
     };
@@ -624,7 +1130,7 @@ public:
 
         int getSizeInUnits() override
         {
-            return (int) sizeof (*this); //xxx should be more accurate
+            return (int) sizeof (MoveChildAction);
         }
 
         UndoableAction* createCoalescedAction (UndoableAction* nextAction) override
@@ -647,8 +1153,11 @@ public:
     const Identifier type;
     NamedValueSet properties;
     ReferenceCountedArray<SharedObject> children;
+    ValueTreeSnapshot::Node::Ptr snapshot;
     SortedSet<ValueTree*> valueTreesWithListeners;
     SharedObject* parent;
+    ValueTreeIndexedData::Ptr lazyData;
+    uint32 lazyChildListOffset, lazySubtreeStart;
 
 private:
     SharedObject& operator= (const SharedObject&);
@@ -737,6 +1246,11 @@ ValueTree ValueTree::createCopy() const
     return ValueTree (createCopyIfNotNull (object.get()));
 }
 
+ValueTreeSnapshot ValueTree::createSnapshot() const
+{
+    return ValueTreeSnapshot (object != nullptr ? object->getSnapshot() : nullptr);
+}
+
 bool ValueTree::hasType (const Identifier& typeName) const noexcept
 {
     return object != nullptr && object->type == typeName;
@@ -905,18 +1419,31 @@ Value ValueTree::getPropertyAsValue (const Identifier& name, UndoManager* const
 //==============================================================================
 int ValueTree::getNumChildren() const noexcept
 {
-    return object == nullptr ? 0 : object->children.size();
+    if (object == nullptr)
+        return 0;
+
+    object->loadChildren();
+    return object->children.size();
 }
 
 ValueTree ValueTree::getChild (int index) const
 {
-    return ValueTree (object != nullptr ? object->children.getObjectPointer (index)
-                                        : static_cast<SharedObject*> (nullptr));
+    if (object == nullptr)
+        return ValueTree();
+
+    object->loadChildren();
+    return ValueTree (object->children.getObjectPointer (index));
 }
 
 ValueTree::Iterator::Iterator (const ValueTree& v, bool isEnd) noexcept
-   : internal (v.object != nullptr ? (isEnd ? v.object->children.end() : v.object->children.begin()) : nullptr)
-{}
+   : internal (nullptr)
+{
+    if (v.object != nullptr)
+    {
+        v.object->loadChildren();
+        internal = isEnd ? v.object->children.end() : v.object->children.begin();
+    }
+}
 
 ValueTree::Iterator& ValueTree::Iterator::operator++() noexcept
 {
@@ -998,6 +1525,7 @@ void ValueTree::moveChild (int currentIndex, int newIndex, UndoManager* undoMana
 void ValueTree::createListOfChildren (OwnedArray<ValueTree>& list) const
 {
     jassert (object != nullptr);
+    object->loadChildren();
 
     for (int i = 0; i < object->children.size(); ++i)
         list.add (new ValueTree (object->children.getObjectPointerUnchecked(i)));
@@ -1133,6 +1661,45 @@ ValueTree ValueTree::readFromGZIPData (const void* const data, const size_t numB
     return readFromStream (gzipStream);
 }
 
+//==============================================================================
+void ValueTree::writeToIndexedStream (OutputStream& output) const
+{
+    if (object != nullptr)
+    {
+        const int64 startPosition = output.getPosition();
+
+        StringArray identifiers;
+        HashMap<String, int> indexes;
+        object->findIdentifiers (identifiers, indexes);
+
+        output.writeInt ((int) ValueTreeIndexedData::magicNumber);
+        output.writeCompressedInt (identifiers.size());
+
+        for (int i = 0; i < identifiers.size(); ++i)
+            output.writeString (identifiers[i]);
+
+        const uint32 rootOffset = object->writeToIndexedStream (output, startPosition, indexes);
+
+        output.writeInt ((int) rootOffset);
+        output.writeInt ((int) ValueTreeIndexedData::magicNumber);
+    }
+}
+
+ValueTree ValueTree::loadFromIndexedFile (const File& file)
+{
+    ScopedPointer<MemoryMappedFile> mappedFile (new MemoryMappedFile (file, MemoryMappedFile::readOnly));
+
+    if (mappedFile->getData() == nullptr)
+        return ValueTree();
+
+    return SharedObject::createTreeFromIndexedData (new ValueTreeIndexedData (mappedFile.release()));
+}
+
+ValueTree ValueTree::readFromIndexedData (const void* const data, const size_t numBytes)
+{
+    return SharedObject::createTreeFromIndexedData (new ValueTreeIndexedData (data, numBytes));
+}
+
 void ValueTree::Listener::valueTreeRedirected (ValueTree&) {}
 
 //==============================================================================
@@ -1180,6 +1747,28 @@ public:
         return CharPointer_UTF32 (buffer);
     }
 
+    static ValueTree createTestTree (int numChildren, int numGrandchildren)
+    {
+        ValueTree root ("root");
+
+        for (int i = 0; i < numChildren; ++i)
+        {
+            ValueTree child ("child");
+
+            for (int j = 0; j < numGrandchildren; ++j)
+            {
+                ValueTree grandchild ("grandchild");
+                grandchild.setProperty ("value", j, nullptr);
+                grandchild.setProperty ("name", "node " + String (j), nullptr);
+                child.addChild (grandchild, -1, nullptr);
+            }
+
+            root.addChild (child, -1, nullptr);
+        }
+
+        return root;
+    }
+
     static ValueTree createRandomTree (UndoManager* undoManager, int depth, Random& r)
     {
         ValueTree v (createRandomIdentifier (r));
@@ -1222,6 +1811,288 @@ public:
             ValueTree v4 = v2.createCopy();
             expect (v1.isEquivalentTo (v4));
         }
+
+        beginTest ("Snapshots");
+        {
+            for (int i = 10; --i >= 0;)
+            {
+                ValueTree v1 (createRandomTree (nullptr, 0, r));
+                const ValueTreeSnapshot s1 (v1.createSnapshot());
+
+                expect (s1.createValueTree().isEquivalentTo (v1));
+                expect (v1.createSnapshot() == s1);
+
+                MemoryOutputStream mo1, mo2;
+                v1.writeToStream (mo1);
+                s1.writeToStream (mo2);
+                expect (mo1.getMemoryBlock() == mo2.getMemoryBlock());
+
+                ScopedPointer<XmlElement> xml1 (v1.createXml());
+                ScopedPointer<XmlElement> xml2 (s1.createXml());
+                expect (xml1->isEquivalentTo (xml2, false));
+
+                // a copy of a tree can share the snapshots of the original
+                expect (v1.createCopy().createSnapshot() == s1);
+            }
+
+            ValueTree root ("root");
+
+            for (int i = 0; i < 10; ++i)
+            {
+                ValueTree child ("child");
+                child.setProperty ("index", i, nullptr);
+
+                for (int j = 0; j < 10; ++j)
+                {
+                    ValueTree grandchild ("grandchild");
+                    grandchild.setProperty ("index", j, nullptr);
+                    child.addChild (grandchild, -1, nullptr);
+                }
+
+                root.addChild (child, -1, nullptr);
+            }
+
+            const ValueTreeSnapshot before (root.createSnapshot());
+            ValueTree modified (root.getChild (3).getChild (4));
+            modified.setProperty ("index", 100, nullptr);
+            const ValueTreeSnapshot after (root.createSnapshot());
+
+            // only the path down to the node that changed should have been copied..
+            expect (before != after);
+            expect ((int) before.getChild (3).getChild (4)["index"] == 4);
+            expect ((int) after.getChild (3).getChild (4)["index"] == 100);
+            expect (before.getChild (3) != after.getChild (3));
+            expect (before.getChild (3).getChild (5) == after.getChild (3).getChild (5));
+
+            for (int i = 0; i < 10; ++i)
+                if (i != 3)
+                    expect (before.getChild (i) == after.getChild (i));
+
+            expect (! before.isEquivalentTo (after));
+
+            UndoManager undoManager;
+            modified.setProperty ("index", 4, &undoManager);
+            expect (root.createSnapshot().isEquivalentTo (before));
+            undoManager.undo();
+            expect (root.createSnapshot().isEquivalentTo (after));
+
+            root.getChild (7).removeChild (2, nullptr);
+            root.moveChild (0, 9, nullptr);
+            root.getChild (1).removeProperty ("index", nullptr);
+            expect (root.createSnapshot().createValueTree().isEquivalentTo (root));
+            expect (root.createSnapshot().getChildWithProperty ("index", 7).getNumChildren() == 9);
+            expect (after.getChild (7).getNumChildren() == 10);
+        }
+
+        beginTest ("Indexed format");
+        {
+            for (int i = 10; --i >= 0;)
+            {
+                ValueTree v1 (createRandomTree (nullptr, 0, r));
+
+                MemoryOutputStream mo;
+                mo.writeString ("some data before the tree");
+                const size_t start = mo.getDataSize();
+                v1.writeToIndexedStream (mo);
+
+                const ValueTree v2 (ValueTree::readFromIndexedData (addBytesToPointer (mo.getData(), start), mo.getDataSize() - start));
+                expect (v1.isEquivalentTo (v2));
+                expect (v2.createCopy().isEquivalentTo (v1));
+
+                // corrupted data shouldn't cause any trouble..
+                MemoryBlock corrupted (addBytesToPointer (mo.getData(), start), mo.getDataSize() - start);
+
+                for (int j = 0; j < 10; ++j)
+                    corrupted[r.nextInt ((int) corrupted.getSize())] = (char) r.nextInt (256);
+
+                // (copying the tree loads all of its nodes)
+                ValueTree::readFromIndexedData (corrupted.getData(), corrupted.getSize()).createCopy();
+                expect (! ValueTree::readFromIndexedData (corrupted.getData(), corrupted.getSize() / 2).isValid());
+            }
+
+            const ValueTree original (createTestTree (20, 20));
+            MemoryOutputStream mo;
+            original.writeToIndexedStream (mo);
+
+            // make some changes to a tree that hasn't been fully loaded..
+            UndoManager undoManager;
+            ValueTree v (ValueTree::readFromIndexedData (mo.getData(), mo.getDataSize()));
+
+            v.getChild (3).addChild (ValueTree ("extra"), 5, &undoManager);
+            v.getChild (4).removeChild (2, &undoManager);
+            v.getChild (5).getChild (6).setProperty ("value", "changed", &undoManager);
+
+            expectEquals (v.getChild (3).getNumChildren(), 21);
+            expect (v.getChild (3).getChild (5).hasType ("extra"));
+            expect (! v.isEquivalentTo (original));
+
+            v.moveChild (0, 10, &undoManager);
+
+            while (undoManager.undo())
+            {}
+
+            expect (v.isEquivalentTo (original));
+
+            TemporaryFile tempFile;
+
+            {
+                FileOutputStream out (tempFile.getFile());
+                original.writeToIndexedStream (out);
+            }
+
+            const ValueTree fromFile (ValueTree::loadFromIndexedFile (tempFile.getFile()));
+            expect ((int) fromFile.getChild (19).getChild (19)["value"] == 19);
+            expect (fromFile.isEquivalentTo (original));
+            expect (! ValueTree::loadFromIndexedFile (File::nonexistent).isValid());
+        }
+
+        beginTest ("Undo coalescing");
+        {
+            UndoManager um;
+            ValueTree v (createTestTree (3, 3));
+            const ValueTree original (v.createCopy());
+
+            um.beginNewTransaction();
+
+            for (int i = 0; i < 1000; ++i)
+                v.setProperty ("x", i, &um);
+
+            for (int i = 0; i < 1000; ++i)
+                v.getChild (0).getChild (0).setProperty ("value", i, &um);
+
+            expectEquals (um.getNumActionsInCurrentTransaction(), 2);
+
+            um.beginNewTransaction();
+
+            for (int i = 0; i < 1000; ++i)
+                v.getChild (1).getChild (0).setProperty ("name", i, &um);
+
+            v.getChild (1).getChild (0).removeProperty ("name", &um);
+            expectEquals (um.getNumActionsInCurrentTransaction(), 1);
+
+            um.beginNewTransaction();
+            const ValueTree child (v.getChild (0));
+            v.removeChild (child, &um);
+            v.addChild (child, 2, &um);
+            expectEquals (um.getNumActionsInCurrentTransaction(), 1);
+            expect (v.getChild (2) == child);
+
+            const ValueTree changed (v.createCopy());
+
+            while (um.canUndo())
+                um.undo();
+
+            expect (v.isEquivalentTo (original));
+
+            while (um.canRedo())
+                um.redo();
+
+            expect (v.isEquivalentTo (changed));
+            expect (v["x"] == var (999));
+            expect (v.getChild (2).getChild (0)["value"] == var (999));
+            expect (! v.getChild (0).getChild (0).hasProperty ("name"));
+        }
+
+        beginTest ("Undo memory limit");
+        {
+            UndoManager um (100000, 1);
+            ValueTree v ("root");
+
+            for (int i = 0; i < 100; ++i)
+            {
+                um.beginNewTransaction();
+                v.setProperty ("text", String::repeatedString ("x", 1000 + i), &um);
+            }
+
+            // each action keeps both the new and old strings, which take a few KB..
+            expect (um.getNumberOfUnitsTakenUpByStoredCommands() > 50000);
+            expect (um.getNumberOfUnitsTakenUpByStoredCommands() <= 100000);
+
+            int numUndos = 0;
+
+            while (um.undo())
+                ++numUndos;
+
+            expect (numUndos > 10 && numUndos < 50);
+            expect (v["text"].toString().length() == 1000 + 99 - numUndos);
+
+            um.clearUndoHistory();
+            ValueTree child (createTestTree (10, 10));
+            v.addChild (child, -1, &um);
+            const int sizeWhenAdded = um.getNumberOfUnitsTakenUpByStoredCommands();
+
+            um.beginNewTransaction();
+            v.removeChild (child, &um);
+
+            // ..and removing a child makes the undo history keep the whole subtree
+            expect (um.getNumberOfUnitsTakenUpByStoredCommands() - sizeWhenAdded > 100 * (int) sizeof (var));
+        }
+
+        beginTest ("Indexed format performance");
+        {
+            const ValueTree original (createTestTree (100, 500));
+            MemoryOutputStream oldFormat, newFormat;
+
+            double start = Time::getMillisecondCounterHiRes();
+            original.writeToStream (oldFormat);
+            const double oldWriteTime = Time::getMillisecondCounterHiRes() - start;
+
+            start = Time::getMillisecondCounterHiRes();
+            original.writeToIndexedStream (newFormat);
+            const double newWriteTime = Time::getMillisecondCounterHiRes() - start;
+
+            start = Time::getMillisecondCounterHiRes();
+            const ValueTree v1 (ValueTree::readFromData (oldFormat.getData(), oldFormat.getDataSize()));
+            const double oldReadTime = Time::getMillisecondCounterHiRes() - start;
+
+            start = Time::getMillisecondCounterHiRes();
+            const ValueTree v2 (ValueTree::readFromIndexedData (newFormat.getData(), newFormat.getDataSize()));
+            expect (v2.getChild (50).getChild (250)["name"] == "node 250");
+            const double lazyReadTime = Time::getMillisecondCounterHiRes() - start;
+
+            start = Time::getMillisecondCounterHiRes();
+            expect (v2.isEquivalentTo (original));
+            const double fullLoadTime = Time::getMillisecondCounterHiRes() - start;
+
+            expect (v1.isEquivalentTo (original));
+            expect (newFormat.getDataSize() < oldFormat.getDataSize());
+
+            logMessage ("50000 nodes: writeToStream " + String (oldFormat.getDataSize() / 1024) + "KB in " + String (oldWriteTime, 2)
+                          + "ms, writeToIndexedStream " + String (newFormat.getDataSize() / 1024) + "KB in " + String (newWriteTime, 2) + "ms");
+
+            logMessage ("readFromData " + String (oldReadTime, 2) + "ms, readFromIndexedData and access one node "
+                          + String (lazyReadTime, 3) + "ms, then load the rest " + String (fullLoadTime, 2) + "ms");
+        }
+
+        beginTest ("Snapshot performance");
+        {
+            ValueTree root (createTestTree (100, 500));
+
+            double start = Time::getMillisecondCounterHiRes();
+            const ValueTree copy (root.createCopy());
+            const double copyTime = Time::getMillisecondCounterHiRes() - start;
+
+            start = Time::getMillisecondCounterHiRes();
+            const ValueTreeSnapshot firstSnapshot (root.createSnapshot());
+            const double firstSnapshotTime = Time::getMillisecondCounterHiRes() - start;
+
+            const int numEdits = 100;
+            start = Time::getMillisecondCounterHiRes();
+
+            for (int i = 0; i < numEdits; ++i)
+            {
+                root.getChild (r.nextInt (100)).getChild (r.nextInt (500)).setProperty ("value", i, nullptr);
+                const ValueTreeSnapshot s (root.createSnapshot());
+            }
+
+            const double snapshotTime = (Time::getMillisecondCounterHiRes() - start) / numEdits;
+
+            expect (copy.isEquivalentTo (firstSnapshot.createValueTree()));
+
+            logMessage ("50000 nodes: createCopy " + String (copyTime, 2) + "ms, first snapshot "
+                          + String (firstSnapshotTime, 2) + "ms, snapshot after an edit "
+                          + String (snapshotTime, 3) + "ms");
+        }
     }
 };
 
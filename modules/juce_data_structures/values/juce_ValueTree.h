@@ -25,6 +25,7 @@
 #ifndef JUCE_VALUETREE_H_INCLUDED
 #define JUCE_VALUETREE_H_INCLUDED
 
+class ValueTreeSnapshot;
 
 //==============================================================================
 /**
@@ -129,6 +130,16 @@ public:
     /** Returns a deep copy of this tree and all its sub-nodes. */
     ValueTree createCopy() const;
 
+    /** Returns an immutable snapshot of the current state of this tree and all its sub-nodes,
+        which other threads can safely read while this tree carries on being modified.
+
+        This is much faster than createCopy(), because any parts of the tree that haven't
+        changed since the last snapshot was taken are shared rather than copied.
+
+        @see ValueTreeSnapshot
+    */
+    ValueTreeSnapshot createSnapshot() const;
+
     //==============================================================================
     /** Returns the type of this node.
         The type is specified when the ValueTree is created.
@@ -397,6 +408,36 @@ public:
     */
     static ValueTree readFromGZIPData (const void* data, size_t numBytes);
 
+    //==============================================================================
+    /** Stores this tree (and all its children) in an indexed binary format, which can be
+        read back with loadFromIndexedFile() or readFromIndexedData().
+
+        This is more compact than the format used by writeToStream(), as each type and
+        property name is only stored once, and it records where the children of each node
+        can be found, so that a tree can be loaded lazily.
+    */
+    void writeToIndexedStream (OutputStream& output) const;
+
+    /** Memory-maps a file that was written with writeToIndexedStream(), and returns its root node.
+
+        To begin with, only the root node is read: the children of a node are loaded the first
+        time they're needed, so that opening even a very big tree is quick, and any parts of it
+        that aren't used won't be loaded at all. (Things that visit the whole tree, e.g.
+        createCopy() or writeToStream(), will of course load all of it).
+
+        The file stays mapped until all its nodes have been loaded, so don't overwrite it
+        while a tree that was loaded from it is still in use.
+
+        Returns an invalid tree if the file can't be opened or isn't in the right format.
+    */
+    static ValueTree loadFromIndexedFile (const File& file);
+
+    /** Reads a tree from a data block that was written with writeToIndexedStream().
+        The data is copied, and as with loadFromIndexedFile(), the nodes are only loaded
+        when they're needed.
+    */
+    static ValueTree readFromIndexedData (const void* data, size_t numBytes);
+
     //==============================================================================
     /** Listener class for events that happen to a ValueTree.
 
@@ -0,0 +1,212 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2015 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+ValueTreeSnapshot::ValueTreeSnapshot() noexcept {}
+ValueTreeSnapshot::ValueTreeSnapshot (Node* n) noexcept  : node (n) {}
+ValueTreeSnapshot::ValueTreeSnapshot (const ValueTreeSnapshot& other) noexcept  : node (other.node) {}
+ValueTreeSnapshot::~ValueTreeSnapshot() {}
+
+ValueTreeSnapshot& ValueTreeSnapshot::operator= (const ValueTreeSnapshot& other) noexcept
+{
+    node = other.node;
+    return *this;
+}
+
+#if JUCE_COMPILER_SUPPORTS_MOVE_SEMANTICS
+ValueTreeSnapshot::ValueTreeSnapshot (ValueTreeSnapshot&& other) noexcept
+    : node (static_cast<Node::Ptr&&> (other.node))
+{
+}
+
+ValueTreeSnapshot& ValueTreeSnapshot::operator= (ValueTreeSnapshot&& other) noexcept
+{
+    node = static_cast<Node::Ptr&&> (other.node);
+    return *this;
+}
+#endif
+
+bool ValueTreeSnapshot::operator== (const ValueTreeSnapshot& other) const noexcept  { return node == other.node; }
+bool ValueTreeSnapshot::operator!= (const ValueTreeSnapshot& other) const noexcept  { return node != other.node; }
+
+bool ValueTreeSnapshot::isEquivalentTo (const ValueTreeSnapshot& other) const
+{
+    if (node == other.node)
+        return true;
+
+    if (node == nullptr || other.node == nullptr
+         || node->type != other.node->type
+         || node->children.size() != other.node->children.size()
+         || node->properties != other.node->properties)
+        return false;
+
+    for (int i = 0; i < node->children.size(); ++i)
+        if (! getChild (i).isEquivalentTo (other.getChild (i)))
+            return false;
+
+    return true;
+}
+
+//==============================================================================
+Identifier ValueTreeSnapshot::getType() const noexcept
+{
+    return node != nullptr ? node->type : Identifier();
+}
+
+bool ValueTreeSnapshot::hasType (const Identifier& typeName) const noexcept
+{
+    return node != nullptr && node->type == typeName;
+}
+
+const var& ValueTreeSnapshot::getProperty (const Identifier& name) const noexcept
+{
+    return node == nullptr ? getNullVarRef() : node->properties[name];
+}
+
+const var& ValueTreeSnapshot::operator[] (const Identifier& name) const noexcept
+{
+    return getProperty (name);
+}
+
+var ValueTreeSnapshot::getProperty (const Identifier& name, const var& defaultReturnValue) const
+{
+    return node == nullptr ? defaultReturnValue
+                           : node->properties.getWithDefault (name, defaultReturnValue);
+}
+
+const var* ValueTreeSnapshot::getPropertyPointer (const Identifier& name) const noexcept
+{
+    return node == nullptr ? nullptr
+                           : node->properties.getVarPointer (name);
+}
+
+bool ValueTreeSnapshot::hasProperty (const Identifier& name) const noexcept
+{
+    return node != nullptr && node->properties.contains (name);
+}
+
+int ValueTreeSnapshot::getNumProperties() const noexcept
+{
+    return node == nullptr ? 0 : node->properties.size();
+}
+
+Identifier ValueTreeSnapshot::getPropertyName (const int index) const noexcept
+{
+    return node == nullptr ? Identifier()
+                           : node->properties.getName (index);
+}
+
+//==============================================================================
+int ValueTreeSnapshot::getNumChildren() const noexcept
+{
+    return node == nullptr ? 0 : node->children.size();
+}
+
+ValueTreeSnapshot ValueTreeSnapshot::getChild (const int index) const
+{
+    return ValueTreeSnapshot (node != nullptr ? node->children.getObjectPointer (index)
+                                              : static_cast<Node*> (nullptr));
+}
+
+ValueTreeSnapshot ValueTreeSnapshot::getChildWithName (const Identifier& typeToMatch) const
+{
+    for (int i = 0; i < getNumChildren(); ++i)
+    {
+        Node* const n = node->children.getObjectPointerUnchecked (i);
+
+        if (n->type == typeToMatch)
+            return ValueTreeSnapshot (n);
+    }
+
+    return ValueTreeSnapshot();
+}
+
+ValueTreeSnapshot ValueTreeSnapshot::getChildWithProperty (const Identifier& propertyName, const var& propertyValue) const
+{
+    for (int i = 0; i < getNumChildren(); ++i)
+    {
+        Node* const n = node->children.getObjectPointerUnchecked (i);
+
+        if (n->properties[propertyName] == propertyValue)
+            return ValueTreeSnapshot (n);
+    }
+
+    return ValueTreeSnapshot();
+}
+
+//==============================================================================
+ValueTree ValueTreeSnapshot::createValueTree() const
+{
+    if (node == nullptr)
+        return ValueTree();
+
+    ValueTree v (node->type);
+
+    for (int i = 0; i < node->properties.size(); ++i)
+        v.setProperty (node->properties.getName (i), node->properties.getValueAt (i), nullptr);
+
+    for (int i = 0; i < node->children.size(); ++i)
+        v.addChild (getChild (i).createValueTree(), -1, nullptr);
+
+    return v;
+}
+
+XmlElement* ValueTreeSnapshot::createXml() const
+{
+    if (node == nullptr)
+        return nullptr;
+
+    XmlElement* const xml = new XmlElement (node->type);
+    node->properties.copyToXmlAttributes (*xml);
+
+    // (NB: it's faster to add nodes to XML elements in reverse order)
+    for (int i = node->children.size(); --i >= 0;)
+        xml->prependChildElement (getChild (i).createXml());
+
+    return xml;
+}
+
+void ValueTreeSnapshot::writeToStream (OutputStream& output) const
+{
+    if (node == nullptr)
+    {
+        output.writeString (String());
+        output.writeCompressedInt (0);
+        output.writeCompressedInt (0);
+        return;
+    }
+
+    output.writeString (node->type.toString());
+    output.writeCompressedInt (node->properties.size());
+
+    for (int j = 0; j < node->properties.size(); ++j)
+    {
+        output.writeString (node->properties.getName (j).toString());
+        node->properties.getValueAt (j).writeToStream (output);
+    }
+
+    output.writeCompressedInt (node->children.size());
+
+    for (int i = 0; i < node->children.size(); ++i)
+        getChild (i).writeToStream (output);
+}
@@ -0,0 +1,171 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2015 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+#ifndef JUCE_VALUETREESNAPSHOT_H_INCLUDED
+#define JUCE_VALUETREESNAPSHOT_H_INCLUDED
+
+
+//==============================================================================
+/**
+    An immutable copy of the state of a ValueTree, which can be safely read by other
+    threads while the original tree carries on being edited.
+
+    You get a snapshot by calling ValueTree::createSnapshot(). This is cheap: each node
+    in a ValueTree keeps hold of the snapshot of its state that was last taken, and any
+    change to a node only discards the snapshots of that node and its parents. So taking
+    a snapshot of a tree that hasn't changed just returns the existing one, and after an
+    edit, only the nodes on the path from the root down to the modified node need to be
+    copied - all the other sub-trees of the new snapshot are shared with the previous one.
+
+    Because of this sharing, you can quickly tell which parts of a tree have changed
+    between two snapshots: if two sub-trees are the same node (i.e. operator== returns
+    true), they're guaranteed to have the same content.
+
+    All the methods in this class are const, and a snapshot can be copied, read and
+    deleted on any thread. Note that var properties that refer to objects (e.g. a
+    DynamicObject or an array) refer to the same object as the original tree, so you
+    shouldn't modify those objects while a snapshot is being used by another thread.
+
+    @code
+    // on the message thread..
+    ValueTreeSnapshot state (myTree.createSnapshot());
+
+    // then on a background thread..
+    FileOutputStream out (file);
+    state.writeToStream (out);
+    @endcode
+
+    @see ValueTree::createSnapshot
+*/
+class JUCE_API  ValueTreeSnapshot
+{
+public:
+    //==============================================================================
+    /** Creates an invalid snapshot. */
+    ValueTreeSnapshot() noexcept;
+
+    /** Creates another reference to the same snapshot. */
+    ValueTreeSnapshot (const ValueTreeSnapshot&) noexcept;
+
+    /** Makes this object refer to another snapshot. */
+    ValueTreeSnapshot& operator= (const ValueTreeSnapshot&) noexcept;
+
+   #if JUCE_COMPILER_SUPPORTS_MOVE_SEMANTICS
+    ValueTreeSnapshot (ValueTreeSnapshot&&) noexcept;
+    ValueTreeSnapshot& operator= (ValueTreeSnapshot&&) noexcept;
+   #endif
+
+    /** Destructor. */
+    ~ValueTreeSnapshot();
+
+    //==============================================================================
+    /** Returns true if this snapshot contains some data. */
+    bool isValid() const noexcept                               { return node != nullptr; }
+
+    /** Returns true if both snapshots refer to the same shared node.
+        Nodes are shared between snapshots when their content hasn't changed, so if
+        this returns true, the two are guaranteed to be equivalent.
+    */
+    bool operator== (const ValueTreeSnapshot&) const noexcept;
+
+    /** Returns true if the snapshots refer to different nodes. */
+    bool operator!= (const ValueTreeSnapshot&) const noexcept;
+
+    /** Performs a deep comparison of the properties and children of two snapshots.
+        Any sub-trees that are shared by both snapshots are skipped, so comparing two
+        snapshots of the same tree is quick.
+    */
+    bool isEquivalentTo (const ValueTreeSnapshot&) const;
+
+    //==============================================================================
+    /** Returns the type of the node. @see ValueTree::getType */
+    Identifier getType() const noexcept;
+
+    /** Returns true if the node has this type. @see ValueTree::hasType */
+    bool hasType (const Identifier& typeName) const noexcept;
+
+    //==============================================================================
+    /** Returns the value of a named property, or a void var if it doesn't exist. */
+    const var& getProperty (const Identifier& name) const noexcept;
+
+    /** Returns the value of a named property, or a default value if it doesn't exist. */
+    var getProperty (const Identifier& name, const var& defaultReturnValue) const;
+
+    /** Returns a pointer to the value of a named property, or nullptr if it doesn't exist. */
+    const var* getPropertyPointer (const Identifier& name) const noexcept;
+
+    /** Returns the value of a named property. */
+    const var& operator[] (const Identifier& name) const noexcept;
+
+    /** Returns true if the node contains a named property. */
+    bool hasProperty (const Identifier& name) const noexcept;
+
+    /** Returns the total number of properties that the node contains. */
+    int getNumProperties() const noexcept;
+
+    /** Returns the identifier of the property with a given index. */
+    Identifier getPropertyName (int index) const noexcept;
+
+    //==============================================================================
+    /** Returns the number of child nodes. */
+    int getNumChildren() const noexcept;
+
+    /** Returns one of the node's children, or an invalid snapshot if the index is out of range. */
+    ValueTreeSnapshot getChild (int index) const;
+
+    /** Returns the first child with the given type, or an invalid snapshot if there isn't one. */
+    ValueTreeSnapshot getChildWithName (const Identifier& type) const;
+
+    /** Returns the first child with a property that matches the value given, or an
+        invalid snapshot if there isn't one.
+    */
+    ValueTreeSnapshot getChildWithProperty (const Identifier& propertyName, const var& propertyValue) const;
+
+    //==============================================================================
+    /** Creates a new ValueTree with the same content as this snapshot. */
+    ValueTree createValueTree() const;
+
+    /** Creates an XmlElement that holds a complete image of this node and all its children.
+        The caller must delete the object that is returned.
+        @see ValueTree::createXml
+    */
+    XmlElement* createXml() const;
+
+    /** Writes the snapshot to a stream, in the same format as ValueTree::writeToStream(),
+        so it can be read back with ValueTree::readFromStream().
+    */
+    void writeToStream (OutputStream& output) const;
+
+private:
+    //==============================================================================
+    class Node;
+    friend class ValueTree;
+
+    ReferenceCountedObjectPtr<Node> node;
+
+    explicit ValueTreeSnapshot (Node*) noexcept;
+};
+
+
+#endif   // JUCE_VALUETREESNAPSHOT_H_INCLUDED
@@ -30,7 +30,8 @@ namespace ValueTreeSynchroniserHelpers
         fullSync         = 2,
         childAdded       = 3,
         childRemoved     = 4,
-        childMoved       = 5
+        childMoved       = 5,
+        batch            = 6
     };
 
     static void getValueTreePath (ValueTree v, const ValueTree& topLevelTree, Array<int>& path)
@@ -85,9 +86,189 @@ namespace ValueTreeSynchroniserHelpers
 
         return v;
     }
+
+    // In a batch, each property name is written in full the first time it's used, and
+    // after that as an index into the list of names that have already appeared.
+    static void writeIdentifier (MemoryOutputStream& stream, const Identifier& name, HashMap<String, int>& names)
+    {
+        const String s (name.toString());
+
+        if (names.contains (s))
+        {
+            stream.writeCompressedInt (names[s] + 1);
+        }
+        else
+        {
+            stream.writeCompressedInt (0);
+            stream.writeString (s);
+            names.set (s, names.size());
+        }
+    }
+
+    static Identifier readIdentifier (MemoryInputStream& input, Array<Identifier>* names)
+    {
+        if (names == nullptr)
+        {
+            const String s (input.readString());
+            return s.isNotEmpty() ? Identifier (s) : Identifier();
+        }
+
+        const int index = input.readCompressedInt();
+
+        if (index == 0)
+        {
+            const String s (input.readString());
+
+            if (s.isEmpty())
+                return Identifier();
+
+            names->add (s);
+            return names->getLast();
+        }
+
+        return isPositiveAndNotGreaterThan (index, names->size()) ? names->getReference (index - 1)
+                                                                 : Identifier();
+    }
+
+    static bool applyChangeToTree (ValueTree v, const ChangeType type, MemoryInputStream& input,
+                                   UndoManager* undoManager, Array<Identifier>* names)
+    {
+        switch (type)
+        {
+            case propertyChanged:
+            {
+                const Identifier property (readIdentifier (input, names));
+
+                if (property.isNull())
+                    break;
+
+                v.setProperty (property, var::readFromStream (input), undoManager);
+                return true;
+            }
+
+            case childAdded:
+            {
+                const int index = input.readCompressedInt();
+                v.addChild (ValueTree::readFromStream (input), index, undoManager);
+                return true;
+            }
+
+            case childRemoved:
+            {
+                const int index = input.readCompressedInt();
+
+                if (isPositiveAndBelow (index, v.getNumChildren()))
+                {
+                    v.removeChild (index, undoManager);
+                    return true;
+                }
+
+                jassertfalse; // Either received some corrupt data, or the trees have drifted out of sync
+                break;
+            }
+
+            case childMoved:
+            {
+                const int oldIndex = input.readCompressedInt();
+                const int newIndex = input.readCompressedInt();
+
+                if (isPositiveAndBelow (oldIndex, v.getNumChildren())
+                     && isPositiveAndBelow (newIndex, v.getNumChildren()))
+                {
+                    v.moveChild (oldIndex, newIndex, undoManager);
+                    return true;
+                }
+
+                jassertfalse; // Either received some corrupt data, or the trees have drifted out of sync
+                break;
+            }
+
+            default:
+                jassertfalse; // Seem to have received some corrupt data?
+                break;
+        }
+
+        return false;
+    }
+
+    static bool applyBatch (ValueTree& root, MemoryInputStream& input, UndoManager* undoManager)
+    {
+        const int numChanges = input.readCompressedInt();
+
+        // The nodes from the root down to the target of the previous change. Each change's
+        // path is sent as the number of levels that it shares with the previous one,
+        // followed by the child indexes for the rest of the way.
+        Array<ValueTree> path;
+        path.add (root);
+
+        Array<Identifier> names;
+
+        for (int i = 0; i < numChanges; ++i)
+        {
+            const ChangeType type = (ChangeType) input.readByte();
+            const int numLevelsShared = input.readCompressedInt();
+            const int numNewLevels = input.readCompressedInt();
+
+            if (! (isPositiveAndBelow (numLevelsShared, path.size())
+                    && isPositiveAndBelow (numNewLevels, 65536))) // sanity-check
+                return false;
+
+            path.removeRange (numLevelsShared + 1, path.size());
+
+            for (int j = 0; j < numNewLevels; ++j)
+            {
+                const ValueTree child (path.getLast().getChild (input.readCompressedInt()));
+
+                if (! child.isValid())
+                    return false;
+
+                path.add (child);
+            }
+
+            if (! applyChangeToTree (path.getLast(), type, input, undoManager, &names))
+                return false;
+        }
+
+        return true;
+    }
 }
 
-ValueTreeSynchroniser::ValueTreeSynchroniser (const ValueTree& tree)  : valueTree (tree)
+//==============================================================================
+struct ValueTreeSynchroniser::PendingChange
+{
+    PendingChange (ValueTreeSynchroniserHelpers::ChangeType t, const ValueTree& target, const ValueTree& root)
+        : type (t), index (0), newIndex (0)
+    {
+        ValueTreeSynchroniserHelpers::getValueTreePath (target, root, path);
+
+        // (getValueTreePath() returns the indexes starting from the bottom)
+        for (int i = 0, j = path.size() - 1; i < j; ++i, --j)
+            path.swap (i, j);
+    }
+
+    String getPropertyKey() const
+    {
+        String key (property.toString());
+
+        for (int i = 0; i < path.size(); ++i)
+            key << '/' << path.getUnchecked (i);
+
+        return key;
+    }
+
+    const ValueTreeSynchroniserHelpers::ChangeType type;
+    Array<int> path;
+    Identifier property;
+    var value;
+    int index, newIndex;
+    MemoryBlock childData;
+
+    JUCE_DECLARE_NON_COPYABLE (PendingChange)
+};
+
+//==============================================================================
+ValueTreeSynchroniser::ValueTreeSynchroniser (const ValueTree& tree)
+    : valueTree (tree), batchingInterval (0)
 {
     valueTree.addListener (this);
 }
@@ -99,14 +280,143 @@ ValueTreeSynchroniser::~ValueTreeSynchroniser()
 
 void ValueTreeSynchroniser::sendFullSyncCallback()
 {
+    // (a full sync includes any changes that were waiting to be sent)
+    stopTimer();
+    pendingChanges.clear();
+    pendingPropertyChanges.clear();
+
     MemoryOutputStream m;
     writeHeader (m, ValueTreeSynchroniserHelpers::fullSync);
     valueTree.writeToStream (m);
     stateChanged (m.getData(), m.getDataSize());
 }
 
+//==============================================================================
+void ValueTreeSynchroniser::setBatchingInterval (const int milliseconds)
+{
+    batchingInterval = jmax (0, milliseconds);
+
+    if (batchingInterval == 0)
+        flushPendingChanges();
+}
+
+void ValueTreeSynchroniser::addPendingChange (PendingChange* const change)
+{
+    if (change->type == ValueTreeSynchroniserHelpers::propertyChanged)
+    {
+        // A later change to a property just replaces the value of an earlier one. The
+        // earlier entry keeps its place, so that the receiver adds new properties in the
+        // same order as the source tree did..
+        const String key (change->getPropertyKey());
+
+        if (pendingPropertyChanges.contains (key))
+        {
+            pendingChanges.getUnchecked (pendingPropertyChanges [key])->value = change->value;
+            delete change;
+            return;
+        }
+
+        pendingPropertyChanges.set (key, pendingChanges.size());
+    }
+    else
+    {
+        // ..but after a structural change, the same path may refer to a different node.
+        pendingPropertyChanges.clear();
+    }
+
+    pendingChanges.add (change);
+
+    if (! isTimerRunning())
+        startTimer (batchingInterval);
+}
+
+void ValueTreeSynchroniser::timerCallback()
+{
+    flushPendingChanges();
+}
+
+void ValueTreeSynchroniser::flushPendingChanges()
+{
+    using namespace ValueTreeSynchroniserHelpers;
+
+    stopTimer();
+
+    if (pendingChanges.size() == 0)
+        return;
+
+    OwnedArray<PendingChange> changes;
+    changes.swapWith (pendingChanges);
+    pendingPropertyChanges.clear();
+
+    MemoryOutputStream m;
+    writeHeader (m, batch);
+    m.writeCompressedInt (changes.size());
+
+    const Array<int> emptyPath;
+    const Array<int>* previousPath = &emptyPath;
+    HashMap<String, int> names;
+
+    for (int i = 0; i < changes.size(); ++i)
+    {
+        const PendingChange& c = *changes.getUnchecked (i);
+        m.writeByte ((char) c.type);
+
+        int numLevelsShared = 0;
+
+        while (numLevelsShared < jmin (c.path.size(), previousPath->size())
+                && c.path.getUnchecked (numLevelsShared) == previousPath->getUnchecked (numLevelsShared))
+            ++numLevelsShared;
+
+        m.writeCompressedInt (numLevelsShared);
+        m.writeCompressedInt (c.path.size() - numLevelsShared);
+
+        for (int j = numLevelsShared; j < c.path.size(); ++j)
+            m.writeCompressedInt (c.path.getUnchecked (j));
+
+        previousPath = &c.path;
+
+        switch (c.type)
+        {
+            case propertyChanged:
+                writeIdentifier (m, c.property, names);
+                c.value.writeToStream (m);
+                break;
+
+            case childAdded:
+                m.writeCompressedInt (c.index);
+                m << c.childData;
+                break;
+
+            case childRemoved:
+                m.writeCompressedInt (c.index);
+                break;
+
+            case childMoved:
+                m.writeCompressedInt (c.index);
+                m.writeCompressedInt (c.newIndex);
+                break;
+
+            default:
+                jassertfalse;
+                break;
+        }
+    }
+
+    stateChanged (m.getData(), m.getDataSize());
+}
+
+//==============================================================================
 void ValueTreeSynchroniser::valueTreePropertyChanged (ValueTree& vt, const Identifier& property)
 {
+    if (batchingInterval > 0)
+    {
+        PendingChange* const c = new PendingChange (ValueTreeSynchroniserHelpers::propertyChanged, vt, valueTree);
+        c->property = property;
+        c->value = vt.getProperty (property);
+        addPendingChange (c);
+        return;
+    }
+
     MemoryOutputStream m;
     ValueTreeSynchroniserHelpers::writeHeader (*this, m, ValueTreeSynchroniserHelpers::propertyChanged, vt);
     m.writeString (property.toString());
@@ -119,6 +429,19 @@ void ValueTreeSynchroniser::valueTreeChildAdded (ValueTree& parentTree, ValueTre
     const int index = parentTree.indexOf (childTree);
     jassert (index >= 0);
 
+    if (batchingInterval > 0)
+    {
+        PendingChange* const c = new PendingChange (ValueTreeSynchroniserHelpers::childAdded, parentTree, valueTree);
+        c->index = index;
+
+        // (the child's current state has to be captured now, as any later changes to it will be sent separately)
+        MemoryOutputStream childData (c->childData, false);
+        childTree.writeToStream (childData);
+
+        addPendingChange (c);
+        return;
+    }
+
     MemoryOutputStream m;
     ValueTreeSynchroniserHelpers::writeHeader (*this, m, ValueTreeSynchroniserHelpers::childAdded, parentTree);
     m.writeCompressedInt (index);
@@ -128,6 +451,14 @@ void ValueTreeSynchroniser::valueTreeChildAdded (ValueTree& parentTree, ValueTre
 
 void ValueTreeSynchroniser::valueTreeChildRemoved (ValueTree& parentTree, ValueTree&, int oldIndex)
 {
+    if (batchingInterval > 0)
+    {
+        PendingChange* const c = new PendingChange (ValueTreeSynchroniserHelpers::childRemoved, parentTree, valueTree);
+        c->index = oldIndex;
+        addPendingChange (c);
+        return;
+    }
+
     MemoryOutputStream m;
     ValueTreeSynchroniserHelpers::writeHeader (*this, m, ValueTreeSynchroniserHelpers::childRemoved, parentTree);
     m.writeCompressedInt (oldIndex);
@@ -136,6 +467,15 @@ void ValueTreeSynchroniser::valueTreeChildRemoved (ValueTree& parentTree, ValueT
 
 void ValueTreeSynchroniser::valueTreeChildOrderChanged (ValueTree& parent, int oldIndex, int newIndex)
 {
+    if (batchingInterval > 0)
+    {
+        PendingChange* const c = new PendingChange (ValueTreeSynchroniserHelpers::childMoved, parent, valueTree);
+        c->index = oldIndex;
+        c->newIndex = newIndex;
+        addPendingChange (c);
+        return;
+    }
+
     MemoryOutputStream m;
     ValueTreeSynchroniserHelpers::writeHeader (*this, m, ValueTreeSynchroniserHelpers::childMoved, parent);
     m.writeCompressedInt (oldIndex);
@@ -157,61 +497,192 @@ bool ValueTreeSynchroniser::applyChange (ValueTree& root, const void* data, size
         return true;
     }
 
+    if (type == ValueTreeSynchroniserHelpers::batch)
+        return ValueTreeSynchroniserHelpers::applyBatch (root, input, undoManager);
+
     ValueTree v (ValueTreeSynchroniserHelpers::readSubTreeLocation (input, root));
 
     if (! v.isValid())
         return false;
 
-    switch (type)
+    return ValueTreeSynchroniserHelpers::applyChangeToTree (v, type, input, undoManager, nullptr);
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ValueTreeSynchroniserTests  : public UnitTest
+{
+public:
+    ValueTreeSynchroniserTests() : UnitTest ("ValueTreeSynchroniser") {}
+
+    struct TestSynchroniser  : public ValueTreeSynchroniser
     {
-        case ValueTreeSynchroniserHelpers::propertyChanged:
+        TestSynchroniser (const ValueTree& source, ValueTree& dest)
+            : ValueTreeSynchroniser (source), target (dest),
+              numMessages (0), numBytes (0), allChangesApplied (true)
         {
-            Identifier property (input.readString());
-            v.setProperty (property, var::readFromStream (input), undoManager);
-            return true;
         }
 
-        case ValueTreeSynchroniserHelpers::childAdded:
+        void stateChanged (const void* data, size_t size) override
         {
-            const int index = input.readCompressedInt();
-            v.addChild (ValueTree::readFromStream (input), index, undoManager);
-            return true;
+            ++numMessages;
+            numBytes += size;
+
+            if (! applyChange (target, data, size, nullptr))
+                allChangesApplied = false;
         }
 
-        case ValueTreeSynchroniserHelpers::childRemoved:
+        ValueTree& target;
+        int numMessages;
+        size_t numBytes;
+        bool allChangesApplied;
+    };
+
+    static ValueTree getRandomNode (ValueTree v, Random& r)
+    {
+        while (v.getNumChildren() > 0 && r.nextInt (3) != 0)
+            v = v.getChild (r.nextInt (v.getNumChildren()));
+
+        return v;
+    }
+
+    static void makeRandomChanges (ValueTree root, Random& r, int numChanges, bool onlyChangeProperties)
+    {
+        for (int i = 0; i < numChanges; ++i)
         {
-            const int index = input.readCompressedInt();
+            ValueTree v (getRandomNode (root, r));
+            const int numChildren = v.getNumChildren();
 
-            if (isPositiveAndBelow (index, v.getNumChildren()))
+            switch (onlyChangeProperties ? 0 : r.nextInt (6))
             {
-                v.removeChild (index, undoManager);
-                return true;
+                case 0:
+                case 1:
+                case 2:
+                    v.setProperty ("property" + String (r.nextInt (5)), r.nextInt (1000), nullptr);
+                    break;
+
+                case 3:
+                {
+                    ValueTree child ("child");
+                    child.setProperty ("value", r.nextInt(), nullptr);
+                    child.addChild (ValueTree ("grandchild"), -1, nullptr);
+                    v.addChild (child, r.nextInt (numChildren + 1), nullptr);
+                    break;
+                }
+
+                case 4:
+                    if (numChildren > 0)
+                        v.removeChild (r.nextInt (numChildren), nullptr);
+                    break;
+
+                case 5:
+                    if (numChildren > 1)
+                        v.moveChild (r.nextInt (numChildren), r.nextInt (numChildren), nullptr);
+                    break;
+
+                default:
+                    break;
             }
+        }
+    }
+
+    static ValueTree createTestTree()
+    {
+        ValueTree root ("root");
+
+        for (int i = 0; i < 20; ++i)
+        {
+            ValueTree child ("child");
+
+            for (int j = 0; j < 20; ++j)
+                child.addChild (ValueTree ("grandchild"), -1, nullptr);
 
-            jassertfalse; // Either received some corrupt data, or the trees have drifted out of sync
-            break;
+            root.addChild (child, -1, nullptr);
         }
 
-        case ValueTreeSynchroniserHelpers::childMoved:
+        return root;
+    }
+
+    void runTest() override
+    {
+        Random r (getRandom());
+
+        beginTest ("Individual changes");
         {
-            const int oldIndex = input.readCompressedInt();
-            const int newIndex = input.readCompressedInt();
+            ValueTree source (createTestTree()), dest;
+            TestSynchroniser sync (source, dest);
+            sync.sendFullSyncCallback();
 
-            if (isPositiveAndBelow (oldIndex, v.getNumChildren())
-                 && isPositiveAndBelow (newIndex, v.getNumChildren()))
+            makeRandomChanges (source, r, 1000, false);
+
+            expect (sync.allChangesApplied);
+            expect (dest.isEquivalentTo (source));
+        }
+
+        // (the batched tests flush their changes explicitly, but the timer that would
+        // otherwise flush them still needs a message manager to exist)
+        ScopedPointer<ScopedJuceInitialiser_GUI> initialiser;
+
+        if (MessageManager::getInstanceWithoutCreating() == nullptr)
+            initialiser = new ScopedJuceInitialiser_GUI();
+
+        beginTest ("Batched changes");
+        {
+            for (int i = 0; i < 20; ++i)
             {
-                v.moveChild (oldIndex, newIndex, undoManager);
-                return true;
+                ValueTree source (createTestTree()), dest;
+                TestSynchroniser sync (source, dest);
+                sync.setBatchingInterval (100000);
+                sync.sendFullSyncCallback();
+
+                makeRandomChanges (source, r, 500, false);
+                expectEquals (sync.numMessages, 1);
+
+                sync.flushPendingChanges();
+                expectEquals (sync.numMessages, 2);
+                expect (sync.allChangesApplied);
+                expect (dest.isEquivalentTo (source));
+
+                makeRandomChanges (source, r, 100, false);
+                sync.setBatchingInterval (0);
+                expectEquals (sync.numMessages, 3);
+                expect (dest.isEquivalentTo (source));
             }
-
-            jassertfalse; // Either received some corrupt data, or the trees have drifted out of sync
-            break;
         }
 
-        default:
-            jassertfalse; // Seem to have received some corrupt data?
-            break;
+        beginTest ("Batch size");
+        {
+            const int numChanges = 20000;
+            const int64 seed = r.nextInt64();
+
+            ValueTree source1 (createTestTree()), dest1;
+            TestSynchroniser individual (source1, dest1);
+            individual.sendFullSyncCallback();
+
+            ValueTree source2 (createTestTree()), dest2;
+            TestSynchroniser batched (source2, dest2);
+            batched.sendFullSyncCallback();
+            batched.setBatchingInterval (100000);
+
+            const size_t fullSyncSize = individual.numBytes;
+            Random r1 (seed), r2 (seed);
+
+            makeRandomChanges (source1, r1, numChanges, true);
+            makeRandomChanges (source2, r2, numChanges, true);
+            batched.flushPendingChanges();
+
+            expect (dest1.isEquivalentTo (dest2));
+            expect (dest2.isEquivalentTo (source2));
+            expect (batched.numBytes - fullSyncSize < (individual.numBytes - fullSyncSize) / 10);
+
+            logMessage (String (numChanges) + " property changes: " + String (individual.numMessages - 1) + " messages totalling "
+                          + String ((int) (individual.numBytes - fullSyncSize)) + " bytes, or one batch of "
+                          + String ((int) (batched.numBytes - fullSyncSize)) + " bytes");
+        }
     }
+};
 
-    return false;
-}
+static ValueTreeSynchroniserTests valueTreeSynchroniserTests;
+
+#endif
@@ -39,8 +39,13 @@
     and implement the stateChanged() method to transmit the encoded change (maybe
     via a network or other means) to a remote destination, where it can be
     applied to a target tree.
+
+    By default, each change is sent as soon as it happens. If your tree gets changed
+    in bulk, you can use setBatchingInterval() to make it collect the changes and send
+    them in a single, compact message instead.
 */
-class JUCE_API  ValueTreeSynchroniser  : private ValueTree::Listener
+class JUCE_API  ValueTreeSynchroniser  : private ValueTree::Listener,
+                                         private Timer
 {
 public:
     /** Creates a ValueTreeSynchroniser that watches the given tree.
@@ -68,6 +73,35 @@ public:
     */
     void sendFullSyncCallback();
 
+    //==============================================================================
+    /** Makes the synchroniser collect changes together rather than sending each one as it happens.
+
+        When the interval is greater than zero, the first change that is made starts a timer,
+        and all the changes that are made before it expires are sent together as a single
+        stateChanged() callback. Within a batch, only the last value that is given to a property
+        is sent, and the paths and property names of the changed nodes are encoded much more
+        compactly than when they're sent individually. The receiver applies the whole batch with
+        one call to applyChange().
+
+        An interval of zero (the default) turns batching off, and sends any pending changes.
+
+        Because this uses a Timer, it should only be used on the message thread.
+
+        @see flushPendingChanges
+    */
+    void setBatchingInterval (int milliseconds);
+
+    /** Returns the interval that was set with setBatchingInterval(). */
+    int getBatchingInterval() const noexcept  { return batchingInterval; }
+
+    /** If batching is enabled and there are some changes waiting to be sent, this sends
+        them immediately, rather than waiting for the timer to expire.
+
+        If you're deleting a synchroniser that uses batching, and want the remote tree to
+        get any final changes, you must call this before it's deleted.
+    */
+    void flushPendingChanges();
+
     /** Applies an encoded change to the given destination tree.
 
         When you implement a receiver for changes that were sent by the stateChanged()
@@ -82,7 +116,15 @@ public:
     const ValueTree& getRoot() noexcept       { return valueTree; }
 
 private:
+    struct PendingChange;
+
     ValueTree valueTree;
+    int batchingInterval;
+    OwnedArray<PendingChange> pendingChanges;
+    HashMap<String, int> pendingPropertyChanges;
+
+    void addPendingChange (PendingChange*);
+    void timerCallback() override;
 
     void valueTreePropertyChanged (ValueTree&, const Identifier&) override;
     void valueTreeChildAdded (ValueTree&, ValueTree&) override;
@@ -40,13 +40,284 @@ private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ConnectionThread)
 };
 
+//==============================================================================
+/*  A single-producer, single-consumer ring buffer in a memory-mapped file, which both
+    processes map. Each message is stored as an 8-byte record header followed by its data,
+    and a message is never split across the end of the buffer, so that the reader can
+    always be given a contiguous block.
+*/
+struct InterprocessConnection::SharedMemoryRing
+{
+    enum WriteResult { written, bufferFull, failed };
+
+    ~SharedMemoryRing()
+    {
+        mappedFile = nullptr;
+
+        if (isOwner)
+            file.deleteFile();
+    }
+
+    static SharedMemoryRing* create (const int minBufferSize)
+    {
+        const uint32 bufferSize = (uint32) nextPowerOfTwo (jlimit ((int) minimumSize, (int) maximumSize, minBufferSize));
+
+        const File f (getDirectory().getNonexistentChildFile (filePrefix + String::toHexString (Random::getSystemRandom().nextInt64()),
+                                                              fileSuffix, false));
+
+        {
+            FileOutputStream out (f);
+
+            if (out.failedToOpen()
+                 || ! out.setPosition ((int64) (sizeof (Header) + bufferSize))
+                 || out.truncate().failed())
+            {
+                f.deleteFile();
+                return nullptr;
+            }
+        }
+
+        ScopedPointer<MemoryMappedFile> mapped (new MemoryMappedFile (f, MemoryMappedFile::readWrite));
+
+        if (mapped->getData() == nullptr || mapped->getSize() != sizeof (Header) + bufferSize)
+        {
+            f.deleteFile();
+            return nullptr;
+        }
+
+        Header* const h = static_cast<Header*> (mapped->getData());
+        h->magic = magicNumber;
+        h->bufferSize = bufferSize;
+
+        return new SharedMemoryRing (f, mapped.release(), true);
+    }
+
+    static SharedMemoryRing* open (const String& path)
+    {
+        // The other end should only ever send the name of a file that it created in
+        // the usual place, so don't let it point us at anything else (especially as
+        // the file gets deleted once it's open)..
+        if (! File::isAbsolutePath (path))
+            return nullptr;
+
+        const File f (path);
+
+        if (! (f.getParentDirectory() == getDirectory()
+                && f.getFileName().startsWith (filePrefix)
+                && f.hasFileExtension (fileSuffix)
+                && f.existsAsFile()))
+            return nullptr;
+
+        ScopedPointer<MemoryMappedFile> mapped (new MemoryMappedFile (f, MemoryMappedFile::readWrite));
+        const Header* const h = static_cast<const Header*> (mapped->getData());
+
+        if (h == nullptr
+             || mapped->getSize() < sizeof (Header)
+             || h->magic != magicNumber
+             || ! isPowerOfTwo (h->bufferSize)
+             || mapped->getSize() != sizeof (Header) + h->bufferSize)
+            return nullptr;
+
+        // Both ends have it mapped now, so the file itself isn't needed any more
+        // (although on some OSes it can't be deleted until both ends have closed it)
+        f.deleteFile();
+
+        return new SharedMemoryRing (f, mapped.release(), false);
+    }
+
+    String getPath() const                  { return file.getFullPathName(); }
+
+    //==============================================================================
+    WriteResult write (const void* const data, const size_t numBytes) noexcept
+    {
+        const uint32 recordSize = getRecordSize (numBytes);
+
+        // (a record can take up more than its own size if it needs padding to get it past the end
+        // of the buffer, so limiting it to half the buffer makes sure it'll always fit eventually)
+        if (numBytes > (size_t) maximumSize || recordSize > bufferSize / 2)
+            return failed;
+
+        const uint32 writePos = header->writePosition.get();
+        const uint32 used = writePos - (uint32) header->readPosition.get();
+
+        if (used > bufferSize)
+            return failed;
+
+        const uint32 offset = writePos & (bufferSize - 1);
+        const uint32 spaceAtEnd = bufferSize - offset;
+        const uint32 padding = recordSize > spaceAtEnd ? spaceAtEnd : 0;
+
+        if (bufferSize - used < padding + recordSize)
+            return bufferFull;
+
+        if (padding > 0)
+            getRecord (offset)[0] = paddingMarker;
+
+        uint32* const record = getRecord ((offset + padding) & (bufferSize - 1));
+        record[0] = (uint32) numBytes;
+        record[1] = 0;
+        memcpy (record + 2, data, numBytes);
+
+        // (this is a full memory barrier, so the reader can't see the new position before the data)
+        header->writePosition += padding + recordSize;
+        return written;
+    }
+
+    /** Returns true if the reader has gone to sleep and needs waking up after a write. */
+    bool needsWakingUp() noexcept
+    {
+        return header->readerIsWaiting.compareAndSetBool (0, 1);
+    }
+
+    //==============================================================================
+    /** Returns the size of the next message, or 0 if there isn't one, or -1 if the buffer
+        contains rubbish.
+    */
+    int getNextMessage (const void*& data) noexcept
+    {
+        for (;;)
+        {
+            const uint32 readPos = header->readPosition.get();
+            const uint32 available = header->writePosition.get() - readPos;
+
+            if (available == 0)
+                return 0;
+
+            const uint32 offset = readPos & (bufferSize - 1);
+            const uint32 spaceAtEnd = bufferSize - offset;
+
+            if (available > bufferSize || available < recordHeaderSize)
+                return -1;
+
+            const uint32 numBytes = getRecord (offset)[0];
+
+            if (numBytes == paddingMarker)
+            {
+                if (available < spaceAtEnd)
+                    return -1;
+
+                header->readPosition += spaceAtEnd;
+                continue;
+            }
+
+            if (numBytes > (uint32) maximumSize || getRecordSize (numBytes) > jmin (available, spaceAtEnd))
+                return -1;
+
+            data = getRecord (offset) + 2;
+            return (int) numBytes;
+        }
+    }
+
+    /** Frees the space used by the message that getNextMessage() returned. */
+    void finishedWithMessage (const int numBytes) noexcept
+    {
+        header->readPosition += getRecordSize ((size_t) numBytes);
+    }
+
+    bool hasMessages() const noexcept
+    {
+        return header->readPosition.get() != header->writePosition.get();
+    }
+
+    /** Tells the writer that we're about to wait for it. If a message has arrived in the
+        meantime, this returns false, and there's no need to wait.
+    */
+    bool prepareToWait() noexcept
+    {
+        header->readerIsWaiting.set (1);
+
+        if (! hasMessages())
+            return true;
+
+        header->readerIsWaiting.set (0);
+        return false;
+    }
+
+    void finishedWaiting() noexcept
+    {
+        header->readerIsWaiting.set (0);
+    }
+
+private:
+    // (the positions are in different cache lines, as they're written by different processes)
+    struct Header
+    {
+        uint32 magic, bufferSize;
+        uint32 reserved1[14];
+        Atomic<uint32> writePosition;
+        uint32 reserved2[15];
+        Atomic<uint32> readPosition;
+        Atomic<int> readerIsWaiting;
+        uint32 reserved3[30];
+    };
+
+    enum
+    {
+        magicNumber = 0x4350494a,
+        recordHeaderSize = 8,
+        minimumSize = 4096,
+        maximumSize = 1 << 30
+    };
+
+    static const uint32 paddingMarker = 0xffffffff;
+
+    File file;
+    ScopedPointer<MemoryMappedFile> mappedFile;
+    Header* const header;
+    uint8* const buffer;
+    const uint32 bufferSize;
+    const bool isOwner;
+
+    static const char* const filePrefix;
+    static const char* const fileSuffix;
+
+    SharedMemoryRing (const File& f, MemoryMappedFile* const m, const bool owner) noexcept
+        : file (f), mappedFile (m),
+          header (static_cast<Header*> (m->getData())),
+          buffer (static_cast<uint8*> (m->getData()) + sizeof (Header)),
+          bufferSize (header->bufferSize),
+          isOwner (owner)
+    {
+    }
+
+    static File getDirectory()
+    {
+       #if JUCE_LINUX
+        const File shm ("/dev/shm");
+
+        if (shm.isDirectory())
+            return shm;
+       #endif
+
+        return File::getSpecialLocation (File::tempDirectory);
+    }
+
+    static uint32 getRecordSize (const size_t numBytes) noexcept
+    {
+        return (uint32) ((recordHeaderSize + numBytes + 7) & ~(size_t) 7);
+    }
+
+    uint32* getRecord (const uint32 offset) const noexcept
+    {
+        return reinterpret_cast<uint32*> (buffer + offset);
+    }
+
+    friend class InterprocessConnectionTests;
+    JUCE_DECLARE_NON_COPYABLE (SharedMemoryRing)
+};
+
+const char* const InterprocessConnection::SharedMemoryRing::filePrefix = "juce_ipc_";
+const char* const InterprocessConnection::SharedMemoryRing::fileSuffix = ".ring";
+
 //==============================================================================
 InterprocessConnection::InterprocessConnection (const bool callbacksOnMessageThread,
                                                 const uint32 magicMessageHeaderNumber)
     : callbackConnectionState (false),
       useMessageThread (callbacksOnMessageThread),
       magicMessageHeader (magicMessageHeaderNumber),
-      pipeReceiveMessageTimeout (-1)
+      pipeReceiveMessageTimeout (-1),
+      numBytesInWriteBuffer (0),
+      numBytesInReceiveBuffer (0)
 {
     thread = new ConnectionThread (*this);
 }
@@ -127,6 +398,12 @@ void InterprocessConnection::disconnect()
     thread->stopThread (4000);
     deletePipeAndSocket();
     connectionLostInt();
+
+    incomingRing = nullptr;
+    numBytesInReceiveBuffer = 0;
+
+    const ScopedLock sl (writeLock);
+    outgoingRing = nullptr;
 }
 
 void InterprocessConnection::deletePipeAndSocket()
@@ -163,18 +440,96 @@ String InterprocessConnection::getConnectedHostName() const
 //==============================================================================
 bool InterprocessConnection::sendMessage (const MemoryBlock& message)
 {
-    uint32 messageHeader[2] = { ByteOrder::swapIfBigEndian (magicMessageHeader),
-                                ByteOrder::swapIfBigEndian ((uint32) message.getSize()) };
+    return sendMessage (message.getData(), message.getSize());
+}
+
+bool InterprocessConnection::sendMessage (const void* const messageData, const size_t numBytes)
+{
+    const int64 startTicks = Time::getHighResolutionTicks();
+    bool ok;
+
+    {
+        const ScopedLock sl (writeLock);
+
+        if (outgoingRing != nullptr)
+        {
+            ok = writeToOutgoingRing (messageData, numBytes) && wakeUpOutgoingRingReader();
+        }
+        else
+        {
+            addToWriteBuffer (magicMessageHeader, messageData, numBytes);
+            ok = flushWriteBuffer();
+        }
+    }
+
+    messageSent (1, numBytes, startTicks);
+    return ok;
+}
+
+bool InterprocessConnection::sendMessages (const Array<MemoryBlock>& messages)
+{
+    const int64 startTicks = Time::getHighResolutionTicks();
+    size_t totalBytes = 0;
+    bool ok = true;
+
+    {
+        const ScopedLock sl (writeLock);
+
+        for (int i = 0; i < messages.size() && ok; ++i)
+        {
+            const MemoryBlock& m = messages.getReference (i);
+            totalBytes += m.getSize();
+
+            if (outgoingRing != nullptr)
+                ok = writeToOutgoingRing (m.getData(), m.getSize());
+            else
+                addToWriteBuffer (magicMessageHeader, m.getData(), m.getSize());
+        }
+
+        ok = outgoingRing != nullptr ? (ok && wakeUpOutgoingRingReader())
+                                     : flushWriteBuffer() && ok;
+    }
+
+    messageSent (messages.size(), totalBytes, startTicks);
+    return ok;
+}
+
+void InterprocessConnection::addToWriteBuffer (const uint32 headerMagic, const void* const messageData, const size_t numBytes)
+{
+    const uint32 messageHeader[2] = { ByteOrder::swapIfBigEndian (headerMagic),
+                                      ByteOrder::swapIfBigEndian ((uint32) numBytes) };
+
+    const size_t sizeNeeded = numBytesInWriteBuffer + sizeof (messageHeader) + numBytes;
+
+    if (writeBuffer.getSize() < sizeNeeded)
+        writeBuffer.ensureSize (sizeNeeded + sizeNeeded / 2);
+
+    writeBuffer.copyFrom (messageHeader, (int) numBytesInWriteBuffer, sizeof (messageHeader));
+    writeBuffer.copyFrom (messageData, (int) (numBytesInWriteBuffer + sizeof (messageHeader)), numBytes);
+    numBytesInWriteBuffer += sizeof (messageHeader) + numBytes;
+}
+
+bool InterprocessConnection::flushWriteBuffer()
+{
+    const int numBytes = (int) numBytesInWriteBuffer;
+    numBytesInWriteBuffer = 0;
 
-    MemoryBlock messageData (sizeof (messageHeader) + message.getSize());
-    messageData.copyFrom (messageHeader, 0, sizeof (messageHeader));
-    messageData.copyFrom (message.getData(), sizeof (messageHeader), message.getSize());
+    const bool ok = writeData (writeBuffer.getData(), numBytes) == numBytes;
 
-    return writeData (messageData.getData(), (int) messageData.getSize()) == (int) messageData.getSize();
+    // (the buffer is kept for the next message, unless an unusually big one has been sent)
+    if (writeBuffer.getSize() > 1024 * 1024)
+        writeBuffer.reset();
+
+    return ok;
 }
 
-int InterprocessConnection::writeData (void* data, int dataSize)
+int InterprocessConnection::writeData (const void* data, int dataSize)
 {
+    {
+        const SpinLock::ScopedLockType sl (statisticsLock);
+        ++statistics.numWrites;
+    }
+
     const ScopedLock sl (pipeAndSocketLock);
 
     if (socket != nullptr)
@@ -186,6 +541,124 @@ int InterprocessConnection::writeData (void* data, int dataSize)
     return 0;
 }
 
+//==============================================================================
+bool InterprocessConnection::enableSharedMemoryTransport (const int bufferSizeBytes)
+{
+    const ScopedLock sl (writeLock);
+
+    if (outgoingRing != nullptr)
+        return true;
+
+    {
+        const ScopedLock sl2 (pipeAndSocketLock);
+
+        // The other end has to be on the same machine to share memory with it!
+        if (socket != nullptr ? ! socket->isLocal() : pipe == nullptr)
+            return false;
+    }
+
+    ScopedPointer<SharedMemoryRing> ring (SharedMemoryRing::create (bufferSizeBytes));
+
+    if (ring == nullptr)
+        return false;
+
+    // The other end is told where to find the buffer with a message that has the bits of the
+    // magic number inverted. After this, the only thing that will be sent through the pipe or
+    // socket is a single byte whenever the other end needs waking up.
+    const String path (ring->getPath());
+
+    addToWriteBuffer (~magicMessageHeader, path.toRawUTF8(), path.getNumBytesAsUTF8());
+
+    if (! flushWriteBuffer())
+        return false;
+
+    outgoingRing = ring;
+    return true;
+}
+
+bool InterprocessConnection::writeToOutgoingRing (const void* const messageData, const size_t numBytes)
+{
+    // (empty messages are never delivered, so there's no point sending them)
+    if (numBytes == 0)
+        return true;
+
+    const uint32 timeoutEnd = Time::getMillisecondCounter() + (uint32) pipeReceiveMessageTimeout;
+
+    for (;;)
+    {
+        const SharedMemoryRing::WriteResult result = outgoingRing->write (messageData, numBytes);
+
+        if (result == SharedMemoryRing::written)
+            return true;
+
+        // If you hit this, you're trying to send a message that's too big to ever
+        // fit in the buffer that you gave to enableSharedMemoryTransport()
+        jassert (result == SharedMemoryRing::bufferFull);
+
+        if (result == SharedMemoryRing::failed
+             || thread->threadShouldExit()
+             || ! thread->isThreadRunning()
+             || (pipeReceiveMessageTimeout >= 0 && Time::getMillisecondCounter() >= timeoutEnd)
+             || ! wakeUpOutgoingRingReader())
+            return false;
+
+        // the buffer is full, so wait for the other end to catch up..
+        Thread::sleep (1);
+    }
+}
+
+bool InterprocessConnection::wakeUpOutgoingRingReader()
+{
+    if (outgoingRing->needsWakingUp())
+    {
+        const char wakeUpByte = 0;
+        return writeData (&wakeUpByte, 1) == 1;
+    }
+
+    return true;
+}
+
+//==============================================================================
+InterprocessConnection::Statistics::Statistics() noexcept
+    : numMessagesSent (0), numBytesSent (0), numWrites (0),
+      totalSendSeconds (0), maxSendSeconds (0),
+      numMessagesReceived (0), numBytesReceived (0), numReads (0),
+      totalDeliverySeconds (0), maxDeliverySeconds (0)
+{
+}
+
+InterprocessConnection::Statistics InterprocessConnection::getStatistics() const
+{
+    const SpinLock::ScopedLockType sl (statisticsLock);
+    return statistics;
+}
+
+void InterprocessConnection::resetStatistics()
+{
+    const SpinLock::ScopedLockType sl (statisticsLock);
+    statistics = Statistics();
+}
+
+void InterprocessConnection::messageSent (const int numMessages, const size_t numBytes, const int64 startTicks)
+{
+    const double seconds = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - startTicks);
+
+    const SpinLock::ScopedLockType sl (statisticsLock);
+    statistics.numMessagesSent += numMessages;
+    statistics.numBytesSent += (int64) numBytes;
+    statistics.totalSendSeconds += seconds;
+    statistics.maxSendSeconds = jmax (statistics.maxSendSeconds, seconds);
+}
+
+void InterprocessConnection::messageDelivered (const int64 receivedTicks)
+{
+    const double seconds = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - receivedTicks);
+
+    const SpinLock::ScopedLockType sl (statisticsLock);
+    statistics.totalDeliverySeconds += seconds;
+    statistics.maxDeliverySeconds = jmax (statistics.maxDeliverySeconds, seconds);
+}
+
 //==============================================================================
 void InterprocessConnection::initialiseWithSocket (StreamingSocket* newSocket)
 {
@@ -256,19 +729,28 @@ void InterprocessConnection::connectionLostInt()
 struct DataDeliveryMessage  : public Message
 {
     DataDeliveryMessage (InterprocessConnection* ipc, const MemoryBlock& d)
-        : owner (ipc), data (d)
+        : owner (ipc), data (d), timeReceived (Time::getHighResolutionTicks())
     {}
 
     void messageCallback() override
     {
         if (InterprocessConnection* const ipc = owner)
+        {
+            ipc->messageDelivered (timeReceived);
             ipc->messageReceived (data);
+        }
     }
 
     WeakReference<InterprocessConnection> owner;
     MemoryBlock data;
+    const int64 timeReceived;
 };
 
+bool InterprocessConnection::messageReceivedInPlace (const void*, size_t)
+{
+    return false;
+}
+
 void InterprocessConnection::deliverDataInt (const MemoryBlock& data)
 {
     jassert (callbackConnectionState);
@@ -280,14 +762,39 @@ void InterprocessConnection::deliverDataInt (const MemoryBlock& data)
 }
 
 //==============================================================================
+bool InterprocessConnection::handleMessageInt (const uint32 headerMagic, const void* const data,
+                                               const size_t numBytes, const MemoryBlock* const block)
+{
+    if (headerMagic != magicMessageHeader)
+        return openIncomingRing (block != nullptr ? *block : MemoryBlock (data, numBytes));
+
+    {
+        const SpinLock::ScopedLockType sl (statisticsLock);
+        ++statistics.numMessagesReceived;
+        statistics.numBytesReceived += (int64) numBytes;
+    }
+
+    if (! messageReceivedInPlace (data, numBytes))
+        deliverDataInt (block != nullptr ? *block : MemoryBlock (data, numBytes));
+
+    return true;
+}
+
 bool InterprocessConnection::readNextMessageInt()
 {
+    {
+        const SpinLock::ScopedLockType sl (statisticsLock);
+        ++statistics.numReads;
+    }
+
     uint32 messageHeader[2];
     const int bytes = socket != nullptr ? socket->read (messageHeader, sizeof (messageHeader), true)
                                         : pipe  ->read (messageHeader, sizeof (messageHeader), -1);
 
+    const uint32 headerMagic = ByteOrder::swapIfBigEndian (messageHeader[0]);
+
     if (bytes == sizeof (messageHeader)
-         && ByteOrder::swapIfBigEndian (messageHeader[0]) == magicMessageHeader)
+         && (headerMagic == magicMessageHeader || headerMagic == ~magicMessageHeader))
     {
         int bytesInMessage = (int) ByteOrder::swapIfBigEndian (messageHeader[1]);
 
@@ -315,7 +822,7 @@ bool InterprocessConnection::readNextMessageInt()
             }
 
             if (bytesRead >= 0)
-                deliverDataInt (messageData);
+                return handleMessageInt (headerMagic, messageData.getData(), messageData.getSize(), &messageData);
         }
     }
     else if (bytes < 0)
@@ -330,42 +837,777 @@ bool InterprocessConnection::readNextMessageInt()
     return true;
 }
 
-void InterprocessConnection::runThread()
+bool InterprocessConnection::readAvailableDataInt()
 {
-    while (! thread->threadShouldExit())
+    // Rather than reading each message's header and body separately, this reads as much as the
+    // socket has available into a buffer, and then picks out all the complete messages in it.
+    if (receiveBuffer.getSize() < 65536)
+        receiveBuffer.setSize (65536);
+
+    const int bytesIn = socket->read (addBytesToPointer (receiveBuffer.getData(), numBytesInReceiveBuffer),
+                                      (int) (receiveBuffer.getSize() - numBytesInReceiveBuffer), false);
+
+    if (bytesIn <= 0)
     {
-        if (socket != nullptr)
-        {
-            const int ready = socket->waitUntilReady (true, 0);
+        // (the socket said it was ready, so no data means that the other end has closed it)
+        deletePipeAndSocket();
+        connectionLostInt();
+        return false;
+    }
 
-            if (ready < 0)
-            {
-                deletePipeAndSocket();
-                connectionLostInt();
-                break;
-            }
+    {
+        const SpinLock::ScopedLockType sl (statisticsLock);
+        ++statistics.numReads;
+    }
 
-            if (ready == 0)
-            {
-                thread->wait (1);
-                continue;
-            }
-        }
-        else if (pipe != nullptr)
+    numBytesInReceiveBuffer += (size_t) bytesIn;
+    size_t pos = 0;
+
+    while (numBytesInReceiveBuffer - pos >= 8)
+    {
+        const uint8* const message = static_cast<const uint8*> (receiveBuffer.getData()) + pos;
+
+        uint32 messageHeader[2];
+        memcpy (messageHeader, message, sizeof (messageHeader));
+        const uint32 headerMagic = ByteOrder::swapIfBigEndian (messageHeader[0]);
+        const uint32 numBytes    = ByteOrder::swapIfBigEndian (messageHeader[1]);
+
+        if (! (headerMagic == magicMessageHeader || headerMagic == ~magicMessageHeader) || numBytes > 0x7fffffff)
         {
-            if (! pipe->isOpen())
-            {
-                deletePipeAndSocket();
-                connectionLostInt();
-                break;
-            }
+            pos += sizeof (messageHeader);
+            continue;
         }
-        else
+
+        if (numBytesInReceiveBuffer - pos - sizeof (messageHeader) < numBytes)
         {
+            // (the rest of this message hasn't arrived yet, so make sure there'll be room for it)
+            receiveBuffer.ensureSize (sizeof (messageHeader) + numBytes);
             break;
         }
 
-        if (thread->threadShouldExit() || ! readNextMessageInt())
-            break;
+        pos += sizeof (messageHeader) + numBytes;
+
+        if (numBytes > 0 && ! handleMessageInt (headerMagic, message + sizeof (messageHeader), numBytes, nullptr))
+            return false;
+
+        // Once the other end has switched to a shared memory buffer, anything
+        // else that arrives on the socket is just a byte to wake us up
+        if (incomingRing != nullptr || thread->threadShouldExit())
+        {
+            numBytesInReceiveBuffer = 0;
+            return ! thread->threadShouldExit();
+        }
     }
+
+    numBytesInReceiveBuffer -= pos;
+
+    if (numBytesInReceiveBuffer > 0 && pos > 0)
+        memmove (receiveBuffer.getData(), addBytesToPointer (receiveBuffer.getData(), pos), numBytesInReceiveBuffer);
+
+    return true;
 }
+
+bool InterprocessConnection::openIncomingRing (const MemoryBlock& pathData)
+{
+    incomingRing = SharedMemoryRing::open (pathData.toString());
+
+    if (incomingRing == nullptr)
+    {
+        // The other end has switched to sending its messages through a buffer that can't
+        // be opened, so there's no way to receive anything more from it..
+        deletePipeAndSocket();
+        connectionLostInt();
+        return false;
+    }
+
+    return true;
+}
+
+bool InterprocessConnection::readFromIncomingRing()
+{
+    for (;;)
+    {
+        const void* data = nullptr;
+        const int numBytes = incomingRing->getNextMessage (data);
+
+        if (numBytes == 0)
+            break;
+
+        if (numBytes < 0)
+        {
+            // The buffer's been corrupted, so nothing more in it can be trusted..
+            deletePipeAndSocket();
+            connectionLostInt();
+            return false;
+        }
+
+        {
+            const SpinLock::ScopedLockType sl (statisticsLock);
+            ++statistics.numMessagesReceived;
+            statistics.numBytesReceived += numBytes;
+        }
+
+        if (! messageReceivedInPlace (data, (size_t) numBytes))
+            deliverDataInt (MemoryBlock (data, (size_t) numBytes));
+
+        incomingRing->finishedWithMessage (numBytes);
+
+        if (thread->threadShouldExit())
+            return false;
+    }
+
+    // When messages are being streamed, the next one is usually only moments away, so on a
+    // multi-core machine it's worth briefly spinning before going to sleep and making the
+    // sender have to wake us up.
+    for (int i = SystemStats::getNumCpus() > 1 ? 200 : 0; --i >= 0;)
+    {
+        if (incomingRing->hasMessages())
+            return true;
+
+        Thread::yield();
+    }
+
+    if (! incomingRing->prepareToWait())
+        return true;
+
+    // Now that the buffer's empty, wait for the other end to send a byte to say that
+    // it's written something more..
+    char wakeUpByte;
+    int bytes = -1;
+
+    if (socket != nullptr)
+    {
+        const int ready = socket->waitUntilReady (true, 100);
+
+        if (ready == 0)
+            return true;
+
+        if (ready > 0)
+            bytes = socket->read (&wakeUpByte, 1, true);
+    }
+    else if (pipe != nullptr)
+    {
+        bytes = pipe->read (&wakeUpByte, 1, -1);
+    }
+
+    incomingRing->finishedWaiting();
+
+    {
+        const SpinLock::ScopedLockType sl (statisticsLock);
+        ++statistics.numReads;
+    }
+
+    if (bytes < 0)
+    {
+        if (socket != nullptr)
+            deletePipeAndSocket();
+
+        connectionLostInt();
+        return false;
+    }
+
+    return true;
+}
+
+void InterprocessConnection::runThread()
+{
+    while (! thread->threadShouldExit())
+    {
+        if (incomingRing != nullptr)
+        {
+            if (! readFromIncomingRing())
+                break;
+
+            continue;
+        }
+
+        if (socket != nullptr)
+        {
+            // (this waits inside the socket rather than polling it, so that a message gets
+            // picked up as soon as it arrives, but it mustn't wait too long, as disconnect()
+            // has to wait for this thread to stop)
+            const int ready = socket->waitUntilReady (true, 20);
+
+            if (ready < 0)
+            {
+                deletePipeAndSocket();
+                connectionLostInt();
+                break;
+            }
+
+            if (ready == 0)
+                continue;
+        }
+        else if (pipe != nullptr)
+        {
+            if (! pipe->isOpen())
+            {
+                deletePipeAndSocket();
+                connectionLostInt();
+                break;
+            }
+        }
+        else
+        {
+            break;
+        }
+
+        if (thread->threadShouldExit() || ! (socket != nullptr ? readAvailableDataInt() : readNextMessageInt()))
+            break;
+    }
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class InterprocessConnectionTests  : public UnitTest
+{
+public:
+    InterprocessConnectionTests() : UnitTest ("InterprocessConnection") {}
+
+    typedef InterprocessConnection::SharedMemoryRing Ring;
+
+    //==============================================================================
+    struct TestConnection  : public InterprocessConnection
+    {
+        TestConnection()
+            : InterprocessConnection (false),
+              callbacksReleased (true), blockCallbacks (false)
+        {
+        }
+
+        ~TestConnection()
+        {
+            callbacksReleased.signal();
+            disconnect();
+        }
+
+        void connectionMade() override  {}
+        void connectionLost() override  { lost.signal(); }
+
+        void messageReceived (const MemoryBlock& message) override
+        {
+            {
+                const ScopedLock sl (lock);
+                messages.add (message);
+            }
+
+            received.signal();
+
+            if (blockCallbacks)
+                callbacksReleased.wait();
+        }
+
+        int getNumMessages() const
+        {
+            const ScopedLock sl (lock);
+            return messages.size();
+        }
+
+        bool waitForMessages (const int numMessages)
+        {
+            const uint32 timeoutEnd = Time::getMillisecondCounter() + 10000;
+
+            while (getNumMessages() < numMessages)
+            {
+                if (Time::getMillisecondCounter() > timeoutEnd)
+                    return false;
+
+                received.wait (100);
+            }
+
+            return true;
+        }
+
+        CriticalSection lock;
+        Array<MemoryBlock> messages;
+        WaitableEvent received, lost, callbacksReleased;
+        bool volatile blockCallbacks;
+    };
+
+    // Sends messages from a background thread, so that the test can see what
+    // happens when the sender gets stuck
+    struct SenderThread  : public Thread
+    {
+        SenderThread (InterprocessConnection& c, const int num, const size_t size)
+            : Thread ("IPC test sender"), connection (c),
+              numMessages (num), messageSize (size), numSent (0), failed (false)
+        {
+        }
+
+        ~SenderThread()
+        {
+            stopThread (5000);
+        }
+
+        void run() override
+        {
+            for (int i = 0; i < numMessages; ++i)
+            {
+                if (! connection.sendMessage (createMessage (i, messageSize)))
+                {
+                    failed = true;
+                    break;
+                }
+
+                ++numSent;
+            }
+        }
+
+        InterprocessConnection& connection;
+        const int numMessages;
+        const size_t messageSize;
+        Atomic<int> numSent;
+        bool volatile failed;
+    };
+
+    //==============================================================================
+    static MemoryBlock createMessage (const int index, const size_t size)
+    {
+        MemoryBlock message (size);
+
+        for (size_t i = 0; i < size; ++i)
+            message[i] = (char) (index * 31 + (int) i);
+
+        return message;
+    }
+
+    static bool connect (TestConnection& client, TestConnection& server)
+    {
+        StreamingSocket listener;
+
+        if (! (listener.createListener (0, "127.0.0.1")
+                && client.connectToSocket ("127.0.0.1", listener.getBoundPort(), 5000)))
+            return false;
+
+        if (StreamingSocket* const socket = listener.waitForNextConnection())
+        {
+            server.initialiseWithSocket (socket);
+            return true;
+        }
+
+        return false;
+    }
+
+    // Connects a connection to a plain socket, so that the test can send it anything it likes
+    static StreamingSocket* connectToRawSocket (TestConnection& client)
+    {
+        StreamingSocket listener;
+
+        if (listener.createListener (0, "127.0.0.1")
+             && client.connectToSocket ("127.0.0.1", listener.getBoundPort(), 5000))
+            return listener.waitForNextConnection();
+
+        return nullptr;
+    }
+
+    static void writePacket (OutputStream& out, const MemoryBlock& message, const uint32 magic = 0xf2b49e2c)
+    {
+        out.writeInt ((int) magic);
+        out.writeInt ((int) message.getSize());
+        out << message;
+    }
+
+    static int64 getTotalSize (const Array<MemoryBlock>& messages)
+    {
+        int64 total = 0;
+
+        for (int i = 0; i < messages.size(); ++i)
+            total += (int64) messages.getReference (i).getSize();
+
+        return total;
+    }
+
+    bool readFromRing (Ring& ring, const MemoryBlock& expected)
+    {
+        const void* data = nullptr;
+        const int numBytes = ring.getNextMessage (data);
+
+        if (numBytes != (int) expected.getSize() || memcmp (data, expected.getData(), expected.getSize()) != 0)
+            return false;
+
+        ring.finishedWithMessage (numBytes);
+        return true;
+    }
+
+    void expectMessagesMatch (TestConnection& receiver, const Array<MemoryBlock>& sent)
+    {
+        expect (receiver.waitForMessages (sent.size()));
+
+        const ScopedLock sl (receiver.lock);
+        expectEquals (receiver.messages.size(), sent.size());
+
+        for (int i = 0; i < jmin (sent.size(), receiver.messages.size()); ++i)
+        {
+            if (receiver.messages.getReference (i) != sent.getReference (i))
+            {
+                expect (false, "message " + String (i) + " is different");
+                break;
+            }
+        }
+    }
+
+    //==============================================================================
+    void runTest() override
+    {
+        Random r = getRandom();
+
+        beginTest ("Batched messages");
+        {
+            TestConnection sender, receiver;
+            expect (connect (sender, receiver));
+
+            Array<MemoryBlock> sent;
+            const int numBatches = 200;
+
+            for (int i = 0; i < numBatches; ++i)
+            {
+                Array<MemoryBlock> batch;
+
+                for (int j = r.nextInt (20); --j >= 0;)
+                    batch.add (createMessage (sent.size() + batch.size(),
+                                              r.nextInt (10) == 0 ? 70000 : 1 + (size_t) r.nextInt (100)));
+
+                if (batch.size() == 1 && r.nextBool())
+                    expect (sender.sendMessage (batch.getReference (0)));
+                else
+                    expect (sender.sendMessages (batch));
+
+                sent.addArray (batch);
+            }
+
+            expectMessagesMatch (receiver, sent);
+
+            // (each batch is sent with a single write)
+            const InterprocessConnection::Statistics sentStats (sender.getStatistics());
+            expectEquals (sentStats.numMessagesSent, (int64) sent.size());
+            expectEquals (sentStats.numBytesSent, getTotalSize (sent));
+            expectEquals (sentStats.numWrites, (int64) numBatches);
+
+            const InterprocessConnection::Statistics receivedStats (receiver.getStatistics());
+            expectEquals (receivedStats.numMessagesReceived, (int64) sent.size());
+            expectEquals (receivedStats.numBytesReceived, getTotalSize (sent));
+            expect (receivedStats.numReads > 0);
+
+            sender.resetStatistics();
+            expectEquals (sender.getStatistics().numMessagesSent, (int64) 0);
+            expectEquals (sender.getStatistics().numWrites, (int64) 0);
+        }
+
+        beginTest ("Fragmented and buffered reads");
+        {
+            TestConnection receiver;
+            ScopedPointer<StreamingSocket> peer (connectToRawSocket (receiver));
+            expect (peer != nullptr);
+
+            Array<MemoryBlock> sent;
+            MemoryOutputStream data;
+
+            for (int i = 0; i < 300; ++i)
+            {
+                // (a header with the wrong magic number is skipped)
+                if (i == 100)
+                    writePacket (data, MemoryBlock(), 0x12345678);
+
+                sent.add (createMessage (i, r.nextInt (20) == 0 ? 200000 : 1 + (size_t) r.nextInt (100)));
+                writePacket (data, sent.getLast());
+            }
+
+            // send it in pieces which split the messages and their headers at random points
+            for (size_t pos = 0; pos < data.getDataSize();)
+            {
+                const int numBytes = jmin ((int) (data.getDataSize() - pos),
+                                           r.nextBool() ? 1 + r.nextInt (3) : 1 + r.nextInt (5000));
+
+                expectEquals (peer->write (addBytesToPointer (data.getData(), pos), numBytes), numBytes);
+                pos += (size_t) numBytes;
+
+                if (r.nextInt (20) == 0)
+                    Thread::sleep (1);
+            }
+
+            expectMessagesMatch (receiver, sent);
+
+            const InterprocessConnection::Statistics stats (receiver.getStatistics());
+            expectEquals (stats.numMessagesReceived, (int64) sent.size());
+            expectEquals (stats.numBytesReceived, getTotalSize (sent));
+
+            // lots of messages arriving at once should only need a few reads
+            receiver.resetStatistics();
+            MemoryOutputStream smallMessages;
+
+            for (int i = 0; i < 500; ++i)
+            {
+                sent.add (createMessage (i, 10));
+                writePacket (smallMessages, sent.getLast());
+            }
+
+            expectEquals (peer->write (smallMessages.getData(), (int) smallMessages.getDataSize()), (int) smallMessages.getDataSize());
+            expectMessagesMatch (receiver, sent);
+
+            expectEquals (receiver.getStatistics().numMessagesReceived, (int64) 500);
+            expect (receiver.getStatistics().numReads < 50);
+        }
+
+        beginTest ("Shared memory ring");
+        {
+            ScopedPointer<Ring> writer (Ring::create (4096));
+            expect (writer != nullptr && writer->bufferSize == 4096);
+
+            ScopedPointer<Ring> reader (Ring::open (writer->getPath()));
+            expect (reader != nullptr);
+            expect (! File (writer->getPath()).exists());
+
+            Array<MemoryBlock> inFlight;
+            int numWritten = 0, numPadded = 0;
+            uint32 totalWritten = 0;
+
+            for (int round = 0; round < 500; ++round)
+            {
+                for (;;)
+                {
+                    const MemoryBlock message (createMessage (numWritten, 1 + (size_t) r.nextInt (1500)));
+                    const uint32 writePos = writer->header->writePosition.get();
+                    const Ring::WriteResult result = writer->write (message.getData(), message.getSize());
+
+                    if (result == Ring::bufferFull)
+                        break;
+
+                    expect (result == Ring::written);
+                    inFlight.add (message);
+                    ++numWritten;
+
+                    // (a record that wouldn't fit before the end of the buffer starts again at the beginning)
+                    if ((writePos & 4095) + Ring::getRecordSize (message.getSize()) > 4096)
+                        ++numPadded;
+
+                    totalWritten += Ring::getRecordSize (message.getSize());
+                }
+
+                for (int i = 1 + r.nextInt (inFlight.size()); --i >= 0;)
+                {
+                    expect (readFromRing (*reader, inFlight.getReference (0)));
+                    inFlight.remove (0);
+                }
+            }
+
+            while (inFlight.size() > 0)
+            {
+                expect (readFromRing (*reader, inFlight.getReference (0)));
+                inFlight.remove (0);
+            }
+
+            const void* data = nullptr;
+            expectEquals (reader->getNextMessage (data), 0);
+            expect (! reader->hasMessages());
+            expect (totalWritten > 100 * 4096 && numPadded > 50);
+
+            // the largest record that can be written is half the buffer
+            const MemoryBlock largest (createMessage (0, 2048 - 8));
+            expect (writer->write (largest.getData(), largest.getSize()) == Ring::written);
+            expect (writer->write (largest.getData(), largest.getSize() + 1) == Ring::failed);
+            expect (writer->write (largest.getData(), (size_t) 1 << 31) == Ring::failed);
+            expect (readFromRing (*reader, largest));
+        }
+
+        beginTest ("Corrupted shared memory rings");
+        {
+            ScopedPointer<Ring> writer (Ring::create (4096));
+            ScopedPointer<Ring> reader (Ring::open (writer->getPath()));
+            expect (reader != nullptr);
+
+            const MemoryBlock message (createMessage (0, 100));
+            expect (writer->write (message.getData(), message.getSize()) == Ring::written);
+
+            // (both ends share the same memory, so anything the writer does, the reader sees)
+            uint32& recordSize = writer->getRecord (writer->header->readPosition.get() & 4095)[0];
+            const void* data = nullptr;
+
+            recordSize = 0x7fffffff;
+            expectEquals (reader->getNextMessage (data), -1);
+
+            recordSize = 1000;
+            expectEquals (reader->getNextMessage (data), -1);
+
+            recordSize = Ring::paddingMarker;
+            expectEquals (reader->getNextMessage (data), -1);
+
+            recordSize = (uint32) message.getSize();
+            writer->header->writePosition += 8192;
+            expectEquals (reader->getNextMessage (data), -1);
+
+            writer->header->writePosition -= 8192;
+            expect (readFromRing (*reader, message));
+
+            // a corrupted header stops the other end from opening the buffer
+            {
+                ScopedPointer<Ring> ring (Ring::create (4096));
+                const File file (ring->getPath());
+
+                {
+                    MemoryMappedFile mapped (file, MemoryMappedFile::readWrite);
+                    static_cast<uint32*> (mapped.getData())[1] = 3000;
+                }
+
+                expect (Ring::open (file.getFullPathName()) == nullptr);
+                expect (file.existsAsFile());
+            }
+        }
+
+        beginTest ("Opening shared memory rings from unexpected places");
+        {
+            ScopedPointer<Ring> ring (Ring::create (4096));
+            const File original (ring->getPath());
+            const File dir (original.getParentDirectory());
+
+            const File otherDir (dir.getNonexistentChildFile ("juce_ipc_test", String(), false));
+            expect (otherDir.createDirectory());
+
+            const File outside (otherDir.getChildFile (original.getFileName()));
+            const File wrongName (dir.getNonexistentChildFile ("juce_ipc_test", ".txt", false));
+            expect (original.copyFileTo (outside) && original.copyFileTo (wrongName));
+
+            // (none of these should be opened, or deleted)
+            expect (Ring::open (outside.getFullPathName()) == nullptr);
+            expect (Ring::open (wrongName.getFullPathName()) == nullptr);
+            expect (Ring::open (original.getFileName()) == nullptr);
+            expect (Ring::open (String()) == nullptr);
+            expect (outside.existsAsFile() && wrongName.existsAsFile() && original.existsAsFile());
+
+            expect (otherDir.deleteRecursively() && wrongName.deleteFile());
+
+            ScopedPointer<Ring> reader (Ring::open (original.getFullPathName()));
+            expect (reader != nullptr && ! original.exists());
+        }
+
+        beginTest ("Bad shared memory data from the other end");
+        {
+            const uint32 ringMagic = ~(uint32) 0xf2b49e2c;
+
+            // a buffer that can't be opened drops the connection..
+            {
+                TestConnection receiver;
+                ScopedPointer<StreamingSocket> socket (connectToRawSocket (receiver));
+                expect (socket != nullptr);
+
+                MemoryOutputStream out;
+                writePacket (out, MemoryBlock ("/etc/passwd", 11), ringMagic);
+                expect (socket->write (out.getData(), (int) out.getDataSize()) == (int) out.getDataSize());
+
+                expect (receiver.lost.wait (5000));
+                expect (! receiver.isConnected());
+            }
+
+            // ..and so does a corrupted record, after the messages before it are delivered
+            {
+                TestConnection receiver;
+                ScopedPointer<StreamingSocket> socket (connectToRawSocket (receiver));
+                expect (socket != nullptr);
+
+                ScopedPointer<Ring> writer (Ring::create (4096));
+                const MemoryBlock message (createMessage (0, 100));
+                expect (writer->write (message.getData(), message.getSize()) == Ring::written);
+
+                const uint32 secondRecord = writer->header->writePosition.get();
+                expect (writer->write (message.getData(), message.getSize()) == Ring::written);
+                writer->getRecord (secondRecord & 4095)[0] = 0x7fffffff;
+
+                const String path (writer->getPath());
+                MemoryOutputStream out;
+                writePacket (out, MemoryBlock (path.toRawUTF8(), path.getNumBytesAsUTF8()), ringMagic);
+                expect (socket->write (out.getData(), (int) out.getDataSize()) == (int) out.getDataSize());
+
+                expect (receiver.lost.wait (5000));
+                expect (! receiver.isConnected());
+
+                const ScopedLock sl (receiver.lock);
+                expectEquals (receiver.messages.size(), 1);
+                expect (receiver.messages.size() == 1 && receiver.messages.getReference (0) == message);
+            }
+        }
+
+        beginTest ("Shared memory transport");
+        {
+            TestConnection sender, receiver;
+            expect (connect (sender, receiver));
+            expect (sender.enableSharedMemoryTransport (4096));
+            expect (sender.isUsingSharedMemoryTransport());
+
+            Array<MemoryBlock> sent;
+
+            for (int i = 0; i < 2000; ++i)
+            {
+                if (r.nextInt (10) == 0)
+                {
+                    Array<MemoryBlock> batch;
+
+                    for (int j = r.nextInt (10); --j >= 0;)
+                        batch.add (createMessage (sent.size() + batch.size(), 1 + (size_t) r.nextInt (1500)));
+
+                    expect (sender.sendMessages (batch));
+                    sent.addArray (batch);
+                }
+                else
+                {
+                    sent.add (createMessage (sent.size(), 1 + (size_t) r.nextInt (1500)));
+                    expect (sender.sendMessage (sent.getLast()));
+                }
+            }
+
+            expectMessagesMatch (receiver, sent);
+        }
+
+        beginTest ("Shutting down while the other end is blocked");
+        {
+            // the sender is stuck waiting for space in the buffer..
+            {
+                TestConnection sender, receiver;
+                expect (connect (sender, receiver));
+                expect (sender.enableSharedMemoryTransport (4096));
+
+                receiver.callbacksReleased.reset();
+                receiver.blockCallbacks = true;
+
+                SenderThread senderThread (sender, 10, 1500);
+                senderThread.startThread();
+
+                expect (receiver.received.wait (5000));
+                Thread::sleep (100);
+                expect (senderThread.isThreadRunning() && senderThread.numSent.get() < 10);
+
+                const uint32 startTime = Time::getMillisecondCounter();
+                sender.disconnect();
+                expect (Time::getMillisecondCounter() - startTime < 2000);
+
+                expect (senderThread.waitForThreadToExit (2000));
+                expect (senderThread.failed);
+
+                receiver.callbacksReleased.signal();
+                expect (receiver.lost.wait (5000));
+            }
+
+            // ..and the receiver is waiting to be woken up
+            {
+                TestConnection sender, receiver;
+                expect (connect (sender, receiver));
+                expect (sender.enableSharedMemoryTransport (4096));
+
+                const MemoryBlock message (createMessage (0, 10));
+                expect (sender.sendMessage (message));
+                expect (receiver.waitForMessages (1));
+                Thread::sleep (50);
+
+                sender.disconnect();
+                expect (receiver.lost.wait (5000));
+
+                const uint32 startTime = Time::getMillisecondCounter();
+                receiver.disconnect();
+                expect (Time::getMillisecondCounter() - startTime < 2000);
+            }
+        }
+    }
+};
+
+static InterprocessConnectionTests interprocessConnectionTests;
+
+#endif
@@ -51,6 +51,10 @@ class MemoryBlock;
     To act as a socket server and create connections for one or more client, see the
     InterprocessConnectionServer class.
 
+    When both processes are on the same machine, enableSharedMemoryTransport() can be used
+    to send the messages through a shared memory ring buffer instead of the pipe or socket,
+    which avoids most of the copying and system calls when a lot of data is being streamed.
+
     @see InterprocessConnectionServer, Socket, NamedPipe
 */
 class JUCE_API  InterprocessConnection
@@ -151,6 +155,55 @@ public:
     */
     bool sendMessage (const MemoryBlock& message);
 
+    /** Tries to send a block of data as a message to the other end of this connection.
+
+        This does the same thing as the sendMessage() method that takes a MemoryBlock,
+        but lets you avoid having to copy the data into one first.
+
+        @see messageReceived, messageReceivedInPlace
+    */
+    bool sendMessage (const void* messageData, size_t numBytes);
+
+    /** Sends a list of messages to the other end of this connection.
+
+        The messages arrive at the other end as if they'd been passed to sendMessage()
+        one at a time, but they're all written to the socket or pipe in a single call,
+        which is much more efficient than sending lots of small messages separately.
+
+        @returns true if all the messages were sent
+        @see sendMessage
+    */
+    bool sendMessages (const Array<MemoryBlock>& messages);
+
+    //==============================================================================
+    /** Makes the messages that this end sends go through a shared memory ring buffer,
+        rather than the pipe or socket.
+
+        This can only be used when the other end is a process on the same machine, and
+        it must also be using a version of this class that supports it - the other end
+        doesn't need to call this method to receive the messages, but if it also wants
+        to send its messages via shared memory, it must call it too.
+
+        Once enabled, each message is copied directly into memory that the other process
+        can read, and the pipe or socket is only used to wake up the other end when it has
+        run out of messages and is waiting for more. The ring buffer stays in use until
+        the connection is closed.
+
+        If the buffer is full when a message is sent, sendMessage() will wait for the other
+        end to read enough messages to make space for it. Messages that are larger than half
+        the size of the buffer can't be sent at all.
+
+        @param bufferSizeBytes  the size of the ring buffer - this is rounded up to a power of 2
+        @returns true if the buffer was created and the other end has been told to use it
+        @see isUsingSharedMemoryTransport, messageReceivedInPlace
+    */
+    bool enableSharedMemoryTransport (int bufferSizeBytes = 1024 * 1024);
+
+    /** Returns true if enableSharedMemoryTransport() has been successfully called since
+        this connection was opened.
+    */
+    bool isUsingSharedMemoryTransport() const noexcept          { return outgoingRing != nullptr; }
+
     //==============================================================================
     /** Called when the connection is first connected.
 
@@ -181,6 +234,64 @@ public:
     */
     virtual void messageReceived (const MemoryBlock& message) = 0;
 
+    /** Called when a message arrives, before it is passed to messageReceived().
+
+        This is always called on the connection's own thread, regardless of the
+        callbacksOnMessageThread setting, and the data is passed directly from wherever it
+        was received into, so if the other end is using a shared memory transport, it points
+        straight into the shared buffer. The data is only valid until this method returns,
+        and the sender may be held up until it does, so don't do anything slow in here.
+
+        If you return true, the message is considered to have been dealt with, and
+        messageReceived() won't be called for it. The default implementation returns
+        false, so that all messages get delivered to messageReceived().
+
+        @see messageReceived, enableSharedMemoryTransport
+    */
+    virtual bool messageReceivedInPlace (const void* messageData, size_t numBytes);
+
+    //==============================================================================
+    /** Some counters that describe the traffic that has gone through a connection.
+        @see getStatistics
+    */
+    struct JUCE_API  Statistics
+    {
+        /** Creates a Statistics object with all the counters set to zero. */
+        Statistics() noexcept;
+
+        /** The number of messages that have been sent. */
+        int64 numMessagesSent;
+        /** The total size of the messages that have been sent, not including their headers. */
+        int64 numBytesSent;
+        /** The number of times that data was written to the socket or pipe. */
+        int64 numWrites;
+        /** The total time spent inside sendMessage() and sendMessages(), which includes
+            any time spent waiting for the socket, pipe or shared memory buffer. */
+        double totalSendSeconds;
+        /** The longest time that a single call to sendMessage() or sendMessages() took. */
+        double maxSendSeconds;
+
+        /** The number of messages that have been received. */
+        int64 numMessagesReceived;
+        /** The total size of the messages that have been received, not including their headers. */
+        int64 numBytesReceived;
+        /** The number of times that data was read from the socket or pipe. */
+        int64 numReads;
+        /** For a connection that uses the message thread, the total time that the messages
+            spent waiting to be delivered to messageReceived() after they'd arrived. */
+        double totalDeliverySeconds;
+        /** The longest time that a message waited to be delivered to messageReceived(). */
+        double maxDeliverySeconds;
+    };
+
+    /** Returns the counters for all the messages that have gone through this connection
+        since it was created, or since resetStatistics() was last called.
+    */
+    Statistics getStatistics() const;
+
+    /** Sets all the counters returned by getStatistics() back to zero. */
+    void resetStatistics();
+
 
 private:
     //==============================================================================
@@ -202,13 +313,37 @@ private:
     void connectionLostInt();
     void deliverDataInt (const MemoryBlock&);
     bool readNextMessageInt();
+    bool readAvailableDataInt();
+    bool handleMessageInt (uint32, const void*, size_t, const MemoryBlock*);
+
+    CriticalSection writeLock;
+    MemoryBlock writeBuffer, receiveBuffer;
+    size_t numBytesInWriteBuffer, numBytesInReceiveBuffer;
+    void addToWriteBuffer (uint32, const void*, size_t);
+    bool flushWriteBuffer();
+
+    struct SharedMemoryRing;
+    friend struct ContainerDeletePolicy<SharedMemoryRing>;
+    ScopedPointer<SharedMemoryRing> outgoingRing, incomingRing;
+    bool openIncomingRing (const MemoryBlock&);
+    bool readFromIncomingRing();
+    bool writeToOutgoingRing (const void*, size_t);
+    bool wakeUpOutgoingRingReader();
+
+    SpinLock statisticsLock;
+    Statistics statistics;
+    void messageSent (int numMessages, size_t numBytes, int64 startTicks);
+    void messageDelivered (int64 receivedTicks);
+    friend struct DataDeliveryMessage;
+
+    friend class InterprocessConnectionTests;
 
     struct ConnectionThread;
     friend struct ConnectionThread;
     friend struct ContainerDeletePolicy<ConnectionThread>;
     ScopedPointer<ConnectionThread> thread;
     void runThread();
-    int writeData (void*, int);
+    int writeData (const void*, int);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (InterprocessConnection)
 };
@@ -22,44 +22,11 @@
   ==============================================================================
 */
 
-static inline void blurDataTriplets (uint8* d, int num, const int delta) noexcept
+// The shadow radius was originally implemented as 2 * radius passes of a 3-pixel
+// averaging filter in each direction, so this keeps the same spread
+static float getShadowStandardDeviation (const int radius) noexcept
 {
-    uint32 last = d[0];
-    d[0] = (uint8) ((d[0] + d[delta] + 1) / 3);
-    d += delta;
-
-    num -= 2;
-
-    do
-    {
-        const uint32 newLast = d[0];
-        d[0] = (uint8) ((last + d[0] + d[delta] + 1) / 3);
-        d += delta;
-        last = newLast;
-    }
-    while (--num > 0);
-
-    d[0] = (uint8) ((last + d[0] + 1) / 3);
-}
-
-static void blurSingleChannelImage (uint8* const data, const int width, const int height,
-                                    const int lineStride, const int repetitions) noexcept
-{
-    jassert (width > 2 && height > 2);
-
-    for (int y = 0; y < height; ++y)
-        for (int i = repetitions; --i >= 0;)
-            blurDataTriplets (data + lineStride * y, width, 1);
-
-    for (int x = 0; x < width; ++x)
-        for (int i = repetitions; --i >= 0;)
-            blurDataTriplets (data + x, height, lineStride);
-}
-
-static void blurSingleChannelImage (Image& image, int radius)
-{
-    const Image::BitmapData bm (image, Image::BitmapData::readWrite);
-    blurSingleChannelImage (bm.data, bm.width, bm.height, bm.lineStride, 2 * radius);
+    return std::sqrt (radius * (4.0f / 3.0f));
 }
 
 //==============================================================================
@@ -83,7 +50,7 @@ void DropShadow::drawForImage (Graphics& g, const Image& srcImage) const
         Image shadowImage (srcImage.convertedToFormat (Image::SingleChannel));
         shadowImage.duplicateIfShared();
 
-        blurSingleChannelImage (shadowImage, radius);
+        ImageBlur::applyGaussianBlur (shadowImage, getShadowStandardDeviation (radius));
 
         g.setColour (colour);
         g.drawImageAt (shadowImage, offset.x, offset.y, true);
@@ -109,7 +76,7 @@ void DropShadow::drawForPath (Graphics& g, const Path& path) const
                                                              (float) (offset.y - area.getY())));
         }
 
-        blurSingleChannelImage (renderedPath, radius);
+        ImageBlur::applyGaussianBlur (renderedPath, getShadowStandardDeviation (radius));
 
         g.setColour (colour);
         g.drawImageAt (renderedPath, area.getX(), area.getY(), true);
@@ -180,3 +147,101 @@ void DropShadowEffect::applyEffect (Image& image, Graphics& g, float scaleFactor
     g.setOpacity (alpha);
     g.drawImageAt (image, 0, 0);
 }
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class DropShadowTests  : public UnitTest
+{
+public:
+    DropShadowTests() : UnitTest ("DropShadow") {}
+
+    // This is how the shadows used to be blurred, with (2 * radius) passes of a
+    // 3-pixel average in each direction
+    static void blurTriplets (uint8* d, int num, const int delta) noexcept
+    {
+        uint32 last = d[0];
+        d[0] = (uint8) ((d[0] + d[delta] + 1) / 3);
+        d += delta;
+
+        num -= 2;
+
+        do
+        {
+            const uint32 newLast = d[0];
+            d[0] = (uint8) ((last + d[0] + d[delta] + 1) / 3);
+            d += delta;
+            last = newLast;
+        }
+        while (--num > 0);
+
+        d[0] = (uint8) ((last + d[0] + 1) / 3);
+    }
+
+    static void applyOriginalBlur (Image& image, const int radius)
+    {
+        const Image::BitmapData data (image, Image::BitmapData::readWrite);
+
+        for (int y = 0; y < data.height; ++y)
+            for (int i = 2 * radius; --i >= 0;)
+                blurTriplets (data.getLinePointer (y), data.width, 1);
+
+        for (int x = 0; x < data.width; ++x)
+            for (int i = 2 * radius; --i >= 0;)
+                blurTriplets (data.getPixelPointer (x, 0), data.height, data.lineStride);
+    }
+
+    // Creates a shadow mask that's solid on its left half, so that there's an edge to blur
+    static Image createEdge (const int radius)
+    {
+        const int size = 32 + radius * 12;
+        Image image (Image::SingleChannel, size, size, true);
+        const Image::BitmapData data (image, Image::BitmapData::writeOnly);
+
+        for (int y = 0; y < size; ++y)
+            memset (data.getLinePointer (y), 0xff, (size_t) size / 2);
+
+        return image;
+    }
+
+    // Measures the spread of a blurred edge, as the variance of the blur that it went
+    // through (the change from one pixel to the next traces out the shape of the blur)
+    static double getEdgeVariance (const Image& image, const int row)
+    {
+        const Image::BitmapData data (image, Image::BitmapData::readOnly);
+        double total = 0, weightedTotal = 0, weightedSquares = 0;
+
+        // (the edges of the image also get blurred, so they're left out)
+        for (int x = data.width / 4; x < data.width * 3 / 4; ++x)
+        {
+            const double step = data.getPixelPointer (x, row)[0] - (double) data.getPixelPointer (x + 1, row)[0];
+            total += step;
+            weightedTotal += step * x;
+            weightedSquares += step * x * x;
+        }
+
+        const double mean = weightedTotal / total;
+        return weightedSquares / total - mean * mean;
+    }
+
+    void runTest() override
+    {
+        beginTest ("Shadow spread");
+
+        for (int radius = 1; radius <= 20; ++radius)
+        {
+            Image original (createEdge (radius)), blurred (createEdge (radius));
+            applyOriginalBlur (original, radius);
+            ImageBlur::applyGaussianBlur (blurred, getShadowStandardDeviation (radius));
+
+            const int row = original.getHeight() / 2;
+            const double originalVariance = getEdgeVariance (original, row);
+
+            expectWithinAbsoluteError (getEdgeVariance (blurred, row), originalVariance, originalVariance * 0.08);
+        }
+    }
+};
+
+static DropShadowTests dropShadowTests;
+
+#endif
@@ -41,17 +41,37 @@ void GlowEffect::setGlowProperties (const float newRadius,
 
 void GlowEffect::applyEffect (Image& image, Graphics& g, float scaleFactor, float alpha)
 {
-    Image temp (image.getFormat(), image.getWidth(), image.getHeight(), true);
-
-    ImageConvolutionKernel blurKernel (roundToInt (radius * scaleFactor * 2.0f));
-
-    blurKernel.createGaussianBlur (radius);
-    blurKernel.rescaleAllValues (radius);
-
-    blurKernel.applyToImage (temp, image, image.getBounds());
-
-    g.setColour (colour.withMultipliedAlpha (alpha));
-    g.drawImageAt (temp, 0, 0, true);
+    const int kernelSize = roundToInt (radius * scaleFactor * 2.0f);
+
+    if (kernelSize > 0)
+    {
+        // This is the same gaussian kernel that ImageConvolutionKernel::createGaussianBlur()
+        // would create, split into its horizontal and vertical halves. The values are
+        // multiplied by the radius in total, which makes larger glows brighter.
+        HeapBlock<float> kernel ((size_t) kernelSize);
+        const double radiusFactor = -1.0 / (radius * radius * 2);
+        double total = 0;
+
+        for (int i = 0; i < kernelSize; ++i)
+        {
+            const int offset = i - (kernelSize >> 1);
+            kernel[i] = (float) exp (radiusFactor * offset * offset);
+            total += kernel[i];
+        }
+
+        for (int i = 0; i < kernelSize; ++i)
+            kernel[i] = (float) (kernel[i] * std::sqrt (radius) / total);
+
+        Image temp (image.createCopy());
+
+        {
+            const Image::BitmapData data (temp, Image::BitmapData::readWrite);
+            ImageBlur::applySeparableKernel (data, kernel, kernelSize);
+        }
+
+        g.setColour (colour.withMultipliedAlpha (alpha));
+        g.drawImageAt (temp, 0, 0, true);
+    }
 
     g.setOpacity (alpha);
     g.drawImageAt (image, 0, 0, false);
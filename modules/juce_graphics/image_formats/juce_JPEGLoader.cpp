@@ -173,6 +173,50 @@ namespace JPEGHelpers
     }
    #endif
 
+    //==============================================================================
+    static int getScaleDenominator (const int imageWidth, const int imageHeight,
+                                    const int targetWidth, const int targetHeight) noexcept
+    {
+        if (targetWidth > 0 && targetHeight > 0)
+            for (int denom = 8; denom > 1; denom /= 2)
+                if ((imageWidth + denom - 1) / denom >= targetWidth
+                     && (imageHeight + denom - 1) / denom >= targetHeight)
+                    return denom;
+
+        return 1;
+    }
+
+    static void copyScanline (const Image::BitmapData& destData, const int y, const uint8* src) noexcept
+    {
+        uint8* dest = destData.getLinePointer (y);
+
+        if (destData.pixelFormat == Image::RGB)
+        {
+            if (destData.pixelStride == 3 && PixelRGB::indexR == 0 && PixelRGB::indexB == 2)
+            {
+                memcpy (dest, src, (size_t) destData.width * 3);
+                return;
+            }
+
+            for (int i = destData.width; --i >= 0;)
+            {
+                ((PixelRGB*) dest)->setARGB (0xff, src[0], src[1], src[2]);
+                dest += destData.pixelStride;
+                src += 3;
+            }
+        }
+        else
+        {
+            // (these pixels are opaque, so don't need premultiplying)
+            for (int i = destData.width; --i >= 0;)
+            {
+                ((PixelARGB*) dest)->setARGB (0xff, src[0], src[1], src[2]);
+                dest += destData.pixelStride;
+                src += 3;
+            }
+        }
+    }
+
     //==============================================================================
     const int jpegBufferSize = 512;
 
@@ -207,7 +251,7 @@ namespace JPEGHelpers
 
 //==============================================================================
 JPEGImageFormat::JPEGImageFormat()
-    : quality (-1.0f)
+    : quality (-1.0f), targetWidth (0), targetHeight (0)
 {
 }
 
@@ -218,6 +262,12 @@ void JPEGImageFormat::setQuality (const float newQuality)
     quality = newQuality;
 }
 
+void JPEGImageFormat::setTargetDecodeSize (const int width, const int height)
+{
+    targetWidth = jmax (0, width);
+    targetHeight = jmax (0, height);
+}
+
 String JPEGImageFormat::getFormatName()                   { return "JPEG"; }
 bool JPEGImageFormat::usesFileExtension (const File& f)   { return f.hasFileExtension ("jpeg;jpg"); }
 
@@ -244,12 +294,27 @@ Image JPEGImageFormat::decodeImage (InputStream& in)
     using namespace jpeglibNamespace;
     using namespace JPEGHelpers;
 
+    // If the data's already in memory, it can be decoded in-place rather than copied
+    const int64 startPosition = in.getPosition();
     MemoryOutputStream mb;
-    mb << in;
+    const uint8* sourceData = nullptr;
+    size_t sourceSize = 0;
+
+    if (MemoryInputStream* const memIn = dynamic_cast<MemoryInputStream*> (&in))
+    {
+        sourceData = static_cast<const uint8*> (memIn->getData()) + startPosition;
+        sourceSize = memIn->getDataSize() - (size_t) startPosition;
+    }
+    else
+    {
+        mb << in;
+        sourceData = static_cast<const uint8*> (mb.getData());
+        sourceSize = mb.getDataSize();
+    }
 
     Image image;
 
-    if (mb.getDataSize() > 16)
+    if (sourceSize > 16)
     {
         struct jpeg_decompress_struct jpegDecompStruct;
 
@@ -271,13 +336,19 @@ Image JPEGImageFormat::decodeImage (InputStream& in)
         jpegDecompStruct.src->resync_to_restart = jpeg_resync_to_restart;
         jpegDecompStruct.src->term_source       = dummyCallback1;
 
-        jpegDecompStruct.src->next_input_byte   = static_cast<const unsigned char*> (mb.getData());
-        jpegDecompStruct.src->bytes_in_buffer   = mb.getDataSize();
+        jpegDecompStruct.src->next_input_byte   = sourceData;
+        jpegDecompStruct.src->bytes_in_buffer   = sourceSize;
 
         jpeg_read_header (&jpegDecompStruct, TRUE);
 
         if (! hasFailed)
         {
+            // The IDCT can produce a 1/2, 1/4 or 1/8 size image directly from the coefficients,
+            // which is much quicker than decoding the whole thing and scaling it afterwards
+            jpegDecompStruct.scale_num = 1;
+            jpegDecompStruct.scale_denom = (unsigned int) getScaleDenominator ((int) jpegDecompStruct.image_width,
+                                                                                (int) jpegDecompStruct.image_height,
+                                                                                targetWidth, targetHeight);
             jpeg_calc_output_dimensions (&jpegDecompStruct);
 
             if (! hasFailed)
@@ -287,54 +358,36 @@ Image JPEGImageFormat::decodeImage (InputStream& in)
 
                 jpegDecompStruct.out_color_space = JCS_RGB;
 
+                const int numBufferLines = 8;
+
                 JSAMPARRAY buffer
                     = (*jpegDecompStruct.mem->alloc_sarray) ((j_common_ptr) &jpegDecompStruct,
                                                              JPOOL_IMAGE,
-                                                             (JDIMENSION) width * 3, 1);
+                                                             (JDIMENSION) width * 3, numBufferLines);
 
                 if (jpeg_start_decompress (&jpegDecompStruct) && ! hasFailed)
                 {
                     image = Image (Image::RGB, width, height, false);
                     image.getProperties()->set ("originalImageHadAlpha", false);
-                    const bool hasAlphaChan = image.hasAlphaChannel(); // (the native image creator may not give back what we expect)
 
+                    // (the native image creator may not give back what we expect)
                     const Image::BitmapData destData (image, Image::BitmapData::writeOnly);
 
-                    for (int y = 0; y < height; ++y)
+                    for (int y = 0; y < height;)
                     {
-                        jpeg_read_scanlines (&jpegDecompStruct, buffer, 1);
+                        const int numLines = (int) jpeg_read_scanlines (&jpegDecompStruct, buffer, (JDIMENSION) numBufferLines);
 
-                        if (hasFailed)
+                        if (hasFailed || numLines <= 0)
                             break;
 
-                        const uint8* src = *buffer;
-                        uint8* dest = destData.getLinePointer (y);
-
-                        if (hasAlphaChan)
-                        {
-                            for (int i = width; --i >= 0;)
-                            {
-                                ((PixelARGB*) dest)->setARGB (0xff, src[0], src[1], src[2]);
-                                ((PixelARGB*) dest)->premultiply();
-                                dest += destData.pixelStride;
-                                src += 3;
-                            }
-                        }
-                        else
-                        {
-                            for (int i = width; --i >= 0;)
-                            {
-                                ((PixelRGB*) dest)->setARGB (0xff, src[0], src[1], src[2]);
-                                dest += destData.pixelStride;
-                                src += 3;
-                            }
-                        }
+                        for (int i = 0; i < numLines; ++i)
+                            copyScanline (destData, y++, buffer[i]);
                     }
 
                     if (! hasFailed)
                         jpeg_finish_decompress (&jpegDecompStruct);
 
-                    in.setPosition (((char*) jpegDecompStruct.src->next_input_byte) - (char*) mb.getData());
+                    in.setPosition (startPosition + (((const uint8*) jpegDecompStruct.src->next_input_byte) - sourceData));
                 }
             }
         }
@@ -434,3 +487,140 @@ bool JPEGImageFormat::writeImageToStream (const Image& image, OutputStream& out)
 
     return true;
 }
+
+//==============================================================================
+#if JUCE_UNIT_TESTS && ! JUCE_USING_COREIMAGE_LOADER
+
+class JPEGImageFormatTests  : public UnitTest
+{
+public:
+    JPEGImageFormatTests() : UnitTest ("JPEGImageFormat") {}
+
+    // (smooth gradients survive the compression well enough to compare the pixels)
+    static Image createGradient (const int width, const int height)
+    {
+        Image image (Image::RGB, width, height, false);
+        const Image::BitmapData data (image, Image::BitmapData::writeOnly);
+
+        for (int y = 0; y < height; ++y)
+            for (int x = 0; x < width; ++x)
+                ((PixelRGB*) data.getPixelPointer (x, y))->setARGB (255, (uint8) (x * 255 / width),
+                                                                         (uint8) (y * 255 / height), 128);
+
+        return image;
+    }
+
+    static int getMaxDifference (const Image& image, const Image& original, const int scale)
+    {
+        const Image::BitmapData data (image, Image::BitmapData::readOnly);
+        const Image::BitmapData originalData (original, Image::BitmapData::readOnly);
+        int maxDifference = 0;
+
+        for (int y = 0; y < data.height; ++y)
+        {
+            for (int x = 0; x < data.width; ++x)
+            {
+                // (compares each pixel with the one in the middle of the block that it covers)
+                const Colour pixel (data.getPixelColour (x, y));
+                const Colour expected (originalData.getPixelColour (jmin (originalData.width - 1,  x * scale + scale / 2),
+                                                                    jmin (originalData.height - 1, y * scale + scale / 2)));
+
+                maxDifference = jmax (maxDifference,
+                                      std::abs (pixel.getRed()   - expected.getRed()),
+                                      std::abs (pixel.getGreen() - expected.getGreen()),
+                                      std::abs (pixel.getBlue()  - expected.getBlue()));
+            }
+        }
+
+        return maxDifference;
+    }
+
+    void expectDecodedSize (const MemoryBlock& jpeg, const int targetWidth, const int targetHeight,
+                            const int expectedWidth, const int expectedHeight)
+    {
+        JPEGImageFormat format;
+        format.setTargetDecodeSize (targetWidth, targetHeight);
+
+        MemoryInputStream in (jpeg, false);
+        const Image image (format.decodeImage (in));
+
+        expectEquals (image.getWidth(), expectedWidth);
+        expectEquals (image.getHeight(), expectedHeight);
+    }
+
+    void runTest() override
+    {
+        const Image original (createGradient (100, 60));
+        MemoryBlock jpeg;
+
+        {
+            MemoryOutputStream out (jpeg, false);
+            JPEGImageFormat format;
+            format.setQuality (1.0f);
+            format.writeImageToStream (original, out);
+        }
+
+        beginTest ("Decoding");
+        {
+            MemoryInputStream in (jpeg, false);
+            const Image image (JPEGImageFormat().decodeImage (in));
+
+            expect (image.getFormat() == Image::RGB);
+            expect (image.getBounds() == original.getBounds());
+            expect (getMaxDifference (image, original, 1) <= 8);
+            expectEquals (in.getPosition(), (int64) jpeg.getSize());
+
+            // (data that isn't in a MemoryInputStream has to be copied before it's decoded)
+            MemoryOutputStream paddedData;
+            paddedData << "padding" << jpeg << "more padding";
+
+            MemoryInputStream paddedIn (paddedData.getData(), paddedData.getDataSize(), false);
+            BufferedInputStream bufferedIn (paddedIn, 1024);
+            expect (bufferedIn.setPosition (7));
+
+            const Image copy (JPEGImageFormat().decodeImage (bufferedIn));
+            expect (copy.getBounds() == image.getBounds());
+
+            const Image::BitmapData data (image, Image::BitmapData::readOnly);
+            const Image::BitmapData copyData (copy, Image::BitmapData::readOnly);
+            int numDifferentLines = 0;
+
+            for (int y = 0; y < data.height; ++y)
+                if (memcmp (data.getLinePointer (y), copyData.getLinePointer (y), (size_t) (data.width * data.pixelStride)) != 0)
+                    ++numDifferentLines;
+
+            expectEquals (numDifferentLines, 0);
+            expectEquals (bufferedIn.getPosition(), (int64) jpeg.getSize() + 7);
+        }
+
+        beginTest ("Scaled decoding");
+        {
+            expectDecodedSize (jpeg, 0, 0,      100, 60);
+            expectDecodedSize (jpeg, 200, 200,  100, 60);
+            expectDecodedSize (jpeg, 100, 60,   100, 60);
+            expectDecodedSize (jpeg, 51, 10,    100, 60);
+            expectDecodedSize (jpeg, 50, 30,    50, 30);
+            expectDecodedSize (jpeg, 26, 15,    50, 30);
+            expectDecodedSize (jpeg, 25, 15,    25, 15);
+            expectDecodedSize (jpeg, 14, 1,     25, 15);
+            expectDecodedSize (jpeg, 13, 8,     13, 8);
+            expectDecodedSize (jpeg, 1, 1,      13, 8);
+
+            // (both sizes have to be given for it to have any effect)
+            expectDecodedSize (jpeg, 10, 0,     100, 60);
+
+            for (int scale = 2; scale <= 8; scale *= 2)
+            {
+                JPEGImageFormat format;
+                format.setTargetDecodeSize (100 / scale, 60 / scale);
+
+                MemoryInputStream in (jpeg, false);
+                expect (getMaxDifference (format.decodeImage (in), original, scale) <= 8);
+            }
+        }
+    }
+};
+
+static JPEGImageFormatTests jpegImageFormatTests;
+
+#endif
@@ -367,45 +367,74 @@ namespace PNGHelpers
         return false;
     }
 
-    static bool readImageData (png_structp pngReadStruct, png_infop pngInfoStruct, jmp_buf& errorJumpBuf, png_bytepp rows) noexcept
-    {
-        if (setjmp (errorJumpBuf) == 0)
-        {
-            if (png_get_valid (pngReadStruct, pngInfoStruct, PNG_INFO_tRNS))
-                png_set_expand (pngReadStruct);
+   #if JUCE_MSVC
+    #pragma warning (pop)
+   #endif
 
-            png_set_add_alpha (pngReadStruct, 0xff, PNG_FILLER_AFTER);
+    //==============================================================================
+    /* Writes each row that libpng decodes into the destination image.
 
-            png_read_image (pngReadStruct, rows);
-            png_read_end (pngReadStruct, pngInfoStruct);
-            return true;
+       Where the destination's pixel layout allows it, libpng is set up to decode straight
+       into the image's own lines in the same byte order as its pixels, so all that's left
+       to do for each row is to premultiply it while it's still in the cache. Otherwise,
+       the rows are decoded as RGBA into a temporary buffer and converted.
+    */
+    struct RowWriter
+    {
+        RowWriter (const Image::BitmapData& dest, bool fileHasAlpha) noexcept
+            : destData (dest),
+              needsPremultiplying (fileHasAlpha && dest.pixelFormat == Image::ARGB),
+              isDirect (canDecodeDirectly (dest))
+        {
         }
 
-        return false;
-    }
+        static bool canDecodeDirectly (const Image::BitmapData& dest) noexcept
+        {
+            if (dest.pixelFormat == Image::ARGB)
+                return dest.pixelStride == 4 && PixelARGB::indexA == 3
+                        && (PixelARGB::indexB == 0 || PixelARGB::indexR == 0);
 
-   #if JUCE_MSVC
-    #pragma warning (pop)
-   #endif
+            return dest.pixelFormat == Image::RGB && dest.pixelStride == 3;
+        }
 
-    static Image createImageFromData (bool hasAlphaChan, int width, int height, png_bytepp rows)
-    {
-        // now convert the data to a juce image format..
-        Image image (hasAlphaChan ? Image::ARGB : Image::RGB, width, height, hasAlphaChan);
+        void setOutputFormat (png_structp pngReadStruct) const noexcept
+        {
+            if (isDirect)
+            {
+                if (destData.pixelFormat == Image::ARGB)
+                {
+                    png_set_add_alpha (pngReadStruct, 0xff, PNG_FILLER_AFTER);
 
-        image.getProperties()->set ("originalImageHadAlpha", image.hasAlphaChannel());
-        hasAlphaChan = image.hasAlphaChannel(); // (the native image creator may not give back what we expect)
+                    if (PixelARGB::indexB == 0)
+                        png_set_bgr (pngReadStruct);
+                }
+                else
+                {
+                    png_set_strip_alpha (pngReadStruct);
 
-        const Image::BitmapData destData (image, Image::BitmapData::writeOnly);
+                    if (PixelRGB::indexB == 0)
+                        png_set_bgr (pngReadStruct);
+                }
+            }
+            else
+            {
+                png_set_add_alpha (pngReadStruct, 0xff, PNG_FILLER_AFTER);
+            }
+        }
 
-        for (int y = 0; y < (int) height; ++y)
+        void rowDecoded (const int y, const uint8* src) const noexcept
         {
-            const uint8* src = rows[y];
             uint8* dest = destData.getLinePointer (y);
 
-            if (hasAlphaChan)
+            if (isDirect)
             {
-                for (int i = (int) width; --i >= 0;)
+                if (needsPremultiplying)
+                    for (int i = destData.width; --i >= 0;)
+                        ((PixelARGB*) dest)[i].premultiply();
+            }
+            else if (destData.pixelFormat == Image::ARGB)
+            {
+                for (int i = destData.width; --i >= 0;)
                 {
                     ((PixelARGB*) dest)->setARGB (src[3], src[0], src[1], src[2]);
                     ((PixelARGB*) dest)->premultiply();
@@ -415,7 +444,7 @@ namespace PNGHelpers
             }
             else
             {
-                for (int i = (int) width; --i >= 0;)
+                for (int i = destData.width; --i >= 0;)
                 {
                     ((PixelRGB*) dest)->setARGB (0, src[0], src[1], src[2]);
                     dest += destData.pixelStride;
@@ -424,10 +453,51 @@ namespace PNGHelpers
             }
         }
 
-        return image;
+        const Image::BitmapData& destData;
+        const bool needsPremultiplying, isDirect;
+
+        JUCE_DECLARE_NON_COPYABLE (RowWriter)
+    };
+
+   #if JUCE_MSVC
+    #pragma warning (push)
+    #pragma warning (disable: 4611) // (warning about setjmp)
+   #endif
+
+    static bool readImageData (png_structp pngReadStruct, png_infop pngInfoStruct, jmp_buf& errorJumpBuf,
+                               png_bytepp rows, const int height, const bool isInterlaced, const RowWriter& writer) noexcept
+    {
+        if (setjmp (errorJumpBuf) == 0)
+        {
+            if (isInterlaced)
+            {
+                // (an interlaced image has to be decoded in its entirety before any rows are complete)
+                png_read_image (pngReadStruct, rows);
+
+                for (int y = 0; y < height; ++y)
+                    writer.rowDecoded (y, rows[y]);
+            }
+            else
+            {
+                for (int y = 0; y < height; ++y)
+                {
+                    png_read_row (pngReadStruct, rows[y], nullptr);
+                    writer.rowDecoded (y, rows[y]);
+                }
+            }
+
+            png_read_end (pngReadStruct, pngInfoStruct);
+            return true;
+        }
+
+        return false;
     }
 
-    static Image readImage (InputStream& in, png_structp pngReadStruct, png_infop pngInfoStruct)
+   #if JUCE_MSVC
+    #pragma warning (pop)
+   #endif
+
+    static Image readImage (InputStream& in, png_structp pngReadStruct, png_infop pngInfoStruct, const ImageType& imageType)
     {
         jmp_buf errorJumpBuf;
         png_set_error_fn (pngReadStruct, &errorJumpBuf, errorCallback, warningCallback);
@@ -438,34 +508,59 @@ namespace PNGHelpers
         if (readHeader (in, pngReadStruct, pngInfoStruct, errorJumpBuf,
                         width, height, bitDepth, colorType, interlaceType))
         {
-            // Load the image into a temp buffer..
-            const size_t lineStride = width * 4;
-            HeapBlock<uint8> tempBuffer (height * lineStride);
-            HeapBlock<png_bytep> rows (height);
-
-            for (size_t y = 0; y < height; ++y)
-                rows[y] = (png_bytep) (tempBuffer + lineStride * y);
-
             png_bytep trans_alpha = nullptr;
             png_color_16p trans_color = nullptr;
             int num_trans = 0;
             png_get_tRNS (pngReadStruct, pngInfoStruct, &trans_alpha, &num_trans, &trans_color);
 
-            if (readImageData (pngReadStruct, pngInfoStruct, errorJumpBuf, rows))
-                return createImageFromData ((colorType & PNG_COLOR_MASK_ALPHA) != 0 || num_trans != 0,
-                                            (int) width, (int) height, rows);
+            const bool hasAlphaChan = (colorType & PNG_COLOR_MASK_ALPHA) != 0 || num_trans != 0;
+
+            if (png_get_valid (pngReadStruct, pngInfoStruct, PNG_INFO_tRNS))
+                png_set_expand (pngReadStruct);
+
+            Image image (hasAlphaChan ? Image::ARGB : Image::RGB, (int) width, (int) height, false, imageType);
+            image.getProperties()->set ("originalImageHadAlpha", image.hasAlphaChannel());
+
+            {
+                // (the native image creator may not give back the format that we asked for)
+                const Image::BitmapData destData (image, Image::BitmapData::writeOnly);
+                const RowWriter writer (destData, hasAlphaChan);
+                writer.setOutputFormat (pngReadStruct);
+
+                const bool isInterlaced = interlaceType != PNG_INTERLACE_NONE;
+                HeapBlock<png_bytep> rows (height);
+                HeapBlock<uint8> tempBuffer;
+
+                if (writer.isDirect)
+                {
+                    for (size_t y = 0; y < height; ++y)
+                        rows[y] = (png_bytep) destData.getLinePointer ((int) y);
+                }
+                else
+                {
+                    // when converting, a non-interlaced image only needs a buffer for one row
+                    const size_t lineStride = width * 4;
+                    tempBuffer.malloc ((isInterlaced ? height : 1) * lineStride);
+
+                    for (size_t y = 0; y < height; ++y)
+                        rows[y] = (png_bytep) (tempBuffer + (isInterlaced ? lineStride * y : 0));
+                }
+
+                if (readImageData (pngReadStruct, pngInfoStruct, errorJumpBuf, rows, (int) height, isInterlaced, writer))
+                    return image;
+            }
         }
 
         return Image();
     }
 
-    static Image readImage (InputStream& in)
+    static Image readImage (InputStream& in, const ImageType& imageType)
     {
         if (png_structp pngReadStruct = png_create_read_struct (PNG_LIBPNG_VER_STRING, 0, 0, 0))
         {
             if (png_infop pngInfoStruct = png_create_info_struct (pngReadStruct))
             {
-                Image image (readImage (in, pngReadStruct, pngInfoStruct));
+                Image image (readImage (in, pngReadStruct, pngInfoStruct, imageType));
                 png_destroy_read_struct (&pngReadStruct, &pngInfoStruct, 0);
                 return image;
             }
@@ -505,7 +600,7 @@ Image PNGImageFormat::decodeImage (InputStream& in)
    #if JUCE_USING_COREIMAGE_LOADER
     return juce_loadWithCoreImage (in);
    #else
-    return PNGHelpers::readImage (in);
+    return PNGHelpers::readImage (in, NativeImageType());
    #endif
 }
 
@@ -593,3 +688,251 @@ bool PNGImageFormat::writeImageToStream (const Image& image, OutputStream& out)
 
     return true;
 }
+
+//==============================================================================
+#if JUCE_UNIT_TESTS && ! JUCE_USING_COREIMAGE_LOADER
+
+class PNGImageFormatTests  : public UnitTest
+{
+public:
+    PNGImageFormatTests() : UnitTest ("PNGImageFormat") {}
+
+    //==============================================================================
+    // An image type whose pixels are spaced further apart than usual, which the decoder
+    // can't write into directly
+    class WidePixelData  : public ImagePixelData
+    {
+    public:
+        WidePixelData (Image::PixelFormat format, int w, int h)
+            : ImagePixelData (format, w, h), lineStride (w * pixelStride + 4)
+        {
+            imageData.calloc ((size_t) (lineStride * jmax (1, h)));
+        }
+
+        LowLevelGraphicsContext* createLowLevelContext() override
+        {
+            sendDataChangeMessage();
+            return new LowLevelGraphicsSoftwareRenderer (Image (this));
+        }
+
+        void initialiseBitmapData (Image::BitmapData& bitmap, int x, int y, Image::BitmapData::ReadWriteMode mode) override
+        {
+            bitmap.data = imageData + x * pixelStride + y * lineStride;
+            bitmap.pixelFormat = pixelFormat;
+            bitmap.lineStride = lineStride;
+            bitmap.pixelStride = pixelStride;
+
+            if (mode != Image::BitmapData::readOnly)
+                sendDataChangeMessage();
+        }
+
+        ImagePixelData::Ptr clone() override
+        {
+            WidePixelData* s = new WidePixelData (pixelFormat, width, height);
+            memcpy (s->imageData, imageData, (size_t) (lineStride * jmax (1, height)));
+            return s;
+        }
+
+        ImageType* createType() const override;
+
+    private:
+        enum { pixelStride = 8 };
+        const int lineStride;
+        HeapBlock<uint8> imageData;
+
+        JUCE_DECLARE_NON_COPYABLE (WidePixelData)
+    };
+
+    struct WideImageType  : public ImageType
+    {
+        ImagePixelData::Ptr create (Image::PixelFormat format, int width, int height, bool) const override
+        {
+            return new WidePixelData (format, width, height);
+        }
+
+        int getTypeID() const override    { return 0x77696465; }
+    };
+
+    //==============================================================================
+    // A PNG file of one of the colour types, along with the colours that it contains
+    struct TestFile
+    {
+        TestFile (Random& r, const int colourType_, const bool isInterlaced)
+            : colourType (colourType_),
+              width (1 + r.nextInt (40)), height (1 + r.nextInt (40)),
+              hasAlpha ((colourType & PNG_COLOR_MASK_ALPHA) != 0 || colourType == PNG_COLOR_TYPE_PALETTE)
+        {
+            using namespace pnglibNamespace;
+
+            const int numPaletteColours = 16;
+            png_color palette [numPaletteColours];
+            png_byte paletteAlpha [numPaletteColours];
+
+            for (int i = 0; i < numPaletteColours; ++i)
+            {
+                palette[i].red   = (png_byte) r.nextInt (256);
+                palette[i].green = (png_byte) r.nextInt (256);
+                palette[i].blue  = (png_byte) r.nextInt (256);
+                paletteAlpha[i]  = (png_byte) (i == 0 ? 0 : (i == 1 ? 255 : r.nextInt (256)));
+            }
+
+            const int bytesPerPixel = colourType == PNG_COLOR_TYPE_RGB_ALPHA ? 4
+                                        : (colourType == PNG_COLOR_TYPE_RGB ? 3 : 1);
+
+            HeapBlock<uint8> fileData ((size_t) (width * height * bytesPerPixel));
+            HeapBlock<png_bytep> rows ((size_t) height);
+            colours.malloc ((size_t) (width * height * 4));
+
+            for (int i = 0; i < width * height; ++i)
+            {
+                uint8* const rgba = colours + i * 4;
+                uint8* const pixel = fileData + i * bytesPerPixel;
+
+                if (colourType == PNG_COLOR_TYPE_PALETTE)
+                {
+                    const int index = r.nextInt (numPaletteColours);
+                    pixel[0] = (uint8) index;
+                    rgba[0] = palette[index].red;
+                    rgba[1] = palette[index].green;
+                    rgba[2] = palette[index].blue;
+                    rgba[3] = paletteAlpha[index];
+                }
+                else if (colourType == PNG_COLOR_TYPE_GRAY)
+                {
+                    pixel[0] = rgba[0] = rgba[1] = rgba[2] = (uint8) r.nextInt (256);
+                    rgba[3] = 255;
+                }
+                else
+                {
+                    for (int j = 0; j < bytesPerPixel; ++j)
+                        pixel[j] = rgba[j] = (uint8) r.nextInt (256);
+
+                    if (! hasAlpha)
+                        rgba[3] = 255;
+                }
+            }
+
+            for (int y = 0; y < height; ++y)
+                rows[y] = fileData + y * width * bytesPerPixel;
+
+            MemoryOutputStream out (data, false);
+
+            png_structp png = png_create_write_struct (PNG_LIBPNG_VER_STRING, 0, 0, 0);
+            png_infop info = png_create_info_struct (png);
+            png_set_write_fn (png, &out, PNGHelpers::writeDataCallback, 0);
+
+            png_set_IHDR (png, info, (png_uint_32) width, (png_uint_32) height, 8, colourType,
+                          isInterlaced ? PNG_INTERLACE_ADAM7 : PNG_INTERLACE_NONE,
+                          PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
+
+            if (colourType == PNG_COLOR_TYPE_PALETTE)
+            {
+                png_set_PLTE (png, info, palette, numPaletteColours);
+                png_set_tRNS (png, info, paletteAlpha, numPaletteColours, nullptr);
+            }
+
+            png_write_info (png, info);
+            png_write_image (png, rows);
+            png_write_end (png, info);
+            png_destroy_write_struct (&png, &info);
+        }
+
+        // Counts the pixels that don't match the ones that the old decoder would have produced
+        int getNumWrongPixels (const Image& image) const
+        {
+            const Image::BitmapData bitmap (image, Image::BitmapData::readOnly);
+            int numWrong = 0;
+
+            for (int y = 0; y < height; ++y)
+            {
+                for (int x = 0; x < width; ++x)
+                {
+                    const uint8* const rgba = colours + (y * width + x) * 4;
+                    const uint8* const pixel = bitmap.getPixelPointer (x, y);
+
+                    if (hasAlpha)
+                    {
+                        PixelARGB expected;
+                        expected.setARGB (rgba[3], rgba[0], rgba[1], rgba[2]);
+                        expected.premultiply();
+
+                        if (((const PixelARGB*) pixel)->getNativeARGB() != expected.getNativeARGB())
+                            ++numWrong;
+                    }
+                    else
+                    {
+                        const PixelRGB& p = *(const PixelRGB*) pixel;
+
+                        if (p.getRed() != rgba[0] || p.getGreen() != rgba[1] || p.getBlue() != rgba[2])
+                            ++numWrong;
+                    }
+                }
+            }
+
+            return numWrong;
+        }
+
+        const int colourType, width, height;
+        const bool hasAlpha;
+        HeapBlock<uint8> colours;
+        MemoryBlock data;
+
+        JUCE_DECLARE_NON_COPYABLE (TestFile)
+    };
+
+    //==============================================================================
+    void testDecoding (const bool isInterlaced, const bool intoWideImage)
+    {
+        const int colourTypes[] = { PNG_COLOR_TYPE_RGB, PNG_COLOR_TYPE_RGB_ALPHA,
+                                    PNG_COLOR_TYPE_PALETTE, PNG_COLOR_TYPE_GRAY };
+
+        Random r = getRandom();
+
+        for (int i = 0; i < numElementsInArray (colourTypes); ++i)
+        {
+            for (int n = 0; n < 5; ++n)
+            {
+                const TestFile file (r, colourTypes[i], isInterlaced);
+                MemoryInputStream in (file.data, false);
+
+                const Image image (intoWideImage ? PNGHelpers::readImage (in, WideImageType())
+                                                 : PNGImageFormat().decodeImage (in));
+
+                expect (image.isValid());
+                expect (image.getFormat() == (file.hasAlpha ? Image::ARGB : Image::RGB));
+                expectEquals (image.getWidth(), file.width);
+                expectEquals (image.getHeight(), file.height);
+                expect ((dynamic_cast<WidePixelData*> (image.getPixelData()) != nullptr) == intoWideImage);
+                expectEquals (file.getNumWrongPixels (image), 0);
+            }
+        }
+    }
+
+    void runTest() override
+    {
+        beginTest ("Decoding into image pixels");
+        testDecoding (false, false);
+
+        beginTest ("Converting into other layouts");
+        testDecoding (false, true);
+
+        beginTest ("Interlaced images");
+        testDecoding (true, false);
+        testDecoding (true, true);
+
+        beginTest ("Corrupt files");
+        {
+            Random r = getRandom();
+            const TestFile file (r, PNG_COLOR_TYPE_RGB_ALPHA, false);
+
+            MemoryInputStream truncated (file.data.getData(), file.data.getSize() / 2, false);
+            expect (PNGImageFormat().decodeImage (truncated).isNull());
+        }
+    }
+};
+
+ImageType* PNGImageFormatTests::WidePixelData::createType() const    { return new WideImageType(); }
+
+static PNGImageFormatTests pngImageFormatTests;
+
+#endif
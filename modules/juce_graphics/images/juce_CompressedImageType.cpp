@@ -0,0 +1,323 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2015 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+class CompressedPixelData  : public ImagePixelData
+{
+public:
+    // Creates an uncompressed image, as returned by CompressedImageType::create()
+    CompressedPixelData (const Image::PixelFormat format, const int w, const int h, const bool clearImage)
+        : ImagePixelData (format, w, h),
+          pixelStride (getPixelStride (format)),
+          lineStride ((pixelStride * jmax (1, w) + 3) & ~3),
+          rowsPerStrip (getRowsPerStrip (lineStride))
+    {
+        pixels.allocate ((size_t) (lineStride * jmax (1, h)), clearImage);
+    }
+
+    CompressedPixelData (const Image::BitmapData& source)
+        : ImagePixelData (source.pixelFormat, source.width, source.height),
+          pixelStride (getPixelStride (source.pixelFormat)),
+          lineStride ((pixelStride * jmax (1, source.width) + 3) & ~3),
+          rowsPerStrip (getRowsPerStrip (lineStride))
+    {
+        HeapBlock<uint8> strip ((size_t) (rowsPerStrip * lineStride), true);
+        MemoryOutputStream out (compressedData, false);
+
+        for (int stripStart = 0; stripStart < height; stripStart += rowsPerStrip)
+        {
+            const int numRows = jmin (rowsPerStrip, height - stripStart);
+
+            for (int y = 0; y < numRows; ++y)
+                memcpy (strip + y * lineStride, source.getLinePointer (stripStart + y), (size_t) (pixelStride * width));
+
+            // Storing each row as the difference from the one above it makes the
+            // smooth gradients that most UI graphics are made of compress much better
+            for (int y = numRows; --y > 0;)
+            {
+                uint8* const line = strip + y * lineStride;
+                const uint8* const lineAbove = line - lineStride;
+
+                for (int i = 0; i < lineStride; ++i)
+                    line[i] = (uint8) (line[i] - lineAbove[i]);
+            }
+
+            stripOffsets.add ((uint32) out.getPosition());
+
+            GZIPCompressorOutputStream compressor (&out, 9, false, GZIPCompressorOutputStream::windowBitsRaw);
+            compressor.write (strip, (size_t) (numRows * lineStride));
+        }
+
+        stripOffsets.add ((uint32) out.getPosition());
+        out.flush();
+        compressedData.setSize ((size_t) out.getPosition());
+    }
+
+    LowLevelGraphicsContext* createLowLevelContext() override
+    {
+        decompressPermanently();
+        sendDataChangeMessage();
+        return new LowLevelGraphicsSoftwareRenderer (Image (this));
+    }
+
+    void initialiseBitmapData (Image::BitmapData& bitmap, int x, int y, Image::BitmapData::ReadWriteMode mode) override
+    {
+        bitmap.pixelFormat = pixelFormat;
+        bitmap.lineStride = lineStride;
+        bitmap.pixelStride = pixelStride;
+
+        if (mode != Image::BitmapData::readOnly)
+        {
+            decompressPermanently();
+            sendDataChangeMessage();
+        }
+
+        if (pixels != nullptr)
+        {
+            bitmap.data = pixels + x * pixelStride + y * lineStride;
+            return;
+        }
+
+        // Only decompress the strips that overlap the rows being read..
+        const int firstStrip = y / rowsPerStrip;
+        const int lastStrip  = (y + jmax (1, bitmap.height) - 1) / rowsPerStrip;
+
+        TemporaryRows* const rows = new TemporaryRows();
+        rows->data.malloc ((size_t) ((lastStrip - firstStrip + 1) * rowsPerStrip * lineStride));
+
+        for (int i = firstStrip; i <= lastStrip; ++i)
+            decompressStrip (i, rows->data + (i - firstStrip) * rowsPerStrip * lineStride);
+
+        bitmap.dataReleaser = rows;
+        bitmap.data = rows->data + x * pixelStride + (y - firstStrip * rowsPerStrip) * lineStride;
+    }
+
+    ImagePixelData::Ptr clone() override
+    {
+        CompressedPixelData* const s = new CompressedPixelData (pixelFormat, width, height, false);
+
+        if (pixels != nullptr)
+        {
+            memcpy (s->pixels, pixels, (size_t) (lineStride * height));
+        }
+        else
+        {
+            s->pixels.free();
+            s->compressedData = compressedData;
+            s->stripOffsets = stripOffsets;
+        }
+
+        return s;
+    }
+
+    ImageType* createType() const override      { return new CompressedImageType(); }
+
+    int64 getMemoryUsage() const noexcept override
+    {
+        if (pixels != nullptr)
+            return lineStride * (int64) height;
+
+        return (int64) (compressedData.getSize() + (size_t) stripOffsets.size() * sizeof (uint32));
+    }
+
+private:
+    HeapBlock<uint8> pixels;
+    MemoryBlock compressedData;
+    Array<uint32> stripOffsets;
+    const int pixelStride, lineStride, rowsPerStrip;
+
+    struct TemporaryRows  : public Image::BitmapData::BitmapDataReleaser
+    {
+        HeapBlock<uint8> data;
+    };
+
+    static int getPixelStride (Image::PixelFormat format) noexcept
+    {
+        return format == Image::RGB ? 3 : ((format == Image::ARGB) ? 4 : 1);
+    }
+
+    static int getRowsPerStrip (int lineStride) noexcept
+    {
+        // Aim for strips of about 16K, which is big enough for zlib to do a good job, but
+        // small enough that drawing a single frame from a filmstrip doesn't unpack much more.
+        return jlimit (1, 64, 16384 / lineStride);
+    }
+
+    void decompressStrip (const int strip, uint8* const dest) const
+    {
+        const int stripStart = strip * rowsPerStrip;
+        const int numRows = jmin (rowsPerStrip, height - stripStart);
+        const uint32 start = stripOffsets.getUnchecked (strip);
+
+        MemoryInputStream in (addBytesToPointer (compressedData.getData(), start),
+                              stripOffsets.getUnchecked (strip + 1) - start, false);
+
+        GZIPDecompressorInputStream decompressor (&in, false, GZIPDecompressorInputStream::deflateFormat,
+                                                  numRows * (int64) lineStride);
+
+        const int bytesRead = decompressor.read (dest, numRows * lineStride);
+        jassert (bytesRead == numRows * lineStride);
+        ignoreUnused (bytesRead);
+
+        for (int y = 1; y < numRows; ++y)
+        {
+            uint8* const line = dest + y * lineStride;
+            const uint8* const lineAbove = line - lineStride;
+
+            for (int i = 0; i < lineStride; ++i)
+                line[i] = (uint8) (line[i] + lineAbove[i]);
+        }
+    }
+
+    void decompressPermanently()
+    {
+        if (pixels == nullptr)
+        {
+            HeapBlock<uint8> newPixels ((size_t) (lineStride * height));
+
+            for (int i = 0; i < stripOffsets.size() - 1; ++i)
+                decompressStrip (i, newPixels + i * rowsPerStrip * lineStride);
+
+            pixels.swapWith (newPixels);
+            compressedData.reset();
+            stripOffsets.clear();
+        }
+    }
+
+    JUCE_LEAK_DETECTOR (CompressedPixelData)
+};
+
+//==============================================================================
+CompressedImageType::CompressedImageType() {}
+CompressedImageType::~CompressedImageType() {}
+
+ImagePixelData::Ptr CompressedImageType::create (Image::PixelFormat format, int width, int height, bool clearImage) const
+{
+    return new CompressedPixelData (format, width, height, clearImage);
+}
+
+int CompressedImageType::getTypeID() const
+{
+    return 4;
+}
+
+Image CompressedImageType::convert (const Image& source) const
+{
+    if (source.isNull() || getTypeID() == (ScopedPointer<ImageType> (source.getPixelData()->createType())->getTypeID()))
+        return source;
+
+    const Image::BitmapData src (source, Image::BitmapData::readOnly);
+    return Image (new CompressedPixelData (src));
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class CompressedImageTypeTests  : public UnitTest
+{
+public:
+    CompressedImageTypeTests()  : UnitTest ("CompressedImageType") {}
+
+    static Image createTestImage (Image::PixelFormat format, int w, int h, Random& r)
+    {
+        Image image (format, w, h, false, SoftwareImageType());
+        const Image::BitmapData data (image, Image::BitmapData::writeOnly);
+
+        // (mostly smooth gradients, with some noise so that it doesn't compress to nothing)
+        for (int y = 0; y < h; ++y)
+        {
+            uint8* const line = data.getLinePointer (y);
+
+            for (int i = 0; i < w * data.pixelStride; ++i)
+                line[i] = (uint8) (i / data.pixelStride + 2 * y + (r.nextInt (8) == 0 ? r.nextInt (256) : 0));
+        }
+
+        return image;
+    }
+
+    static bool pixelsMatch (const Image& a, const Image& b, Rectangle<int> area)
+    {
+        const Image::BitmapData da (a, area.getX(), area.getY(), area.getWidth(), area.getHeight());
+        const Image::BitmapData db (b, area.getX(), area.getY(), area.getWidth(), area.getHeight());
+
+        for (int y = 0; y < area.getHeight(); ++y)
+            if (memcmp (da.getLinePointer (y), db.getLinePointer (y), (size_t) (area.getWidth() * da.pixelStride)) != 0)
+                return false;
+
+        return true;
+    }
+
+    void testFormat (Image::PixelFormat format, Random& r)
+    {
+        const int w = 32 + r.nextInt (300), h = 32 + r.nextInt (700);
+        const Image original (createTestImage (format, w, h, r));
+        const Image compressed (CompressedImageType().convert (original));
+
+        expect (compressed.getFormat() == format);
+        expectEquals (compressed.getWidth(), w);
+        expectEquals (compressed.getHeight(), h);
+        expect (compressed.getPixelData()->getMemoryUsage() < original.getPixelData()->getMemoryUsage());
+        expect (pixelsMatch (original, compressed, original.getBounds()));
+
+        for (int i = 0; i < 20; ++i)
+        {
+            const int x = r.nextInt (w), y = r.nextInt (h);
+            const Rectangle<int> area (x, y, 1 + r.nextInt (w - x), 1 + r.nextInt (h - y));
+            expect (pixelsMatch (original, compressed, area));
+        }
+
+        Image copy (compressed.createCopy());
+        expect (pixelsMatch (original, copy, original.getBounds()));
+
+        // writing to the image should leave it permanently decompressed
+        int lineStride = 0;
+
+        {
+            const Image::BitmapData data (copy, 0, 0, 1, 1, Image::BitmapData::readWrite);
+            data.getLinePointer (0)[0] = (uint8) (data.getLinePointer (0)[0] + 1);
+            lineStride = data.lineStride;
+        }
+
+        expectEquals (copy.getPixelData()->getMemoryUsage(), lineStride * (int64) h);
+        expect (! pixelsMatch (original, copy, Rectangle<int> (0, 0, 1, 1)));
+        expect (pixelsMatch (original, compressed, original.getBounds()));
+    }
+
+    void runTest() override
+    {
+        beginTest ("Compressed images");
+
+        Random r = getRandom();
+
+        for (int i = 0; i < 5; ++i)
+        {
+            testFormat (Image::ARGB, r);
+            testFormat (Image::RGB, r);
+            testFormat (Image::SingleChannel, r);
+        }
+    }
+};
+
+static CompressedImageTypeTests compressedImageTypeTests;
+
+#endif
@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2015 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+#ifndef JUCE_COMPRESSEDIMAGETYPE_H_INCLUDED
+#define JUCE_COMPRESSEDIMAGETYPE_H_INCLUDED
+
+
+//==============================================================================
+/**
+    An image storage type which keeps its pixels zlib-compressed in memory, and only
+    decompresses the rows that are needed when the image is drawn.
+
+    The pixels are split into horizontal strips of a few rows each, which are compressed
+    independently. When an area of the image is read - e.g. when a section of a filmstrip
+    is drawn with Graphics::drawImage() - only the strips that overlap that area get
+    decompressed, into a temporary buffer which is released afterwards.
+
+    This makes it a good choice for large images of which only a small part is drawn at
+    a time, such as knob or meter filmstrips, which typically compress very well. It's
+    not a good choice for images that get drawn in their entirety on every repaint, as
+    the whole image would then be decompressed each time.
+
+    Reading from the image is thread-safe. If you draw into a compressed image, or access
+    it with a writable BitmapData, it'll be decompressed permanently and will behave like
+    a normal software image from then on.
+
+    @code
+    Image knobStrip (CompressedImageType().convert (ImageCache::getFromMemory (data, size)));
+    @endcode
+
+    @see ImageType, SoftwareImageType, ImageCache::setStoreImagesCompressed
+*/
+class JUCE_API  CompressedImageType   : public ImageType
+{
+public:
+    CompressedImageType();
+    ~CompressedImageType();
+
+    ImagePixelData::Ptr create (Image::PixelFormat, int width, int height, bool clearImage) const override;
+    int getTypeID() const override;
+    Image convert (const Image& source) const override;
+};
+
+
+#endif   // JUCE_COMPRESSEDIMAGETYPE_H_INCLUDED
@@ -44,6 +44,11 @@ int ImagePixelData::getSharedCount() const noexcept
     return getReferenceCount();
 }
 
+int64 ImagePixelData::getMemoryUsage() const noexcept
+{
+    return width * (int64) height * (pixelFormat == Image::RGB ? 3 : ((pixelFormat == Image::ARGB) ? 4 : 1));
+}
+
 //==============================================================================
 ImageType::ImageType() {}
 ImageType::~ImageType() {}
@@ -111,6 +116,8 @@ public:
 
     ImageType* createType() const override    { return new SoftwareImageType(); }
 
+    int64 getMemoryUsage() const noexcept override  { return lineStride * (int64) jmax (1, height); }
+
 private:
     HeapBlock<uint8> imageData;
     const int pixelStride, lineStride;
@@ -193,6 +200,9 @@ public:
     /* as we always hold a reference to image, don't double count */
     int getSharedCount() const noexcept override    { return getReferenceCount() + sourceImage->getSharedCount() - 1; }
 
+    /* the pixels belong to the source image */
+    int64 getMemoryUsage() const noexcept override  { return 0; }
+
 private:
     friend class Image;
     const ImagePixelData::Ptr sourceImage;
@@ -452,6 +452,9 @@ public:
         shared image data. This is different to the reference count as an instance of ImagePixelData
         can internally depend on another ImagePixelData via it's member variables. */
     virtual int getSharedCount() const noexcept;
+    /** Returns the number of bytes of memory that this object is using to hold its pixels.
+        This is used by the ImageCache to keep track of how much memory its images use. */
+    virtual int64 getMemoryUsage() const noexcept;
 
 
     /** The pixel format of the image data. */
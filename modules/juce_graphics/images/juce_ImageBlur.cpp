@@ -0,0 +1,571 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2015 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+namespace ImageBlurHelpers
+{
+    // Blurs a horizontal line of one colour channel, whose pixels are 'stride' bytes apart
+    static void blurLine (const uint8* src, uint8* dest, const int num, const int stride,
+                          const int radius, const float scale) noexcept
+    {
+        int sum = 0;
+
+        for (int i = jmin (radius, num); --i >= 0;)
+            sum += src[i * stride];
+
+        for (int i = 0; i < num; ++i)
+        {
+            if (i + radius < num)
+                sum += src[(i + radius) * stride];
+
+            dest[i * stride] = (uint8) (sum * scale + 0.5f);
+
+            if (i >= radius)
+                sum -= src[(i - radius) * stride];
+        }
+    }
+
+   #if JUCE_USE_SSE_INTRINSICS
+    static forcedinline __m128i loadPixel (const uint8* p) noexcept
+    {
+        const __m128i zero = _mm_setzero_si128();
+        return _mm_unpacklo_epi16 (_mm_unpacklo_epi8 (_mm_cvtsi32_si128 (readUnaligned<int> (p)), zero), zero);
+    }
+
+    // Blurs a line of 4-byte pixels, with all four channels being done at once
+    static void blurLineOf4BytePixels (const uint8* src, uint8* dest, const int num,
+                                         const int radius, const float scale) noexcept
+    {
+        const __m128 multiplier = _mm_set1_ps (scale);
+        __m128i sum = _mm_setzero_si128();
+
+        for (int i = jmin (radius, num); --i >= 0;)
+            sum = _mm_add_epi32 (sum, loadPixel (src + i * 4));
+
+        for (int i = 0; i < num; ++i)
+        {
+            if (i + radius < num)
+                sum = _mm_add_epi32 (sum, loadPixel (src + (i + radius) * 4));
+
+            __m128i result = _mm_cvtps_epi32 (_mm_mul_ps (_mm_cvtepi32_ps (sum), multiplier));
+            result = _mm_packs_epi32 (result, result);
+            writeUnaligned<int> (dest + i * 4, _mm_cvtsi128_si32 (_mm_packus_epi16 (result, result)));
+
+            if (i >= radius)
+                sum = _mm_sub_epi32 (sum, loadPixel (src + (i - radius) * 4));
+        }
+    }
+   #endif
+
+    static void blurRows (const uint8* src, const int srcStride, uint8* dest, const int destStride,
+                          const int width, const int height, const int pixelStride, const int radius) noexcept
+    {
+        const float scale = 1.0f / (float) (radius * 2 + 1);
+
+        for (int y = 0; y < height; ++y)
+        {
+            const uint8* const s = src + y * srcStride;
+            uint8* const d = dest + y * destStride;
+
+           #if JUCE_USE_SSE_INTRINSICS
+            if (pixelStride == 4)
+            {
+                blurLineOf4BytePixels (s, d, width, radius, scale);
+                continue;
+            }
+           #endif
+
+            for (int channel = 0; channel < pixelStride; ++channel)
+                blurLine (s + channel, d + channel, width, pixelStride, radius, scale);
+        }
+    }
+
+    //==============================================================================
+    // The vertical pass keeps a running total for every byte in a row, so that it can
+    // work along whole rows at a time rather than jumping between them.
+    static void addRow (int32* totals, const uint8* src, const int num) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_USE_SSE_INTRINSICS
+        const __m128i zero = _mm_setzero_si128();
+
+        for (; i <= num - 16; i += 16)
+        {
+            const __m128i bytes = _mm_loadu_si128 ((const __m128i*) (src + i));
+            const __m128i lo = _mm_unpacklo_epi8 (bytes, zero);
+            const __m128i hi = _mm_unpackhi_epi8 (bytes, zero);
+            __m128i* const t = (__m128i*) (totals + i);
+
+            _mm_storeu_si128 (t,     _mm_add_epi32 (_mm_loadu_si128 (t),     _mm_unpacklo_epi16 (lo, zero)));
+            _mm_storeu_si128 (t + 1, _mm_add_epi32 (_mm_loadu_si128 (t + 1), _mm_unpackhi_epi16 (lo, zero)));
+            _mm_storeu_si128 (t + 2, _mm_add_epi32 (_mm_loadu_si128 (t + 2), _mm_unpacklo_epi16 (hi, zero)));
+            _mm_storeu_si128 (t + 3, _mm_add_epi32 (_mm_loadu_si128 (t + 3), _mm_unpackhi_epi16 (hi, zero)));
+        }
+       #endif
+
+        for (; i < num; ++i)
+            totals[i] += src[i];
+    }
+
+    static void subtractRow (int32* totals, const uint8* src, const int num) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_USE_SSE_INTRINSICS
+        const __m128i zero = _mm_setzero_si128();
+
+        for (; i <= num - 16; i += 16)
+        {
+            const __m128i bytes = _mm_loadu_si128 ((const __m128i*) (src + i));
+            const __m128i lo = _mm_unpacklo_epi8 (bytes, zero);
+            const __m128i hi = _mm_unpackhi_epi8 (bytes, zero);
+            __m128i* const t = (__m128i*) (totals + i);
+
+            _mm_storeu_si128 (t,     _mm_sub_epi32 (_mm_loadu_si128 (t),     _mm_unpacklo_epi16 (lo, zero)));
+            _mm_storeu_si128 (t + 1, _mm_sub_epi32 (_mm_loadu_si128 (t + 1), _mm_unpackhi_epi16 (lo, zero)));
+            _mm_storeu_si128 (t + 2, _mm_sub_epi32 (_mm_loadu_si128 (t + 2), _mm_unpacklo_epi16 (hi, zero)));
+            _mm_storeu_si128 (t + 3, _mm_sub_epi32 (_mm_loadu_si128 (t + 3), _mm_unpackhi_epi16 (hi, zero)));
+        }
+       #endif
+
+        for (; i < num; ++i)
+            totals[i] -= src[i];
+    }
+
+    static void writeRow (const int32* totals, uint8* dest, const int num, const float scale) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_USE_SSE_INTRINSICS
+        const __m128 multiplier = _mm_set1_ps (scale);
+
+        for (; i <= num - 16; i += 16)
+        {
+            const __m128i* const t = (const __m128i*) (totals + i);
+
+            const __m128i r0 = _mm_cvtps_epi32 (_mm_mul_ps (_mm_cvtepi32_ps (_mm_loadu_si128 (t)),     multiplier));
+            const __m128i r1 = _mm_cvtps_epi32 (_mm_mul_ps (_mm_cvtepi32_ps (_mm_loadu_si128 (t + 1)), multiplier));
+            const __m128i r2 = _mm_cvtps_epi32 (_mm_mul_ps (_mm_cvtepi32_ps (_mm_loadu_si128 (t + 2)), multiplier));
+            const __m128i r3 = _mm_cvtps_epi32 (_mm_mul_ps (_mm_cvtepi32_ps (_mm_loadu_si128 (t + 3)), multiplier));
+
+            _mm_storeu_si128 ((__m128i*) (dest + i), _mm_packus_epi16 (_mm_packs_epi32 (r0, r1),
+                                                                       _mm_packs_epi32 (r2, r3)));
+        }
+       #endif
+
+        for (; i < num; ++i)
+            dest[i] = (uint8) (totals[i] * scale + 0.5f);
+    }
+
+    static void blurColumns (const uint8* src, const int srcStride, uint8* dest, const int destStride,
+                             const int rowBytes, const int height, const int radius, int32* totals) noexcept
+    {
+        const float scale = 1.0f / (float) (radius * 2 + 1);
+
+        zeromem (totals, sizeof (int32) * (size_t) rowBytes);
+
+        for (int y = 0; y < jmin (radius, height); ++y)
+            addRow (totals, src + y * srcStride, rowBytes);
+
+        for (int y = 0; y < height; ++y)
+        {
+            if (y + radius < height)
+                addRow (totals, src + (y + radius) * srcStride, rowBytes);
+
+            writeRow (totals, dest + y * destStride, rowBytes, scale);
+
+            if (y >= radius)
+                subtractRow (totals, src + (y - radius) * srcStride, rowBytes);
+        }
+    }
+
+    //==============================================================================
+    static void convolveRows (const Image::BitmapData& bitmap, float* dest,
+                              const float* kernel, const int kernelSize) noexcept
+    {
+        const int centre = kernelSize >> 1;
+        const int rowBytes = bitmap.width * bitmap.pixelStride;
+
+        for (int y = 0; y < bitmap.height; ++y)
+        {
+            const uint8* const src = bitmap.getLinePointer (y);
+            float* const d = dest + y * rowBytes;
+
+            for (int x = 0; x < bitmap.width; ++x)
+            {
+                const int start = jmax (0, centre - x);
+                const int end   = jmin (kernelSize, bitmap.width + centre - x);
+
+               #if JUCE_USE_SSE_INTRINSICS
+                if (bitmap.pixelStride == 4)
+                {
+                    __m128 sum = _mm_setzero_ps();
+
+                    for (int i = start; i < end; ++i)
+                        sum = _mm_add_ps (sum, _mm_mul_ps (_mm_set1_ps (kernel[i]),
+                                                           _mm_cvtepi32_ps (loadPixel (src + (x + i - centre) * 4))));
+
+                    _mm_storeu_ps (d + x * 4, sum);
+                    continue;
+                }
+               #endif
+
+                for (int channel = 0; channel < bitmap.pixelStride; ++channel)
+                {
+                    float sum = 0;
+
+                    for (int i = start; i < end; ++i)
+                        sum += kernel[i] * src[(x + i - centre) * bitmap.pixelStride + channel];
+
+                    d[x * bitmap.pixelStride + channel] = sum;
+                }
+            }
+        }
+    }
+
+    static void addScaledRow (float* totals, const float* src, const float multiplier, const int num) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_USE_SSE_INTRINSICS
+        const __m128 m = _mm_set1_ps (multiplier);
+
+        for (; i <= num - 4; i += 4)
+            _mm_storeu_ps (totals + i, _mm_add_ps (_mm_loadu_ps (totals + i), _mm_mul_ps (m, _mm_loadu_ps (src + i))));
+       #endif
+
+        for (; i < num; ++i)
+            totals[i] += multiplier * src[i];
+    }
+
+    static void writeClippedRow (const float* totals, uint8* dest, const int num) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_USE_SSE_INTRINSICS
+        for (; i <= num - 8; i += 8)
+        {
+            const __m128i r0 = _mm_cvtps_epi32 (_mm_loadu_ps (totals + i));
+            const __m128i r1 = _mm_cvtps_epi32 (_mm_loadu_ps (totals + i + 4));
+            _mm_storel_epi64 ((__m128i*) (dest + i), _mm_packus_epi16 (_mm_packs_epi32 (r0, r1), _mm_setzero_si128()));
+        }
+       #endif
+
+        for (; i < num; ++i)
+            dest[i] = (uint8) jlimit (0, 255, roundToInt (totals[i]));
+    }
+
+    //==============================================================================
+    // Finds the sizes of three box blurs whose combined variance matches a gaussian's.
+    // A box of radius r has a variance of r (r + 1) / 3, so using only two neighbouring
+    // sizes can be out by 25% for small blurs - letting the sizes differ by up to 3 gets
+    // much closer, and where there's a choice, the most even sizes are used.
+    static void getBoxRadiiForGaussian (const double sd, int* radii) noexcept
+    {
+        const double target = 3.0 * sd * sd;
+        const int maxRadius = (int) std::sqrt (target) + 1;
+        double bestError = target + 1.0;
+        int bestSpread = 0;
+
+        radii[0] = radii[1] = radii[2] = 0;
+
+        for (int r0 = 0; r0 <= maxRadius; ++r0)
+        {
+            const int largest = jmin (r0 + 3, maxRadius);
+
+            for (int r1 = r0; r1 <= largest; ++r1)
+            {
+                for (int r2 = r1; r2 <= largest; ++r2)
+                {
+                    const double error = std::abs (r0 * (r0 + 1.0) + r1 * (r1 + 1.0) + r2 * (r2 + 1.0) - target);
+
+                    if (error < bestError - 1.0e-9 || (error < bestError + 1.0e-9 && r2 - r0 < bestSpread))
+                    {
+                        bestError = error;
+                        bestSpread = r2 - r0;
+                        radii[0] = r0;
+                        radii[1] = r1;
+                        radii[2] = r2;
+                    }
+                }
+            }
+        }
+    }
+}
+
+//==============================================================================
+void ImageBlur::applyGaussianBlur (Image& image, const float standardDeviation)
+{
+    if (image.isValid())
+    {
+        const Image::BitmapData bitmap (image, Image::BitmapData::readWrite);
+        applyGaussianBlur (bitmap, standardDeviation);
+    }
+}
+
+void ImageBlur::applyGaussianBlur (const Image::BitmapData& bitmap, const float standardDeviation)
+{
+    using namespace ImageBlurHelpers;
+
+    int radii[3];
+    getBoxRadiiForGaussian (standardDeviation, radii);
+
+    if (radii[0] + radii[1] + radii[2] <= 0 || bitmap.width <= 0 || bitmap.height <= 0)
+        return;
+
+    const int rowBytes = bitmap.width * bitmap.pixelStride;
+    HeapBlock<uint8> temp ((size_t) (rowBytes * bitmap.height));
+    HeapBlock<int32> totals ((size_t) rowBytes);
+
+    // (the passes alternate between the image and the temporary buffer, so that the
+    // result ends up back in the image)
+    blurRows (bitmap.data, bitmap.lineStride, temp, rowBytes, bitmap.width, bitmap.height, bitmap.pixelStride, radii[0]);
+    blurRows (temp, rowBytes, bitmap.data, bitmap.lineStride, bitmap.width, bitmap.height, bitmap.pixelStride, radii[1]);
+    blurRows (bitmap.data, bitmap.lineStride, temp, rowBytes, bitmap.width, bitmap.height, bitmap.pixelStride, radii[2]);
+
+    blurColumns (temp, rowBytes, bitmap.data, bitmap.lineStride, rowBytes, bitmap.height, radii[0], totals);
+    blurColumns (bitmap.data, bitmap.lineStride, temp, rowBytes, rowBytes, bitmap.height, radii[1], totals);
+    blurColumns (temp, rowBytes, bitmap.data, bitmap.lineStride, rowBytes, bitmap.height, radii[2], totals);
+}
+
+void ImageBlur::applySeparableKernel (const Image::BitmapData& bitmap, const float* kernel, const int kernelSize)
+{
+    using namespace ImageBlurHelpers;
+
+    jassert (kernel != nullptr || kernelSize <= 0);
+
+    if (kernelSize <= 0 || bitmap.width <= 0 || bitmap.height <= 0)
+        return;
+
+    const int rowBytes = bitmap.width * bitmap.pixelStride;
+    const int centre = kernelSize >> 1;
+
+    // (the intermediate results are kept as floats, so that nothing gets clipped until the end)
+    HeapBlock<float> temp ((size_t) (rowBytes * bitmap.height));
+    HeapBlock<float> totals ((size_t) rowBytes);
+
+    convolveRows (bitmap, temp, kernel, kernelSize);
+
+    for (int y = 0; y < bitmap.height; ++y)
+    {
+        zeromem (totals, sizeof (float) * (size_t) rowBytes);
+
+        for (int i = jmax (0, centre - y); i < jmin (kernelSize, bitmap.height + centre - y); ++i)
+            addScaledRow (totals, temp + (y + i - centre) * rowBytes, kernel[i], rowBytes);
+
+        writeClippedRow (totals, bitmap.getLinePointer (y), rowBytes);
+    }
+}
+
+void ImageBlur::applyBoxBlur (const Image::BitmapData& bitmap, const int radius)
+{
+    using namespace ImageBlurHelpers;
+
+    if (radius <= 0 || bitmap.width <= 0 || bitmap.height <= 0)
+        return;
+
+    const int rowBytes = bitmap.width * bitmap.pixelStride;
+    HeapBlock<uint8> temp ((size_t) (rowBytes * bitmap.height));
+    HeapBlock<int32> totals ((size_t) rowBytes);
+
+    blurRows (bitmap.data, bitmap.lineStride, temp, rowBytes, bitmap.width, bitmap.height, bitmap.pixelStride, radius);
+    blurColumns (temp, rowBytes, bitmap.data, bitmap.lineStride, rowBytes, bitmap.height, radius, totals);
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ImageBlurTests  : public UnitTest
+{
+public:
+    ImageBlurTests() : UnitTest ("ImageBlur") {}
+
+    static Image createRandomImage (Random& r, const Image::PixelFormat format, const int w, const int h)
+    {
+        Image image (format, w, h, false);
+        const Image::BitmapData data (image, Image::BitmapData::writeOnly);
+
+        for (int y = 0; y < h; ++y)
+            for (int i = 0; i < w * data.pixelStride; ++i)
+                data.getLinePointer (y)[i] = (uint8) r.nextInt (256);
+
+        return image;
+    }
+
+    static int getMaxDifference (const Image& a, const Image& b)
+    {
+        const Image::BitmapData da (a, Image::BitmapData::readOnly);
+        const Image::BitmapData db (b, Image::BitmapData::readOnly);
+        int maxDiff = 0;
+
+        for (int y = 0; y < da.height; ++y)
+            for (int i = 0; i < da.width * da.pixelStride; ++i)
+                maxDiff = jmax (maxDiff, std::abs (da.getLinePointer (y)[i] - db.getLinePointer (y)[i]));
+
+        return maxDiff;
+    }
+
+    // A plain implementation of a box blur pass, without any of the sliding-window or SSE
+    // tricks, rounding each pass to 8 bits in the same way.
+    static void referenceBoxBlur (const Image::BitmapData& data, const int radius, const bool vertical)
+    {
+        const int length = vertical ? data.height : data.width;
+        const int numLines = vertical ? data.width : data.height;
+        const float scale = 1.0f / (float) (radius * 2 + 1);
+        HeapBlock<int> line ((size_t) length);
+
+        for (int n = 0; n < numLines; ++n)
+        {
+            for (int channel = 0; channel < data.pixelStride; ++channel)
+            {
+                for (int i = 0; i < length; ++i)
+                    line[i] = *((vertical ? data.getPixelPointer (n, i) : data.getPixelPointer (i, n)) + channel);
+
+                for (int i = 0; i < length; ++i)
+                {
+                    int sum = 0;
+
+                    for (int j = jmax (0, i - radius); j <= jmin (length - 1, i + radius); ++j)
+                        sum += line[j];
+
+                    *((vertical ? data.getPixelPointer (n, i) : data.getPixelPointer (i, n)) + channel) = (uint8) (sum * scale + 0.5f);
+                }
+            }
+        }
+    }
+
+    //==============================================================================
+    void testSeparableKernel (Random& r, const Image::PixelFormat format, const int w, const int h, const int kernelSize)
+    {
+        HeapBlock<float> kernel ((size_t) kernelSize);
+        float total = 0;
+
+        for (int i = 0; i < kernelSize; ++i)
+            total += (kernel[i] = 0.1f + r.nextFloat());
+
+        for (int i = 0; i < kernelSize; ++i)
+            kernel[i] /= total;
+
+        ImageConvolutionKernel kernel2D (kernelSize);
+
+        for (int y = 0; y < kernelSize; ++y)
+            for (int x = 0; x < kernelSize; ++x)
+                kernel2D.setKernelValue (x, y, kernel[x] * kernel[y]);
+
+        const Image source (createRandomImage (r, format, w, h));
+        Image expected (source.createCopy());
+        kernel2D.applyToImage (expected, source, expected.getBounds());
+
+        Image result (source.createCopy());
+
+        {
+            const Image::BitmapData data (result, Image::BitmapData::readWrite);
+            ImageBlur::applySeparableKernel (data, kernel, kernelSize);
+        }
+
+        // (the two methods add things up in a different order, so a value that's
+        // almost exactly half-way between two levels can be rounded either way)
+        expect (getMaxDifference (result, expected) <= 1,
+                String (w) + "x" + String (h) + ", kernel size " + String (kernelSize));
+    }
+
+    void testBoxBlurs (Random& r, const Image::PixelFormat format, const int w, const int h, const float sd)
+    {
+        const Image source (createRandomImage (r, format, w, h));
+
+        {
+            const int radius = jmax (1, roundToInt (sd));
+            Image result (source.createCopy()), expected (source.createCopy());
+
+            ImageBlur::applyBoxBlur (Image::BitmapData (result, Image::BitmapData::readWrite), radius);
+
+            const Image::BitmapData data (expected, Image::BitmapData::readWrite);
+            referenceBoxBlur (data, radius, false);
+            referenceBoxBlur (data, radius, true);
+
+            expectEquals (getMaxDifference (result, expected), 0);
+        }
+
+        {
+            Image result (source.createCopy()), expected (source.createCopy());
+            ImageBlur::applyGaussianBlur (result, sd);
+
+            int radii[3];
+            ImageBlurHelpers::getBoxRadiiForGaussian (sd, radii);
+
+            const Image::BitmapData data (expected, Image::BitmapData::readWrite);
+
+            for (int i = 0; i < 3; ++i)
+                if (radii[i] > 0)
+                    referenceBoxBlur (data, radii[i], false);
+
+            for (int i = 0; i < 3; ++i)
+                if (radii[i] > 0)
+                    referenceBoxBlur (data, radii[i], true);
+
+            expectEquals (getMaxDifference (result, expected), 0);
+        }
+    }
+
+    //==============================================================================
+    void runTest() override
+    {
+        Random r (getRandom());
+
+        beginTest ("Separable kernels");
+        {
+            const int kernelSizes[] = { 1, 2, 5, 8, 13 };
+
+            for (int i = 0; i < numElementsInArray (kernelSizes); ++i)
+            {
+                testSeparableKernel (r, Image::ARGB, 37, 23, kernelSizes[i]);
+                testSeparableKernel (r, Image::SingleChannel, 37, 23, kernelSizes[i]);
+                testSeparableKernel (r, Image::RGB, 19, 29, kernelSizes[i]);
+
+                // (images smaller than the kernel are all edges)
+                testSeparableKernel (r, Image::ARGB, 3, 2, kernelSizes[i]);
+                testSeparableKernel (r, Image::SingleChannel, 1, 4, kernelSizes[i]);
+            }
+        }
+
+        beginTest ("Box and gaussian blurs");
+        {
+            // (the library's results here come from the SSE code when it's enabled, so this
+            // compares them with a plain version of the same arithmetic)
+            const float deviations[] = { 0.5f, 1.0f, 2.5f, 6.0f, 20.0f };
+
+            for (int i = 0; i < numElementsInArray (deviations); ++i)
+            {
+                testBoxBlurs (r, Image::ARGB, 61, 43, deviations[i]);
+                testBoxBlurs (r, Image::SingleChannel, 67, 35, deviations[i]);
+                testBoxBlurs (r, Image::RGB, 18, 50, deviations[i]);
+                testBoxBlurs (r, Image::ARGB, 5, 3, deviations[i]);
+            }
+        }
+    }
+};
+
+static ImageBlurTests imageBlurTests;
+
+#endif
@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2015 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+#ifndef JUCE_IMAGEBLUR_H_INCLUDED
+#define JUCE_IMAGEBLUR_H_INCLUDED
+
+
+//==============================================================================
+/**
+    Fast blurring functions which operate directly on an image's pixel data.
+
+    These work in separate horizontal and vertical passes, each of which uses a sliding
+    window, so the time they take doesn't depend on the size of the blur. Each colour
+    channel (and the alpha channel) is blurred independently, which gives the correct
+    result for the premultiplied pixels used by ARGB images.
+
+    Pixels outside the area being blurred are treated as being transparent black, so
+    the edges of the area will fade out.
+
+    @see ImageConvolutionKernel, DropShadow, GlowEffect
+*/
+class JUCE_API  ImageBlur
+{
+public:
+    //==============================================================================
+    /** Applies a blur which closely approximates a gaussian blur to an image.
+
+        This uses three successive box blurs in each direction, whose sizes are chosen to
+        give the same spread as a gaussian with the given standard deviation.
+        The image is modified in-place, so if it may be shared, call Image::duplicateIfShared()
+        first.
+    */
+    static void applyGaussianBlur (Image& image, float standardDeviation);
+
+    /** Applies a blur which closely approximates a gaussian blur to some pixel data.
+        @see applyGaussianBlur
+    */
+    static void applyGaussianBlur (const Image::BitmapData& bitmapData, float standardDeviation);
+
+    /** Blurs some pixel data by replacing each pixel with the average of the pixels in
+        a square of (radius * 2 + 1) pixels around it.
+    */
+    static void applyBoxBlur (const Image::BitmapData& bitmapData, int radius);
+
+    /** Convolves some pixel data with a separable kernel.
+
+        The kernel is applied horizontally and then vertically, which has the same effect
+        as using an ImageConvolutionKernel whose values are kernel[x] * kernel[y], but only
+        takes time proportional to the kernel's size rather than its area. As with
+        ImageConvolutionKernel, the kernel's centre is at index (kernelSize / 2).
+
+        The results are clipped to the range 0 to 255 after both passes have been applied.
+    */
+    static void applySeparableKernel (const Image::BitmapData& bitmapData, const float* kernel, int kernelSize);
+
+private:
+    ImageBlur() JUCE_DELETED_FUNCTION;
+    JUCE_DECLARE_NON_COPYABLE (ImageBlur)
+};
+
+
+#endif   // JUCE_IMAGEBLUR_H_INCLUDED
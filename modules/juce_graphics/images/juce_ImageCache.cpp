@@ -22,11 +22,31 @@
   ==============================================================================
 */
 
+static int64 hashData (const void* const data, const size_t numBytes) noexcept
+{
+    // 64-bit FNV-1a: the pointer can't be used as a key for the shared pixel cache, as
+    // it'll be different in other processes
+    uint64 hash = 0xcbf29ce484222325ULL;
+
+    for (size_t i = 0; i < numBytes; ++i)
+        hash = (hash ^ static_cast<const uint8*> (data)[i]) * 0x100000001b3ULL;
+
+    return (int64) hash;
+}
+
+// (the file's details are included in the hash used for the shared pixel cache, so
+// that a stale copy won't be used if the file is changed)
+static int64 getContentHash (const File& file)
+{
+    return file.hashCode64() ^ (file.getLastModificationTime().toMilliseconds() * 31 + file.getSize());
+}
+
+//==============================================================================
 class ImageCache::Pimpl     : private Timer,
                               private DeletedAtShutdown
 {
 public:
-    Pimpl()  : cacheTimeout (5000)
+    Pimpl()  : cacheTimeout (5000), memoryLimit (0), storeCompressed (false)
     {
     }
 
@@ -41,10 +61,13 @@ public:
 
         for (int i = images.size(); --i >= 0;)
         {
-            const Item* const item = images.getUnchecked(i);
+            Item* const item = images.getUnchecked(i);
 
             if (item->hashCode == hashCode)
+            {
+                item->lastUseTime = Time::getApproximateMillisecondCounter();
                 return item->image;
+            }
         }
 
         return Image();
@@ -64,6 +87,9 @@ public:
 
             const ScopedLock sl (lock);
             images.add (item);
+
+            if (memoryLimit > 0)
+                releaseLeastRecentlyUsedImages();
         }
     }
 
@@ -88,6 +114,9 @@ public:
             }
         }
 
+        if (memoryLimit > 0)
+            releaseLeastRecentlyUsedImages();
+
         if (images.size() == 0)
             stopTimer();
     }
@@ -101,6 +130,121 @@ public:
                 images.remove (i);
     }
 
+    int64 getMemoryUsage() const
+    {
+        const ScopedLock sl (lock);
+        int64 total = 0;
+
+        for (int i = images.size(); --i >= 0;)
+            if (const ImagePixelData* const data = images.getUnchecked(i)->image.getPixelData())
+                total += data->getMemoryUsage();
+
+        return total;
+    }
+
+    void releaseLeastRecentlyUsedImages()
+    {
+        const ScopedLock sl (lock);
+
+        int64 total = getMemoryUsage();
+
+        if (total <= memoryLimit)
+            return;
+
+        Array<Item*> unusedItems;
+
+        for (int i = images.size(); --i >= 0;)
+            if (images.getUnchecked(i)->image.getReferenceCount() <= 1)
+                unusedItems.add (images.getUnchecked(i));
+
+        LeastRecentlyUsedComparator comparator;
+        unusedItems.sort (comparator);
+
+        SortedSet<Item*> itemsToRemove;
+
+        for (int i = 0; i < unusedItems.size() && total > memoryLimit; ++i)
+        {
+            total -= unusedItems.getUnchecked(i)->image.getPixelData()->getMemoryUsage();
+            itemsToRemove.add (unusedItems.getUnchecked(i));
+        }
+
+        for (int i = images.size(); --i >= 0;)
+            if (itemsToRemove.contains (images.getUnchecked(i)))
+                images.remove (i);
+    }
+
+    /** Loads an image, either by mapping the decoded pixels that a previous load left in the
+        shared directory, or by decoding it and applying the storage options to the result.
+    */
+    Image loadImage (InputStream& source, const File& sharedFile)
+    {
+        Image image (getSharedImage (sharedFile));
+
+        if (image.isNull())
+            image = storeDecodedImage (ImageFileFormat::loadFrom (source), sharedFile);
+
+        return image;
+    }
+
+    static Image getSharedImage (const File& sharedFile)
+    {
+        if (sharedFile != File())
+            return MemoryMappedImage::loadFromFile (sharedFile);
+
+        return Image();
+    }
+
+    Image storeDecodedImage (const Image& image, const File& sharedFile) const
+    {
+        if (image.isValid())
+        {
+            if (sharedFile != File())
+            {
+                if (sharedFile.getParentDirectory().createDirectory()
+                     && MemoryMappedImage::saveToFile (image, sharedFile))
+                {
+                    const Image mapped (MemoryMappedImage::loadFromFile (sharedFile));
+
+                    if (mapped.isValid())
+                        return mapped;
+                }
+            }
+            else if (storeCompressed)
+            {
+                return CompressedImageType().convert (image);
+            }
+        }
+
+        return image;
+    }
+
+    // Returns the file in the shared pixel cache that would hold an image, or File()
+    // if there's no shared cache. (The contents are only hashed if they'll be needed).
+    File getSharedFile (const File& imageFile) const
+    {
+        const ScopedLock sl (lock);
+
+        if (sharedPixelDirectory != File())
+            return getSharedFile (getContentHash (imageFile));
+
+        return File();
+    }
+
+    File getSharedFile (const void* imageData, const size_t numBytes) const
+    {
+        const ScopedLock sl (lock);
+
+        if (sharedPixelDirectory != File())
+            return getSharedFile (hashData (imageData, numBytes));
+
+        return File();
+    }
+
+    File getSharedFile (const int64 contentHash) const
+    {
+        return sharedPixelDirectory.getChildFile ("img_" + String::toHexString (contentHash) + ".jpix");
+    }
+
     struct Item
     {
         Image image;
@@ -108,13 +252,26 @@ public:
         uint32 lastUseTime;
     };
 
+    struct LeastRecentlyUsedComparator
+    {
+        static int compareElements (const Item* first, const Item* second) noexcept
+        {
+            const int diff = (int) (first->lastUseTime - second->lastUseTime);
+            return diff < 0 ? -1 : (diff > 0 ? 1 : 0);
+        }
+    };
+
     unsigned int cacheTimeout;
+    int64 memoryLimit;
+    bool storeCompressed;
+    File sharedPixelDirectory;
 
     juce_DeclareSingleton_SingleThreaded_Minimal (ImageCache::Pimpl)
 
 private:
     OwnedArray<Item> images;
     CriticalSection lock;
+    friend class ImageCache;
 
     JUCE_DECLARE_NON_COPYABLE (Pimpl)
 };
@@ -143,8 +300,15 @@ Image ImageCache::getFromFile (const File& file)
 
     if (image.isNull())
     {
-        image = ImageFileFormat::loadFrom (file);
-        addImageToCache (image, hashCode);
+        FileInputStream stream (file);
+
+        if (stream.openedOk())
+        {
+            BufferedInputStream b (stream, 8192);
+            Pimpl* const p = Pimpl::getInstance();
+            image = p->loadImage (b, p->getSharedFile (file));
+            addImageToCache (image, hashCode);
+        }
     }
 
     return image;
@@ -155,15 +319,48 @@ Image ImageCache::getFromMemory (const void* imageData, const int dataSize)
     const int64 hashCode = (int64) (pointer_sized_int) imageData;
     Image image (getFromHashCode (hashCode));
 
-    if (image.isNull())
+    if (image.isNull() && imageData != nullptr && dataSize > 4)
     {
-        image = ImageFileFormat::loadFrom (imageData, (size_t) dataSize);
+        MemoryInputStream stream (imageData, (size_t) dataSize, false);
+
+        Pimpl* const p = Pimpl::getInstance();
+        image = p->loadImage (stream, p->getSharedFile (imageData, (size_t) dataSize));
         addImageToCache (image, hashCode);
     }
 
     return image;
 }
 
+void ImageCache::preloadFiles (const Array<File>& files, const int numThreads)
+{
+    Pimpl* const p = Pimpl::getInstance();
+    Array<File> filesToDecode;
+
+    for (int i = 0; i < files.size(); ++i)
+    {
+        const File& file = files.getReference (i);
+        const int64 hashCode = file.hashCode64();
+
+        if (getFromHashCode (hashCode).isNull() && ! filesToDecode.contains (file))
+        {
+            const Image shared (Pimpl::getSharedImage (p->getSharedFile (file)));
+
+            if (shared.isValid())
+                addImageToCache (shared, hashCode);
+            else
+                filesToDecode.add (file);
+        }
+    }
+
+    const Array<Image> images (ImageFileFormat::loadFromFiles (filesToDecode, numThreads));
+
+    for (int i = 0; i < images.size(); ++i)
+    {
+        const File& file = filesToDecode.getReference (i);
+        addImageToCache (p->storeDecodedImage (images.getReference (i), p->getSharedFile (file)), file.hashCode64());
+    }
+}
+
 void ImageCache::setCacheTimeout (const int millisecs)
 {
     jassert (millisecs >= 0);
@@ -174,3 +371,215 @@ void ImageCache::releaseUnusedImages()
 {
     Pimpl::getInstance()->releaseUnusedImages();
 }
+
+void ImageCache::setCacheMemoryLimit (const int64 maxNumBytes)
+{
+    jassert (maxNumBytes >= 0);
+
+    Pimpl* const p = Pimpl::getInstance();
+
+    {
+        const ScopedLock sl (p->lock);
+        p->memoryLimit = maxNumBytes;
+    }
+
+    if (maxNumBytes > 0)
+        p->releaseLeastRecentlyUsedImages();
+}
+
+int64 ImageCache::getCacheMemoryUsage()
+{
+    if (Pimpl* const p = Pimpl::getInstanceWithoutCreating())
+        return p->getMemoryUsage();
+
+    return 0;
+}
+
+void ImageCache::setStoreImagesCompressed (const bool shouldStoreCompressed)
+{
+    Pimpl::getInstance()->storeCompressed = shouldStoreCompressed;
+}
+
+void ImageCache::setSharedPixelCacheDirectory (const File& directory)
+{
+    Pimpl* const p = Pimpl::getInstance();
+    const ScopedLock sl (p->lock);
+    p->sharedPixelDirectory = directory;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ImageCacheTests  : public UnitTest
+{
+public:
+    ImageCacheTests()  : UnitTest ("ImageCache") {}
+
+    static Image createImage()
+    {
+        return Image (Image::ARGB, 64, 64, true, SoftwareImageType());
+    }
+
+    // (makes sure that the next image to be used gets a later time-stamp)
+    static void advanceClock()
+    {
+        Thread::sleep (5);
+        Time::getMillisecondCounter();
+    }
+
+    void runTest() override
+    {
+        // the cache uses a timer, which needs a message manager
+        ScopedPointer<ScopedJuceInitialiser_GUI> initialiser;
+
+        if (MessageManager::getInstanceWithoutCreating() == nullptr)
+            initialiser = new ScopedJuceInitialiser_GUI();
+
+        Random r = getRandom();
+
+        beginTest ("Memory limit");
+        {
+            const int64 hash = r.nextInt64();
+            const int64 imageSize = createImage().getPixelData()->getMemoryUsage();
+
+            ImageCache::releaseUnusedImages();
+            const int64 limit = ImageCache::getCacheMemoryUsage() + 3 * imageSize;
+            ImageCache::setCacheMemoryLimit (limit);
+
+            const Image inUse (createImage());
+            ImageCache::addImageToCache (inUse, hash);
+
+            for (int i = 1; i <= 3; ++i)
+            {
+                advanceClock();
+                ImageCache::addImageToCache (createImage(), hash + i);
+            }
+
+            // the oldest image that isn't being used should have been released
+            expect (ImageCache::getFromHashCode (hash).isValid());
+            expect (ImageCache::getFromHashCode (hash + 1).isNull());
+            expect (ImageCache::getFromHashCode (hash + 2).isValid());
+            expect (ImageCache::getFromHashCode (hash + 3).isValid());
+            expect (ImageCache::getCacheMemoryUsage() <= limit);
+
+            advanceClock();
+            expect (ImageCache::getFromHashCode (hash + 2).isValid());
+            advanceClock();
+            ImageCache::addImageToCache (createImage(), hash + 4);
+
+            expect (ImageCache::getFromHashCode (hash + 2).isValid());
+            expect (ImageCache::getFromHashCode (hash + 3).isNull());
+            expect (ImageCache::getFromHashCode (hash + 4).isValid());
+            expect (ImageCache::getCacheMemoryUsage() <= limit);
+
+            // (looking an image up counts as using it)
+            advanceClock();
+            expect (ImageCache::getFromHashCode (hash + 4).isValid());
+
+            ImageCache::setCacheMemoryLimit (limit - imageSize);
+            expect (ImageCache::getFromHashCode (hash).isValid());
+            expect (ImageCache::getFromHashCode (hash + 2).isNull());
+            expect (ImageCache::getFromHashCode (hash + 4).isValid());
+
+            ImageCache::setCacheMemoryLimit (0);
+            ImageCache::releaseUnusedImages();
+        }
+
+        beginTest ("Shared pixel cache");
+        {
+            const File directory (File::createTempFile ("pixelcache"));
+            ImageCache::setSharedPixelCacheDirectory (directory);
+
+            Image source (Image::RGB, 30, 20, true);
+            source.setPixelAt (3, 4, Colours::orange);
+
+            MemoryOutputStream png;
+            expect (PNGImageFormat().writeImageToStream (source, png));
+
+            {
+                const Image loaded (ImageCache::getFromMemory (png.getData(), (int) png.getDataSize()));
+                expect (MemoryMappedImage::isMemoryMapped (loaded));
+                expect (loaded.getPixelAt (3, 4) == Colours::orange);
+                expectEquals (directory.getNumberOfChildFiles (File::findFiles), 1);
+            }
+
+            // (the image is cached by the address of its data, which is about to be freed)
+            ImageCache::releaseUnusedImages();
+            ImageCache::setSharedPixelCacheDirectory (File());
+            expect (directory.deleteRecursively());
+        }
+
+        beginTest ("Preloading files");
+        {
+            const File directory (File::createTempFile ("preload"));
+            expect (directory.createDirectory());
+
+            Array<File> files;
+
+            for (int i = 0; i < 6; ++i)
+            {
+                Image source (Image::RGB, 20, 10 + i, true);
+                source.setPixelAt (i, 3, Colours::orange);
+
+                MemoryOutputStream png;
+                expect (PNGImageFormat().writeImageToStream (source, png));
+
+                files.add (directory.getChildFile ("image" + String (i) + ".png"));
+                expect (files.getLast().replaceWithData (png.getData(), png.getDataSize()));
+            }
+
+            files.add (directory.getChildFile ("notAnImage.png"));
+            expect (files.getLast().replaceWithText ("not an image"));
+
+            {
+                // (files that are already in the cache are left alone)
+                const Image alreadyCached (ImageCache::getFromFile (files[0]));
+
+                ImageCache::setStoreImagesCompressed (true);
+                ImageCache::preloadFiles (files, 3);
+                ImageCache::setStoreImagesCompressed (false);
+
+                for (int i = 0; i < 6; ++i)
+                {
+                    const Image image (ImageCache::getFromHashCode (files[i].hashCode64()));
+                    const ScopedPointer<ImageType> type (image.getPixelData()->createType());
+
+                    expectEquals (image.getHeight(), 10 + i);
+                    expect (image.getPixelAt (i, 3) == Colours::orange);
+                    expect ((type->getTypeID() == CompressedImageType().getTypeID()) == (i > 0));
+                }
+
+                expect (ImageCache::getFromHashCode (files[0].hashCode64()).getPixelData() == alreadyCached.getPixelData());
+                expect (ImageCache::getFromHashCode (files.getLast().hashCode64()).isNull());
+            }
+
+            ImageCache::releaseUnusedImages();
+
+            const File pixelDirectory (directory.getChildFile ("pixels"));
+            ImageCache::setSharedPixelCacheDirectory (pixelDirectory);
+
+            // (the second time around, the pixels are mapped from the files left by the first)
+            for (int pass = 0; pass < 2; ++pass)
+            {
+                ImageCache::preloadFiles (files);
+
+                for (int i = 0; i < 6; ++i)
+                {
+                    const Image image (ImageCache::getFromHashCode (files[i].hashCode64()));
+                    expect (MemoryMappedImage::isMemoryMapped (image));
+                    expect (image.getPixelAt (i, 3) == Colours::orange);
+                }
+
+                expectEquals (pixelDirectory.getNumberOfChildFiles (File::findFiles), 6);
+                ImageCache::releaseUnusedImages();
+            }
+
+            ImageCache::setSharedPixelCacheDirectory (File());
+            expect (directory.deleteRecursively());
+        }
+    }
+};
+
+static ImageCacheTests imageCacheTests;
+
+#endif
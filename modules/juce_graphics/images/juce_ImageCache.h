@@ -78,6 +78,22 @@ public:
     */
     static Image getFromMemory (const void* imageData, int dataSize);
 
+    /** Loads a set of image files into the cache, decoding them in parallel.
+
+        This is a quick way to load all the images that an app will need when it starts
+        up: any of the files that aren't already in the cache are decoded at the same time
+        on several threads, using ImageFileFormat::loadFromFiles(), and added to the cache,
+        so that subsequent calls to getFromFile() for them will return straight away.
+
+        Bear in mind that unless something else keeps a reference to them, the images
+        will still be released when the cache timeout expires.
+
+        @param files        the image files to load
+        @param numThreads   the number of threads to use, or 0 to use one per CPU core
+        @see getFromFile, setCacheTimeout
+    */
+    static void preloadFiles (const Array<File>& files, int numThreads = 0);
+
     //==============================================================================
     /** Checks the cache for an image with a particular hashcode.
 
@@ -111,6 +127,51 @@ public:
     */
     static void releaseUnusedImages();
 
+    //==============================================================================
+    /** Sets a limit on the amount of memory that the cached images can use.
+
+        When the total size of the images in the cache goes over this limit, the
+        least-recently used images that aren't being referenced elsewhere will be
+        released straight away, rather than waiting for the cache timeout to expire.
+        Images that are still in use are never released, so the total can exceed the
+        limit if there are enough of those.
+
+        A value of 0 (the default) means there's no limit.
+        @see getCacheMemoryUsage
+    */
+    static void setCacheMemoryLimit (int64 maxNumBytes);
+
+    /** Returns the number of bytes used by the pixels of all the images in the cache.
+        Images that are memory-mapped or compressed are counted by the amount of
+        private memory that they actually use.
+        @see setCacheMemoryLimit, ImagePixelData::getMemoryUsage
+    */
+    static int64 getCacheMemoryUsage();
+
+    /** If enabled, images that are loaded by getFromFile() and getFromMemory() will be
+        stored using a CompressedImageType, which can use much less memory at the cost
+        of decompressing them when they're drawn.
+        This only affects images that are loaded after the option is changed.
+        @see CompressedImageType
+    */
+    static void setStoreImagesCompressed (bool shouldStoreCompressed);
+
+    /** Sets a directory in which decoded images will be shared between processes.
+
+        When this is set, the first time an image is loaded by getFromFile() or
+        getFromMemory(), its decoded pixels are written to a file in this directory,
+        and the image that's returned is memory-mapped from that file. Any other process
+        (or later run of the same app) which loads the same image will then map the
+        same file instead of decoding it again, and all of them will share a single
+        copy of the pixels in the OS's file cache.
+
+        This is useful when many instances of the same app or plugin are loaded at once.
+        Pass File() to turn it off. If this is enabled, setStoreImagesCompressed() is
+        ignored.
+        @see MemoryMappedImage
+    */
+    static void setSharedPixelCacheDirectory (const File& directory);
+
 private:
     //==============================================================================
     class Pimpl;
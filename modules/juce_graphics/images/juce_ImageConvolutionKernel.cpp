@@ -275,7 +275,7 @@ void ImageConvolutionKernel::applyToImage (Image& destImage,
                             }
                             else
                             {
-                                src += 3;
+                                ++src;
                             }
 
                             ++sx;
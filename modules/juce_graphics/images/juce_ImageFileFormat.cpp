@@ -103,3 +103,168 @@ Image ImageFileFormat::loadFrom (const void* rawData, const size_t numBytes)
 
     return Image();
 }
+
+//==============================================================================
+struct ParallelImageLoader
+{
+    ParallelImageLoader (const Array<File>& filesToLoad)  : files (filesToLoad)
+    {
+        results.insertMultiple (0, Image(), files.size());
+    }
+
+    void loadRemainingFiles()
+    {
+        for (;;)
+        {
+            const int index = (++nextIndex) - 1;
+
+            if (index >= files.size())
+                break;
+
+            results.getReference (index) = ImageFileFormat::loadFrom (files.getReference (index));
+        }
+    }
+
+    struct Job  : public ThreadPoolJob
+    {
+        Job (ParallelImageLoader& l)  : ThreadPoolJob ("Image loader"), loader (l) {}
+
+        JobStatus runJob() override
+        {
+            loader.loadRemainingFiles();
+            return jobHasFinished;
+        }
+
+        ParallelImageLoader& loader;
+
+        JUCE_DECLARE_NON_COPYABLE (Job)
+    };
+
+    const Array<File>& files;
+    Array<Image> results;
+    Atomic<int> nextIndex;
+
+    JUCE_DECLARE_NON_COPYABLE (ParallelImageLoader)
+};
+
+Array<Image> ImageFileFormat::loadFromFiles (const Array<File>& files, int numThreads)
+{
+    ParallelImageLoader loader (files);
+
+    if (numThreads <= 0)
+        numThreads = SystemStats::getNumCpus();
+
+    numThreads = jmin (numThreads, files.size());
+
+    if (numThreads > 1)
+    {
+        ThreadPool pool (numThreads - 1);
+
+        for (int i = 1; i < numThreads; ++i)
+            pool.addJob (new ParallelImageLoader::Job (loader), true);
+
+        loader.loadRemainingFiles();
+
+        // any jobs that haven't started by now have nothing left to do, and will just be
+        // removed, but we need to wait for the others to finish the files they're loading
+        pool.removeAllJobs (false, -1);
+    }
+    else
+    {
+        loader.loadRemainingFiles();
+    }
+
+    return loader.results;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ImageFileFormatTests  : public UnitTest
+{
+public:
+    ImageFileFormatTests() : UnitTest ("ImageFileFormat") {}
+
+    static Colour getMarkerColour (const int index) noexcept
+    {
+        return Colour ((uint8) (index * 20), (uint8) (255 - index * 10), (uint8) (index * 7));
+    }
+
+    static Image createImage (const int index)
+    {
+        Image image (Image::RGB, 10 + index, 20, true);
+        image.setPixelAt (index, 5, getMarkerColour (index));
+        return image;
+    }
+
+    void runTest() override
+    {
+        beginTest ("Loading files in parallel");
+
+        const File directory (File::createTempFile ("images"));
+        expect (directory.createDirectory());
+
+        Array<File> files;
+        Array<int> imageIndexes;
+
+        for (int i = 0; i < 12; ++i)
+        {
+            MemoryOutputStream png;
+            expect (PNGImageFormat().writeImageToStream (createImage (i), png));
+
+            files.add (directory.getChildFile ("image" + String (i) + ".png"));
+            imageIndexes.add (i);
+
+            // (some files that can't be loaded are mixed in with the others)
+            if (i == 3)
+            {
+                expect (files.getLast().replaceWithData (png.getData(), png.getDataSize() / 2));
+                imageIndexes.set (imageIndexes.size() - 1, -1);
+            }
+            else
+            {
+                expect (files.getLast().replaceWithData (png.getData(), png.getDataSize()));
+            }
+
+            if (i == 7)
+            {
+                files.add (directory.getChildFile ("notAnImage.png"));
+                imageIndexes.add (-1);
+                expect (files.getLast().replaceWithText ("not an image"));
+            }
+        }
+
+        files.add (directory.getChildFile ("missing.png"));
+        imageIndexes.add (-1);
+
+        const int numThreadsToTry[] = { 0, 1, 3, 100 };
+
+        for (int i = 0; i < numElementsInArray (numThreadsToTry); ++i)
+        {
+            const Array<Image> images (ImageFileFormat::loadFromFiles (files, numThreadsToTry[i]));
+            expectEquals (images.size(), files.size());
+
+            for (int j = 0; j < files.size(); ++j)
+            {
+                const int index = imageIndexes[j];
+
+                if (index < 0)
+                {
+                    expect (images[j].isNull());
+                }
+                else
+                {
+                    expectEquals (images[j].getWidth(), 10 + index);
+                    expect (images[j].getPixelAt (index, 5) == getMarkerColour (index));
+                }
+            }
+        }
+
+        expect (ImageFileFormat::loadFromFiles (Array<File>()).isEmpty());
+        expect (directory.deleteRecursively());
+    }
+};
+
+static ImageFileFormatTests imageFileFormatTests;
+
+#endif
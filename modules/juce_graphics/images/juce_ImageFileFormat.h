@@ -135,6 +135,20 @@ public:
     */
     static Image loadFrom (const void* rawData,
                            size_t numBytesOfData);
+
+    /** Loads a set of image files, decoding several of them at once on different threads.
+
+        This is much quicker than loading the files one at a time when there are a lot of
+        them, e.g. when loading all the images that an app uses at startup. The calling
+        thread also decodes images, and the method returns when they've all been loaded.
+
+        @param files        the files to load
+        @param numThreads   the number of threads to use, or 0 to use one per CPU core
+        @returns            an array containing an image for each of the files, in the same
+                            order. Any that couldn't be loaded will be invalid images.
+        @see ImageCache::preloadFiles
+    */
+    static Array<Image> loadFromFiles (const Array<File>& files, int numThreads = 0);
 };
 
 //==============================================================================
@@ -180,6 +194,17 @@ public:
     */
     void setQuality (float newQuality);
 
+    /** Allows smaller versions of large images to be decoded much more quickly.
+
+        When this is set, decodeImage() will use the JPEG decoder's ability to produce an
+        image at 1/2, 1/4 or 1/8 of its full size without decoding all the detail, picking
+        the smallest of these scales that still gives an image at least as large as the
+        size given here. It's then up to you to do any further scaling when it's drawn.
+
+        Pass zero for both sizes (the default) to always decode at full size.
+    */
+    void setTargetDecodeSize (int width, int height);
+
     //==============================================================================
     String getFormatName() override;
     bool usesFileExtension (const File&) override;
@@ -189,6 +214,7 @@ public:
 
 private:
     float quality;
+    int targetWidth, targetHeight;
 };
 
 //==============================================================================
@@ -0,0 +1,295 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2015 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+namespace MemoryMappedImageHelpers
+{
+    enum
+    {
+        magicNumber = 0x5849504a, // "JPIX"
+        formatVersion = 1,
+        headerSize = 64  // (keeps the pixel data cache-line aligned within the mapped pages)
+    };
+
+    static int getPixelStride (Image::PixelFormat format) noexcept
+    {
+        return format == Image::RGB ? 3 : ((format == Image::ARGB) ? 4 : 1);
+    }
+}
+
+//==============================================================================
+class MappedPixelData  : public ImagePixelData
+{
+public:
+    MappedPixelData (MemoryMappedFile* const file, const Image::PixelFormat format,
+                     const int w, const int h, const int stride)
+        : ImagePixelData (format, w, h),
+          mappedFile (file),
+          mappedPixels (addBytesToPointer (file->getData(), (int) MemoryMappedImageHelpers::headerSize)),
+          pixelStride (MemoryMappedImageHelpers::getPixelStride (format)),
+          lineStride (stride)
+    {
+    }
+
+    LowLevelGraphicsContext* createLowLevelContext() override
+    {
+        makePrivateCopy();
+        sendDataChangeMessage();
+        return new LowLevelGraphicsSoftwareRenderer (Image (this));
+    }
+
+    void initialiseBitmapData (Image::BitmapData& bitmap, int x, int y, Image::BitmapData::ReadWriteMode mode) override
+    {
+        if (mode != Image::BitmapData::readOnly)
+        {
+            makePrivateCopy();
+            sendDataChangeMessage();
+        }
+
+        uint8* const pixels = privateCopy != nullptr ? privateCopy.getData()
+                                                     : static_cast<uint8*> (mappedPixels);
+
+        bitmap.data = pixels + x * pixelStride + y * lineStride;
+        bitmap.pixelFormat = pixelFormat;
+        bitmap.lineStride = lineStride;
+        bitmap.pixelStride = pixelStride;
+    }
+
+    ImagePixelData::Ptr clone() override
+    {
+        Image newImage (SoftwareImageType().create (pixelFormat, width, height, false));
+
+        const Image::BitmapData src (Image (this), Image::BitmapData::readOnly);
+        const Image::BitmapData dest (newImage, Image::BitmapData::writeOnly);
+
+        for (int y = 0; y < height; ++y)
+            memcpy (dest.getLinePointer (y), src.getLinePointer (y), (size_t) (pixelStride * width));
+
+        return newImage.getPixelData();
+    }
+
+    ImageType* createType() const override          { return new SoftwareImageType(); }
+
+    /* the mapped pages belong to the OS's file cache, and may be shared with other processes */
+    int64 getMemoryUsage() const noexcept override  { return privateCopy != nullptr ? lineStride * (int64) height : 0; }
+
+    bool isStillMapped() const noexcept             { return mappedFile != nullptr; }
+
+private:
+    ScopedPointer<MemoryMappedFile> mappedFile;
+    void* mappedPixels;
+    HeapBlock<uint8> privateCopy;
+    const int pixelStride, lineStride;
+
+    void makePrivateCopy()
+    {
+        if (privateCopy == nullptr)
+        {
+            privateCopy.malloc ((size_t) lineStride * (size_t) height);
+            memcpy (privateCopy, mappedPixels, (size_t) lineStride * (size_t) height);
+            mappedFile = nullptr;
+            mappedPixels = nullptr;
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MappedPixelData)
+};
+
+//==============================================================================
+bool MemoryMappedImage::saveToFile (const Image& image, const File& file)
+{
+    using namespace MemoryMappedImageHelpers;
+
+    if (image.isNull())
+        return false;
+
+    const Image::BitmapData src (image, Image::BitmapData::readOnly);
+    const int pixelStride = getPixelStride (src.pixelFormat);
+    const int lineStride = (pixelStride * src.width + 3) & ~3;
+
+    TemporaryFile temp (file);
+
+    {
+        FileOutputStream out (temp.getFile());
+
+        if (out.failedToOpen())
+            return false;
+
+        out.writeInt (magicNumber);
+        out.writeInt (formatVersion);
+        out.writeInt ((int) src.pixelFormat);
+        out.writeInt (src.width);
+        out.writeInt (src.height);
+        out.writeInt (lineStride);
+        out.writeRepeatedByte (0, (size_t) headerSize - 6 * sizeof (int));
+
+        HeapBlock<uint8> line ((size_t) lineStride, true);
+
+        for (int y = 0; y < src.height; ++y)
+        {
+            memcpy (line, src.getLinePointer (y), (size_t) (pixelStride * src.width));
+
+            if (! out.write (line, (size_t) lineStride))
+                return false;
+        }
+
+        out.flush();
+
+        if (out.getStatus().failed())
+            return false;
+    }
+
+    return temp.overwriteTargetFileWithTemporary();
+}
+
+Image MemoryMappedImage::loadFromFile (const File& file)
+{
+    using namespace MemoryMappedImageHelpers;
+
+    ScopedPointer<MemoryMappedFile> mappedFile (new MemoryMappedFile (file, MemoryMappedFile::readOnly));
+
+    if (mappedFile->getData() == nullptr || mappedFile->getSize() < (size_t) headerSize)
+        return Image();
+
+    const int* const header = static_cast<const int*> (mappedFile->getData());
+
+    const Image::PixelFormat format = (Image::PixelFormat) ByteOrder::swapIfBigEndian (header[2]);
+    const int width      = (int) ByteOrder::swapIfBigEndian (header[3]);
+    const int height     = (int) ByteOrder::swapIfBigEndian (header[4]);
+    const int lineStride = (int) ByteOrder::swapIfBigEndian (header[5]);
+
+    if ((int) ByteOrder::swapIfBigEndian (header[0]) != magicNumber
+         || (int) ByteOrder::swapIfBigEndian (header[1]) != formatVersion
+         || ! (format == Image::RGB || format == Image::ARGB || format == Image::SingleChannel)
+         || width <= 0 || height <= 0
+         || lineStride < width * (int64) getPixelStride (format)
+         || (int64) mappedFile->getSize() < headerSize + lineStride * (int64) height)
+        return Image();
+
+    return Image (new MappedPixelData (mappedFile.release(), format, width, height, lineStride));
+}
+
+bool MemoryMappedImage::isMemoryMapped (const Image& image)
+{
+    if (const MappedPixelData* const data = dynamic_cast<const MappedPixelData*> (image.getPixelData()))
+        return data->isStillMapped();
+
+    return false;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class MemoryMappedImageTests  : public UnitTest
+{
+public:
+    MemoryMappedImageTests()  : UnitTest ("MemoryMappedImage") {}
+
+    static bool pixelsMatch (const Image& a, const Image& b)
+    {
+        if (a.getBounds() != b.getBounds() || a.getFormat() != b.getFormat())
+            return false;
+
+        const Image::BitmapData da (a, Image::BitmapData::readOnly);
+        const Image::BitmapData db (b, Image::BitmapData::readOnly);
+
+        for (int y = 0; y < a.getHeight(); ++y)
+            if (memcmp (da.getLinePointer (y), db.getLinePointer (y), (size_t) (a.getWidth() * da.pixelStride)) != 0)
+                return false;
+
+        return true;
+    }
+
+    // Writes a copy of the file with one of the header fields changed
+    static Image loadWithModifiedHeader (const File& original, int fieldIndex, int newValue, size_t newSize = 0)
+    {
+        MemoryBlock data;
+        original.loadFileAsData (data);
+        static_cast<int*> (data.getData())[fieldIndex] = (int) ByteOrder::swapIfBigEndian ((uint32) newValue);
+
+        if (newSize > 0)
+            data.setSize (newSize);
+
+        const TemporaryFile temp;
+        temp.getFile().replaceWithData (data.getData(), data.getSize());
+        return MemoryMappedImage::loadFromFile (temp.getFile());
+    }
+
+    void runTest() override
+    {
+        beginTest ("Saving and loading");
+
+        Random r = getRandom();
+        const Image::PixelFormat formats[] = { Image::ARGB, Image::RGB, Image::SingleChannel };
+
+        for (int i = 0; i < numElementsInArray (formats); ++i)
+        {
+            Image original (formats[i], 1 + r.nextInt (200), 1 + r.nextInt (200), false, SoftwareImageType());
+
+            {
+                const Image::BitmapData data (original, Image::BitmapData::writeOnly);
+
+                for (int y = 0; y < original.getHeight(); ++y)
+                    r.fillBitsRandomly (data.getLinePointer (y), (size_t) (original.getWidth() * data.pixelStride));
+            }
+
+            const TemporaryFile temp;
+            expect (MemoryMappedImage::saveToFile (original, temp.getFile()));
+
+            Image mapped (MemoryMappedImage::loadFromFile (temp.getFile()));
+            expect (MemoryMappedImage::isMemoryMapped (mapped));
+            expect (pixelsMatch (original, mapped));
+            expectEquals (mapped.getPixelData()->getMemoryUsage(), (int64) 0);
+
+            // writing to the image must make a private copy, and leave the file alone
+            mapped.setPixelAt (0, 0, Colours::red.withAlpha (0.5f));
+            expect (! MemoryMappedImage::isMemoryMapped (mapped));
+            expect (pixelsMatch (original, MemoryMappedImage::loadFromFile (temp.getFile())));
+        }
+
+        beginTest ("Invalid headers");
+        {
+            const Image original (Image::ARGB, 20, 10, true, SoftwareImageType());
+            const TemporaryFile temp;
+            expect (MemoryMappedImage::saveToFile (original, temp.getFile()));
+            expect (MemoryMappedImage::loadFromFile (temp.getFile()).isValid());
+
+            expect (loadWithModifiedHeader (temp.getFile(), 0, 12345).isNull());          // magic number
+            expect (loadWithModifiedHeader (temp.getFile(), 1, 2).isNull());              // version
+            expect (loadWithModifiedHeader (temp.getFile(), 2, 99).isNull());             // format
+            expect (loadWithModifiedHeader (temp.getFile(), 3, -20).isNull());            // width
+            expect (loadWithModifiedHeader (temp.getFile(), 4, 0).isNull());              // height
+            expect (loadWithModifiedHeader (temp.getFile(), 5, 40).isNull());             // line stride
+            expect (loadWithModifiedHeader (temp.getFile(), 4, 11).isNull());             // file too short
+            expect (loadWithModifiedHeader (temp.getFile(), 4, 10, 100).isNull());        // truncated
+
+            // (width * pixelStride would overflow an int, and appear to fit in the stride)
+            expect (loadWithModifiedHeader (temp.getFile(), 3, 0x40000000).isNull());
+            expect (loadWithModifiedHeader (temp.getFile(), 4, 0x7fffffff).isNull());
+        }
+    }
+};
+
+static MemoryMappedImageTests memoryMappedImageTests;
+
+#endif
@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2015 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+#ifndef JUCE_MEMORYMAPPEDIMAGE_H_INCLUDED
+#define JUCE_MEMORYMAPPEDIMAGE_H_INCLUDED
+
+
+//==============================================================================
+/**
+    Saves and loads images as raw, uncompressed pixels which can be memory-mapped.
+
+    An image loaded with loadFromFile() doesn't allocate any memory for its pixels:
+    they're read directly from the file by the OS's virtual memory system. This means
+    that if several processes (e.g. many instances of the same plugin) load the same
+    image file, they'll all share a single copy of the pixels in the OS's file cache,
+    and pages that aren't being drawn can be discarded by the OS when memory is low.
+
+    If you draw into a mapped image, or access it with a writable BitmapData, it'll
+    make a private copy of its pixels first, so the file is never modified.
+
+    The files aren't intended to be portable - they're a cache of decoded pixel data
+    for the machine that created them, not an image file format.
+
+    @see ImageCache::setSharedPixelCacheDirectory
+*/
+class JUCE_API  MemoryMappedImage
+{
+public:
+    //==============================================================================
+    /** Writes an image's pixels to a file in a form that loadFromFile() can map.
+        The file is written to a temporary file first and then moved into place, so
+        that other processes can never map a partially-written file.
+        @returns true if the file was written successfully
+    */
+    static bool saveToFile (const Image& image, const File& file);
+
+    /** Maps a file that was written with saveToFile().
+        @returns the image, or an invalid image if the file couldn't be mapped or
+                 isn't in the right format
+    */
+    static Image loadFromFile (const File& file);
+
+    /** Returns true if this image's pixels are being read from a mapped file. */
+    static bool isMemoryMapped (const Image& image);
+
+private:
+    MemoryMappedImage() JUCE_DELETED_FUNCTION;
+    JUCE_DECLARE_NON_COPYABLE (MemoryMappedImage)
+};
+
+
+#endif   // JUCE_MEMORYMAPPEDIMAGE_H_INCLUDED
@@ -127,6 +127,9 @@ class LowLevelGraphicsContext;
 #include "contexts/juce_GraphicsContext.h"
 #include "contexts/juce_LowLevelGraphicsContext.h"
 #include "images/juce_Image.h"
+#include "images/juce_CompressedImageType.h"
+#include "images/juce_MemoryMappedImage.h"
+#include "images/juce_ImageBlur.h"
 #include "colour/juce_FillType.h"
 #include "native/juce_RenderingHelpers.h"
 #include "contexts/juce_LowLevelGraphicsSoftwareRenderer.h"
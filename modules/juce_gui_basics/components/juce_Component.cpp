@@ -447,6 +447,46 @@ struct Component::ComponentHelpers
         for (int i = c.getNumChildComponents(); --i >= 0;)
             releaseAllCachedImageResources (*c.getChildComponent (i));
     }
+
+   #if JUCE_ENABLE_PAINT_PROFILING
+    static ComponentPaintProfiler* getActivePaintProfiler() noexcept
+    {
+        ComponentPaintProfiler* const profiler = ComponentPaintProfiler::getInstanceWithoutCreating();
+        return profiler != nullptr && profiler->isEnabled() ? profiler : nullptr;
+    }
+
+    // Times a call to paintComponentAndChildren(), separating the time spent in the
+    // component's own paint methods from the time taken by its children.
+    struct PaintTimer
+    {
+        PaintTimer (Component& c, Rectangle<int> clip) noexcept
+            : profiler (getActivePaintProfiler()), component (c), area (clip.getIntersection (c.getLocalBounds())),
+              startTime (profiler != nullptr ? Time::getHighResolutionTicks() : 0),
+              childrenStartTime (startTime), childrenTime (0)
+        {
+        }
+
+        ~PaintTimer()
+        {
+            if (profiler != nullptr)
+            {
+                const int64 totalTime = Time::getHighResolutionTicks() - startTime;
+                profiler->componentPainted (component, area, totalTime - childrenTime, totalTime);
+            }
+        }
+
+        void childrenStarting() noexcept    { if (profiler != nullptr) childrenStartTime = Time::getHighResolutionTicks(); }
+        void childrenFinished() noexcept    { if (profiler != nullptr) childrenTime = Time::getHighResolutionTicks() - childrenStartTime; }
+
+        ComponentPaintProfiler* const profiler;
+        Component& component;
+        const Rectangle<int> area;
+        const int64 startTime;
+        int64 childrenStartTime, childrenTime;
+
+        JUCE_DECLARE_NON_COPYABLE (PaintTimer)
+    };
+   #endif
 };
 
 //==============================================================================
@@ -488,6 +528,11 @@ Component::~Component()
     if (flags.hasHeavyweightPeerFlag)
         removeFromDesktop();
 
+   #if JUCE_ENABLE_PAINT_PROFILING
+    if (ComponentPaintProfiler* const profiler = ComponentPaintProfiler::getInstanceWithoutCreating())
+        profiler->componentDeleted (*this);
+   #endif
+
     // Something has added some children to this component during its destructor! Not a smart idea!
     jassert (childComponentList.size() == 0);
 }
@@ -1966,15 +2011,34 @@ void Component::paintWithinParentContext (Graphics& g)
     g.setOrigin (getPosition());
 
     if (cachedImage != nullptr)
+    {
+       #if JUCE_ENABLE_PAINT_PROFILING
+        if (ComponentPaintProfiler* const profiler = ComponentHelpers::getActivePaintProfiler())
+        {
+            // if the cached image needed re-rendering, the component will have been painted
+            const int paintCounter = profiler->getPaintCounter();
+            cachedImage->paint (g);
+            profiler->cachedImageUsed (*this, profiler->getPaintCounter() != paintCounter);
+            return;
+        }
+       #endif
+
         cachedImage->paint (g);
+    }
     else
+    {
         paintEntireComponent (g, false);
+    }
 }
 
 void Component::paintComponentAndChildren (Graphics& g)
 {
     const Rectangle<int> clipBounds (g.getClipBounds());
 
+   #if JUCE_ENABLE_PAINT_PROFILING
+    ComponentHelpers::PaintTimer paintTimer (*this, clipBounds);
+   #endif
+
     if (flags.dontClipGraphicsFlag)
     {
         paint (g);
@@ -1989,6 +2053,10 @@ void Component::paintComponentAndChildren (Graphics& g)
         g.restoreState();
     }
 
+   #if JUCE_ENABLE_PAINT_PROFILING
+    paintTimer.childrenStarting();
+   #endif
+
     for (int i = 0; i < childComponentList.size(); ++i)
     {
         Component& child = *childComponentList.getUnchecked (i);
@@ -2037,6 +2105,10 @@ void Component::paintComponentAndChildren (Graphics& g)
         }
     }
 
+   #if JUCE_ENABLE_PAINT_PROFILING
+    paintTimer.childrenFinished();
+   #endif
+
     g.saveState();
     paintOverChildren (g);
     g.restoreState();
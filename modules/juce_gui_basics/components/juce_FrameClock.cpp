@@ -0,0 +1,389 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2015 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+FrameClock::Listener::~Listener()
+{
+    if (FrameClock* const clock = FrameClock::getInstanceWithoutCreating())
+        clock->removeListener (this);
+}
+
+//==============================================================================
+FrameClock::FrameClock()
+    : frameIntervalMs (1000.0 / 60.0),
+      lastFrameTime (0), nextFrameTime (0),
+      frameCount (0),
+      repaintPacingEnabled (true),
+      isInsideFrame (false)
+{
+}
+
+FrameClock::~FrameClock()
+{
+    clearSingletonInstance();
+}
+
+juce_ImplementSingleton_SingleThreaded (FrameClock)
+
+//==============================================================================
+void FrameClock::addListener (Listener* const listener)
+{
+    ASSERT_MESSAGE_MANAGER_IS_LOCKED
+
+    listeners.add (listener);
+    wakeUp();
+}
+
+void FrameClock::removeListener (Listener* const listener)
+{
+    ASSERT_MESSAGE_MANAGER_IS_LOCKED
+
+    listeners.remove (listener);
+    oneShotListeners.removeAllInstancesOf (listener);
+    listenersForCurrentFrame.removeAllInstancesOf (listener);
+}
+
+void FrameClock::requestFrame (Listener* const listener)
+{
+    ASSERT_MESSAGE_MANAGER_IS_LOCKED
+    jassert (listener != nullptr);
+
+    oneShotListeners.addIfNotAlreadyThere (listener);
+    wakeUp();
+}
+
+void FrameClock::addPeerNeedingRepaint (ComponentPeer& peer)
+{
+    peersNeedingRepaint.addIfNotAlreadyThere (&peer);
+    wakeUp();
+}
+
+void FrameClock::setRepaintPacingEnabled (const bool shouldPaceRepaints) noexcept
+{
+    repaintPacingEnabled = shouldPaceRepaints;
+}
+
+//==============================================================================
+void FrameClock::setFrameRate (const double framesPerSecond)
+{
+    // that's not a sensible frame rate..
+    jassert (framesPerSecond > 0);
+
+    frameIntervalMs = 1000.0 / jlimit (1.0, 1000.0, framesPerSecond);
+
+    if (isTimerRunning())
+    {
+        nextFrameTime = lastFrameTime + frameIntervalMs;
+        scheduleNextFrame();
+    }
+}
+
+void FrameClock::performFrameNow()
+{
+    stopTimer();
+    runFrame (Time::getMillisecondCounterHiRes());
+}
+
+//==============================================================================
+bool FrameClock::hasWorkPending() const noexcept
+{
+    return ! (listeners.isEmpty() && oneShotListeners.isEmpty() && peersNeedingRepaint.isEmpty());
+}
+
+void FrameClock::wakeUp()
+{
+    if (! (isTimerRunning() || isInsideFrame))
+        scheduleNextFrame();
+}
+
+void FrameClock::scheduleNextFrame()
+{
+    const double now = Time::getMillisecondCounterHiRes();
+
+    // If we've been idle, or fallen behind, skip any frames that were missed but keep
+    // the new frames on the same grid as the old ones, so their spacing stays even.
+    if (nextFrameTime < now)
+        nextFrameTime = lastFrameTime <= 0 ? now
+                                           : lastFrameTime + frameIntervalMs * (std::floor ((now - lastFrameTime) / frameIntervalMs) + 1.0);
+
+    startTimer (jmax (1, (int) (nextFrameTime - now)));
+}
+
+void FrameClock::timerCallback()
+{
+    stopTimer();
+
+    const double now = Time::getMillisecondCounterHiRes();
+    double frameTime = nextFrameTime;
+
+    // if we've been held up for longer than a whole frame, drop the ones we missed
+    if (now - frameTime >= frameIntervalMs)
+        frameTime += frameIntervalMs * std::floor ((now - frameTime) / frameIntervalMs);
+
+    runFrame (frameTime);
+}
+
+void FrameClock::runFrame (const double frameTime)
+{
+    const ScopedValueSetter<bool> svs (isInsideFrame, true);
+
+    lastFrameTime = frameTime;
+    nextFrameTime = frameTime + frameIntervalMs;
+    ++frameCount;
+
+    listeners.call (&Listener::frameCallback, frameTime);
+
+    // (one-shot listeners are allowed to re-register themselves for the next frame
+    // from inside their callback, so they're moved out of the pending list first)
+    listenersForCurrentFrame.swapWith (oneShotListeners);
+
+    while (listenersForCurrentFrame.size() > 0)
+    {
+        Listener* const l = listenersForCurrentFrame.removeAndReturn (0);
+
+        if (! listeners.contains (l))
+            l->frameCallback (frameTime);
+    }
+
+    // Anything that the listeners invalidated gets painted in this same frame,
+    // together with any other repaints that have built up since the last one.
+    Array<ComponentPeer*> peers;
+    peers.swapWith (peersNeedingRepaint);
+
+    for (int i = 0; i < peers.size(); ++i)
+    {
+        ComponentPeer* const peer = peers.getUnchecked (i);
+
+        if (ComponentPeer::isValidPeer (peer))
+            peer->performAnyPendingRepaintsNow();
+    }
+
+    if (hasWorkPending())
+        scheduleNextFrame();
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS && JUCE_MODAL_LOOPS_PERMITTED
+
+class FrameClockTests  : public UnitTest
+{
+public:
+    FrameClockTests() : UnitTest ("FrameClock") {}
+
+    //==============================================================================
+    struct RecordingListener  : public FrameClock::Listener
+    {
+        RecordingListener() : numRepeats (0), removeSelf (false), stallTimeMs (0) {}
+
+        void frameCallback (double frameTimeMs) override
+        {
+            frameTimes.add (frameTimeMs);
+
+            if (stallTimeMs > 0)
+            {
+                Thread::sleep (stallTimeMs);
+                stallTimeMs = 0;
+            }
+
+            if (removeSelf)
+                FrameClock::getInstance()->removeListener (this);
+
+            if (numRepeats > 0 && --numRepeats > 0)
+                FrameClock::getInstance()->requestFrame (this);
+        }
+
+        Array<double> frameTimes;
+        int numRepeats;
+        bool removeSelf;
+        int stallTimeMs;
+    };
+
+    //==============================================================================
+    static void runFramesUntil (const Array<double>& frameTimes, const int numFrames)
+    {
+        const uint32 timeoutEnd = Time::getMillisecondCounter() + 5000;
+
+        while (frameTimes.size() < numFrames && Time::getMillisecondCounter() < timeoutEnd)
+            MessageManager::getInstance()->runDispatchLoopUntil (5);
+    }
+
+    static void runFramesFor (const int milliseconds)
+    {
+        MessageManager::getInstance()->runDispatchLoopUntil (milliseconds);
+    }
+
+    // frames are always a whole number of intervals apart, even when some get skipped
+    void expectOnFrameGrid (const double t1, const double t2, const double interval)
+    {
+        const double numIntervals = (t2 - t1) / interval;
+
+        expect (numIntervals > 0.5, "frames out of order");
+        expect (std::abs (numIntervals - std::floor (numIntervals + 0.5)) < 1.0e-6,
+                "frame off the grid by " + String (numIntervals - std::floor (numIntervals + 0.5)));
+    }
+
+    void expectAllOnFrameGrid (const Array<double>& frameTimes, const double interval)
+    {
+        for (int i = 1; i < frameTimes.size(); ++i)
+            expectOnFrameGrid (frameTimes[i - 1], frameTimes[i], interval);
+    }
+
+    //==============================================================================
+    void runTest() override
+    {
+        // (this makes the current thread the message thread if there isn't one yet, and
+        // deletes the clock and anything else that the test creates when it's finished)
+        const ScopedJuceInitialiser_GUI libraryInitialiser;
+
+        beginTest ("Frame spacing");
+
+        if (! MessageManager::getInstance()->isThisTheMessageThread())
+        {
+            logMessage ("(skipped because the tests aren't running on the message thread)");
+            return;
+        }
+
+        FrameClock& clock = *FrameClock::getInstance();
+        const double originalRate = clock.getFrameRate();
+        clock.setFrameRate (100.0);
+        const double interval = clock.getFrameIntervalMs();
+
+        {
+            RecordingListener listener;
+            clock.addListener (&listener);
+            runFramesUntil (listener.frameTimes, 10);
+            expectEquals (listener.frameTimes.size(), 10);
+            expectAllOnFrameGrid (listener.frameTimes, interval);
+
+            // after being idle, the clock restarts on the same grid, and not in the past
+            clock.removeListener (&listener);
+            runFramesFor (55);
+            expectEquals (listener.frameTimes.size(), 10);
+
+            const double restartTime = Time::getMillisecondCounterHiRes();
+            clock.addListener (&listener);
+            runFramesUntil (listener.frameTimes, 15);
+            clock.removeListener (&listener);
+
+            expectEquals (listener.frameTimes.size(), 15);
+            expectAllOnFrameGrid (listener.frameTimes, interval);
+            expect (listener.frameTimes[10] - listener.frameTimes[9] >= 5 * interval - 1.0e-6);
+            expect (listener.frameTimes[10] >= restartTime - 1.0e-6);
+        }
+
+        beginTest ("Missed frames");
+        {
+            RecordingListener listener;
+            clock.addListener (&listener);
+            runFramesUntil (listener.frameTimes, 3);
+
+            // a frame that takes much longer than the interval makes the clock drop the ones
+            // it missed, rather than firing them all at once to catch up
+            listener.stallTimeMs = (int) (interval * 4);
+            const int stalledFrame = listener.frameTimes.size();
+            runFramesUntil (listener.frameTimes, stalledFrame + 5);
+            clock.removeListener (&listener);
+
+            expectAllOnFrameGrid (listener.frameTimes, interval);
+            expect (listener.frameTimes[stalledFrame + 1] - listener.frameTimes[stalledFrame] >= 4 * interval - 1.0e-6);
+
+            for (int i = 1; i < listener.frameTimes.size(); ++i)
+                expect (listener.frameTimes[i] - listener.frameTimes[i - 1] > 0.5 * interval);
+        }
+
+        beginTest ("One-shot frames");
+        {
+            RecordingListener listener;
+            listener.numRepeats = 5;
+
+            // (asking twice for the same frame only gives one callback)
+            clock.requestFrame (&listener);
+            clock.requestFrame (&listener);
+
+            runFramesUntil (listener.frameTimes, 5);
+            runFramesFor ((int) (interval * 5));
+
+            expectEquals (listener.frameTimes.size(), 5);
+            expectAllOnFrameGrid (listener.frameTimes, interval);
+        }
+
+        beginTest ("Removing listeners during a frame");
+        {
+            RecordingListener removesItself, keepsRunning, oneShot;
+            removesItself.removeSelf = true;
+            oneShot.removeSelf = true;
+
+            clock.addListener (&removesItself);
+            clock.addListener (&keepsRunning);
+            clock.requestFrame (&oneShot);
+
+            runFramesUntil (keepsRunning.frameTimes, 4);
+            clock.removeListener (&keepsRunning);
+
+            expectEquals (removesItself.frameTimes.size(), 1);
+            expectEquals (oneShot.frameTimes.size(), 1);
+            expectEquals (keepsRunning.frameTimes.size(), 4);
+            expect (removesItself.frameTimes[0] == keepsRunning.frameTimes[0]);
+
+            // a listener that's removed before its frame arrives isn't called
+            RecordingListener removedEarly;
+            clock.requestFrame (&removedEarly);
+            clock.removeListener (&removedEarly);
+            runFramesFor ((int) (interval * 3));
+            expectEquals (removedEarly.frameTimes.size(), 0);
+        }
+
+        beginTest ("ComponentAnimator");
+        {
+            Component comp;
+            comp.setBounds (0, 0, 10, 10);
+
+            ComponentAnimator animator;
+            const int durationMs = 200;
+            const int64 startFrame = clock.getFrameCount();
+
+            animator.animateComponent (&comp, Rectangle<int> (100, 50, 20, 30), 1.0f, durationMs, false, 1.0, 1.0);
+            expect (animator.isAnimating (&comp));
+
+            const uint32 timeoutEnd = Time::getMillisecondCounter() + 5000;
+
+            while (animator.isAnimating() && Time::getMillisecondCounter() < timeoutEnd)
+                runFramesFor (5);
+
+            const int64 numFrames = clock.getFrameCount() - startFrame;
+
+            expect (! animator.isAnimating());
+            expect (comp.getBounds() == Rectangle<int> (100, 50, 20, 30));
+
+            // (frames can be dropped when the machine's busy, but never added)
+            expect (numFrames > 1 && numFrames <= (int64) std::ceil (durationMs / interval) + 1,
+                    "took " + String (numFrames) + " frames");
+        }
+
+        clock.setFrameRate (originalRate);
+    }
+};
+
+static FrameClockTests frameClockTests;
+
+#endif
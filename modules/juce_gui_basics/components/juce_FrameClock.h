@@ -0,0 +1,187 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2015 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+#ifndef JUCE_FRAMECLOCK_H_INCLUDED
+#define JUCE_FRAMECLOCK_H_INCLUDED
+
+
+//==============================================================================
+/**
+    A shared clock which paces all animation and repainting to the display's
+    refresh interval.
+
+    Instead of each animating object running its own Timer (and each window flushing
+    its dirty regions whenever the message loop gets round to it), the FrameClock
+    produces a single, evenly-spaced sequence of frames. On each frame it first calls
+    all of its registered Listeners, so that animations can move their components
+    and call Component::repaint(), and then it flushes the pending repaints of every
+    window that was invalidated since the previous frame, so that everything is
+    painted in one pass.
+
+    The clock only runs while there's something for it to do, so an idle app doesn't
+    get woken up 60 times a second.
+
+    ComponentAnimator and AnimatedPosition are both driven by this clock. If you're
+    writing your own animated component, you can either register a Listener for as
+    long as the animation is running, or call requestFrame() each time you need
+    another callback, e.g.
+
+    @code
+    class PulsingComponent  : public Component,
+                              private FrameClock::Listener
+    {
+        void start()                            { FrameClock::getInstance()->requestFrame (this); }
+
+        void frameCallback (double timeMs) override
+        {
+            level = updateLevelForTime (timeMs);
+            repaint();   // painted in this same frame
+
+            if (! finished())
+                FrameClock::getInstance()->requestFrame (this);
+        }
+        ...
+    @endcode
+
+    All methods must be called on the message thread.
+
+    @see ComponentAnimator, AnimatedPosition
+*/
+class JUCE_API  FrameClock  : private Timer,
+                              private DeletedAtShutdown
+{
+public:
+    //==============================================================================
+    juce_DeclareSingleton_SingleThreaded_Minimal (FrameClock)
+
+    //==============================================================================
+    /** An object that receives a callback on each frame of the FrameClock. */
+    class JUCE_API  Listener
+    {
+    public:
+        /** Destructor. */
+        virtual ~Listener();
+
+        /** Called at the start of a frame, before any pending repaints are flushed.
+
+            The time passed in is the nominal time of this frame, in the same units as
+            Time::getMillisecondCounterHiRes(). Successive frames are always exactly one
+            frame interval apart, even if the callback itself happens slightly late, so
+            it's a good time base for animation.
+        */
+        virtual void frameCallback (double frameTimeMs) = 0;
+    };
+
+    /** Registers a listener to be called on every frame until it is removed.
+        While any listeners are registered, the clock will keep running.
+    */
+    void addListener (Listener* listener);
+
+    /** Removes a listener that was added with addListener() or requestFrame().
+        It's safe to call this from inside a frameCallback().
+    */
+    void removeListener (Listener* listener);
+
+    /** Asks for a single callback on the next frame.
+
+        Calling this more than once before the frame arrives has no extra effect. If the
+        listener also needs the frame after that, it can call this again from inside its
+        callback.
+    */
+    void requestFrame (Listener* listener);
+
+    //==============================================================================
+    /** Called by a ComponentPeer when it has dirty regions that it wants painted on
+        the next frame.
+
+        A peer that uses this must implement ComponentPeer::performAnyPendingRepaintsNow(),
+        which the clock will call for it once its listeners have been called.
+        This doesn't need to be called by user code - Component::repaint() will do the
+        right thing.
+    */
+    void addPeerNeedingRepaint (ComponentPeer& peer);
+
+    /** Returns true if windows should leave their pending repaints for the frame clock
+        to flush, rather than scheduling their own.
+        @see setRepaintPacingEnabled
+    */
+    bool isRepaintPacingEnabled() const noexcept            { return repaintPacingEnabled; }
+
+    /** Enables or disables the pacing of window repaints.
+
+        When enabled (the default), windows that support it will hand their dirty
+        regions to the clock instead of running their own repaint timers. Turning it
+        off reverts to each window painting on its own schedule, but animations will
+        still be driven by the clock.
+    */
+    void setRepaintPacingEnabled (bool shouldPaceRepaints) noexcept;
+
+    //==============================================================================
+    /** Sets the rate at which frames are produced.
+        By default this is 60Hz, which matches most displays.
+    */
+    void setFrameRate (double framesPerSecond);
+
+    /** Returns the current frame rate in frames-per-second. */
+    double getFrameRate() const noexcept                    { return 1000.0 / frameIntervalMs; }
+
+    /** Returns the length of a frame in milliseconds. */
+    double getFrameIntervalMs() const noexcept              { return frameIntervalMs; }
+
+    /** Returns the nominal time of the most recent frame, in the same units as
+        Time::getMillisecondCounterHiRes(), or 0 if no frames have happened yet.
+    */
+    double getLastFrameTimeMs() const noexcept              { return lastFrameTime; }
+
+    /** Returns the number of frames that have been produced so far. */
+    int64 getFrameCount() const noexcept                    { return frameCount; }
+
+    /** Immediately runs a frame, calling the listeners and flushing any pending
+        repaints, rather than waiting for the next tick.
+    */
+    void performFrameNow();
+
+private:
+    //==============================================================================
+    FrameClock();
+    ~FrameClock();
+
+    ListenerList<Listener> listeners;
+    Array<Listener*> oneShotListeners, listenersForCurrentFrame;
+    Array<ComponentPeer*> peersNeedingRepaint;
+    double frameIntervalMs, lastFrameTime, nextFrameTime;
+    int64 frameCount;
+    bool repaintPacingEnabled, isInsideFrame;
+
+    bool hasWorkPending() const noexcept;
+    void wakeUp();
+    void scheduleNextFrame();
+    void runFrame (double frameTime);
+    void timerCallback() override;
+
+    JUCE_DECLARE_NON_COPYABLE (FrameClock)
+};
+
+
+#endif   // JUCE_FRAMECLOCK_H_INCLUDED
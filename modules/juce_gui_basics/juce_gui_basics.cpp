@@ -42,6 +42,10 @@
 
 #include "juce_gui_basics.h"
 
+#if JUCE_ENABLE_PAINT_PROFILING && (JUCE_GCC || JUCE_CLANG)
+ #include <cxxabi.h>
+#endif
+
 //==============================================================================
 #if JUCE_MAC
  #import <WebKit/WebKit.h>
@@ -146,6 +150,7 @@ extern bool juce_areThereAnyAlwaysOnTopWindows();
 #include "components/juce_ComponentListener.cpp"
 #include "mouse/juce_MouseInputSource.cpp"
 #include "components/juce_Desktop.cpp"
+#include "components/juce_FrameClock.cpp"
 #include "components/juce_ModalComponentManager.cpp"
 #include "mouse/juce_ComponentDragger.cpp"
 #include "mouse/juce_DragAndDropContainer.cpp"
@@ -252,6 +257,7 @@ extern bool juce_areThereAnyAlwaysOnTopWindows();
 #include "application/juce_Application.cpp"
 #include "misc/juce_BubbleComponent.cpp"
 #include "misc/juce_DropShadower.cpp"
+#include "misc/juce_ComponentPaintProfiler.cpp"
 
 // these classes are C++11-only
 #if JUCE_COMPILER_SUPPORTS_MOVE_SEMANTICS && JUCE_COMPILER_SUPPORTS_INITIALIZER_LISTS && JUCE_COMPILER_SUPPORTS_LAMBDAS
@@ -65,6 +65,15 @@
  #define JUCE_ENABLE_REPAINT_DEBUGGING 0
 #endif
 
+/** Config: JUCE_ENABLE_PAINT_PROFILING
+    If this option is turned on, the ComponentPaintProfiler class can be used to record
+    how long each component takes to paint, how often cached component images are re-used,
+    and how much overdraw there is. When it's off, no profiling code is compiled in.
+*/
+#ifndef JUCE_ENABLE_PAINT_PROFILING
+ #define JUCE_ENABLE_PAINT_PROFILING 0
+#endif
+
 /** JUCE_USE_XRANDR: Enables Xrandr multi-monitor support (Linux only).
     Unless you specifically want to disable this, it's best to leave this option turned on.
     Note that your users do not need to have Xrandr installed for your JUCE app to run, as
@@ -167,6 +176,7 @@ class FlexBox;
 #include "components/juce_ComponentListener.h"
 #include "components/juce_CachedComponentImage.h"
 #include "components/juce_Component.h"
+#include "components/juce_FrameClock.h"
 #include "layout/juce_ComponentAnimator.h"
 #include "components/juce_Desktop.h"
 #include "layout/juce_ComponentBoundsConstrainer.h"
@@ -249,6 +259,7 @@ class FlexBox;
 #include "windows/juce_AlertWindow.h"
 #include "windows/juce_CallOutBox.h"
 #include "windows/juce_ComponentPeer.h"
+#include "misc/juce_ComponentPaintProfiler.h"
 #include "windows/juce_ResizableWindow.h"
 #include "windows/juce_DocumentWindow.h"
 #include "windows/juce_DialogWindow.h"
@@ -35,8 +35,8 @@
     thrown around with the mouse/touch, and by writing your own behaviour class, you can
     customise the trajectory that it follows when released.
 
-    The class uses its own Timer to continuously change its value when a drag ends, and
-    Listener objects can be registered to receive callbacks whenever the value changes.
+    The class uses the shared FrameClock to continuously change its value when a drag ends,
+    and Listener objects can be registered to receive callbacks whenever the value changes.
 
     The value is stored as a double, and can be used to represent whatever units you need.
 
@@ -48,13 +48,14 @@
          AnimatedPositionBehaviours::SnapToPageBoundaries
 */
 template <typename Behaviour>
-class AnimatedPosition  : private Timer
+class AnimatedPosition  : private FrameClock::Listener
 {
 public:
     AnimatedPosition()
         : position(), grabbedPos(), releaseVelocity(),
           range (-std::numeric_limits<double>::max(),
-                  std::numeric_limits<double>::max())
+                  std::numeric_limits<double>::max()),
+          lastUpdateTime(), resumeTime()
     {
     }
 
@@ -77,7 +78,7 @@ public:
     {
         grabbedPos = position;
         releaseVelocity = 0;
-        stopTimer();
+        stopAnimating();
     }
 
     /** Called during a mouse-drag operation, to indicate that the mouse has moved.
@@ -94,7 +95,7 @@ public:
     */
     void endDrag()
     {
-        startTimerHz (60);
+        startAnimating (0);
     }
 
     /** Called outside of a drag operation to cause a nudge in the specified direction.
@@ -102,7 +103,7 @@ public:
     */
     void nudge (double deltaFromCurrentPosition)
     {
-        startTimerHz (10);
+        startAnimating (100);
         moveTo (position + deltaFromCurrentPosition);
     }
 
@@ -119,7 +120,7 @@ public:
     */
     void setPosition (double newPosition)
     {
-        stopTimer();
+        stopAnimating();
         setPositionAndSendChange (newPosition);
     }
 
@@ -153,7 +154,8 @@ private:
     //==============================================================================
     double position, grabbedPos, releaseVelocity;
     Range<double> range;
-    Time lastUpdate, lastDrag;
+    Time lastDrag;
+    double lastUpdateTime, resumeTime;
     ListenerList<Listener> listeners;
 
     static double getSpeed (const Time last, double lastPos,
@@ -185,19 +187,30 @@ private:
         }
     }
 
-    void timerCallback() override
+    void startAnimating (int delayBeforeMovingMs)
     {
-        const Time now = Time::getCurrentTime();
+        resumeTime = Time::getMillisecondCounterHiRes() + delayBeforeMovingMs;
+        FrameClock::getInstance()->addListener (this);
+    }
+
+    void stopAnimating()
+    {
+        if (FrameClock* const clock = FrameClock::getInstanceWithoutCreating())
+            clock->removeListener (this);
+    }
+
+    void frameCallback (double frameTimeMs) override
+    {
+        if (frameTimeMs < resumeTime)
+            return;
 
-        const double elapsed = jlimit (0.001, 0.020, (now - lastUpdate).inSeconds());
-        lastUpdate = now;
+        const double elapsed = jlimit (0.001, 0.020, (frameTimeMs - lastUpdateTime) * 0.001);
+        lastUpdateTime = frameTimeMs;
 
         const double newPos = behaviour.getNextPosition (position, elapsed);
 
         if (behaviour.isStopped (newPos))
-            stopTimer();
-        else
-            startTimerHz (60);
+            stopAnimating();
 
         setPositionAndSendChange (newPos);
     }
@@ -228,10 +228,10 @@ void ComponentAnimator::animateComponent (Component* const component,
         at->reset (finalBounds, finalAlpha, millisecondsToSpendMoving,
                    useProxyComponent, startSpeed, endSpeed);
 
-        if (! isTimerRunning())
+        if (lastTime == 0)
         {
-            lastTime = Time::getMillisecondCounter();
-            startTimerHz (50);
+            lastTime = Time::getMillisecondCounterHiRes();
+            FrameClock::getInstance()->addListener (this);
         }
     }
 }
@@ -303,14 +303,12 @@ bool ComponentAnimator::isAnimating() const noexcept
     return tasks.size() != 0;
 }
 
-void ComponentAnimator::timerCallback()
+void ComponentAnimator::frameCallback (const double frameTimeMs)
 {
-    const uint32 timeNow = Time::getMillisecondCounter();
-
-    if (lastTime == 0 || lastTime == timeNow)
-        lastTime = timeNow;
-
-    const int elapsed = (int) (timeNow - lastTime);
+    // (any fraction of a millisecond is carried over to the next frame, so that
+    // the total time stays accurate even though each timeslice is rounded)
+    const int elapsed = jmax (0, (int) (frameTimeMs - lastTime));
+    lastTime += elapsed;
 
     for (int i = tasks.size(); --i >= 0;)
     {
@@ -321,8 +319,9 @@ void ComponentAnimator::timerCallback()
         }
     }
 
-    lastTime = timeNow;
-
     if (tasks.size() == 0)
-        stopTimer();
+    {
+        FrameClock::getInstance()->removeListener (this);
+        lastTime = 0;
+    }
 }
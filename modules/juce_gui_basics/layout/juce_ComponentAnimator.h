@@ -48,7 +48,7 @@
     @see Desktop::getAnimator
 */
 class JUCE_API  ComponentAnimator  : public ChangeBroadcaster,
-                                     private Timer
+                                     private FrameClock::Listener
 {
 public:
     //==============================================================================
@@ -149,10 +149,10 @@ private:
     //==============================================================================
     class AnimationTask;
     OwnedArray<AnimationTask> tasks;
-    uint32 lastTime;
+    double lastTime;
 
     AnimationTask* findTaskFor (Component*) const noexcept;
-    void timerCallback() override;
+    void frameCallback (double) override;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ComponentAnimator)
 };
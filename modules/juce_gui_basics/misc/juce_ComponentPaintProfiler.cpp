@@ -0,0 +1,436 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2015 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+ComponentPaintProfiler::Stats::Stats() noexcept
+    : deleted (false), numPaints (0),
+      totalSeconds (0), totalSecondsIncludingChildren (0), maxSeconds (0),
+      numCacheHits (0), numCacheMisses (0), pixelsPainted (0)
+{
+}
+
+//==============================================================================
+ComponentPaintProfiler::ComponentPaintProfiler()
+    : numFrames (0), paintCounter (0), totalFrameSeconds (0),
+      totalPixelsPainted (0), totalPixelsInvalidated (0),
+      enabled (false), overlayEnabled (false)
+{
+}
+
+ComponentPaintProfiler::~ComponentPaintProfiler()
+{
+    clearSingletonInstance();
+}
+
+juce_ImplementSingleton_SingleThreaded (ComponentPaintProfiler)
+
+//==============================================================================
+void ComponentPaintProfiler::setEnabled (const bool shouldBeEnabled) noexcept
+{
+    // This will have no effect unless the library is built with paint profiling turned on!
+    jassert (JUCE_ENABLE_PAINT_PROFILING || ! shouldBeEnabled);
+
+    enabled = shouldBeEnabled;
+}
+
+void ComponentPaintProfiler::setOverlayEnabled (const bool shouldShowOverlay) noexcept
+{
+    overlayEnabled = shouldShowOverlay;
+}
+
+void ComponentPaintProfiler::reset()
+{
+    statsForComponent.clear();
+    allStats.clear();
+    currentFrameItems.clearQuick();
+    numFrames = 0;
+    totalFrameSeconds = 0;
+    totalPixelsPainted = 0;
+    totalPixelsInvalidated = 0;
+}
+
+//==============================================================================
+static String getComponentTypeName (const Component& c)
+{
+    const char* const name = typeid (c).name();
+
+   #if JUCE_ENABLE_PAINT_PROFILING && (JUCE_GCC || JUCE_CLANG)
+    int status = 0;
+
+    if (char* const demangled = abi::__cxa_demangle (name, nullptr, nullptr, &status))
+    {
+        const String result (demangled);
+        ::free (demangled);
+        return result;
+    }
+   #endif
+
+    return name;
+}
+
+ComponentPaintProfiler::Stats& ComponentPaintProfiler::getOrCreateStatsFor (const Component& c)
+{
+    if (Stats* const s = statsForComponent [&c])
+        return *s;
+
+    Stats* const s = allStats.add (new Stats());
+
+    s->name = c.getName().isNotEmpty() ? c.getName()
+                                       : (c.getComponentID().isNotEmpty() ? "#" + c.getComponentID()
+                                                                          : String ("(unnamed)"));
+    s->typeName = getComponentTypeName (c);
+
+    statsForComponent.set (&c, s);
+    return *s;
+}
+
+void ComponentPaintProfiler::frameStarted (Component& peerComponent, Rectangle<int> areaBeingPainted)
+{
+    currentPeerComponent = &peerComponent;
+    currentFrameItems.clearQuick();
+    totalPixelsInvalidated += areaBeingPainted.getWidth() * (int64) areaBeingPainted.getHeight();
+}
+
+void ComponentPaintProfiler::frameFinished (Graphics& g, const int64 startTicks)
+{
+    totalFrameSeconds += Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - startTicks);
+    ++numFrames;
+
+    if (overlayEnabled)
+    {
+        for (int i = 0; i < currentFrameItems.size(); ++i)
+        {
+            const FrameItem& item = currentFrameItems.getReference (i);
+
+            // anything taking longer than 4ms is shown in solid red..
+            const float cost = (float) jmin (1.0, item.seconds * 250.0);
+
+            g.setColour (Colours::green.interpolatedWith (Colours::red, cost).withAlpha (0.25f));
+            g.fillRect (item.area);
+
+            if (item.seconds >= 0.001)
+            {
+                g.setColour (Colours::white);
+                g.setFont (10.0f);
+                g.drawText (String (item.seconds * 1000.0, 1) + "ms",
+                            item.area.withHeight (jmin (12, item.area.getHeight())),
+                            Justification::topLeft, false);
+            }
+        }
+    }
+
+    currentFrameItems.clearQuick();
+    currentPeerComponent = nullptr;
+}
+
+void ComponentPaintProfiler::componentPainted (Component& c, Rectangle<int> areaPainted,
+                                               const int64 selfTicks, const int64 totalTicks)
+{
+    ++paintCounter;
+
+    const double seconds = Time::highResolutionTicksToSeconds (selfTicks);
+    const int64 numPixels = areaPainted.getWidth() * (int64) areaPainted.getHeight();
+
+    Stats& s = getOrCreateStatsFor (c);
+    ++s.numPaints;
+    s.totalSeconds += seconds;
+    s.totalSecondsIncludingChildren += Time::highResolutionTicksToSeconds (totalTicks);
+    s.maxSeconds = jmax (s.maxSeconds, seconds);
+    s.pixelsPainted += numPixels;
+
+    totalPixelsPainted += numPixels;
+
+    if (overlayEnabled && ! areaPainted.isEmpty())
+    {
+        Component* const peerComp = currentPeerComponent.getComponent();
+
+        if (peerComp != nullptr && (peerComp == &c || peerComp->isParentOf (&c)))
+        {
+            const FrameItem item = { peerComp->getLocalArea (&c, areaPainted), seconds };
+            currentFrameItems.add (item);
+        }
+    }
+}
+
+void ComponentPaintProfiler::cachedImageUsed (Component& c, const bool wasReRendered)
+{
+    Stats& s = getOrCreateStatsFor (c);
+
+    if (wasReRendered)
+        ++s.numCacheMisses;
+    else
+        ++s.numCacheHits;
+}
+
+void ComponentPaintProfiler::componentDeleted (Component& c)
+{
+    if (Stats* const s = statsForComponent [&c])
+    {
+        s->deleted = true;
+        statsForComponent.remove (&c);
+    }
+}
+
+//==============================================================================
+struct PaintStatsComparator
+{
+    static int compareElements (const ComponentPaintProfiler::Stats& first,
+                                const ComponentPaintProfiler::Stats& second) noexcept
+    {
+        return first.totalSeconds > second.totalSeconds ? -1
+                                                         : (first.totalSeconds < second.totalSeconds ? 1 : 0);
+    }
+};
+
+Array<ComponentPaintProfiler::Stats> ComponentPaintProfiler::getStats() const
+{
+    Array<Stats> result;
+    result.ensureStorageAllocated (allStats.size());
+
+    for (int i = 0; i < allStats.size(); ++i)
+        result.add (*allStats.getUnchecked (i));
+
+    PaintStatsComparator comparator;
+    result.sort (comparator, true);
+    return result;
+}
+
+ComponentPaintProfiler::Stats ComponentPaintProfiler::getStatsFor (const Component& c) const
+{
+    if (const Stats* const s = statsForComponent [&c])
+        return *s;
+
+    return Stats();
+}
+
+double ComponentPaintProfiler::getOverdrawRatio() const noexcept
+{
+    return totalPixelsInvalidated > 0 ? totalPixelsPainted / (double) totalPixelsInvalidated : 0.0;
+}
+
+String ComponentPaintProfiler::createReport (const int maxNumComponentsToList) const
+{
+    const Array<Stats> stats (getStats());
+
+    String report;
+    report << "Paint profile: " << numFrames << " window paints, "
+           << String (totalFrameSeconds * 1000.0, 2) << "ms total, overdraw "
+           << String (getOverdrawRatio(), 2) << "x, "
+           << stats.size() << " components" << newLine
+           << newLine
+           << "    total ms   incl. ms    avg ms    max ms   paints   cache hit/miss   Mpixels  component" << newLine;
+
+    for (int i = 0; i < jmin (maxNumComponentsToList, stats.size()); ++i)
+    {
+        const Stats& s = stats.getReference (i);
+
+        report << String (s.totalSeconds * 1000.0, 2).paddedLeft (' ', 12)
+               << String (s.totalSecondsIncludingChildren * 1000.0, 2).paddedLeft (' ', 11)
+               << String (s.getAverageSeconds() * 1000.0, 3).paddedLeft (' ', 10)
+               << String (s.maxSeconds * 1000.0, 3).paddedLeft (' ', 10)
+               << String (s.numPaints).paddedLeft (' ', 9)
+               << (String (s.numCacheHits) + "/" + String (s.numCacheMisses)).paddedLeft (' ', 17)
+               << String (s.pixelsPainted / 1.0e6, 2).paddedLeft (' ', 10)
+               << "  " << s.name << " [" << s.typeName << "]"
+               << (s.deleted ? " (deleted)" : "") << newLine;
+    }
+
+    return report;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS && JUCE_ENABLE_PAINT_PROFILING
+
+class ComponentPaintProfilerTests  : public UnitTest
+{
+public:
+    ComponentPaintProfilerTests() : UnitTest ("ComponentPaintProfiler") {}
+
+    struct TestComponent  : public Component
+    {
+        TestComponent (const String& name, const int paintTimeMs)
+            : Component (name), paintTime (paintTimeMs), numPaints (0)
+        {
+            setOpaque (true);
+        }
+
+        void paint (Graphics& g) override
+        {
+            ++numPaints;
+            g.fillAll (Colours::grey);
+
+            if (paintTime > 0)
+                Thread::sleep (paintTime);
+        }
+
+        const int paintTime;
+        int numPaints;
+    };
+
+    // Paints the component in the same way that its window would
+    static void paintWindow (ComponentPaintProfiler& profiler, Component& c, Image& target)
+    {
+        Graphics g (target);
+        const bool isProfiling = profiler.isEnabled();
+        const int64 startTicks = Time::getHighResolutionTicks();
+
+        if (isProfiling)
+            profiler.frameStarted (c, g.getClipBounds());
+
+        c.paintEntireComponent (g, true);
+
+        if (isProfiling)
+            profiler.frameFinished (g, startTicks);
+    }
+
+    void runTest() override
+    {
+        // (making components visible needs the Desktop, which this cleans up afterwards)
+        const ScopedJuceInitialiser_GUI libraryInitialiser;
+
+        ComponentPaintProfiler& profiler = *ComponentPaintProfiler::getInstance();
+        profiler.reset();
+        profiler.setEnabled (true);
+
+        TestComponent parent ("parent", 0);
+        TestComponent left ("left", 2);
+        ScopedPointer<TestComponent> right (new TestComponent ("right", 2));
+
+        parent.setBounds (0, 0, 100, 100);
+        left.setBounds (0, 0, 50, 50);
+        right->setBounds (50, 0, 50, 100);
+        parent.addAndMakeVisible (left);
+        parent.addAndMakeVisible (right);
+
+        Image image (Image::RGB, 100, 100, true);
+
+        beginTest ("Paint counts and times");
+        {
+            paintWindow (profiler, parent, image);
+            paintWindow (profiler, parent, image);
+
+            const ComponentPaintProfiler::Stats p (profiler.getStatsFor (parent));
+            const ComponentPaintProfiler::Stats l (profiler.getStatsFor (left));
+            const ComponentPaintProfiler::Stats r (profiler.getStatsFor (*right));
+
+            expectEquals (p.numPaints, 2);
+            expectEquals (l.numPaints, 2);
+            expectEquals (r.numPaints, 2);
+            expect (p.name == "parent" && p.typeName.contains ("TestComponent"));
+
+            expectEquals (p.pixelsPainted, (int64) 2 * 100 * 100);
+            expectEquals (l.pixelsPainted, (int64) 2 * 50 * 50);
+            expectEquals (r.pixelsPainted, (int64) 2 * 50 * 100);
+
+            // the children's paint time counts towards the parent's total, but not its own time
+            expect (l.totalSeconds >= 0.004 && r.totalSeconds >= 0.004);
+            expect (p.totalSecondsIncludingChildren >= l.totalSecondsIncludingChildren + r.totalSecondsIncludingChildren);
+            expect (p.totalSeconds <= p.totalSecondsIncludingChildren - 0.008);
+            expect (l.totalSeconds <= l.totalSecondsIncludingChildren);
+            expect (l.maxSeconds >= 0.002 && l.maxSeconds <= l.totalSeconds);
+
+            const Array<ComponentPaintProfiler::Stats> stats (profiler.getStats());
+            expectEquals (stats.size(), 3);
+            expect (stats.getLast().name == "parent");
+            expectEquals (profiler.getNumFrames(), 2);
+
+            // nothing gets recorded while the profiler's disabled
+            profiler.setEnabled (false);
+            paintWindow (profiler, parent, image);
+            profiler.setEnabled (true);
+
+            expectEquals (left.numPaints, 3);
+            expectEquals (profiler.getStatsFor (left).numPaints, 2);
+            expectEquals (profiler.getNumFrames(), 2);
+        }
+
+        beginTest ("Overdraw");
+        {
+            profiler.reset();
+            paintWindow (profiler, parent, image);
+
+            // every pixel is painted by the parent, and then again by one of its children
+            expectEquals (profiler.getOverdrawRatio(), (100 * 100 + 50 * 50 + 50 * 100) / (double) (100 * 100));
+
+            Image smallerArea (Image::RGB, 50, 50, true);
+            paintWindow (profiler, parent, smallerArea);
+            expectEquals (profiler.getOverdrawRatio(), (100 * 100 + 50 * 50 + 50 * 100 + 2 * 50 * 50) / (double) (100 * 100 + 50 * 50));
+        }
+
+        beginTest ("Cached images");
+        {
+            profiler.reset();
+            left.setBufferedToImage (true);
+
+            paintWindow (profiler, parent, image);
+            paintWindow (profiler, parent, image);
+
+            ComponentPaintProfiler::Stats l (profiler.getStatsFor (left));
+            expectEquals (l.numCacheMisses, 1);
+            expectEquals (l.numCacheHits, 1);
+            expectEquals (l.numPaints, 1);
+
+            left.repaint();
+            paintWindow (profiler, parent, image);
+
+            l = profiler.getStatsFor (left);
+            expectEquals (l.numCacheMisses, 2);
+            expectEquals (l.numCacheHits, 1);
+            expectEquals (l.numPaints, 2);
+            expectEquals (profiler.getStatsFor (parent).numCacheMisses + profiler.getStatsFor (parent).numCacheHits, 0);
+
+            left.setBufferedToImage (false);
+        }
+
+        beginTest ("Deleted components");
+        {
+            right = nullptr;
+
+            Array<ComponentPaintProfiler::Stats> stats (profiler.getStats());
+            int numDeleted = 0;
+
+            for (int i = 0; i < stats.size(); ++i)
+            {
+                if (stats.getReference (i).deleted)
+                {
+                    ++numDeleted;
+                    expect (stats.getReference (i).name == "right");
+                }
+            }
+
+            expectEquals (numDeleted, 1);
+            expect (profiler.createReport().contains ("right [") && profiler.createReport().contains ("(deleted)"));
+
+            // (the stats are kept, but they don't belong to anything that gets created at the same address)
+            TestComponent replacement ("replacement", 0);
+            expectEquals (profiler.getStatsFor (replacement).numPaints, 0);
+        }
+
+        profiler.setEnabled (false);
+        profiler.reset();
+    }
+};
+
+static ComponentPaintProfilerTests componentPaintProfilerTests;
+
+#endif
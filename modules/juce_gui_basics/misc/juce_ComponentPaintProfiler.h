@@ -0,0 +1,190 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2015 - ROLI Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+#ifndef JUCE_COMPONENTPAINTPROFILER_H_INCLUDED
+#define JUCE_COMPONENTPAINTPROFILER_H_INCLUDED
+
+
+//==============================================================================
+/**
+    Measures how long each component spends painting itself.
+
+    When the JUCE_ENABLE_PAINT_PROFILING option is turned on and the profiler has been
+    enabled with setEnabled(), every call that the library makes to Component::paint()
+    and Component::paintOverChildren() is timed, and the results are accumulated
+    per-component. For each component this records:
+
+    - the number of times it was painted
+    - the time spent in its own paint methods, and the time including its children
+    - how often its CachedComponentImage could be re-used rather than re-rendered
+    - the number of pixels it painted, which when compared with the area of the
+      windows that was actually invalidated gives a measure of overdraw.
+
+    You can get the results as a list of Stats objects, or as a text report with
+    createReport(). When the overlay is enabled, each window will also be drawn
+    with a translucent box over each component that was painted, coloured from green
+    to red according to how long it took - areas that are painted many times will
+    appear darker.
+
+    @code
+    ComponentPaintProfiler::getInstance()->setEnabled (true);
+    ...
+    DBG (ComponentPaintProfiler::getInstance()->createReport (30));
+    @endcode
+
+    When JUCE_ENABLE_PAINT_PROFILING is 0 (the default), the class is still available
+    but the Component class won't call it, so there's no overhead at all.
+
+    All methods must be called on the message thread.
+*/
+class JUCE_API  ComponentPaintProfiler  : private DeletedAtShutdown
+{
+public:
+    //==============================================================================
+    juce_DeclareSingleton_SingleThreaded_Minimal (ComponentPaintProfiler)
+
+    //==============================================================================
+    /** Starts or stops recording paint statistics. */
+    void setEnabled (bool shouldBeEnabled) noexcept;
+
+    /** Returns true if the profiler is recording. */
+    bool isEnabled() const noexcept                         { return enabled; }
+
+    /** Enables an overlay which is drawn over each window, showing the areas that
+        were painted and how long they took.
+        The profiler must also be enabled for anything to be shown.
+    */
+    void setOverlayEnabled (bool shouldShowOverlay) noexcept;
+
+    /** Returns true if the overlay is enabled. */
+    bool isOverlayEnabled() const noexcept                  { return overlayEnabled; }
+
+    /** Clears all the statistics that have been collected so far. */
+    void reset();
+
+    //==============================================================================
+    /** The statistics recorded for a single component. */
+    struct Stats
+    {
+        /** Creates an empty Stats object. */
+        Stats() noexcept;
+
+        /** A description of the component, using its name or ID. */
+        String name;
+        /** The C++ type of the component. */
+        String typeName;
+        /** True if the component has been deleted since its stats were recorded. */
+        bool deleted;
+
+        /** The number of times the component has painted itself. */
+        int numPaints;
+        /** The total time spent in the component's paint() and paintOverChildren() methods. */
+        double totalSeconds;
+        /** The total time spent painting the component including all its children. */
+        double totalSecondsIncludingChildren;
+        /** The longest time that a single paint() and paintOverChildren() took. */
+        double maxSeconds;
+
+        /** The number of times that the component's CachedComponentImage could be
+            drawn without re-painting the component. */
+        int numCacheHits;
+        /** The number of times that the component's CachedComponentImage had to be
+            re-rendered. */
+        int numCacheMisses;
+
+        /** The total number of (logical) pixels that the component has painted. */
+        int64 pixelsPainted;
+
+        /** Returns the average time that a paint took. */
+        double getAverageSeconds() const noexcept   { return numPaints > 0 ? totalSeconds / numPaints : 0.0; }
+    };
+
+    /** Returns the stats for all the components that have been painted, sorted so
+        that the ones with the highest total paint time come first.
+    */
+    Array<Stats> getStats() const;
+
+    /** Returns the stats that were recorded for a component, or an empty Stats
+        object if it hasn't been painted.
+    */
+    Stats getStatsFor (const Component& component) const;
+
+    /** Returns the number of window paints that have been recorded. */
+    int getNumFrames() const noexcept                       { return numFrames; }
+
+    /** Returns the total time spent painting all windows. */
+    double getTotalPaintSeconds() const noexcept            { return totalFrameSeconds; }
+
+    /** Returns the ratio between the number of pixels painted by all the components
+        and the area of the windows that was actually invalidated.
+        A value of 1.0 means that every pixel was only drawn once.
+    */
+    double getOverdrawRatio() const noexcept;
+
+    /** Creates a human-readable summary of the statistics, listing the
+        most expensive components first.
+    */
+    String createReport (int maxNumComponentsToList = 50) const;
+
+    //==============================================================================
+    /** @internal */
+    void frameStarted (Component& peerComponent, Rectangle<int> areaBeingPainted);
+    /** @internal */
+    void frameFinished (Graphics&, int64 startTicks);
+    /** @internal */
+    void componentPainted (Component&, Rectangle<int> areaPainted, int64 selfTicks, int64 totalTicks);
+    /** @internal */
+    void cachedImageUsed (Component&, bool wasReRendered);
+    /** @internal */
+    void componentDeleted (Component&);
+    /** @internal */
+    int getPaintCounter() const noexcept                    { return paintCounter; }
+
+private:
+    //==============================================================================
+    struct FrameItem
+    {
+        Rectangle<int> area;
+        double seconds;
+    };
+
+    HashMap<const Component*, Stats*> statsForComponent;
+    OwnedArray<Stats> allStats;
+    Array<FrameItem> currentFrameItems;
+    Component::SafePointer<Component> currentPeerComponent;
+    int numFrames, paintCounter;
+    double totalFrameSeconds;
+    int64 totalPixelsPainted, totalPixelsInvalidated;
+    bool enabled, overlayEnabled;
+
+    ComponentPaintProfiler();
+    ~ComponentPaintProfiler();
+
+    Stats& getOrCreateStatsFor (const Component&);
+
+    JUCE_DECLARE_NON_COPYABLE (ComponentPaintProfiler)
+};
+
+
+#endif   // JUCE_COMPONENTPAINTPROFILER_H_INCLUDED
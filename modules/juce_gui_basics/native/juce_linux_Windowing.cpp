@@ -2563,7 +2563,7 @@ private:
                 return;
            #endif
 
-            if (! regionsNeedingRepaint.isEmpty())
+            if (! (regionsNeedingRepaint.isEmpty() || isPacedByFrameClock()))
             {
                 stopTimer();
                 performAnyPendingRepaintsNow();
@@ -2577,9 +2577,7 @@ private:
 
         void repaint (const Rectangle<int>& area)
         {
-            if (! isTimerRunning())
-                startTimer (repaintTimerPeriod);
-
+            scheduleRepaint();
             regionsNeedingRepaint.add (area * peer.currentScaleFactor);
         }
 
@@ -2588,7 +2586,7 @@ private:
            #if JUCE_USE_XSHM
             if (shmPaintsPending != 0)
             {
-                startTimer (repaintTimerPeriod);
+                scheduleRepaint();
                 return;
             }
            #endif
@@ -2647,7 +2645,7 @@ private:
             }
 
             lastTimeImageUsed = Time::getApproximateMillisecondCounter();
-            startTimer (repaintTimerPeriod);
+            startTimer (isPacedByFrameClock() ? imageReleaseTimerPeriod : repaintTimerPeriod);
         }
 
        #if JUCE_USE_XSHM
@@ -2655,7 +2653,23 @@ private:
        #endif
 
     private:
-        enum { repaintTimerPeriod = 1000 / 100 };
+        enum { repaintTimerPeriod = 1000 / 100,
+               imageReleaseTimerPeriod = 1000 };
+
+        static bool isPacedByFrameClock()
+        {
+            return FrameClock::getInstance()->isRepaintPacingEnabled();
+        }
+
+        // When the frame clock is pacing repaints, it'll call performAnyPendingRepaintsNow()
+        // on its next frame, and our own timer is only used to release the image.
+        void scheduleRepaint()
+        {
+            if (isPacedByFrameClock())
+                FrameClock::getInstance()->addPeerNeedingRepaint (peer);
+            else if (! isTimerRunning())
+                startTimer (repaintTimerPeriod);
+        }
 
         LinuxComponentPeer& peer;
         Image image;
@@ -3733,6 +3747,19 @@ ComponentPeer* Component::createNewPeer (int styleFlags, void* nativeWindowToAtt
 //==============================================================================
 void Desktop::Displays::findDisplays (float masterScale)
 {
+    // Without a connection to an X server (e.g. when running headless unit tests), there's
+    // nothing to query, so just pretend there's a single main display
+    if (display == nullptr)
+    {
+        Desktop::Displays::Display d;
+        d.isMain = true;
+        d.scale = masterScale;
+        d.dpi = 96.0;
+        d.totalArea = d.userArea = Rectangle<int> (1024, 768);
+        displays.add (d);
+        return;
+    }
+
     DisplayGeometry& geometry = DisplayGeometry::getOrCreateInstance (display, masterScale);
 
     // add the main display first
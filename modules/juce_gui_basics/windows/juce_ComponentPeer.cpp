@@ -129,12 +129,26 @@ void ComponentPeer::handlePaint (LowLevelGraphicsContext& contextToPaintTo)
     }
   #endif
 
+   #if JUCE_ENABLE_PAINT_PROFILING
+    ComponentPaintProfiler* const profiler = ComponentPaintProfiler::getInstanceWithoutCreating();
+    const bool isProfiling = profiler != nullptr && profiler->isEnabled();
+    const int64 paintStartTime = isProfiling ? Time::getHighResolutionTicks() : 0;
+
+    if (isProfiling)
+        profiler->frameStarted (component, g.getClipBounds());
+   #endif
+
     JUCE_TRY
     {
         component.paintEntireComponent (g, true);
     }
     JUCE_CATCH_EXCEPTION
 
+   #if JUCE_ENABLE_PAINT_PROFILING
+    if (isProfiling)
+        profiler->frameFinished (g, paintStartTime);
+   #endif
+
   #if JUCE_ENABLE_REPAINT_DEBUGGING
    #ifdef JUCE_IS_REPAINT_DEBUGGING_ACTIVE
     if (JUCE_IS_REPAINT_DEBUGGING_ACTIVE)